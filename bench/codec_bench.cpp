@@ -0,0 +1,356 @@
+///////////////////////////////////////////////////////////////////////////
+// codec_bench.cpp — QuoteCodec Round-Trip Fuzzer and Throughput Benchmark
+//
+// Fuzz: drives an Encoder/Decoder pair through random sessions (symbols
+// joining and leaving, random tick moves, repeated rows, late joiners
+// starting from a snapshot) and checks every decoded board against the
+// input; feeds truncated and bit-flipped messages to a decoder, which must
+// reject or survive them; round-trips random bar windows at 0..6 decimals.
+//
+// Throughput: a 400-symbol board where ~10% of symbols move per poll,
+// timed through Update/Apply and Snapshot/Apply, with bytes per poll
+// against the fixed-width records ProxyProtocol v1 sent.
+//
+// Portable; CMake target codec_bench (run by ctest), or by hand:
+//
+//   g++ -O2 -std=c++17 -Iinclude -o codec_bench bench/codec_bench.cpp
+//       src/QuoteCodec.cpp
+//   ./codec_bench [--rounds 5000] [--iters 20000] [--seed 1]
+///////////////////////////////////////////////////////////////////////////
+
+#include "QuoteCodec.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+double Now() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+uint64_t g_rng = 1;
+
+uint32_t Next() {
+  g_rng = g_rng * 6364136223846793005ull + 1442695040888963407ull;
+  return (uint32_t)(g_rng >> 33);
+}
+
+int64_t Range(int64_t lo, int64_t hi) {
+  return lo + (int64_t)(Next() % (uint64_t)(hi - lo + 1));
+}
+
+// A quote on the wire grid, shaped like ParseLatestPriceHtml output
+void RandomQuote(DseQuote &q, bool small) {
+  int64_t span = small ? 50 : 10000000;
+  int64_t ltp = Range(0, span);
+  q.ltp = ltp / 100.0;
+  q.high = (ltp + Range(0, span / 10)) / 100.0;
+  q.low = (ltp - Range(0, span / 10)) / 100.0;
+  q.close = Range(0, span) / 100.0;
+  q.ycp = Range(0, span) / 100.0;
+  q.open = Next() % 4 ? q.ycp : Range(0, span) / 100.0;
+  q.change = Range(-span, span) / 100.0;
+  q.volume = (double)Range(0, small ? 1000 : 4000000000ll);
+  q.trade = (double)Range(0, 100000);
+  q.value = Range(0, 50000000) / 1000.0;
+  q.valid = Next() % 8 != 0;
+  q.changePercent = q.ycp > 0 ? ((q.ltp - q.ycp) / q.ycp) * 100.0 : 0;
+}
+
+bool SameQuote(const DseQuote &a, const DseQuote &b) {
+  return strcmp(a.symbol, b.symbol) == 0 && a.ltp == b.ltp &&
+         a.high == b.high && a.low == b.low && a.open == b.open &&
+         a.close == b.close && a.ycp == b.ycp && a.change == b.change &&
+         a.changePercent == b.changePercent && a.volume == b.volume &&
+         a.trade == b.trade && a.value == b.value && a.valid == b.valid;
+}
+
+// Decoded board (by ID) against the expected one (by symbol)
+bool SameBoard(const QuoteCodec::Decoder &dec,
+               const std::map<std::string, DseQuote> &want) {
+  size_t live = 0;
+  for (const DseQuote &q : dec.Board()) {
+    if (!q.symbol[0])
+      continue;
+    ++live;
+    auto it = want.find(q.symbol);
+    if (it == want.end() || !SameQuote(it->second, q))
+      return false;
+  }
+  return live == want.size();
+}
+
+int FuzzSessions(int rounds) {
+  int failures = 0;
+  for (int round = 0; round < rounds; ++round) {
+    QuoteCodec::Encoder enc;
+    QuoteCodec::Decoder dec;
+    std::map<std::string, DseQuote> board;
+    int universe = (int)Range(1, 60);
+    bool small = Next() % 2 == 0;
+    int steps = (int)Range(1, 30);
+
+    for (int step = 0; step < steps; ++step) {
+      // Symbols join and leave; the rest move now and then
+      for (int s = 0; s < universe; ++s) {
+        char name[32];
+        snprintf(name, sizeof(name), Next() % 5 ? "S%d" : "L%030d", s);
+        auto it = board.find(name);
+        if (it == board.end()) {
+          if (Next() % 3 == 0) {
+            DseQuote q;
+            memset(&q, 0, sizeof(q));
+            snprintf(q.symbol, sizeof(q.symbol), "%s", name);
+            RandomQuote(q, small);
+            board[q.symbol] = q;
+          }
+        } else if (Next() % 10 == 0) {
+          board.erase(it);
+        } else if (Next() % 3 == 0) {
+          RandomQuote(it->second, small);
+        }
+      }
+
+      std::vector<DseQuote> rows;
+      for (const auto &e : board)
+        rows.push_back(e.second);
+      if (!rows.empty() && Next() % 4 == 0)
+        rows.push_back(rows[Next() % rows.size()]); // repeated row
+      for (size_t i = rows.size(); i > 1; --i)
+        std::swap(rows[i - 1], rows[Next() % i]);
+      // A repeated row keeps the first; expect whichever came first
+      std::map<std::string, DseQuote> want;
+      for (const auto &q : rows)
+        want.emplace(q.symbol, q);
+
+      std::string msg;
+      if (step == 0) {
+        enc.Update(rows.data(), rows.size(), msg);
+        msg.clear();
+        enc.Snapshot(msg);
+      } else {
+        enc.Update(rows.data(), rows.size(), msg);
+      }
+      if (!dec.Apply(msg.data(), msg.size()) || !SameBoard(dec, want)) {
+        printf("FAIL round %d step %d: delta round trip\n", round, step);
+        ++failures;
+        break;
+      }
+
+      // A late joiner starting from a snapshot sees the same board
+      if (Next() % 4 == 0) {
+        QuoteCodec::Decoder late;
+        std::string snap;
+        enc.Snapshot(snap);
+        if (!late.Apply(snap.data(), snap.size()) || !SameBoard(late, want)) {
+          printf("FAIL round %d step %d: snapshot round trip\n", round, step);
+          ++failures;
+          break;
+        }
+      }
+
+      // Damaged copies must be rejected or decode without harm
+      if (!msg.empty() && Next() % 2 == 0) {
+        QuoteCodec::Decoder bad = dec;
+        std::string damaged = msg;
+        if (Next() % 2)
+          damaged.resize(Next() % damaged.size());
+        else
+          damaged[Next() % damaged.size()] ^= (char)(1 << (Next() % 8));
+        if (!bad.Apply(damaged.data(), damaged.size()) && bad.HasBoard()) {
+          printf("FAIL round %d step %d: rejected message kept the board\n",
+                 round, step);
+          ++failures;
+          break;
+        }
+      }
+    }
+  }
+  return failures;
+}
+
+// Random bytes after a valid header must never crash the decoder
+void FuzzGarbage(int rounds) {
+  for (int round = 0; round < rounds; ++round) {
+    std::string junk;
+    junk.push_back((char)QuoteCodec::kVersion);
+    junk.push_back((char)(1 + Next() % 2));
+    size_t n = Next() % 64;
+    for (size_t i = 0; i < n; ++i)
+      junk.push_back((char)Next());
+    QuoteCodec::Decoder dec;
+    dec.Apply(junk.data(), junk.size());
+    std::vector<DseBar> bars;
+    junk[1] = (char)(Next() % 8);
+    QuoteCodec::DecodeBars(junk.data(), junk.size(), bars);
+  }
+}
+
+int FuzzBars(int rounds) {
+  static const double kPow10[] = {1, 10, 100, 1e3, 1e4, 1e5, 1e6};
+  int failures = 0;
+  for (int round = 0; round < rounds; ++round) {
+    int decimals = (int)Range(0, 6);
+    double scale = kPow10[decimals];
+    std::vector<DseBar> bars((size_t)Range(0, 300));
+    int y = (int)Range(1990, 2030), m = 1, d = 1;
+    for (DseBar &b : bars) {
+      memset(&b, 0, sizeof(b));
+      d += (int)Range(1, 4);
+      if (d > 28) {
+        d = 1;
+        if (++m > 12) {
+          m = 1;
+          ++y;
+        }
+      }
+      b.year = y;
+      b.month = m;
+      b.day = d;
+      b.open = Range(0, 10000000) / scale;
+      b.high = Range(0, 10000000) / scale;
+      b.low = Range(0, 10000000) / scale;
+      b.close = Range(0, 10000000) / scale;
+      b.volume = (double)Range(0, 4000000000ll);
+      b.trade = (double)Range(0, 100000);
+      b.value = Range(0, 50000000) / 1000.0;
+      b.valid = Next() % 8 != 0;
+      b.provisional = Next() % 16 == 0;
+    }
+    if (!bars.empty() && Next() % 8 == 0)
+      std::swap(bars.front(), bars.back()); // out of order still works
+
+    std::string msg;
+    QuoteCodec::EncodeBars(bars.data(), bars.size(), msg);
+    std::vector<DseBar> out;
+    bool ok = QuoteCodec::DecodeBars(msg.data(), msg.size(), out) &&
+              out.size() == bars.size();
+    for (size_t i = 0; ok && i < bars.size(); ++i) {
+      const DseBar &a = bars[i], &b = out[i];
+      ok = a.year == b.year && a.month == b.month && a.day == b.day &&
+           a.open == b.open && a.high == b.high && a.low == b.low &&
+           a.close == b.close && a.volume == b.volume && a.trade == b.trade &&
+           a.value == b.value && a.valid == b.valid &&
+           a.provisional == b.provisional;
+    }
+    if (!ok) {
+      printf("FAIL bars round %d (%d decimals)\n", round, decimals);
+      ++failures;
+    }
+  }
+  return failures;
+}
+
+void Report(const char *name, int iters, size_t bytes, double sec) {
+  printf("%-16s %8.0f msgs/s %8.1f MB/s %8.1f bytes/msg\n", name, iters / sec,
+         bytes / 1048576.0 / sec, (double)bytes / iters);
+}
+
+int Throughput(int iters) {
+  const int kSymbols = 400;
+  std::vector<DseQuote> board(kSymbols);
+  for (int s = 0; s < kSymbols; ++s) {
+    memset(&board[s], 0, sizeof(DseQuote));
+    snprintf(board[s].symbol, sizeof(board[s].symbol), "SYM%04d", s);
+    RandomQuote(board[s], false);
+    board[s].valid = true;
+  }
+
+  // Pre-build the polls so the timing covers only the codec
+  std::vector<std::vector<DseQuote>> polls((size_t)iters);
+  for (auto &poll : polls) {
+    for (int k = 0; k < kSymbols / 10; ++k) {
+      DseQuote &q = board[Next() % kSymbols];
+      q.ltp += Range(-20, 20) / 100.0;
+      q.high = q.ltp > q.high ? q.ltp : q.high;
+      q.low = q.ltp < q.low ? q.ltp : q.low;
+      q.volume += (double)Range(1, 5000);
+      q.trade += 1;
+      q.value += Range(1, 500) / 1000.0;
+    }
+    poll = board;
+  }
+
+  // Both ends start from the opening board
+  QuoteCodec::Encoder enc;
+  QuoteCodec::Decoder dec;
+  std::string open;
+  enc.Update(board.data(), board.size(), open);
+  open.clear();
+  enc.Snapshot(open);
+  dec.Apply(open.data(), open.size());
+
+  std::vector<std::string> msgs((size_t)iters);
+  double t = Now();
+  for (int i = 0; i < iters; ++i)
+    enc.Update(polls[i].data(), polls[i].size(), msgs[i]);
+  double encSec = Now() - t;
+  size_t bytes = 0;
+  for (const auto &m : msgs)
+    bytes += m.size();
+
+  int applied = 0;
+  t = Now();
+  for (int i = 0; i < iters; ++i)
+    applied += dec.Apply(msgs[i].data(), msgs[i].size());
+  double decSec = Now() - t;
+  if (applied != iters)
+    printf("FAIL: %d of %d deltas rejected\n", iters - applied, iters);
+
+  Report("delta encode", iters, bytes, encSec);
+  Report("delta decode", iters, bytes, decSec);
+
+  std::string snap;
+  int snaps = iters / 10 > 0 ? iters / 10 : 1;
+  t = Now();
+  for (int i = 0; i < snaps; ++i) {
+    snap.clear();
+    enc.Snapshot(snap);
+  }
+  Report("snapshot encode", snaps, snap.size() * snaps, Now() - t);
+  QuoteCodec::Decoder late;
+  t = Now();
+  for (int i = 0; i < snaps; ++i)
+    late.Apply(snap.data(), snap.size());
+  Report("snapshot decode", snaps, snap.size() * snaps, Now() - t);
+
+  // v1: u8 len + symbol, 11 doubles, u8 valid per changed quote
+  double v1Delta = 24 + (kSymbols / 10) * (1 + 7 + 11 * 8 + 1);
+  double v1Snap = 24 + kSymbols * (1 + 7 + 11 * 8 + 1);
+  printf("bytes per poll: delta %.0f (v1 %.0f), snapshot %zu (v1 %.0f)\n",
+         (double)bytes / iters, v1Delta, snap.size(), v1Snap);
+  return applied == iters ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int rounds = 5000, iters = 20000;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (!strcmp(argv[i], "--rounds"))
+      rounds = atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "--iters"))
+      iters = atoi(argv[i + 1]);
+    else if (!strcmp(argv[i], "--seed"))
+      g_rng = strtoull(argv[i + 1], NULL, 10);
+  }
+
+  double t = Now();
+  int failures = FuzzSessions(rounds);
+  FuzzGarbage(rounds * 20);
+  failures += FuzzBars(rounds / 5 > 0 ? rounds / 5 : 1);
+  printf("%s: fuzz %d rounds, %d failures (%.1f s)\n",
+         failures ? "FAIL" : "ok", rounds, failures, Now() - t);
+
+  if (iters > 0)
+    failures += Throughput(iters);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,319 @@
+///////////////////////////////////////////////////////////////////////////
+// dse_bench.cpp — Parser Throughput Benchmarks
+//
+// Runs every hot-path parser over the recorded fixture corpus in
+// bench/fixtures and reports, per fixture:
+//
+//   MB/s, rows/s     input bytes and input rows per second of parse time
+//   allocs/row       heap allocations per input row (global operator new)
+//   p50, p99         per-page (per-call) parse latency in microseconds
+//
+// engine_market drives DseDataEngine::FetchMarketHistory end to end
+// (chunking, parse, per-symbol merge, cache) with an HttpClient that
+// serves the market archive page; its "out" column is symbols updated.
+//
+// then compares MB/s against bench/baseline.txt. A case more than
+// --max-regress percent (default 25) below its baseline fails the run.
+// Builds on any platform with the dse_bench CMake target:
+//
+//   cmake -S . -B build && cmake --build build --target dse_bench
+//   ./build/dse_bench [--fixtures DIR] [--baseline FILE] [--iters N]
+//                     [--max-regress PCT] [--write-baseline FILE]
+///////////////////////////////////////////////////////////////////////////
+
+#include "CsvSeedLoader.h"
+#include "CsvUtils.h"
+#include "DseDataEngine.h"
+#include "DsePageParser.h"
+#include "HttpClient.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifndef DSE_BENCH_FIXTURES
+#define DSE_BENCH_FIXTURES "bench/fixtures"
+#endif
+#ifndef DSE_BENCH_BASELINE
+#define DSE_BENCH_BASELINE "bench/baseline.txt"
+#endif
+
+// ─────────────────────────────────────────────────────────
+// Allocation counting (engine cases allocate on worker threads too)
+// ─────────────────────────────────────────────────────────
+
+static std::atomic<size_t> g_allocs(0);
+
+void *operator new(size_t n) {
+  g_allocs.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc();
+}
+void *operator new[](size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+namespace {
+
+double Now() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+bool ReadFile(const std::string &path, std::string &out) {
+  FILE *fp = fopen(path.c_str(), "rb");
+  if (!fp)
+    return false;
+  char buf[65536];
+  size_t n;
+  out.clear();
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+    out.append(buf, n);
+  fclose(fp);
+  return true;
+}
+
+// Input rows: <tr> elements after the header row, or CSV lines after the
+// header. Counted once per fixture so every parser is measured the same way.
+size_t CountInputRows(const std::string &data, bool html) {
+  size_t n = 0;
+  if (html) {
+    for (size_t p = 0; (p = data.find("<tr", p)) != std::string::npos; p += 3)
+      ++n;
+  } else {
+    n = std::count(data.begin(), data.end(), '\n');
+    if (!data.empty() && data.back() != '\n')
+      ++n;
+  }
+  return n > 0 ? n - 1 : 0;
+}
+
+// Serves one page for every request, so engine paths run offline
+class FixtureHttpClient : public HttpClient {
+public:
+  const std::string *page = nullptr;
+
+  bool Open(const char *, int, const LogFn &) override {
+    m_open = true;
+    return true;
+  }
+  void Configure(const char *, int) override {}
+  void Close() override { m_open = false; }
+  bool IsOpen() const override { return m_open; }
+
+  bool Get(const char *, std::string &outBody) override {
+    if (!page)
+      return false;
+    outBody = *page;
+    return true;
+  }
+  bool Post(const char *url, const char *, std::string &outBody) override {
+    return Get(url, outBody);
+  }
+
+private:
+  bool m_open = false;
+};
+
+struct Case {
+  const char *name;
+  const char *file;
+  bool html;
+  // One parse of the whole input; returns rows the parser produced
+  std::function<size_t(const std::string &)> run;
+};
+
+struct Result {
+  std::string name;
+  size_t bytes, inRows, outRows, iters;
+  double mbps, rowsPerSec, allocsPerRow, p50us, p99us;
+};
+
+Result Measure(const Case &c, const std::string &data, int minIters,
+               double minSeconds) {
+  Result r;
+  r.name = c.name;
+  r.bytes = data.size();
+  r.inRows = CountInputRows(data, c.html);
+  r.outRows = c.run(data); // warm-up
+
+  std::vector<double> times;
+  size_t allocs = 0;
+  double total = 0;
+  while ((int)times.size() < minIters || total < minSeconds) {
+    size_t a = g_allocs;
+    double t = Now();
+    c.run(data);
+    double dt = Now() - t;
+    allocs += g_allocs - a; // before push_back, which may allocate
+    times.push_back(dt);
+    total += dt;
+  }
+
+  r.iters = times.size();
+  std::sort(times.begin(), times.end());
+  r.p50us = times[times.size() / 2] * 1e6;
+  r.p99us = times[std::min(times.size() - 1, times.size() * 99 / 100)] * 1e6;
+  r.mbps = r.bytes * (double)r.iters / (1024.0 * 1024.0) / total;
+  r.rowsPerSec = r.inRows * (double)r.iters / total;
+  r.allocsPerRow =
+      r.inRows ? (double)allocs / ((double)r.inRows * r.iters) : 0;
+  return r;
+}
+
+std::map<std::string, double> ReadBaseline(const char *path) {
+  std::map<std::string, double> base;
+  FILE *fp = fopen(path, "r");
+  if (!fp)
+    return base;
+  char line[256], name[128];
+  double mbps;
+  while (fgets(line, sizeof(line), fp))
+    if (line[0] != '#' && sscanf(line, "%127s %lf", name, &mbps) == 2)
+      base[name] = mbps;
+  fclose(fp);
+  return base;
+}
+
+bool WriteBaseline(const char *path, const std::vector<Result> &results) {
+  FILE *fp = fopen(path, "w");
+  if (!fp)
+    return false;
+  fprintf(fp, "# dse_bench baseline: <case> <MB/s>\n"
+              "# Regenerate with: dse_bench --write-baseline <this file>\n");
+  for (const Result &r : results)
+    fprintf(fp, "%s %.1f\n", r.name.c_str(), r.mbps);
+  fclose(fp);
+  return true;
+}
+
+void Usage() {
+  fprintf(stderr,
+          "usage: dse_bench [--fixtures DIR] [--baseline FILE] [--iters N]\n"
+          "                 [--max-regress PCT] [--write-baseline FILE]\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string fixtures = DSE_BENCH_FIXTURES;
+  const char *baselinePath = DSE_BENCH_BASELINE;
+  const char *writePath = nullptr;
+  int minIters = 50;
+  double maxRegress = 25;
+
+  for (int i = 1; i < argc; ++i) {
+    bool more = i + 1 < argc;
+    if (!strcmp(argv[i], "--fixtures") && more)
+      fixtures = argv[++i];
+    else if (!strcmp(argv[i], "--baseline") && more)
+      baselinePath = argv[++i];
+    else if (!strcmp(argv[i], "--write-baseline") && more)
+      writePath = argv[++i];
+    else if (!strcmp(argv[i], "--iters") && more)
+      minIters = std::max(1, atoi(argv[++i]));
+    else if (!strcmp(argv[i], "--max-regress") && more)
+      maxRegress = atof(argv[++i]);
+    else {
+      Usage();
+      return 2;
+    }
+  }
+
+  auto archive = [](const std::string &html) -> size_t {
+    int n = DsePageParser::ParseArchiveTable(
+        html, [](const std::string &, const DseBar &) {});
+    return n > 0 ? (size_t)n : 0;
+  };
+  auto latest = [](const std::string &html) -> size_t {
+    std::vector<DseQuote> quotes;
+    DsePageParser::ParseLatestPriceHtml(html, quotes);
+    return quotes.size();
+  };
+  auto amarstock = [](const std::string &csv) -> size_t {
+    std::vector<DseBar> bars;
+    CsvUtils::ParseAmarstockCsv(csv, "DSEX", bars);
+    return bars.size();
+  };
+  auto seed = [](const std::string &csv) -> size_t {
+    std::vector<DseBar> bars;
+    return CsvSeedLoader::Parse(csv.data(), csv.size(), bars);
+  };
+
+  // Built-in defaults (no INI); the fixture covers 2024-06-02..04
+  FixtureHttpClient *http = new FixtureHttpClient();
+  DseDataEngine engine;
+  engine.SetHttpClient(std::unique_ptr<HttpClient>(http));
+  engine.Initialize("");
+  auto engineMarket = [&engine, http](const std::string &html) -> size_t {
+    http->page = &html;
+    return (size_t)engine.FetchMarketHistory("2024-06-02", "2024-06-04");
+  };
+
+  const Case cases[] = {
+      {"archive_symbol", "dse_archive_symbol.html", true, archive},
+      {"archive_market", "dse_archive_market.html", true, archive},
+      {"latest_price", "dse_latest_price.html", true, latest},
+      {"amarstock_csv", "amarstock_day.csv", false, amarstock},
+      {"seed_csv_1y", "seed_1y.csv", false, seed},
+      {"seed_csv_25y", "seed_25y.csv", false, seed},
+      {"engine_market", "dse_archive_market.html", true, engineMarket},
+  };
+
+  std::vector<Result> results;
+  for (const Case &c : cases) {
+    std::string data;
+    if (!ReadFile(fixtures + "/" + c.file, data)) {
+      fprintf(stderr, "dse_bench: cannot read %s/%s\n", fixtures.c_str(),
+              c.file);
+      return 2;
+    }
+    results.push_back(Measure(c, data, minIters, 0.25));
+  }
+
+  std::map<std::string, double> base = ReadBaseline(baselinePath);
+  int regressions = 0;
+  printf("%-15s %8s %7s %7s %9s %11s %10s %9s %9s  %s\n", "case", "KB",
+         "rows", "out", "MB/s", "rows/s", "allocs/row", "p50 us", "p99 us",
+         "vs baseline");
+  for (const Result &r : results) {
+    char delta[64] = "-";
+    auto it = base.find(r.name);
+    if (it != base.end() && it->second > 0) {
+      double pct = (r.mbps / it->second - 1) * 100;
+      bool slow = pct < -maxRegress;
+      regressions += slow;
+      snprintf(delta, sizeof(delta), "%+.1f%%%s", pct,
+               slow ? "  REGRESSION" : "");
+    }
+    printf("%-15s %8.1f %7zu %7zu %9.1f %11.0f %10.2f %9.1f %9.1f  %s\n",
+           r.name.c_str(), r.bytes / 1024.0, r.inRows, r.outRows, r.mbps,
+           r.rowsPerSec, r.allocsPerRow, r.p50us, r.p99us, delta);
+  }
+
+  if (writePath) {
+    if (!WriteBaseline(writePath, results)) {
+      fprintf(stderr, "dse_bench: cannot write %s\n", writePath);
+      return 2;
+    }
+    printf("baseline written to %s\n", writePath);
+  } else if (base.empty()) {
+    printf("no baseline at %s\n", baselinePath);
+  }
+
+  if (regressions)
+    printf("FAIL: %d case(s) more than %.0f%% below baseline\n", regressions,
+           maxRegress);
+  return regressions ? 1 : 0;
+}
@@ -0,0 +1,224 @@
+///////////////////////////////////////////////////////////////////////////
+// seed_loader_bench.cpp — CSV Seed Loader Microbenchmark
+//
+// Writes a synthetic 25-year seed set (one Format B file per symbol,
+// 240 trading days a year) and times three ways of loading it:
+//
+//   reference  the previous fgets/strtok/atof loop, one file at a time
+//   serial     CsvSeedLoader::LoadFile, one file at a time
+//   parallel   CsvSeedLoader::LoadMany on every core
+//   market     CsvSeedLoader::LoadMarketFile on the same rows written as
+//              one Format A file, interleaved by date like a vendor dump
+//
+// and checks that all of them produce identical bars. Portable; builds
+// without the plugin or Windows headers (CMake target seed_loader_bench,
+// or by hand):
+//
+//   g++ -O2 -std=c++17 -Iinclude -o seed_loader_bench
+//       bench/seed_loader_bench.cpp src/CsvSeedLoader.cpp
+//       src/MappedFile.cpp -lpthread
+//   ./seed_loader_bench [dir=seed_bench_data] [symbols=400] [years=25]
+///////////////////////////////////////////////////////////////////////////
+
+#include "CsvSeedLoader.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#define MAKE_DIR(d) _mkdir(d)
+#define SEP "\\"
+#else
+#include <sys/stat.h>
+#define MAKE_DIR(d) mkdir(d, 0755)
+#define SEP "/"
+#endif
+
+namespace {
+
+double Now() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Random walk of prices with DSE-like magnitudes (2 decimals)
+uint64_t Generate(const char *dir, int symbols, int years,
+                  std::vector<std::string> &names) {
+  MAKE_DIR(dir);
+  uint64_t total = 0;
+  uint32_t rng = 12345;
+  auto next = [&rng]() {
+    rng = rng * 1664525u + 1013904223u;
+    return rng >> 8;
+  };
+  for (int s = 0; s < symbols; ++s) {
+    char name[32];
+    snprintf(name, sizeof(name), "SYM%04d", s);
+    names.push_back(name);
+    std::string path = std::string(dir) + SEP + name + ".csv";
+    FILE *fp = fopen(path.c_str(), "wb");
+    if (!fp)
+      continue;
+    total += fprintf(fp, "Date,Open,High,Low,Close,Volume\r\n");
+    double px = 10 + (next() % 50000) / 100.0;
+    for (int y = 2000; y < 2000 + years; ++y)
+      for (int m = 1; m <= 12; ++m)
+        for (int d = 1; d <= 28; ++d) {
+          if ((d % 7) == 5 || (d % 7) == 6)
+            continue; // weekend-ish gaps, 240 rows a year
+          double o = px;
+          double c = o * (1 + ((int)(next() % 801) - 400) / 10000.0);
+          if (c < 1)
+            c = 1;
+          double h = (o > c ? o : c) * (1 + (next() % 200) / 10000.0);
+          double l = (o < c ? o : c) * (1 - (next() % 200) / 10000.0);
+          total += fprintf(fp, "%04d-%02d-%02d,%.2f,%.2f,%.2f,%.2f,%u\r\n",
+                           y, m, d, o, h, l, c, next() % 5000000);
+          px = c;
+        }
+    fclose(fp);
+  }
+  return total;
+}
+
+// The loop LoadCsvSeed used before CsvSeedLoader, kept for comparison
+bool ReferenceLoad(const char *path, std::vector<DseBar> &out) {
+  FILE *fp = fopen(path, "r");
+  if (!fp)
+    return false;
+  char line[2048];
+  while (fgets(line, sizeof(line), fp)) {
+    char *p = line + strlen(line) - 1;
+    while (p >= line && (*p == '\n' || *p == '\r' || *p == ' ' || *p == '\t'))
+      *p-- = 0;
+    if (!line[0])
+      continue;
+    char tmp[2048];
+    strcpy(tmp, line);
+    char *c1 = strtok(tmp, ",");
+    if (!c1 || strcmp(c1, "Date") == 0)
+      continue;
+    DseBar bar;
+    memset(&bar, 0, sizeof(bar));
+    bar.year = atoi(std::string(c1, 4).c_str());
+    bar.month = atoi(std::string(c1 + 5, 2).c_str());
+    bar.day = atoi(std::string(c1 + 8, 2).c_str());
+    double *dst[5] = {&bar.open, &bar.high, &bar.low, &bar.close, &bar.volume};
+    for (double *d : dst) {
+      char *f = strtok(NULL, ",");
+      if (f)
+        *d = atof(f);
+    }
+    bar.valid = true;
+    out.push_back(bar);
+  }
+  fclose(fp);
+  return true;
+}
+
+// Every symbol's rows in one file, date-major: one row per symbol per day
+uint64_t WriteMarketFile(const std::string &path,
+                         const std::vector<std::string> &names,
+                         const std::vector<std::vector<DseBar>> &bars) {
+  FILE *fp = fopen(path.c_str(), "wb");
+  if (!fp)
+    return 0;
+  uint64_t total =
+      fprintf(fp, "Trading_Code,Date,Open,High,Low,Close,Volume\r\n");
+  for (size_t row = 0;; ++row) {
+    bool any = false;
+    for (size_t s = 0; s < names.size(); ++s) {
+      if (row >= bars[s].size())
+        continue;
+      const DseBar &b = bars[s][row];
+      total += fprintf(fp, "%s,%04d-%02d-%02d,%.2f,%.2f,%.2f,%.2f,%.0f\r\n",
+                       names[s].c_str(), b.year, b.month, b.day, b.open,
+                       b.high, b.low, b.close, b.volume);
+      any = true;
+    }
+    if (!any)
+      break;
+  }
+  fclose(fp);
+  return total;
+}
+
+bool SameBars(const std::vector<DseBar> &a, const std::vector<DseBar> &b) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); ++i)
+    if (a[i].year != b[i].year || a[i].month != b[i].month ||
+        a[i].day != b[i].day || a[i].open != b[i].open ||
+        a[i].high != b[i].high || a[i].low != b[i].low ||
+        a[i].close != b[i].close || a[i].volume != b[i].volume)
+      return false;
+  return true;
+}
+
+void Report(const char *name, size_t rows, uint64_t bytes, double sec) {
+  printf("%-10s %9zu rows %8.1f MB %8.1f ms %12.0f rows/s %8.1f MB/s\n",
+         name, rows, bytes / 1048576.0, sec * 1000, rows / sec,
+         bytes / 1048576.0 / sec);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const char *dir = argc > 1 ? argv[1] : "seed_bench_data";
+  int symbols = argc > 2 ? atoi(argv[2]) : 400;
+  int years = argc > 3 ? atoi(argv[3]) : 25;
+
+  std::vector<std::string> names;
+  double t = Now();
+  uint64_t bytes = Generate(dir, symbols, years, names);
+  printf("generated %d symbols x %d years (%.1f MB) in %.1f s\n", symbols,
+         years, bytes / 1048576.0, Now() - t);
+
+  // Reference and serial, file by file
+  std::vector<std::vector<DseBar>> ref(names.size()), fast(names.size());
+  size_t refRows = 0, fastRows = 0;
+  uint64_t fastBytes = 0;
+  t = Now();
+  for (size_t i = 0; i < names.size(); ++i) {
+    std::string path = std::string(dir) + SEP + names[i] + ".csv";
+    ReferenceLoad(path.c_str(), ref[i]);
+    refRows += ref[i].size();
+  }
+  Report("reference", refRows, bytes, Now() - t);
+
+  t = Now();
+  for (size_t i = 0; i < names.size(); ++i) {
+    std::string path = std::string(dir) + SEP + names[i] + ".csv";
+    uint64_t n = 0;
+    CsvSeedLoader::LoadFile(path.c_str(), fast[i], &n);
+    fastRows += fast[i].size();
+    fastBytes += n;
+  }
+  Report("serial", fastRows, fastBytes, Now() - t);
+
+  std::map<std::string, std::vector<DseBar>> seeds;
+  CsvSeedLoader::Stats st = CsvSeedLoader::LoadMany(dir, names, 0, seeds);
+  Report("parallel", st.rows, st.bytes, st.seconds);
+
+  std::string marketPath = std::string(dir) + SEP + "market.csv";
+  t = Now();
+  WriteMarketFile(marketPath, names, ref);
+  printf("wrote %s in %.1f s\n", marketPath.c_str(), Now() - t);
+  std::map<std::string, std::vector<DseBar>> market;
+  st = CsvSeedLoader::LoadMarketFile(marketPath.c_str(), 0, market);
+  Report("market", st.rows, st.bytes, st.seconds);
+
+  int mismatches = 0;
+  for (size_t i = 0; i < names.size(); ++i)
+    if (!SameBars(ref[i], fast[i]) || !SameBars(ref[i], seeds[names[i]]) ||
+        !SameBars(ref[i], market[names[i]]))
+      ++mismatches;
+  printf("%s: %d of %zu symbols differ from the reference\n",
+         mismatches ? "FAIL" : "ok", mismatches, names.size());
+  return mismatches ? 1 : 0;
+}
@@ -23,7 +23,7 @@ echo [INFO] -------------------------------------------------------------
 if not exist "build\Release\x86" mkdir "build\Release\x86"
 
 REM Use cmd /c to run in isolated environment so variables don't persist
-cmd /c "call "%VC_VARS%" x86 >nul && cl /nologo /LD /MT /O2 /W3 /EHsc /DNDEBUG /D_USRDLL /I.\include src\Plugin.cpp src\DseDataEngine.cpp src\RealtimeFeed.cpp src\HtmlUtils.cpp src\CsvUtils.cpp /Fe:build\Release\x86\DSE_DataPlugin_x86.dll /link /DEF:Plugin.def user32.lib kernel32.lib wininet.lib ws2_32.lib comctl32.lib shell32.lib ole32.lib"
+cmd /c "call "%VC_VARS%" x86 >nul && cl /nologo /LD /MT /O2 /W3 /std:c++17 /EHsc /DNDEBUG /D_USRDLL /I.\include src\Plugin.cpp src\DseDataEngine.cpp src\RealtimeFeed.cpp src\WinInetHttpClient.cpp src\AllocHooks.cpp src\HtmlUtils.cpp src\DsePageParser.cpp src\CsvUtils.cpp src\IntradayAggregator.cpp src\SnapshotJournal.cpp src\SnapshotDiff.cpp src\FeedSource.cpp src\PollScheduler.cpp src\TradingCalendar.cpp src\MarketClock.cpp src\BarCache.cpp src\ConfigWatcher.cpp src\CsvExporter.cpp src\CsvTailWriter.cpp src\ArrowExport.cpp src\CsvSeedLoader.cpp src\MappedFile.cpp src\OsServices.cpp src\IniFile.cpp src\Metrics.cpp src\Trace.cpp src\MetricsServer.cpp src\SharedMemory.cpp src\QuoteBus.cpp src\QuoteCodec.cpp src\ProxyProtocol.cpp src\ProxyServer.cpp src\ProxyClient.cpp /Fe:build\Release\x86\DSE_DataPlugin_x86.dll /link /DEF:Plugin.def user32.lib kernel32.lib wininet.lib ws2_32.lib psapi.lib comctl32.lib gdi32.lib shell32.lib ole32.lib"
 
 if %ERRORLEVEL% NEQ 0 (
     echo [ERROR] x86 Build FAILED!
@@ -43,7 +43,7 @@ echo [INFO] -------------------------------------------------------------
 if not exist "build\Release\x64" mkdir "build\Release\x64"
 
 REM Use cmd /c to run in isolated environment
-cmd /c "call "%VC_VARS%" x64 >nul && cl /nologo /LD /MT /O2 /W3 /EHsc /DNDEBUG /D_USRDLL /I.\include src\Plugin.cpp src\DseDataEngine.cpp src\RealtimeFeed.cpp src\HtmlUtils.cpp src\CsvUtils.cpp /Fe:build\Release\x64\DSE_DataPlugin_x64.dll /link /DEF:Plugin.def user32.lib kernel32.lib wininet.lib ws2_32.lib comctl32.lib shell32.lib ole32.lib"
+cmd /c "call "%VC_VARS%" x64 >nul && cl /nologo /LD /MT /O2 /W3 /std:c++17 /EHsc /DNDEBUG /D_USRDLL /I.\include src\Plugin.cpp src\DseDataEngine.cpp src\RealtimeFeed.cpp src\WinInetHttpClient.cpp src\AllocHooks.cpp src\HtmlUtils.cpp src\DsePageParser.cpp src\CsvUtils.cpp src\IntradayAggregator.cpp src\SnapshotJournal.cpp src\SnapshotDiff.cpp src\FeedSource.cpp src\PollScheduler.cpp src\TradingCalendar.cpp src\MarketClock.cpp src\BarCache.cpp src\ConfigWatcher.cpp src\CsvExporter.cpp src\CsvTailWriter.cpp src\ArrowExport.cpp src\CsvSeedLoader.cpp src\MappedFile.cpp src\OsServices.cpp src\IniFile.cpp src\Metrics.cpp src\Trace.cpp src\MetricsServer.cpp src\SharedMemory.cpp src\QuoteBus.cpp src\QuoteCodec.cpp src\ProxyProtocol.cpp src\ProxyServer.cpp src\ProxyClient.cpp /Fe:build\Release\x64\DSE_DataPlugin_x64.dll /link /DEF:Plugin.def user32.lib kernel32.lib wininet.lib ws2_32.lib psapi.lib comctl32.lib gdi32.lib shell32.lib ole32.lib"
 
 if %ERRORLEVEL% NEQ 0 (
     echo [ERROR] x64 Build FAILED!
@@ -52,6 +52,23 @@ if %ERRORLEVEL% NEQ 0 (
     echo File: %CD%\build\Release\x64\DSE_DataPlugin_x64.dll
 )
 
+REM =========================================================================
+REM Build dse_proxyd (x64 console daemon)
+REM =========================================================================
+echo.
+echo [INFO] -------------------------------------------------------------
+echo [INFO] Building dse_proxyd (x64)...
+echo [INFO] -------------------------------------------------------------
+
+cmd /c "call "%VC_VARS%" x64 >nul && cl /nologo /MT /O2 /W3 /std:c++17 /EHsc /DNDEBUG /I.\include daemon\dse_proxyd.cpp src\WinInetHttpClient.cpp src\DseDataEngine.cpp src\HtmlUtils.cpp src\DsePageParser.cpp src\CsvUtils.cpp src\IntradayAggregator.cpp src\SnapshotJournal.cpp src\SnapshotDiff.cpp src\FeedSource.cpp src\PollScheduler.cpp src\TradingCalendar.cpp src\MarketClock.cpp src\BarCache.cpp src\ConfigWatcher.cpp src\CsvExporter.cpp src\CsvTailWriter.cpp src\ArrowExport.cpp src\CsvSeedLoader.cpp src\MappedFile.cpp src\OsServices.cpp src\IniFile.cpp src\Metrics.cpp src\Trace.cpp src\MetricsServer.cpp src\SharedMemory.cpp src\QuoteBus.cpp src\QuoteCodec.cpp src\ProxyProtocol.cpp src\ProxyServer.cpp src\ProxyClient.cpp /Fe:build\Release\x64\dse_proxyd.exe /link kernel32.lib wininet.lib ws2_32.lib psapi.lib"
+
+if %ERRORLEVEL% NEQ 0 (
+    echo [ERROR] dse_proxyd Build FAILED!
+) else (
+    echo [SUCCESS] dse_proxyd Build Complete.
+    echo File: %CD%\build\Release\x64\dse_proxyd.exe
+)
+
 echo.
 echo [INFO] -------------------------------------------------------------
 echo [INFO] Cleaning up intermediate files...
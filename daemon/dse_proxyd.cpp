@@ -0,0 +1,188 @@
+///////////////////////////////////////////////////////////////////////////
+// dse_proxyd.cpp — LAN Quote and History Proxy for Plugin Desks
+//
+// Scrapes dsebd.org once for the whole office and serves the result to
+// every plugin instance that sets [Proxy] Server=host:port. Built from
+// dse_core: the same page parser, bar cache and config as the plugin,
+// with WinInet on Windows and libcurl elsewhere as the transport.
+//
+//   dse_proxyd [path/to/dse_config.ini]
+//
+// Reads the plugin's INI ([General] poll interval and URLs, [Debug] log
+// file, ...) plus its own [Daemon] section:
+//
+//   Port=9470             where desks connect
+//   Bind=0.0.0.0          listen address
+//   SnapshotEvery=60      polls between full snapshots (deltas between)
+//   ClosedPollSec=300     poll interval outside the session
+//   HistoryCacheSec=900   how long a fetched history window is reused
+//
+// [Proxy] Server must be empty on the daemon's own INI. Stop with Ctrl+C.
+///////////////////////////////////////////////////////////////////////////
+
+#include "DseDataEngine.h"
+#include "IniFile.h"
+#include "OsServices.h"
+#include "ProxyServer.h"
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include "WinInetHttpClient.h"
+typedef WinInetHttpClient PlatformHttpClient;
+#else
+#include "CurlHttpClient.h"
+typedef CurlHttpClient PlatformHttpClient;
+#endif
+
+namespace {
+
+std::atomic<bool> g_stop(false);
+
+void OnSignal(int) { g_stop = true; }
+
+// Sleep up to ms, returning early once a stop is requested
+void SleepUnlessStopped(int ms) {
+  while (ms > 0 && !g_stop) {
+    int slice = ms < 200 ? ms : 200;
+    Os::SleepMs(slice);
+    ms -= slice;
+  }
+}
+
+// History windows already fetched for some desk, reused by the next one
+class HistoryCache {
+public:
+  HistoryCache(DseDataEngine &engine, int ttlSec)
+      : m_engine(engine), m_ttlMs((uint64_t)ttlSec * 1000) {}
+
+  bool Fetch(const std::string &symbol, const std::string &startDate,
+             const std::string &endDate, std::vector<DseBar> &out) {
+    std::string key = symbol + '|' + startDate + '|' + endDate;
+    uint64_t now = Os::MonotonicMs();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto it = m_entries.find(key);
+      if (it != m_entries.end() && now - it->second.fetchedMs < m_ttlMs) {
+        out = it->second.bars;
+        return true;
+      }
+    }
+
+    if (!m_engine.FetchHistoricalData(symbol.c_str(), startDate.c_str(),
+                                      endDate.c_str(), out))
+      return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_entries.size() >= kMaxEntries) {
+      for (auto it = m_entries.begin(); it != m_entries.end();)
+        it = now - it->second.fetchedMs >= m_ttlMs ? m_entries.erase(it)
+                                                   : std::next(it);
+      if (m_entries.size() >= kMaxEntries)
+        m_entries.erase(m_entries.begin());
+    }
+    Entry &e = m_entries[key];
+    e.bars = out;
+    e.fetchedMs = now;
+    return true;
+  }
+
+private:
+  static const size_t kMaxEntries = 4096;
+
+  struct Entry {
+    std::vector<DseBar> bars;
+    uint64_t fetchedMs;
+  };
+
+  DseDataEngine &m_engine;
+  uint64_t m_ttlMs;
+  std::mutex m_mutex;
+  std::map<std::string, Entry> m_entries;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const char *configPath = argc > 1 ? argv[1] : "dse_config.ini";
+  if (!Os::FileExists(configPath)) {
+    fprintf(stderr, "dse_proxyd: %s not found\n", configPath);
+    return 1;
+  }
+
+  std::signal(SIGINT, OnSignal);
+  std::signal(SIGTERM, OnSignal);
+
+  DseDataEngine engine;
+  engine.SetHttpClient(std::unique_ptr<HttpClient>(new PlatformHttpClient));
+  if (!engine.Initialize(configPath)) {
+    fprintf(stderr, "dse_proxyd: cannot initialize from %s\n", configPath);
+    return 1;
+  }
+  std::shared_ptr<const DseConfig> cfg = engine.GetConfig();
+  if (cfg->proxyServer[0]) {
+    fprintf(stderr,
+            "dse_proxyd: [Proxy] Server is set in %s; the daemon must "
+            "scrape dsebd.org itself\n",
+            configPath);
+    return 1;
+  }
+
+  IniFile ini;
+  ini.Load(configPath);
+  int port = ini.GetInt("Daemon", "Port", DseDataEngine::kDefaultProxyPort);
+  char bind[64];
+  ini.GetString("Daemon", "Bind", "0.0.0.0", bind, sizeof(bind));
+  int snapshotEvery = ini.GetInt("Daemon", "SnapshotEvery", 60);
+  int closedPollSec = ini.GetInt("Daemon", "ClosedPollSec", 300);
+  if (closedPollSec < 10)
+    closedPollSec = 10;
+  HistoryCache history(engine, ini.GetInt("Daemon", "HistoryCacheSec", 900));
+
+  ProxyServer server;
+  bool listening = server.Start(
+      bind, port, snapshotEvery,
+      [&history](const std::string &symbol, const std::string &start,
+                 const std::string &end, std::vector<DseBar> &out) {
+        return history.Fetch(symbol, start, end, out);
+      },
+      [&engine](const char *msg) { engine.Log("%s", msg); });
+  if (!listening) {
+    fprintf(stderr, "dse_proxyd: cannot listen on %s:%d\n", bind, port);
+    return 1;
+  }
+  printf("dse_proxyd: serving %s:%d (log: %s)\n", bind, server.Port(),
+         cfg->logFilePath);
+  fflush(stdout);
+
+  size_t lastClients = (size_t)-1;
+  while (!g_stop) {
+    cfg = engine.GetConfig(); // follows live INI reloads
+    std::vector<DseQuote> quotes;
+    if (engine.FetchLatestQuotes(quotes)) {
+      MarketClock::Time t = engine.GetClock().Now();
+      server.PublishQuotes(quotes, t.date, t.secOfDay);
+    }
+
+    size_t clients = server.ClientCount();
+    if (clients != lastClients) {
+      printf("dse_proxyd: %zu desk(s) connected\n", clients);
+      fflush(stdout);
+      lastClients = clients;
+    }
+
+    SleepUnlessStopped(engine.IsMarketOpen() ? cfg->pollIntervalMs
+                                             : closedPollSec * 1000);
+  }
+
+  printf("dse_proxyd: stopping\n");
+  server.Stop();
+  engine.Shutdown();
+  return 0;
+}
@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////
+// ArrowExport.h — Whole-Market Export as One Arrow IPC (Feather v2) File
+//
+// Writes every cached series into a single columnar file that pandas and
+// pyarrow load without parsing:
+//
+//   symbol  dictionary<int32, utf8>   one dictionary for the whole file
+//   date    timestamp[ms], midnight of the trading day, no time zone
+//           (pandas reads it as datetime64 without a per-row conversion)
+//   open, high, low, close  float64
+//   volume  int64
+//
+// The file holds one record batch per symbol, in symbol order, so a reader
+// can also pull a single symbol's batch. Uncompressed, little-endian,
+// metadata version V5; no Arrow library needed to write it.
+//
+//   pd.read_feather("dse_bars.arrow")
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef ARROW_EXPORT_H
+#define ARROW_EXPORT_H
+
+#include "DseTypes.h"
+#include <map>
+#include <string>
+#include <vector>
+
+class ArrowBarWriter {
+public:
+  // Encode one symbol's bars as column buffers (copies them; the caller's
+  // vector may change afterwards). Empty series are skipped.
+  void AddSeries(const std::string &symbol, const std::vector<DseBar> &bars);
+
+  // Write everything added so far to path (path.tmp, then renamed over it).
+  bool Write(const char *path) const;
+
+  size_t SymbolCount() const { return m_batches.size(); }
+  size_t RowCount() const { return m_rows; }
+
+private:
+  struct Batch {
+    size_t rows;
+    std::string body; // column buffers, symbol indices filled in by Write
+  };
+
+  std::map<std::string, Batch> m_batches;
+  size_t m_rows = 0;
+};
+
+#endif // ARROW_EXPORT_H
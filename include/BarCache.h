@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////
+// BarCache.h — Per-Symbol Bar Series, Sharded by Symbol Hash
+//
+// Each shard has its own lock, so a backfill writing one symbol does not
+// stall GetQuotesEx reading another. Operations touching every symbol
+// (export, provisional-bar scans) visit shards one at a time and never hold
+// two shard locks at once. Every write stamps the series with a cache-wide
+// version so exports can pick out what changed since their last pass.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef BAR_CACHE_H
+#define BAR_CACHE_H
+
+#include "DseTypes.h"
+#include "Trace.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+class BarCache {
+public:
+  explicit BarCache(size_t shardCount = 16);
+
+  // Copy a symbol's series; false if the symbol has never been cached.
+  bool Get(const std::string &symbol, std::vector<DseBar> &outBars) const;
+
+  bool Contains(const std::string &symbol) const;
+
+  // Replace a symbol's series.
+  void Put(const std::string &symbol, std::vector<DseBar> bars);
+
+  // Edit a series in place under its shard lock. With create=false a
+  // missing symbol is skipped and false returned. fn must not call back
+  // into the cache. If fn returns bool, false means "left unchanged" and
+  // the series keeps its version.
+  template <class Fn>
+  bool Update(const std::string &symbol, bool create, Fn fn) {
+    Shard &s = ShardFor(symbol);
+    Trace::Lock<std::mutex> lock(s.mutex, "BarCache shard");
+    auto it = s.series.find(symbol);
+    if (it == s.series.end()) {
+      if (!create)
+        return false;
+      it = s.series.emplace(symbol, Series()).first;
+    }
+    if constexpr (std::is_same<decltype(fn(it->second.bars)), bool>::value) {
+      if (fn(it->second.bars))
+        it->second.version = NextVersion();
+    } else {
+      fn(it->second.bars);
+      it->second.version = NextVersion();
+    }
+    return true;
+  }
+
+  // Visit every series, one shard lock at a time.
+  void ForEach(const std::function<void(const std::string &,
+                                        const std::vector<DseBar> &)> &fn) const;
+
+  // Sorted copy of the whole cache (for export).
+  std::map<std::string, std::vector<DseBar>> Snapshot() const;
+
+  // Version the next write will exceed. Read it before SnapshotSince and
+  // pass it as 'since' next time: writes racing the snapshot are then
+  // picked up again rather than lost.
+  uint64_t CurrentVersion() const { return m_version.load(); }
+
+  // Copy of every non-empty series written after version 'since'.
+  std::map<std::string, std::vector<DseBar>> SnapshotSince(uint64_t since) const;
+
+  size_t Size() const;
+
+  // Symbols and bars held, one shard lock at a time.
+  void Count(size_t &symbols, size_t &bars) const;
+
+private:
+  struct Series {
+    std::vector<DseBar> bars;
+    uint64_t version = 0;
+  };
+
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Series> series;
+  };
+
+  Shard &ShardFor(const std::string &symbol) const;
+  uint64_t NextVersion() { return ++m_version; }
+
+  std::vector<std::unique_ptr<Shard>> m_shards;
+  std::atomic<uint64_t> m_version;
+};
+
+#endif // BAR_CACHE_H
@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////
+// ByteCodec.h — Compact Binary Encoding Helpers
+//
+// LEB128 varints, zigzag signed mapping and little-endian fixed-width
+// integers over std::string byte buffers. Used by the snapshot journal.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef BYTE_CODEC_H
+#define BYTE_CODEC_H
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+namespace ByteCodec {
+
+  /// Append an unsigned LEB128 varint (1..10 bytes)
+  inline void PutVarint(std::string &out, uint64_t v) {
+    while (v >= 0x80) {
+      out.push_back((char)(uint8_t)(v | 0x80));
+      v >>= 7;
+    }
+    out.push_back((char)(uint8_t)v);
+  }
+
+  /// Read a varint; returns false on truncated or overlong input
+  inline bool GetVarint(const uint8_t *&p, const uint8_t *end, uint64_t &v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (p >= end)
+        return false;
+      uint8_t b = *p++;
+      v |= (uint64_t)(b & 0x7F) << shift;
+      if (!(b & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  /// Map signed to unsigned so small magnitudes stay small
+  inline uint64_t ZigZag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+  }
+
+  inline int64_t UnZigZag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+  }
+
+  inline void PutU32(std::string &out, uint32_t v) {
+    for (int i = 0; i < 4; ++i)
+      out.push_back((char)(uint8_t)(v >> (8 * i)));
+  }
+
+  inline bool GetU32(const uint8_t *&p, const uint8_t *end, uint32_t &v) {
+    if (end - p < 4)
+      return false;
+    v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+        ((uint32_t)p[3] << 24);
+    p += 4;
+    return true;
+  }
+
+  /// Fixed-point conversion for prices/volumes (scale = 100 for paisa)
+  inline int64_t ToTicks(double v, double scale) {
+    return (int64_t)std::llround(v * scale);
+  }
+
+} // namespace ByteCodec
+
+#endif // BYTE_CODEC_H
@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////
+// ConfigWatcher.h — Notices Edits to dse_config.ini
+//
+// A background thread compares the file's modification time and size
+// every interval. A change is reported once it has held for a full
+// interval, so an editor's multi-step save triggers one reload rather than
+// several half-written ones. A missing file (mid-save) is not a change.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef CONFIG_WATCHER_H
+#define CONFIG_WATCHER_H
+
+#include "PollScheduler.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+class ConfigWatcher {
+public:
+  ConfigWatcher();
+  ~ConfigWatcher();
+
+  // Watch path, calling onChange (on the watcher thread) after each settled
+  // edit. Returns false if already running.
+  bool Start(const char *path, int intervalMs, std::function<void()> onChange);
+
+  // Stop and join. Must not be called from onChange.
+  void Stop();
+
+  bool IsRunning() const { return m_thread.joinable(); }
+
+  // Takes effect from the next check.
+  void SetIntervalMs(int ms) { m_intervalMs = ms < 100 ? 100 : ms; }
+
+private:
+  struct Stamp {
+    bool exists;
+    int64_t mtime;
+    uint64_t size;
+    bool operator==(const Stamp &o) const {
+      return exists == o.exists && mtime == o.mtime && size == o.size;
+    }
+    bool operator!=(const Stamp &o) const { return !(*this == o); }
+  };
+
+  static Stamp Read(const std::string &path);
+  void Run();
+
+  std::string m_path;
+  std::atomic<int> m_intervalMs;
+  std::function<void()> m_onChange;
+  StopSignal m_stop;
+  std::thread m_thread;
+};
+
+#endif // CONFIG_WATCHER_H
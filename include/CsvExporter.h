@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////
+// CsvExporter.h — Background CSV Export of Changed Symbols
+//
+// Each pass exports only the series written since the previous pass (by
+// BarCache version), on a small worker pool, off the caller's thread.
+// Files are written to a temp name and renamed over the target, so tools
+// reading the export folder never see a half-written CSV. In append mode
+// files are instead updated in place from their first changed row (see
+// CsvTailWriter). Files that fail to write are retried on the next pass.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef CSV_EXPORTER_H
+#define CSV_EXPORTER_H
+
+#include "BarCache.h"
+#include "CsvTailWriter.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+class CsvExporter {
+public:
+  struct Stats {
+    int rewritten;     // whole file (re)written
+    int appended;      // rows added, existing bytes untouched
+    int tailRewritten; // rewritten from the first changed row
+    int unchanged;     // nothing to write
+    int failed;
+    int elapsedMs;
+  };
+
+  // Called on a worker thread when a pass finishes
+  typedef std::function<void(const Stats &stats)> DoneFn;
+
+  CsvExporter();
+  ~CsvExporter();
+
+  // Spawn the worker pool; later calls are ignored while it runs.
+  void Start(int threads);
+
+  // Finish the queued files, then join the workers.
+  void Stop();
+
+  // Queue every series changed since the last pass (all = every series,
+  // e.g. a manual export or a new folder). append selects in-place tail
+  // updates over whole-file replacement. Returns false without queuing
+  // if the previous pass is still running. onDone is not called for a pass
+  // with nothing to write.
+  bool Export(const BarCache &cache, const char *exportPath, bool all,
+              bool append, DoneFn onDone);
+
+  bool IsBusy() const;
+
+private:
+  struct Job {
+    std::string symbol;
+    std::vector<DseBar> bars;
+  };
+
+  void Worker();
+
+  // Append mode: bring one file up to date from its watermark.
+  static CsvWriteResult WriteAppend(const Job &job, const std::string &dir,
+                                    CsvWatermark &mark);
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<Job> m_queue;
+  std::vector<std::thread> m_threads;
+  bool m_stopping;
+
+  // Current pass
+  std::string m_path;
+  bool m_append;
+  int m_pending;
+  Stats m_stats;
+  DoneFn m_onDone;
+  std::chrono::steady_clock::time_point m_passStart;
+  uint64_t m_passVersion;
+
+  // Cache version covered by the last completed pass, and symbols whose
+  // file could not be written then
+  uint64_t m_exportedVersion;
+  std::string m_exportedPath;
+  std::set<std::string> m_retry;
+
+  // Append mode: what each file last received (entries are only touched
+  // by the worker exporting that symbol)
+  std::map<std::string, CsvWatermark> m_marks;
+};
+
+#endif // CSV_EXPORTER_H
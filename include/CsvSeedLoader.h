@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////
+// CsvSeedLoader.h — Fast, Parallel Loading of CSV Seed Files
+//
+// Each file is read whole in one call and parsed in place: delimiters are
+// found eight bytes at a time (SWAR), dates are read at fixed positions and
+// prices are assembled from their digits. Decimal prices with up to 15
+// significant digits come out bit-identical to atof; anything unusual
+// (exponents, very long mantissas) falls back to strtod. Accepts the same
+// two layouts as before:
+//   Format A: Trading_Code,Date,Open,High,Low,Close,Volume
+//   Format B: Date,Open,High,Low,Close,Volume
+// Dates are YYYY-MM-DD (any separator) or a bare YYYYMMDD field.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef CSV_SEED_LOADER_H
+#define CSV_SEED_LOADER_H
+
+#include "DseTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace CsvSeedLoader {
+
+  /// Throughput of one load, for the log and the benchmark
+  struct Stats {
+    int files;      // files found and read
+    size_t rows;    // valid bars produced
+    uint64_t bytes; // bytes read
+    double seconds;
+
+    double RowsPerSec() const { return seconds > 0 ? rows / seconds : 0; }
+    double MBPerSec() const {
+      return seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0;
+    }
+  };
+
+  /// Parse one line [p, end) without its newline. Header rows, blank rows
+  /// and bars failing the seed sanity checks return false. For Format A
+  /// rows, *sym / *symLen (if given) receive the Trading_Code field;
+  /// Format B rows set *symLen to 0.
+  bool ParseLine(const char *p, const char *end, DseBar &bar,
+                 const char **sym = nullptr, size_t *symLen = nullptr);
+
+  /// Parse a whole file's bytes, appending valid bars. Returns rows added.
+  size_t Parse(const char *data, size_t len, std::vector<DseBar> &outBars);
+
+  /// Read and parse one file. False if it cannot be opened.
+  bool LoadFile(const char *path, std::vector<DseBar> &outBars,
+                uint64_t *bytesRead = nullptr);
+
+  /// Load dir/<SYMBOL>.csv for every symbol on up to 'threads' threads
+  /// (0 = one per core). Symbols with no file or no valid rows are left
+  /// out of outSeeds.
+  Stats LoadMany(const char *dir, const std::vector<std::string> &symbols,
+                 int threads,
+                 std::map<std::string, std::vector<DseBar>> &outSeeds);
+
+  /// Smallest slice of a market-wide file handed to one parser thread
+  const size_t kMinMarketChunk = 4 * 1024 * 1024;
+
+  /// Most of a market-wide file mapped at once: all of it in a 64-bit
+  /// process, 256 MB windows in a 32-bit one (whose address space cannot
+  /// take a multi-GB view). The parsed bars must still fit in memory.
+  const size_t kMarketWindow =
+      sizeof(void *) >= 8 ? (size_t)-1 : (size_t)256 * 1024 * 1024;
+
+  /// Ingest one market-wide Format A file (Trading_Code,Date,...) in a
+  /// single pass: the file is memory-mapped a window at a time, cut into
+  /// chunks on line boundaries, parsed on up to 'threads' threads (0 = one
+  /// per core) and scattered into one series per Trading_Code, in file
+  /// order. Format B rows carry no symbol and are skipped.
+  Stats LoadMarketFile(const char *path, int threads,
+                       std::map<std::string, std::vector<DseBar>> &outSeeds);
+
+} // namespace CsvSeedLoader
+
+#endif // CSV_SEED_LOADER_H
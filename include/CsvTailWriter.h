@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////
+// CsvTailWriter.h — Append-Only Updates to Exported CSV Files
+//
+// A watermark remembers what was last written to one file: its size and a
+// hash per block of rows. The next export is compared block by block
+// against the watermark, and only bytes from the first changed block
+// onward touch the disk. A new bar is a pure append, a revised provisional
+// bar rewrites one block's worth of tail, and tools tailing the file see
+// just that. Watermarks live in memory; the first export after a restart
+// indexes the existing file once instead.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef CSV_TAIL_WRITER_H
+#define CSV_TAIL_WRITER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct CsvWatermark {
+  struct Block {
+    uint64_t offset;
+    uint32_t length;
+    uint64_t hash;
+  };
+
+  bool valid = false;
+  uint64_t size = 0;              // bytes on disk after the last write
+  std::vector<Block> blocks;      // header line, then kRowsPerBlock rows each
+};
+
+enum CsvWriteResult {
+  CSV_WRITE_FAILED = 0,
+  CSV_UNCHANGED,
+  CSV_APPENDED,      // old bytes untouched, new rows added
+  CSV_TAIL_REWRITTEN, // rewritten in place from the first changed block
+  CSV_REWRITTEN      // replaced whole (new file or changed header)
+};
+
+namespace CsvTailWriter {
+
+  /// Rows per hashed block: the most a single changed row can cost
+  const int kRowsPerBlock = 256;
+
+  /// Bring the file at path up to content (header + rows, exact bytes),
+  /// writing as little as the watermark allows, and update the watermark.
+  CsvWriteResult Write(const char *path, const std::string &content,
+                       CsvWatermark &wm);
+
+  /// Rebuild blocks from content, keeping wm.blocks[0..keep).
+  void Index(const std::string &content, CsvWatermark &wm, size_t keep = 0);
+
+} // namespace CsvTailWriter
+
+#endif // CSV_TAIL_WRITER_H
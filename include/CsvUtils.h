@@ -14,17 +14,36 @@
 
 namespace CsvUtils {
 
-  /// Load historical bars from a CSV seed file
+  /// Load historical bars from a CSV seed file (see CsvSeedLoader)
   /// Supports two formats:
   ///   Format A: Trading_Code,Date,Open,High,Low,Close,Volume
   ///   Format B: Date,Open,High,Low,Close,Volume
   bool LoadCsvSeed(const char *symbol, const char *csvSeedPath,
                    std::vector<DseBar> &outBars);
 
-  /// Export cached bars to a CSV file
+  /// Export cached bars to a CSV file (replaced atomically)
   bool ExportBarsToCsv(const char *symbol, const char *exportPath,
                        const std::vector<DseBar> &bars);
 
+  /// Export file header line, including the newline
+  extern const char kCsvHeader[];
+
+  /// Longest row FormatBarRow can produce, including the newline
+  const size_t kMaxCsvRow = 2048;
+
+  /// Format one export row ("YYYY-MM-DD,O,H,L,C,V" + line end) into dst
+  /// without printf; prices to 2 decimals, volume whole. Line ends are
+  /// CRLF on Windows. Returns bytes written.
+  size_t FormatBarRow(char *dst, const DseBar &bar);
+
+  /// Append rows for bars[from..] to out.
+  void AppendBarRows(std::string &out, const std::vector<DseBar> &bars,
+                     size_t from = 0);
+
+  /// Write data (binary, as is) to path.tmp, then rename it over path, so
+  /// readers see either the old file or the new one, never a partial write.
+  bool WriteFileAtomic(const char *path, const std::string &data);
+
   /// Export all cached data to CSV files (one file per symbol)
   int ExportAllDataToCsv(const std::map<std::string, std::vector<DseBar>> &cache,
                          const char *exportPath);
@@ -0,0 +1,41 @@
+///////////////////////////////////////////////////////////////////////////
+// CurlHttpClient.h — HttpClient over libcurl (dse_proxyd on Linux)
+//
+// One easy handle per request, so requests from several threads never
+// share state; the user agent and timeout are read under a lock at the
+// start of each. Each request records the Metrics HTTP stages (connect,
+// TTFB, body) from curl's own timers.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef CURL_HTTP_CLIENT_H
+#define CURL_HTTP_CLIENT_H
+
+#include "HttpClient.h"
+#include <mutex>
+
+class CurlHttpClient : public HttpClient {
+public:
+  CurlHttpClient();
+  ~CurlHttpClient();
+
+  bool Open(const char *userAgent, int timeoutSec, const LogFn &log) override;
+  void Configure(const char *userAgent, int timeoutSec) override;
+  void Close() override;
+  bool IsOpen() const override;
+
+  bool Get(const char *url, std::string &outBody) override;
+  bool Post(const char *url, const char *formPayload,
+            std::string &outBody) override;
+
+private:
+  bool Perform(const char *url, const char *formPayload,
+               std::string &outBody);
+
+  mutable std::mutex m_mutex;
+  bool m_open;
+  std::string m_userAgent;
+  int m_timeoutSec;
+  LogFn m_log;
+};
+
+#endif // CURL_HTTP_CLIENT_H
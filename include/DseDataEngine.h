@@ -2,35 +2,77 @@
 //
 // Downloads and caches OHLCV bars (historical) and live quotes (real-time)
 // from dsebd.org and amarstock.com. HTML parsing delegates to HtmlUtils;
-// CSV I/O delegates to CsvUtils.
+// CSV I/O delegates to CsvUtils. Part of dse_core: no Win32 here — HTTP
+// comes from the HttpClient the host installs, the rest from OsServices.
 
 #ifndef DSE_DATA_ENGINE_H
 #define DSE_DATA_ENGINE_H
 
+#include "BarCache.h"
+#include "ConfigWatcher.h"
+#include "CsvExporter.h"
 #include "CsvUtils.h"
 #include "DseTypes.h"
 #include "HtmlUtils.h"
+#include "HttpClient.h"
+#include "MarketClock.h"
+#include "Metrics.h"
+#include "MetricsServer.h"
+#include "ProxyClient.h"
+#include "QuoteBus.h"
+#include "TradingCalendar.h"
+#include <atomic>
+#include <cstdio>
+#include <ctime>
 #include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <vector>
-#include <windows.h>
-#include <wininet.h>
-
 
 class DseDataEngine {
 public:
   DseDataEngine();
   ~DseDataEngine();
 
-  // Load config from INI and open a WinInet session.
+  // Transport for every request (the plugin installs WinInetHttpClient).
+  // Call before Initialize; without one the engine still loads seeds,
+  // caches and exports, but every fetch fails.
+  void SetHttpClient(std::unique_ptr<HttpClient> client);
+
+  // Load config from INI and open the HTTP session.
   // Safe to call multiple times (reloads config on each call).
   bool Initialize(const char *configPath);
 
-  // Release WinInet handles and close log file.
+  // Close the HTTP session and the log file.
   void Shutdown();
 
+  // ── Live Configuration ───────────────────────────────────────────────────
+
+  // Called after a reload with the previous and the new snapshot.
+  typedef std::function<void(const DseConfig &oldCfg, const DseConfig &newCfg)>
+      ConfigListener;
+
+  // Re-read the INI given to Initialize and publish it without dropping the
+  // HTTP session: timeouts, user agent, calendar, clock offset, logging
+  // and log file are applied in place, then listeners run on the calling
+  // thread.
+  // Everything read per operation (URLs, fetch threads, export settings)
+  // simply sees the new snapshot. False if the INI is missing.
+  bool ReloadConfig();
+
+  // Returns an id for RemoveConfigListener. Listeners must not add or
+  // remove listeners, nor reload. Overlapping reloads notify in the order
+  // they published; a reload overtaken by a newer one is not reported, and
+  // each notification's oldCfg is the snapshot listeners saw last.
+  int AddConfigListener(ConfigListener listener);
+
+  // Waits for a notification in progress to finish; once it returns the
+  // listener is never called again, so its captures may be destroyed.
+  void RemoveConfigListener(int id);
+
   // ── Historical Data ──────────────────────────────────────────────────────
 
   // Fetch OHLCV bars for [startDate, endDate] ("YYYY-MM-DD").
@@ -39,42 +81,102 @@ public:
                            const char *endDate, std::vector<DseBar> &outBars,
                            std::function<void()> onProgress = nullptr);
 
+  // Fetch every instrument for [startDate, endDate] with market-wide archive
+  // requests (no &inst=) and scatter the rows into each symbol's cache
+  // series. Returns the number of symbols updated, 0 on failure. Windows
+  // that still fail after a second round are left out of every series;
+  // failedWindows (optional) receives how many, so the caller can fetch
+  // the range per symbol instead.
+  int FetchMarketHistory(const char *startDate, const char *endDate,
+                         int *failedWindows = nullptr);
+
+  // Turn a post-close latest-price snapshot into provisional EOD bars dated
+  // (year, month, day) and append them to every symbol already in the cache.
+  // Archive bars for that date are never overwritten. Returns bars appended.
+  int AppendSessionBars(const std::vector<DseQuote> &quotes, int year,
+                        int month, int day);
+
+  // Replace provisional bars with day_end_archive data via one market-wide
+  // fetch over their date span. Returns the number of symbols updated.
+  int ReconcileProvisionalBars();
+
+  // True while any cached bar is still provisional.
+  bool HasProvisionalBars();
+
   // Return cached bars for a symbol (populated by FetchHistoricalData).
   bool GetCachedBars(const char *symbol, std::vector<DseBar> &outBars);
 
-  // Export all cached bars to individual CSV files in exportPath.
+  // Export all cached bars to individual CSV files in exportPath, in the
+  // background (returns once the files are queued).
   void ExportAllDataToCsv();
 
-  // Trigger ExportAllDataToCsv if exportIntervalSec has elapsed.
+  // Every exportIntervalSec, export the symbols changed since the last
+  // pass in the background. Cheap to call often.
   void CheckAutoExport();
 
   // ── Real-Time Data ───────────────────────────────────────────────────────
 
   // Fetch live quotes for every symbol from the DSE latest-price page.
-  bool FetchLatestQuotes(std::vector<DseQuote> &outQuotes);
+  // outPage, if given, receives the raw page (for recording).
+  bool FetchLatestQuotes(std::vector<DseQuote> &outQuotes,
+                         std::string *outPage = nullptr);
+
+  // Parse a latest_share_price HTML page into quotes.
+  bool ParseLatestPriceHtml(const std::string &html,
+                            std::vector<DseQuote> &outQuotes);
 
   // Fetch live quote for a single symbol (fetches all, then filters).
   bool FetchLatestQuote(const char *symbol, DseQuote &outQuote);
 
   // ── Symbol Management ────────────────────────────────────────────────────
 
-  // Return cached symbol list; refreshes from DSE if empty.
-  const std::vector<std::string> &GetSymbolList();
+  // Current published symbol list (sorted); refreshes from DSE if empty.
+  // The returned snapshot stays valid after later refreshes.
+  std::shared_ptr<const std::vector<std::string>> GetSymbolList();
 
   // Re-scrape the DSE live-price page to rebuild the symbol list.
   bool RefreshSymbolList();
 
   // ── State ────────────────────────────────────────────────────────────────
 
-  ConnectionState GetConnectionState() const { return m_connState; }
-  const DseConfig &GetConfig() const { return m_config; }
+  ConnectionState GetConnectionState() const { return m_connState.load(); }
+
+  // Immutable snapshot of the current config. Hold on to the pointer for
+  // the duration of one operation; a reload publishes a new snapshot.
+  std::shared_ptr<const DseConfig> GetConfig() const {
+    return std::atomic_load(&m_configSnap);
+  }
 
-  // Returns true if now falls within configured market hours (Sun–Thu).
+  // Returns true if today is a trading day and now is within its session.
   bool IsMarketOpen() const;
 
+  // Trading days, holidays and session hours (snapshot, like GetConfig).
+  std::shared_ptr<const TradingCalendar> GetCalendar() const {
+    return std::atomic_load(&m_calendar);
+  }
+
+  // Exchange time (UTC + ExchangeUtcOffsetMin). Non-const so tests and
+  // replays can substitute the time source.
+  MarketClock &GetClock() { return m_clock; }
+  const MarketClock &GetClock() const { return m_clock; }
+
+  // True for the index symbols served by amarstock.com instead of dsebd.org.
+  bool IsAmarstockIndex(const char *symbol);
+
   // Append a timestamped log line (no-op when logging is disabled).
   void Log(const char *fmt, ...);
 
+  // Write the recorded thread timeline to cfg.traceFile (Chrome
+  // trace_event JSON). outPath receives the resolved path, or "" when
+  // tracing is off.
+  bool DumpTrace(std::string &outPath);
+
+  // Connection to the desk's dse_proxyd ([Proxy] Server); idle when unset.
+  ProxyClient &GetProxy() { return m_proxy; }
+
+  // Port dse_proxyd listens on unless configured otherwise.
+  static const int kDefaultProxyPort = 9470;
+
 private:
   // ── HTTP Layer ───────────────────────────────────────────────────────────
 
@@ -85,20 +187,66 @@ private:
   std::string BuildHistoryUrl(const char *symbol, const char *startDate,
                               const char *endDate);
 
+  // ── Chunked History Download ─────────────────────────────────────────────
+
+  // One calendar-aligned slice of a long [startDate, endDate] window.
+  struct HistoryChunk {
+    char startDate[16];
+    char endDate[16];
+    std::vector<DseBar> bars;                              // per-symbol mode
+    std::map<std::string, std::vector<DseBar>> bySymbol;   // market-wide mode
+    bool ok;
+  };
+
+  // Shared state for the chunk worker threads of one download.
+  struct ChunkFetchContext {
+    DseDataEngine *engine;
+    const char *symbol;
+    std::vector<HistoryChunk> *chunks;
+    std::atomic<size_t> next;
+  };
+
+  // Split [startDate, endDate] into calendar-aligned chunks of N months.
+  std::vector<HistoryChunk> SplitHistoryRange(const char *startDate,
+                                              const char *endDate, int months);
+
+  // Download and parse one chunk, retrying only that chunk on failure.
+  // An empty symbol requests the whole market and fills chunk.bySymbol.
+  bool FetchHistoryChunk(const char *symbol, HistoryChunk &chunk);
+
+  // Run FetchHistoryChunk over all chunks on historyFetchThreads workers.
+  void RunChunkWorkers(const char *symbol, std::vector<HistoryChunk> &chunks);
+
+  // Fetch all chunks with bounded fan-out and merge the bars by date.
+  // Fails if any chunk still fails after its retries.
+  bool FetchWebHistory(const char *symbol, const char *startDate,
+                       const char *endDate, std::vector<DseBar> &outBars);
+
+  // Worker loop: claim the next chunk until none are left.
+  static void ChunkWorker(ChunkFetchContext *ctx);
+
   // ── Parsing ──────────────────────────────────────────────────────────────
 
-  // Parse the day_end_archive HTML page into bars.
+  // Walk the day_end_archive table, calling onRow(tradingCode, bar) for
+  // every valid row. Returns the row count, or -1 if no table was found.
+  int ParseArchiveTable(
+      const std::string &html,
+      const std::function<void(const std::string &, const DseBar &)> &onRow);
+
+  // Parse the day_end_archive HTML page into bars. foundTable (optional)
+  // tells an archive table with no rows apart from a page without one.
   bool ParseHistoricalHtml(const std::string &html,
-                           std::vector<DseBar> &outBars);
+                           std::vector<DseBar> &outBars,
+                           bool *foundTable = nullptr);
 
-  // Parse the latest_share_price HTML page into quotes.
-  bool ParseLatestPriceHtml(const std::string &html,
-                            std::vector<DseQuote> &outQuotes);
+  // Parse a market-wide day_end_archive page, grouping bars by symbol.
+  bool ParseMarketHistoryHtml(
+      const std::string &html,
+      std::map<std::string, std::vector<DseBar>> &outBySymbol,
+      bool *foundTable = nullptr);
 
   // ── Amarstock Indices ────────────────────────────────────────────────────
 
-  bool IsAmarstockIndex(const char *symbol);
-
   // Fetch index bars day-by-day from amarstock.com/data/download/CSV.
   bool FetchAmarstockIndexData(const char *symbol, const char *startDate,
                                const char *endDate,
@@ -107,22 +255,120 @@ private:
 
   // ── Config ───────────────────────────────────────────────────────────────
 
+  std::shared_ptr<const DseConfig> Config() const {
+    return std::atomic_load(&m_configSnap);
+  }
+
   bool LoadConfig(const char *path);
 
-  // ── Members ──────────────────────────────────────────────────────────────
+  // Build and publish m_calendar from the staged config; holidaysFile is
+  // relative to the INI.
+  void LoadCalendar(const char *configPath);
+  void LoadHolidays(TradingCalendar &calendar, const char *configPath);
 
-  HINTERNET m_hInternet;
-  HINTERNET m_hConnect;
-  DseConfig m_config;
-  ConnectionState m_connState;
+  // Apply the staged [Metrics] settings: recording on/off, the stats
+  // file writer (statsFile is relative to the INI) and the endpoint.
+  void ApplyMetricsConfig();
+
+  // Engine health lines for the Prometheus endpoint (scrape thread).
+  void AppendHealthMetrics(std::string &out);
+
+  // Start or stop Trace recording per the staged [Trace] settings.
+  void ApplyTraceConfig();
+
+  // Join, switch or leave the [SharedBus] section per the staged settings.
+  void ApplySharedBusConfig();
+
+  // Connect to, switch or drop the [Proxy] daemon per the staged settings.
+  void ApplyProxyConfig();
+
+  // A path from the INI, relative to the INI's folder unless absolute.
+  std::string ResolveConfigRelative(const char *file) const;
 
-  std::vector<std::string> m_symbols;
-  std::map<std::string, std::vector<DseBar>> m_cache;
+  // Open m_config.logFilePath if logging is on (caller holds m_logMutex).
+  void OpenLogFile();
 
-  mutable std::mutex m_mutex;
+  // One log line per finished export pass.
+  void LogExportStats(const char *who, const std::string &path,
+                      const CsvExporter::Stats &st);
+
+  // Rewrite the whole-market Arrow file in dir, if one is configured.
+  // Runs on an exporter worker after a pass that wrote something.
+  void WriteArrowFile(const std::string &dir);
+
+  // Seed bars for one symbol: from the market-wide seed file if one is
+  // configured, else from csvSeedPath\<symbol>.csv.
+  bool LoadSeed(const char *symbol, const DseConfig &cfg,
+                std::vector<DseBar> &outBars);
+
+  // Parse cfg.marketSeedFile once (again if the path changes) and merge
+  // every series into the bar cache, releasing each parsed series as it
+  // goes; from then on the cache is the seed. False if unreadable.
+  bool HandOverMarketSeeds(const DseConfig &cfg);
+
+  // ── Members ──────────────────────────────────────────────────────────────
+
+  // HTTP session: requests hold it shared, (re)initialization exclusive
+  std::unique_ptr<HttpClient> m_http;
+  std::shared_mutex m_sessionMutex;
+
+  // Config being loaded (Initialize/ReloadConfig, under m_initMutex) and
+  // the published immutable snapshot every other reader uses
+  DseConfig m_config;
+  std::shared_ptr<const DseConfig> m_configSnap;
+  std::mutex m_initMutex;
+  char m_configPath[512];
+
+  // Reload on INI edits, and who to tell afterwards
+  ConfigWatcher m_watcher;
+  std::map<int, ConfigListener> m_listeners;
+  int m_nextListenerId;
+  std::mutex m_listenerMutex;
+  uint64_t m_configSeq;     // reloads published (under m_initMutex)
+  // One notification at a time; the last one sent (under m_dispatchMutex)
+  std::mutex m_dispatchMutex;
+  uint64_t m_dispatchedSeq;
+  std::shared_ptr<const DseConfig> m_dispatchedCfg;
+
+  std::atomic<ConnectionState> m_connState;
+  std::shared_ptr<const TradingCalendar> m_calendar; // atomic_load/store
+  MarketClock m_clock;
+
+  // Sorted symbol list, replaced wholesale (atomic_load/store)
+  std::shared_ptr<const std::vector<std::string>> m_symbols;
+
+  // Per-symbol bar series, one lock per shard
+  BarCache m_cache;
 
   FILE *m_logFile;
+  std::mutex m_logMutex;
+
+  // Background CSV writer; m_lastExportTime is touched by the poll thread
+  CsvExporter m_exporter;
   time_t m_lastExportTime;
+  std::mutex m_arrowMutex; // serialises WriteArrowFile
+
+  // Rewrites cfg.statsFile with the Metrics report; serves it to scrapers
+  Metrics::StatsFileWriter m_statsWriter;
+  MetricsServer m_metricsServer;
+
+  // Quote board and history shared with other instances, and the section
+  // name it was opened with (under m_initMutex)
+  QuoteBus m_bus;
+  std::string m_busName;
+
+  // Connection to the desk's dse_proxyd and the "host:port" it was
+  // started with (under m_initMutex)
+  ProxyClient m_proxy;
+  std::string m_proxyServer;
+
+  // Os::MonotonicMs() of the last request that returned a body (0 = none)
+  std::atomic<uint64_t> m_lastFetchOkMs;
+
+  // Market-wide seed file last handed to the cache, and whether it loaded
+  std::mutex m_seedMutex;
+  std::string m_marketSeedPath;
+  bool m_marketSeedsOk;
 };
 
 #endif // DSE_DATA_ENGINE_H
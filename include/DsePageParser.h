@@ -0,0 +1,41 @@
+///////////////////////////////////////////////////////////////////////////
+// DsePageParser.h — dsebd.org Page Parsers
+//
+// Turns the day_end_archive and latest_share_price pages into bars and
+// quotes. Free of Win32 and of the engine, so the parsers can be
+// benchmarked and profiled on any platform; DseDataEngine wraps them and
+// routes their diagnostics to its log.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef DSE_PAGE_PARSER_H
+#define DSE_PAGE_PARSER_H
+
+#include "DseTypes.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace DsePageParser {
+
+  /// Receives one diagnostic line; may be empty (no logging, no formatting)
+  typedef std::function<void(const char *msg)> LogFn;
+
+  /// Called with the TRADING CODE cell (empty if the page has none) and bar
+  typedef std::function<void(const std::string &, const DseBar &)> RowFn;
+
+  /// Rejects zero prices, bad dates and inverted high/low
+  bool ValidateBar(const DseBar &bar);
+
+  /// Walk the day_end_archive table, calling onRow for every valid row.
+  /// Returns the row count, or -1 if no table was found.
+  int ParseArchiveTable(const std::string &html, const RowFn &onRow,
+                        const LogFn &log = LogFn());
+
+  /// Parse a latest_share_price page into quotes (appended to outQuotes).
+  bool ParseLatestPriceHtml(const std::string &html,
+                            std::vector<DseQuote> &outQuotes,
+                            const LogFn &log = LogFn());
+
+} // namespace DsePageParser
+
+#endif // DSE_PAGE_PARSER_H
@@ -17,6 +17,19 @@ struct DseBar {
   double trade;   // number of trades
   double value;   // turnover value
   bool valid;     // false if bad tick
+  bool provisional; // built from the live page at close, pending archive
+};
+
+///////////////////////////////////////////////////////////////////////////
+// One intraday bar built from polled snapshots
+///////////////////////////////////////////////////////////////////////////
+struct DseIntradayBar {
+  int date;       // YYYYMMDD
+  int time;       // HHMMSS of the bar start
+  double open, high, low, close;
+  double volume;  // traded in this interval (delta of cumulative volume)
+  double trade;
+  double value;
 };
 
 ///////////////////////////////////////////////////////////////////////////
@@ -43,9 +56,18 @@ struct DseQuote {
 ///////////////////////////////////////////////////////////////////////////
 struct DseConfig {
   int historyDays;
+  int historyChunkMonths;   // months per day_end_archive request (12 = year)
+  int historyFetchThreads;  // max concurrent chunk requests
+  int historyChunkRetries;  // extra attempts for a failed chunk
+  int marketChunkMonths;    // months per market-wide archive request
   int pollIntervalMs;
+  int pollMinIntervalMs;    // adaptive interval floor
+  int pollMaxIntervalMs;    // adaptive interval ceiling
+  int pollJitterPct;        // +/- random spread applied to each interval
+  bool pollAdaptive;        // follow the page's observed update cadence
   int marketOpenHour, marketOpenMinute;
   int marketCloseHour, marketCloseMinute;
+  int exchangeUtcOffsetMin; // exchange time = UTC + this (DSE: 360)
   int maxReconnectAttempts;
   int httpTimeoutSec;
   char userAgent[256];
@@ -56,8 +78,39 @@ struct DseConfig {
   bool enableLogging;
   char logFilePath[260];
   char csvSeedPath[512];
+  int seedThreads;       // seed files parsed in parallel (0 = one per core)
+  char marketSeedFile[512]; // one Format A file for every symbol ("" = off)
   char exportPath[512];
   int exportIntervalSec;
+  int exportThreads;     // files written in parallel per export pass
+  bool exportAppend;     // update files in place from the first changed row
+  char arrowFile[64];    // whole-market Arrow file in exportPath ("" = off)
+  int intradayBarSec;    // base intraday bar size built from snapshots
+  int intradaySessions;  // sessions of intraday bars kept per symbol
+  char tradingWeekdays[64]; // e.g. "Sun,Mon,Tue,Wed,Thu"
+  char holidaysFile[512];   // holiday/special-session list (see TradingCalendar)
+  bool journalEnabled;      // record polled snapshots to disk
+  char journalPath[512];    // folder for YYYYMMDD.dsj session journals
+  int journalKeyframeEvery; // polls between full-state keyframes
+  bool replayEnabled;       // feed from a recording instead of dsebd.org
+  char replayPath[512];     // folder of recorded pages, or a .dsj journal
+  int replaySpeed;          // 1 = recorded cadence, N = Nx, 0 = max
+  char recordPath[512];     // save each live page here (empty = off)
+  bool configWatch;         // reload when dse_config.ini changes on disk
+  int configWatchMs;        // how often the INI is checked
+  bool metricsEnabled;      // record per-stage latency histograms
+  char statsFile[512];      // periodic metrics report ("" = off)
+  int statsIntervalSec;     // how often statsFile is rewritten
+  int metricsPort;          // loopback Prometheus endpoint (0 = off)
+  bool traceEnabled;        // record a Chrome trace of plugin threads
+  int traceEventsPerThread; // ring size; older events are overwritten
+  char traceFile[512];      // where DumpTrace writes the JSON
+  bool sharedBusEnabled;    // share one poller between AmiBroker instances
+  char sharedBusName[64];   // shared-memory section all instances map
+  int sharedBarsMB;         // history arena size (set by the first instance)
+  int sharedBusLeaseSec;    // silent writer keeps its role this long
+  char proxyServer[128];    // dse_proxyd "host:port" ("" = scrape directly)
+  int proxyTimeoutSec;      // wait for a history reply from the daemon
 };
 
 ///////////////////////////////////////////////////////////////////////////
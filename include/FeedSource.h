@@ -0,0 +1,120 @@
+///////////////////////////////////////////////////////////////////////////
+// FeedSource.h — Where RealtimeFeed Gets Its Snapshots (and Its Clock)
+//
+// LiveFeedSource polls dsebd.org on wall-clock time, optionally saving each
+// raw latest-price page; with a dse_proxyd connected it wakes on each
+// pushed change instead. ReplayFeedSource plays those recorded pages (or a
+// snapshot journal) back on a virtual clock at 1x, Nx or maximum speed, so
+// the streaming path can be exercised outside market hours.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef FEED_SOURCE_H
+#define FEED_SOURCE_H
+
+#include "DseTypes.h"
+#include "PollScheduler.h"
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class DseDataEngine;
+
+///////////////////////////////////////////////////////////////////////////
+// IFeedSource — snapshot provider plus the clock it runs on
+///////////////////////////////////////////////////////////////////////////
+class IFeedSource {
+public:
+  virtual ~IFeedSource() {}
+
+  // Fetch the next full latest-price snapshot.
+  virtual bool Fetch(std::vector<DseQuote> &outQuotes) = 0;
+
+  // True while the (possibly virtual) market is in session.
+  virtual bool IsMarketOpen() = 0;
+
+  // Current feed time in exchange time: date as YYYYMMDD, seconds since
+  // midnight.
+  virtual void Now(int &date, int &secOfDay) = 0;
+
+  // Wait ms of feed time, returning as soon as stop is set.
+  virtual void Wait(int ms, StopSignal &stop) = 0;
+
+  // False for simulated sources: no archive reconcile, no journaling.
+  virtual bool IsLive() const = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////
+// LiveFeedSource — dsebd.org on the engine's market clock
+///////////////////////////////////////////////////////////////////////////
+class LiveFeedSource : public IFeedSource {
+public:
+  // recordDir: if non-empty, every fetched page is saved there as
+  // YYYYMMDD_HHMMSS.html for later replay.
+  LiveFeedSource(DseDataEngine *engine, const char *recordDir);
+
+  bool Fetch(std::vector<DseQuote> &outQuotes) override;
+  bool IsMarketOpen() override;
+  void Now(int &date, int &secOfDay) override;
+  void Wait(int ms, StopSignal &stop) override;
+  bool IsLive() const override { return true; }
+
+private:
+  DseDataEngine *m_engine;
+  std::string m_recordDir;
+  uint64_t m_proxySeq; // dse_proxyd board seen by the last Fetch
+};
+
+///////////////////////////////////////////////////////////////////////////
+// ReplayFeedSource — recorded pages or a .dsj journal on a virtual clock
+///////////////////////////////////////////////////////////////////////////
+class ReplayFeedSource : public IFeedSource {
+public:
+  // path:  a folder of recorded pages (YYYYMMDD_HHMMSS.html, played in name
+  //        order) or a snapshot journal file (YYYYMMDD.dsj).
+  // speed: 1 = recorded cadence, N = N times faster, 0 = as fast as possible.
+  ReplayFeedSource(DseDataEngine *engine, const char *path, int speed);
+
+  // Index the recording. Returns false if nothing playable was found.
+  bool Load();
+
+  bool Fetch(std::vector<DseQuote> &outQuotes) override;
+  bool IsMarketOpen() override;
+  void Now(int &date, int &secOfDay) override;
+  void Wait(int ms, StopSignal &stop) override;
+  bool IsLive() const override { return false; }
+
+  size_t GetFrameCount() const { return m_frames.size(); }
+
+private:
+  struct Frame {
+    int date;
+    int secOfDay;
+    std::string pagePath;         // recorded page, parsed on Fetch
+    std::vector<DseQuote> quotes; // pre-decoded journal record (changed
+                                  // rows only)
+  };
+
+  bool LoadPages();
+  bool LoadJournal();
+
+  DseDataEngine *m_engine;
+  std::string m_path;
+  int m_speed;
+
+  std::vector<Frame> m_frames;
+  size_t m_next; // next frame Fetch delivers
+  int m_date, m_secOfDay;
+
+  // Journal replay: the board so far, in first-seen order, with each
+  // symbol's row in it
+  std::vector<DseQuote> m_board;
+  std::unordered_map<std::string, size_t> m_boardIndex;
+
+  // Throughput stats, logged when the recording runs out
+  size_t m_quotesDelivered;
+  std::chrono::steady_clock::time_point m_startTime;
+  bool m_reported;
+};
+
+#endif // FEED_SOURCE_H
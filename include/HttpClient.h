@@ -0,0 +1,43 @@
+///////////////////////////////////////////////////////////////////////////
+// HttpClient.h — Transport Interface Used by DseDataEngine
+//
+// The engine only needs "GET this URL" and "POST this form"; how the bytes
+// travel is up to the host. The plugin supplies WinInetHttpClient, and
+// dse_proxyd links CurlHttpClient where WinInet is missing (Linux). The
+// benchmarks run without one (network fetches fail cleanly) or with a
+// harness-provided client that serves recorded pages.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include <functional>
+#include <string>
+
+class HttpClient {
+public:
+  // Receives one diagnostic line (transport errors)
+  typedef std::function<void(const char *msg)> LogFn;
+
+  virtual ~HttpClient() {}
+
+  // Open the session, replacing any open one. The engine calls this with
+  // no request in flight.
+  virtual bool Open(const char *userAgent, int timeoutSec,
+                    const LogFn &log) = 0;
+
+  // New timeouts / user agent for requests started from now on.
+  virtual void Configure(const char *userAgent, int timeoutSec) = 0;
+
+  virtual void Close() = 0;
+  virtual bool IsOpen() const = 0;
+
+  // Response body of a GET, or of a form-encoded POST. False on transport
+  // failure; a successful request may still return an empty body. Safe to
+  // call from several threads at once.
+  virtual bool Get(const char *url, std::string &outBody) = 0;
+  virtual bool Post(const char *url, const char *formPayload,
+                    std::string &outBody) = 0;
+};
+
+#endif // HTTP_CLIENT_H
@@ -0,0 +1,42 @@
+///////////////////////////////////////////////////////////////////////////
+// IniFile.h — Portable Reader for dse_config.ini
+//
+// Reads the file once and answers lookups from memory, following the
+// GetPrivateProfile*A rules the config has always been written for:
+// section and key names are case-insensitive, the first occurrence of a
+// key wins, whitespace around names and values is trimmed, a value wrapped
+// in matching quotes loses them, and ';' starts a comment line only at the
+// beginning of a line. Missing files and keys yield the caller's default.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef INI_FILE_H
+#define INI_FILE_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+class IniFile {
+public:
+  // Read path, replacing anything loaded before. False if it cannot be
+  // opened (every lookup then returns its default).
+  bool Load(const char *path);
+
+  // Integer value (decimal, or hex with 0x); def if the key is absent.
+  // A present but non-numeric value reads as 0, as GetPrivateProfileInt.
+  int GetInt(const char *section, const char *key, int def) const;
+
+  // Copy the value (or def) into out, truncated to size - 1 characters.
+  void GetString(const char *section, const char *key, const char *def,
+                 char *out, size_t size) const;
+
+  bool Has(const char *section, const char *key) const;
+
+private:
+  static std::string MakeKey(const char *section, const char *key);
+
+  // Lower-cased "section\nkey" -> value
+  std::map<std::string, std::string> m_values;
+};
+
+#endif // INI_FILE_H
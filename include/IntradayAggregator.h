@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////
+// IntradayAggregator.h — Intraday OHLCV Bars from Polled Snapshots
+//
+// The DSE latest-price page only carries cumulative day totals (volume,
+// trade count, value) and the day's running high/low. The aggregator turns
+// successive snapshots into per-interval bars using the deltas between
+// polls and keeps them in a fixed-size ring buffer per symbol.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef INTRADAY_AGGREGATOR_H
+#define INTRADAY_AGGREGATOR_H
+
+#include "DseTypes.h"
+#include "TradingCalendar.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class IntradayAggregator {
+public:
+  IntradayAggregator();
+
+  // barIntervalSec: base bar size (bars are built at this resolution)
+  // sessions:       how many trading sessions of bars each symbol keeps
+  // openSec/closeSec: session bounds as seconds since midnight
+  // Clears any bars already held.
+  void Configure(int barIntervalSec, int sessions, int openSec, int closeSec);
+
+  // Take each day's session open (special sessions included) from a
+  // calendar instead of the fixed openSec given to Configure.
+  void SetCalendar(std::shared_ptr<const TradingCalendar> calendar);
+
+  // Fold one snapshot taken at date (YYYYMMDD) / secOfDay into the bars.
+  void OnSnapshot(const std::vector<DseQuote> &quotes, int date, int secOfDay);
+
+  // Copy a symbol's bars, oldest first, compressed to intervalSec (rounded
+  // up to a multiple of the base interval). Returns false if none exist.
+  bool GetBars(const char *symbol, int intervalSec,
+               std::vector<DseIntradayBar> &outBars) const;
+
+  int GetBaseInterval() const { return m_intervalSec; }
+
+  void Clear();
+
+private:
+  struct Series {
+    std::vector<DseIntradayBar> ring; // grows to m_capacity, then wraps
+    size_t head;                      // oldest element once full
+    int lastDate;                     // date of the previous snapshot
+    double lastVolume, lastTrade, lastValue;
+    double lastHigh, lastLow;         // running day high/low
+  };
+
+  DseIntradayBar &Newest(Series &s);
+  void Append(Series &s, const DseIntradayBar &bar);
+
+  std::map<std::string, Series> m_series;
+  mutable std::mutex m_mutex;
+
+  std::shared_ptr<const TradingCalendar> m_calendar;
+  int m_intervalSec;
+  int m_openSec;
+  size_t m_capacity;
+};
+
+#endif // INTRADAY_AGGREGATOR_H
@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////
+// MappedFile.h — Read-Only Memory-Mapped File
+//
+// Maps a file for reading (CreateFileMapping/MapViewOfFile on Windows,
+// mmap elsewhere) so large inputs are parsed in place without being
+// copied into a buffer first. Either the whole file is mapped at once, or
+// the file is opened and mapped one window at a time, which is how a
+// 32-bit process reads files larger than its free address space.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+
+class MappedFile {
+public:
+  MappedFile();
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // Map path read-only, whole. An empty file opens with Size() == 0.
+  bool Open(const char *path);
+
+  // Open path read-only without mapping anything; call MapWindow next.
+  bool OpenUnmapped(const char *path);
+
+  // Replace the current view with [offset, offset + length) of the file
+  // (clipped to its end). Offsets need no particular alignment.
+  bool MapWindow(uint64_t offset, size_t length);
+
+  void Close();
+
+  // Current view
+  const char *Data() const { return m_data; }
+  size_t Size() const { return m_size; }
+
+  uint64_t FileSize() const { return m_fileSize; }
+
+private:
+  void Unmap();
+
+  const char *m_data;
+  size_t m_size;
+  uint64_t m_fileSize;
+  void *m_base;       // start of the view as mapped (aligned down)
+  size_t m_baseSize;
+#ifdef _WIN32
+  void *m_file;    // HANDLE
+  void *m_mapping; // HANDLE
+#else
+  int m_fd;
+#endif
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////
+// MarketClock.h — Exchange Time, Independent of the Workstation Time Zone
+//
+// Exchange time is UTC plus a fixed configured offset (DSE: UTC+6, no DST),
+// so open/close decisions and bar dates come out the same on a Dhaka
+// workstation, a UTC Linux replay box, or a laptop set to another zone.
+// The current exchange date is cached and only recomputed when a day
+// boundary is crossed. Tests and replays can substitute the UTC source.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef MARKET_CLOCK_H
+#define MARKET_CLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+class MarketClock {
+public:
+  // Milliseconds since 1970-01-01 UTC
+  typedef std::function<int64_t()> UtcSource;
+
+  // Exchange-local wall time
+  struct Time {
+    int date;      // YYYYMMDD
+    int secOfDay;  // seconds since exchange midnight
+    int ms;        // milliseconds within the second
+    int dayOfWeek; // 0 = Sunday ... 6 = Saturday
+    int hour() const { return secOfDay / 3600; }
+    int minute() const { return (secOfDay / 60) % 60; }
+    int second() const { return secOfDay % 60; }
+    int hhmmss() const { return hour() * 10000 + minute() * 100 + second(); }
+  };
+
+  MarketClock();
+
+  // Exchange offset from UTC in minutes (DSE = +360).
+  void SetUtcOffsetMinutes(int minutes);
+  int GetUtcOffsetMinutes() const { return m_offsetMin.load(); }
+
+  // Replace the time source (nullptr restores the system clock).
+  void SetUtcSource(UtcSource source);
+
+  int64_t NowUtcMs() const;
+
+  // Current exchange-local time.
+  Time Now() const;
+
+  // Current exchange date (YYYYMMDD); cached until the next midnight.
+  int Today() const;
+
+  // Convert a UTC instant to exchange-local time.
+  Time ToExchange(int64_t utcMs) const;
+
+  // The UTC instant of exchange-local date (YYYYMMDD) and second of day.
+  int64_t ToUtcMs(int date, int secOfDay) const;
+
+  // System clock, for SetUtcSource callers that wrap it.
+  static int64_t SystemUtcMs();
+
+private:
+  std::atomic<int> m_offsetMin;
+  std::shared_ptr<UtcSource> m_source; // null = system clock
+
+  // (day number << 32) | YYYYMMDD of the last Today() answer
+  mutable std::atomic<int64_t> m_cachedDay;
+};
+
+#endif // MARKET_CLOCK_H
@@ -0,0 +1,200 @@
+///////////////////////////////////////////////////////////////////////////
+// Metrics.h — Hot-Path Latency Histograms and Counters
+//
+// Process-wide, fixed set of stages and counters, so recording is an
+// array index and a few relaxed atomic adds — no lookups, no locks, no
+// allocation. Latencies go into log-linear (HDR-style) histograms: 16
+// sub-buckets per power of two, so any percentile is within 6.25% of the
+// true value, from 1 us up to ~19 hours.
+//
+//   {
+//     Metrics::ScopedTimer t(Metrics::kHtmlParse);
+//     ...
+//   }
+//   Metrics::Add(Metrics::kQuotes, quotes.size());
+//
+// FormatReport() renders everything as text (stats file, Configure
+// dialog), FormatPrometheus() as Prometheus exposition text (the loopback
+// endpoint, see MetricsServer); StatsFileWriter rewrites the text report
+// on an interval.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Metrics {
+
+  /// Timed stages. HTTP stages are measured by the transport: connect is
+  /// opening the request up to the response headers (WinInet does DNS,
+  /// TCP, TLS and the headers in that one call), TTFB is request start to
+  /// the first body byte, body is first byte to last.
+  enum Stage {
+    kHttpConnect,
+    kHttpTtfb,
+    kHttpBody,
+    kHtmlParse,
+    kCsvParse,
+    kCacheMerge,
+    kGetQuotesEx,
+    kGetRecentInfo,
+    kStreamingUpdate,
+    kPoll,         // one live poll: fetch, parse, cache and push
+    kSnapshotDiff, // diffing a polled page against the previous one
+    kStageCount
+  };
+
+  /// Monotonic counters
+  enum Counter {
+    kHttpRequests,
+    kHttpErrors,
+    kHttpBytes,
+    kHtmlBars,     // bars parsed from archive pages
+    kQuotes,       // quotes parsed from latest-price pages
+    kCsvBars,      // bars parsed from seed / amarstock CSV
+    kBarsMerged,   // bars written into the cache by merges
+    kStreamingUpdates,
+    kAllocations,  // operator new calls (plugin build only)
+    kPolls,
+    kPollFailures,
+    kParseFailures, // non-empty pages that yielded no rows
+    kBusQuoteReads, // snapshots taken from another instance's QuoteBus
+    kBusBarHits,    // history windows copied from the QuoteBus
+    kProxyQuoteReads, // snapshots taken from dse_proxyd's pushed board
+    kProxyHistory,    // history windows answered by dse_proxyd
+    kQuotesChanged,   // polled rows that differed from the previous poll
+    kQuotesAppeared,  // symbols new to the page (every row on a first poll)
+    kQuotesHalted,    // symbols that dropped off the page
+    kCounterCount
+  };
+
+  /// Point-in-time values
+  enum Gauge {
+    kExportQueue,  // symbols queued or being written by CsvExporter
+    kJournalQueue, // snapshots waiting for the journal writer
+    kBackfills,    // per-symbol backfill threads running
+    kGaugeCount
+  };
+
+  const char *StageName(Stage s);
+  const char *CounterName(Counter c);
+  const char *GaugeName(Gauge g);
+
+  // ── Histogram ────────────────────────────────────────────────────────────
+
+  class Histogram {
+  public:
+    static const int kSubBits = 4;                       // 16 per octave
+    static const int kMaxBits = 36;                      // ~19 h in us
+    static const int kBuckets = (kMaxBits - kSubBits + 2) << kSubBits;
+
+    void Record(uint64_t us);
+    void Reset();
+
+    uint64_t Count() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t SumUs() const { return m_sum.load(std::memory_order_relaxed); }
+    uint64_t MaxUs() const { return m_max.load(std::memory_order_relaxed); }
+
+    /// Upper bound of the bucket holding the p-th percentile (0..100);
+    /// 0 when empty
+    uint64_t PercentileUs(double p) const;
+
+    static int BucketOf(uint64_t us);
+    static uint64_t BucketUpper(int bucket);
+
+  private:
+    std::atomic<uint64_t> m_buckets[kBuckets];
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max;
+  };
+
+  // ── Recording ────────────────────────────────────────────────────────────
+
+  /// Off: timers skip the clock and recording is a no-op (counters still
+  /// count; they are a single add)
+  void SetEnabled(bool enabled);
+  bool Enabled();
+
+  void Record(Stage s, uint64_t us);
+  void Add(Counter c, uint64_t n = 1);
+  void Set(Gauge g, int64_t value);
+  void Adjust(Gauge g, int64_t delta);
+
+  const Histogram &Get(Stage s);
+  uint64_t Get(Counter c);
+  int64_t Get(Gauge g);
+
+  /// Zero every histogram and counter (gauges keep their values)
+  void Reset();
+
+  inline uint64_t NowUs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  /// Records the time from construction to destruction into one stage
+  class ScopedTimer {
+  public:
+    explicit ScopedTimer(Stage s)
+        : m_stage(s), m_start(Enabled() ? NowUs() : 0) {}
+    ~ScopedTimer() {
+      if (m_start)
+        Record(m_stage, NowUs() - m_start);
+    }
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+  private:
+    Stage m_stage;
+    uint64_t m_start;
+  };
+
+  // ── Reporting ────────────────────────────────────────────────────────────
+
+  /// Fixed-width text: one line per stage (count, p50/p90/p99/max/mean in
+  /// microseconds), then counters and gauges. Lines end in eol.
+  std::string FormatReport(const char *eol = "\n");
+
+  /// Prometheus text format 0.0.4: stage latencies as summaries
+  /// (dse_stage_latency_seconds{stage,quantile}), counters as
+  /// dse_<name>_total, gauges as dse_<name>
+  std::string FormatPrometheus();
+
+  /// Rewrites a file with FormatReport() every intervalSec on its own
+  /// thread (written to path.tmp, then renamed over it)
+  class StatsFileWriter {
+  public:
+    StatsFileWriter();
+    ~StatsFileWriter();
+
+    // Start, or retarget a running writer. An empty path stops it.
+    void Configure(const std::string &path, int intervalSec);
+    void Stop();
+
+    // Write the report now; false if the file could not be written
+    static bool WriteNow(const std::string &path);
+
+  private:
+    void Loop();
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::string m_path;
+    int m_intervalSec;
+    bool m_stop;
+  };
+
+} // namespace Metrics
+
+#endif // METRICS_H
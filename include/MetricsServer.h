@@ -0,0 +1,57 @@
+///////////////////////////////////////////////////////////////////////////
+// MetricsServer.h — Loopback Prometheus Endpoint
+//
+// A minimal HTTP/1.1 server bound to 127.0.0.1 that answers
+// "GET /metrics" with Metrics::FormatPrometheus() plus whatever the owner
+// appends (connection state, cache size, ...). It runs on its own thread
+// and only reads atomics and snapshots, so a scrape never blocks the
+// threads being measured. One connection at a time; every response
+// closes the connection.
+//
+//   curl http://127.0.0.1:9464/metrics
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+class MetricsServer {
+public:
+  // Appends extra exposition lines to a scrape response
+  typedef std::function<void(std::string &out)> AppendFn;
+  typedef std::function<void(const char *msg)> LogFn;
+
+  MetricsServer();
+  ~MetricsServer();
+
+  // Listen on 127.0.0.1:port (0 = any free port; see Port()), replacing
+  // a running listener. False if the port cannot be bound.
+  bool Start(int port, AppendFn extra, const LogFn &log = LogFn());
+  void Stop();
+
+  bool IsRunning() const { return m_thread.joinable(); }
+
+  // Port actually bound (0 when stopped)
+  int Port() const { return m_port; }
+
+  // The full response body for GET /metrics
+  std::string Render() const;
+
+private:
+  void Loop();
+  void Serve(uintptr_t client);
+
+  std::thread m_thread;
+  std::atomic<bool> m_stop;
+  uintptr_t m_listen; // SOCKET / fd
+  int m_port;
+  AppendFn m_extra;
+  LogFn m_log;
+};
+
+#endif // METRICS_SERVER_H
@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////
+// OsServices.h — Clock, File and Debug-Output Primitives
+//
+// The few operating-system calls dse_core needs outside the CRT, behind
+// one portable surface: Win32 in the plugin, POSIX on the Linux build
+// used for profiling. Exchange time is MarketClock's job; the clock here
+// is the workstation's (log stamps, elapsed-time measurements).
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef OS_SERVICES_H
+#define OS_SERVICES_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Os {
+
+  // ── Clock ────────────────────────────────────────────────────────────────
+
+  /// Workstation local wall time
+  struct LocalTime {
+    int year, month, day;
+    int hour, minute, second, ms;
+  };
+
+  LocalTime LocalNow();
+
+  /// Monotonic milliseconds, for measuring elapsed time only
+  uint64_t MonotonicMs();
+
+  void SleepMs(int ms);
+
+  // ── Files ────────────────────────────────────────────────────────────────
+
+  /// Native separator ('\\' on Windows, '/' elsewhere); both are accepted
+  /// wherever a path is split
+  extern const char kPathSep;
+
+  bool FileExists(const char *path);
+
+  /// Create one directory level; true if it exists afterwards
+  bool MakeDir(const char *path);
+
+  /// Names of the regular files in dir, sorted (empty if unreadable)
+  std::vector<std::string> ListFiles(const std::string &dir);
+
+  /// Rooted ("\\x", "/x") or drive-qualified ("C:x")
+  bool IsAbsolutePath(const char *path);
+
+  /// dir + separator + name; name alone if dir is empty
+  std::string JoinPath(const std::string &dir, const std::string &name);
+
+  /// Everything before the last separator ("" if there is none)
+  std::string DirName(const char *path);
+
+  // ── Diagnostics ──────────────────────────────────────────────────────────
+
+  /// Debugger output (OutputDebugString); nothing on other platforms
+  void DebugOutput(const char *text);
+
+  /// Physical memory held by this process (working set / RSS); 0 if the
+  /// platform will not say
+  uint64_t ResidentBytes();
+
+  // ── Processes ────────────────────────────────────────────────────────────
+
+  uint32_t ProcessId();
+
+  /// False once the process has exited (a PID we may not inspect counts as
+  /// running)
+  bool ProcessAlive(uint32_t pid);
+
+} // namespace Os
+
+#endif // OS_SERVICES_H
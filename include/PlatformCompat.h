@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////
+// PlatformCompat.h — Win32 CRT Names on Other Platforms
+//
+// Portable modules (parsers, CSV helpers, exporters, the engine) use the
+// same secure CRT calls as the rest of the plugin. On Windows this is just
+// <windows.h>; elsewhere the handful of names they need are mapped onto
+// their POSIX equivalents so those modules build and run on Linux (the
+// benchmarks, profilers).
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef PLATFORM_COMPAT_H
+#define PLATFORM_COMPAT_H
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+#else
+
+#include <cerrno>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <strings.h>
+
+typedef int errno_t;
+
+inline int sprintf_s(char *dst, size_t size, const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(dst, size, fmt, args);
+  va_end(args);
+  return n;
+}
+
+template <size_t N>
+inline int sprintf_s(char (&dst)[N], const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(dst, N, fmt, args);
+  va_end(args);
+  return n;
+}
+
+template <size_t N>
+inline errno_t strcpy_s(char (&dst)[N], const char *src) {
+  snprintf(dst, N, "%s", src);
+  return 0;
+}
+
+// Only numeric conversions go through sscanf_s here, so the extra buffer
+// size arguments %s/%c would need never appear
+#define sscanf_s sscanf
+
+inline errno_t fopen_s(FILE **fp, const char *path, const char *mode) {
+  *fp = fopen(path, mode);
+  return *fp ? 0 : errno;
+}
+
+inline int _stricmp(const char *a, const char *b) { return strcasecmp(a, b); }
+
+#define MOVEFILE_REPLACE_EXISTING 0x1
+#define MOVEFILE_WRITE_THROUGH 0x8
+
+// rename() replaces the target atomically on POSIX file systems
+inline bool MoveFileExA(const char *from, const char *to, unsigned) {
+  return rename(from, to) == 0;
+}
+
+#endif // _WIN32
+
+#endif // PLATFORM_COMPAT_H
@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////
+// PollScheduler.h — When RealtimeFeed Polls Next
+//
+// While the market is open the interval follows how often the latest-price
+// page actually changes (faster while it moves, backing off while it sits
+// still), with random jitter, clipped so the close edge is never overshot.
+// While closed the wait runs exactly to the next open edge. StopSignal lets
+// every wait end the moment the feed is stopped.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef POLL_SCHEDULER_H
+#define POLL_SCHEDULER_H
+
+#include "DseTypes.h"
+#include "TradingCalendar.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////
+// StopSignal — manual-reset event that waits can block on
+///////////////////////////////////////////////////////////////////////////
+class StopSignal {
+public:
+  StopSignal() : m_set(false) {}
+
+  void Set() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_set = true;
+    }
+    m_cv.notify_all();
+  }
+
+  void Reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_set = false;
+  }
+
+  bool IsSet() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_set;
+  }
+
+  // Block up to ms; returns true if the signal is (or becomes) set.
+  bool WaitFor(int ms) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (ms > 0)
+      m_cv.wait_for(lock, std::chrono::milliseconds(ms),
+                    [this] { return m_set; });
+    return m_set;
+  }
+
+private:
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_set;
+};
+
+///////////////////////////////////////////////////////////////////////////
+// PollScheduler — adaptive poll interval plus exact session edges
+///////////////////////////////////////////////////////////////////////////
+class PollScheduler {
+public:
+  PollScheduler();
+
+  // baseMs: interval until the page cadence is known (and when adaptive is
+  // off). openSec/closeSec: session bounds in seconds since midnight; the
+  // session is open through the whole closing minute, as IsMarketOpen is.
+  void Configure(int baseMs, int minMs, int maxMs, int jitterPct,
+                 bool adaptive, int openSec, int closeSec);
+
+  // Take session edges (holidays, special hours) from a calendar instead of
+  // the fixed hours given to Configure.
+  void SetCalendar(std::shared_ptr<const TradingCalendar> calendar) {
+    m_calendar = std::move(calendar);
+  }
+
+  // Forget the observed cadence (new session).
+  void Reset();
+
+  // Change the base interval (Configure dialog), clamped to [min, max].
+  void SetBaseIntervalMs(int ms);
+  int GetBaseIntervalMs() const { return m_baseMs; }
+
+  // Record one successful poll at feed time secOfDay; pageMoved says
+  // whether the page differed from the previous poll.
+  void OnPoll(bool pageMoved, int secOfDay);
+
+  // Delay before the next poll while open, never past the close edge.
+  int NextOpenDelayMs(int date, int secOfDay);
+
+  // Delay while closed: to the next session's open edge (skipping weekends
+  // and holidays), at most kMaxClosedWaitMs so a clock change or resume
+  // from sleep is picked up.
+  int NextClosedDelayMs(int date, int secOfDay) const;
+
+  // Current open-market interval before jitter
+  int GetIntervalMs() const { return m_intervalMs; }
+
+  // Observed page update cadence (0 = not yet known)
+  int GetCadenceMs() const { return m_cadenceMs; }
+
+private:
+  static const int kMaxClosedWaitMs = 30 * 60 * 1000;
+
+  int m_baseMs, m_minMs, m_maxMs;
+  int m_jitterPct;
+  bool m_adaptive;
+  int m_openSec, m_closeEdgeSec;
+  std::shared_ptr<const TradingCalendar> m_calendar;
+
+  int m_intervalMs;
+  int m_cadenceMs;      // EWMA of gaps between content changes
+  int m_lastChangeSec;  // -1 until the first poll
+  int m_unchanged;      // consecutive polls with the same content
+
+  std::mt19937 m_rng;
+};
+
+#endif // POLL_SCHEDULER_H
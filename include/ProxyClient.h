@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////
+// ProxyClient.h — Plugin Side of a dse_proxyd Connection
+//
+// Keeps one TCP connection to the desk's dse_proxyd, reconnecting with
+// backoff for as long as it runs. A receive thread decodes the pushed
+// Snapshot/Delta stream (QuoteCodec) into a local copy of the board,
+// asking for a Resync on any gap, so GetQuotes is a copy, not a request. History requests
+// go over the same connection and wait for their reply.
+//
+// The engine consults it before dsebd.org: quotes come from the board
+// while the connection is up, history from the daemon's cache or its own
+// fetch. With the daemon unreachable everything falls back to scraping.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef PROXY_CLIENT_H
+#define PROXY_CLIENT_H
+
+#include "DseTypes.h"
+#include "QuoteCodec.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ProxyClient {
+public:
+  typedef std::function<void(const char *msg)> LogFn;
+
+  ProxyClient();
+  ~ProxyClient();
+
+  ProxyClient(const ProxyClient &) = delete;
+  ProxyClient &operator=(const ProxyClient &) = delete;
+
+  // Connect to host:port in the background (replacing any running
+  // connection) and stay connected until Stop
+  void Start(const std::string &host, int port, const LogFn &log = LogFn());
+  void Stop();
+
+  bool IsRunning() const { return m_thread.joinable(); }
+  bool IsConnected() const;
+
+  // The pushed board, in symbol order. False while disconnected or before
+  // the first snapshot. seq moves with every change the daemon pushes.
+  bool GetQuotes(std::vector<DseQuote> &outQuotes, uint64_t &seq) const;
+
+  // Board sequence last applied (0 = none)
+  uint64_t Sequence() const;
+
+  // Block until the board moves past seenSeq (true), ms pass or the
+  // client stops (false)
+  bool WaitForUpdate(uint64_t seenSeq, int ms);
+
+  // Bars for [startDate, endDate] ("YYYY-MM-DD") from the daemon. False on
+  // timeout, disconnect, or if the daemon's own fetch failed.
+  bool FetchHistory(const char *symbol, const char *startDate,
+                    const char *endDate, std::vector<DseBar> &outBars,
+                    int timeoutMs);
+
+private:
+  struct Pending {
+    bool done = false;
+    bool ok = false;
+    std::vector<DseBar> bars;
+  };
+
+  void Loop();
+  uintptr_t Connect();
+  void Session(uintptr_t sock);
+  bool Send(const std::string &frame);
+  void HandleFrame(uint8_t type, const std::string &payload);
+  void Disconnected();
+  void Log(const char *fmt, ...);
+
+  std::thread m_thread;
+  std::atomic<bool> m_stop;
+  std::string m_host;
+  int m_port;
+  LogFn m_log;
+
+  // Socket of the live session; sends from any thread, one at a time
+  std::mutex m_sendMutex;
+  uintptr_t m_sock;
+
+  // Board, sequence and pending history replies; m_cv signals all three
+  // (and Stop)
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_connected;
+  bool m_haveBoard;
+  bool m_resyncSent;
+  uint64_t m_seq;
+  QuoteCodec::Decoder m_decoder; // the board by symbol ID
+  std::vector<DseQuote> m_board; // symbol order
+  std::vector<size_t> m_pos;     // m_board row of each symbol ID
+  std::map<uint32_t, Pending *> m_pending;
+  uint32_t m_nextReqId;
+};
+
+#endif // PROXY_CLIENT_H
@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////
+// ProxyProtocol.h — Framing Between dse_proxyd and Plugin Instances
+//
+// Every message is one frame: a little-endian u32 payload length, a u8
+// message type, then the payload. Quotes and bars travel in the
+// QuoteCodec.h binary delta encoding rather than the HTML they were
+// scraped from.
+//
+//   client -> daemon   Hello, Resync, HistoryRequest
+//   daemon -> client   Welcome, Snapshot, Delta, HistoryReply, Heartbeat
+//
+// After Hello the daemon sends a full Snapshot, then one Delta per poll
+// carrying only the fields that changed (and the symbols that left the
+// board). Delta n applies to the board after message n-1; a client that
+// sees a gap, or a Delta its decoder rejects, sends Resync and gets a
+// fresh Snapshot. The daemon also sends a Snapshot every few polls so a
+// missed Delta cannot stick.
+//
+// v2 replaced v1's fixed-width quote and bar records with QuoteCodec.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef PROXY_PROTOCOL_H
+#define PROXY_PROTOCOL_H
+
+#include <cstdint>
+#include <string>
+
+namespace ProxyProtocol {
+
+  const uint32_t kMagic = 0x50455344; // "DSEP"
+  const uint16_t kVersion = 2;
+
+  // Frames above this are a protocol error (a full history reply for one
+  // symbol is well under 1 MB)
+  const uint32_t kMaxPayload = 16 * 1024 * 1024;
+
+  // Frame header: u32 length + u8 type
+  const size_t kHeaderSize = 5;
+
+  enum MsgType : uint8_t {
+    kHello = 1,          // u32 magic, u16 version, u16 flags
+    kWelcome = 2,        // u16 version, u64 seq
+    kSnapshot = 3,       // u64 seq, i32 date, i32 sec, QuoteCodec snapshot
+    kDelta = 4,          // u64 seq, i32 date, i32 sec, QuoteCodec delta
+    kResync = 5,         // (empty)
+    kHistoryRequest = 6, // u32 id, str symbol, str start, str end
+    kHistoryReply = 7,   // u32 id, u8 ok, QuoteCodec bars
+    kHeartbeat = 8       // u64 seq
+  };
+
+  // Hello flags
+  const uint16_t kWantQuotes = 1;
+
+  // ── Encoding ─────────────────────────────────────────────────────────────
+
+  /// Appends little-endian fields to a payload
+  class Writer {
+  public:
+    void U8(uint8_t v) { m_buf += (char)v; }
+    void U16(uint16_t v);
+    void U32(uint32_t v);
+    void U64(uint64_t v);
+    void I32(int32_t v) { U32((uint32_t)v); }
+    void Str(const char *s); // u8 length + bytes (truncated at 255)
+
+    const std::string &Data() const { return m_buf; }
+    std::string &Data() { return m_buf; }
+
+  private:
+    std::string m_buf;
+  };
+
+  /// Reads what Writer wrote; any read past the end clears Ok() and
+  /// returns zeros
+  class Reader {
+  public:
+    Reader(const char *data, size_t size)
+        : m_p(data), m_end(data + size), m_ok(true) {}
+
+    uint8_t U8();
+    uint16_t U16();
+    uint32_t U32();
+    uint64_t U64();
+    int32_t I32() { return (int32_t)U32(); }
+    void Str(char *out, size_t size);
+
+    bool Ok() const { return m_ok; }
+    size_t Remaining() const { return (size_t)(m_end - m_p); }
+
+    // The unread bytes (a QuoteCodec message at the end of a payload)
+    const char *Rest() const { return m_p; }
+
+  private:
+    const char *Take(size_t n);
+
+    const char *m_p;
+    const char *m_end;
+    bool m_ok;
+  };
+
+  /// Header + payload, ready to send
+  std::string MakeFrame(MsgType type, const std::string &payload);
+
+  /// Take one complete frame off the front of buf. False if more bytes are
+  /// needed; bad is set (and false returned) for an oversized frame.
+  bool PopFrame(std::string &buf, uint8_t &type, std::string &payload,
+                bool &bad);
+
+  // ── Messages shared by both ends ─────────────────────────────────────────
+
+  /// Snapshot or Delta around an encoded QuoteCodec message
+  std::string MakeQuotesFrame(MsgType type, uint64_t seq, int date, int sec,
+                              const std::string &encoded);
+
+} // namespace ProxyProtocol
+
+#endif // PROXY_PROTOCOL_H
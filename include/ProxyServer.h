@@ -0,0 +1,122 @@
+///////////////////////////////////////////////////////////////////////////
+// ProxyServer.h — Push Fan-Out of Quotes and History to Plugin Instances
+//
+// The serving half of dse_proxyd. The owner polls dsebd.org once and hands
+// every snapshot to PublishQuotes; the server's QuoteCodec encoder diffs
+// it against the last one and pushes a Delta (or, every few publishes, a
+// full Snapshot) to every subscriber — see ProxyProtocol.h for the wire
+// format. History requests are answered on a worker thread through the
+// owner's callback, so a slow archive fetch never stalls the quote fan-out.
+//
+// One thread multiplexes every connection with poll(): non-blocking
+// sockets, a per-client queue of shared frames (one encoding per publish,
+// however many subscribers), and a cap on queued bytes that disconnects
+// clients too slow to keep up. Hundreds of subscribers cost one thread.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef PROXY_SERVER_H
+#define PROXY_SERVER_H
+
+#include "DseTypes.h"
+#include "QuoteCodec.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ProxyServer {
+public:
+  // Fill out with [startDate, endDate] ("YYYY-MM-DD") for symbol
+  typedef std::function<bool(const std::string &symbol,
+                             const std::string &startDate,
+                             const std::string &endDate,
+                             std::vector<DseBar> &out)>
+      HistoryFn;
+  typedef std::function<void(const char *msg)> LogFn;
+
+  ProxyServer();
+  ~ProxyServer();
+
+  ProxyServer(const ProxyServer &) = delete;
+  ProxyServer &operator=(const ProxyServer &) = delete;
+
+  // Listen on bindAddr:port (port 0 = any free port; see Port()).
+  // snapshotEvery: publishes between full snapshots (min 1).
+  bool Start(const char *bindAddr, int port, int snapshotEvery,
+             HistoryFn history, const LogFn &log = LogFn());
+  void Stop();
+
+  int Port() const { return m_port; }
+  size_t ClientCount() const;
+
+  // Diff quotes against the previous publish and push the change to every
+  // subscriber. An unchanged board sends nothing. Any thread.
+  void PublishQuotes(const std::vector<DseQuote> &quotes, int date, int sec);
+
+private:
+  typedef std::shared_ptr<const std::string> Frame;
+
+  struct Client {
+    uint64_t id;
+    uintptr_t sock;
+    std::string peer;
+    std::string in;          // bytes not yet framed
+    std::deque<Frame> out;   // frames not yet fully sent
+    size_t outOffset = 0;    // bytes of out.front() already sent
+    size_t queued = 0;       // unsent bytes across out
+    bool greeted = false;    // Hello accepted
+    bool subscribed = false; // Hello with kWantQuotes seen
+    bool dead = false;       // dropped at the next loop pass
+  };
+
+  struct HistoryJob {
+    uint64_t clientId;
+    uint32_t reqId;
+    std::string symbol, startDate, endDate;
+  };
+
+  void Loop();
+  void HistoryLoop();
+  void AcceptAll();
+  void ReadFrom(Client &c);
+  void HandleFrame(Client &c, uint8_t type, const std::string &payload);
+
+  // Caller holds m_mutex
+  void Queue(Client &c, const Frame &frame);
+  void Flush(Client &c);
+  Frame SnapshotFrame();
+  void Log(const char *fmt, ...);
+
+  std::thread m_thread;
+  std::thread m_historyThread;
+  std::atomic<bool> m_stop;
+  uintptr_t m_listen;
+  int m_port;
+  int m_snapshotEvery;
+  HistoryFn m_history;
+  LogFn m_log;
+
+  // Clients, the board and the frames built from it. Only the loop thread
+  // adds or erases clients; publishers queue and flush under the lock.
+  mutable std::mutex m_mutex;
+  std::vector<std::unique_ptr<Client>> m_clients;
+  uint64_t m_nextClientId;
+  QuoteCodec::Encoder m_encoder; // the board as last published
+  uint64_t m_seq;                // last Snapshot/Delta sent
+  int m_date, m_sec;
+  int m_sinceSnapshot;
+  Frame m_snapshot; // Snapshot of m_seq, built on first need
+  uint64_t m_lastHeartbeatMs;
+
+  std::mutex m_jobMutex;
+  std::condition_variable m_jobCv;
+  std::deque<HistoryJob> m_jobs;
+};
+
+#endif // PROXY_SERVER_H
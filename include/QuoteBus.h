@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////////
+// QuoteBus.h — Quote Board and Bar Series Shared Between Plugin Instances
+//
+// Every AmiBroker instance on a workstation maps the same named section
+// (SharedMemory). One of them — the writer — polls dsebd.org and
+// publishes each snapshot to the quote board; the others read the board
+// instead of polling. The writer is elected by lease: whoever fetches
+// first claims it and keeps it by publishing; when its heartbeat is older
+// than the lease (instance closed, feed stopped, process hung) the next
+// instance that needs quotes takes over.
+//
+// Each quote slot and bar slot is a seqlock: the writer makes the
+// sequence odd, copies the record, makes it even again; a reader copies
+// and retries while the sequence was odd or moved. Readers never block
+// the writer and never see a torn quote. Slots are found by open
+// addressing on the symbol and are never freed.
+//
+// Historical bars fetched by any instance are appended to a bump arena
+// with the window they cover, so another instance backfilling the same
+// window copies them instead of downloading them again. When the arena
+// is full it starts over and every older series is invalidated.
+//
+// The layout is a private contract between builds of this plugin: the
+// header carries a version and the record sizes, and a mismatch makes
+// Open fail (the instance then simply fetches on its own).
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef QUOTE_BUS_H
+#define QUOTE_BUS_H
+
+#include "DseTypes.h"
+#include "SharedMemory.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+class QuoteBus {
+public:
+  QuoteBus();
+  ~QuoteBus();
+
+  QuoteBus(const QuoteBus &) = delete;
+  QuoteBus &operator=(const QuoteBus &) = delete;
+
+  // Map (or create) the section called name. barArenaBytes and the slot
+  // counts only apply when this instance creates it. leaseMs: how long a
+  // silent writer keeps its role.
+  bool Open(const char *name, size_t barArenaBytes, int leaseMs);
+
+  // Gives up the writer role, then unmaps
+  void Close();
+
+  bool IsOpen() const;
+
+  // ── Writer election ──────────────────────────────────────────────────────
+
+  // True if this process holds (or just claimed) the writer role; renews
+  // the lease when it does
+  bool TryAcquireWriter();
+
+  void ReleaseWriter();
+
+  // True if this process held the role at its last check
+  bool IsWriter() const;
+
+  // ── Quote board ──────────────────────────────────────────────────────────
+
+  // Writer only: replace the board with one full snapshot. False if the
+  // role was lost.
+  bool PublishQuotes(const std::vector<DseQuote> &quotes);
+
+  // The latest snapshot, in first-published order, if one was published
+  // within the lease. seq increments with every publish.
+  bool ReadQuotes(std::vector<DseQuote> &outQuotes, uint64_t &seq) const;
+
+  // ── Bar series ───────────────────────────────────────────────────────────
+
+  // Share bars covering [startKey, endKey] (YYYYMMDD). Any instance may
+  // publish; a later publish for the symbol replaces the earlier one.
+  bool PublishBars(const char *symbol, int startKey, int endKey,
+                   const std::vector<DseBar> &bars);
+
+  // Bars for symbol if a published series covers [startKey, endKey]
+  bool ReadBars(const char *symbol, int startKey, int endKey,
+                std::vector<DseBar> &outBars) const;
+
+private:
+  struct Header;
+  struct QuoteSlot;
+  struct BarSlot;
+
+  Header *Hdr() const;
+  QuoteSlot *QuoteSlots() const;
+  uint32_t *QuoteOrder() const;
+  BarSlot *BarSlots() const;
+  char *Arena() const;
+
+  bool LockBars();
+  void UnlockBars();
+
+  // Guards the mapping against Open/Close; shared for everything else
+  mutable std::shared_mutex m_mapMutex;
+  // One publisher per process at a time (the seqlocks assume one writer)
+  std::mutex m_publishMutex;
+
+  SharedMemory m_shm;
+  uint32_t m_pid;
+  int m_leaseMs;
+  std::atomic<bool> m_writer;
+};
+
+#endif // QUOTE_BUS_H
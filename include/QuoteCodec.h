@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////
+// QuoteCodec.h — Compact Binary Delta Encoding of Quotes and Bars
+//
+// The versioned wire format for moving boards and history between
+// processes (dse_proxyd to plugins). Symbols get small numeric IDs; each
+// update carries, per changed symbol, a field bitmap and the zigzag
+// varint tick delta of every field it names. A snapshot is the same
+// message encoded against an empty board, so one decode path serves both.
+//
+// Quote message (little-endian, varints from ByteCodec.h):
+//   u8 version, u8 kind (1 = snapshot, 2 = delta)
+//   varint n, n x { varint id, u8 len, name }     IDs (re)defined here
+//   varint n, n x { varint id }                   IDs that left the board
+//   varint n, n x { varint id, varint fields,
+//                   zigzag varint per field of each set bit (ticks) }
+// A snapshot lists every symbol and no removals; a delta lists only new
+// names. Removals are applied before names, and a removed ID may later be
+// given to another symbol.
+//
+// Field bits take the values of the RecentInfo RI_* bits (Plugin.h), so a
+// decoded change set reads like an RI bitmap; fields RecentInfo has no bit
+// for sit above bit 15. changePercent is not sent; it is recomputed from
+// ltp and ycp the way ParseLatestPriceHtml computes it.
+//
+// Bars message:
+//   u8 version, u8 price decimals, u8 volume decimals, u8 value decimals
+//   varint n, n x { zigzag varint date delta (YYYYMMDD), u8 flags,
+//                   zigzag varint tick delta per field from the bar before }
+// The decimals are the fewest (0..6) that carry every value of the window
+// exactly, so seeded or adjusted history survives the trip unchanged.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef QUOTE_CODEC_H
+#define QUOTE_CODEC_H
+
+#include "DseTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace QuoteCodec {
+
+  const uint8_t kVersion = 1;
+
+  enum Kind : uint8_t { kSnapshot = 1, kDelta = 2 };
+
+  // Changed-field bits (RI_* values where RecentInfo has one)
+  const uint32_t kLast = 1u << 0;       // RI_LAST: ltp
+  const uint32_t kOpen = 1u << 1;       // RI_OPEN: open
+  const uint32_t kHighLow = 1u << 2;    // RI_HIGHLOW: high, low
+  const uint32_t kTradeVol = 1u << 3;   // RI_TRADEVOL: trade
+  const uint32_t kTotalVol = 1u << 4;   // RI_TOTALVOL: volume
+  const uint32_t kPrevChange = 1u << 6; // RI_PREVCHANGE: ycp, change
+  const uint32_t kClose = 1u << 16;     // close
+  const uint32_t kValue = 1u << 17;     // value
+  const uint32_t kValid = 1u << 18;     // valid flag
+
+  // Bits that map onto RecentInfo::nBitmap
+  const uint32_t kRecentInfoFields =
+      kLast | kOpen | kHighLow | kTradeVol | kTotalVol | kPrevChange;
+
+  // Symbol IDs at or above this are a protocol error
+  const uint32_t kMaxSymbols = 65536;
+
+  // Fields in wire order: ltp, open, high, low, trade, volume, ycp, change,
+  // close, value, valid
+  const int kFieldCount = 11;
+
+  /// Keeps the board last encoded and turns each new one into a delta.
+  /// Not thread-safe.
+  class Encoder {
+  public:
+    Encoder();
+
+    // Diff quotes (one row per symbol; a repeated symbol keeps its first
+    // row) against the previous call and append a delta to out. Symbols
+    // missing from quotes are removed. Returns false if nothing changed
+    // (out still gets an empty, valid delta).
+    bool Update(const DseQuote *quotes, size_t n, std::string &out);
+
+    // Append a snapshot of the current board (for a new subscriber, or
+    // periodically so a lost delta cannot stick)
+    void Snapshot(std::string &out) const;
+
+    // Forget every ID; the next message must be a snapshot
+    void Reset();
+
+    size_t Symbols() const { return m_ids.size(); }
+
+  private:
+    std::unordered_map<std::string, uint32_t> m_ids;
+    std::vector<std::string> m_names; // by ID; empty = free
+    std::vector<int64_t> m_ticks;     // by ID, kFieldCount each
+    std::vector<uint32_t> m_stamp;    // by ID: last Update that saw it
+    std::vector<uint32_t> m_free;     // IDs to reuse
+    std::vector<uint32_t> m_order;    // ID at each row of the last Update
+    uint32_t m_generation;
+    std::string m_nameBuf, m_bodyBuf; // sections of the message in progress
+  };
+
+  /// Applies messages to a board of DseQuote indexed by symbol ID,
+  /// decoding each field straight into its slot. Not thread-safe.
+  class Decoder {
+  public:
+    struct Change {
+      uint32_t id;
+      uint32_t fields; // bits above; all of them for a new symbol
+    };
+
+    Decoder();
+
+    // Apply one message. False for a malformed message, an unknown
+    // version, or a delta that does not follow the board (unknown ID, or
+    // no snapshot since the last failure); the board is then dropped and
+    // only a snapshot is accepted.
+    bool Apply(const char *data, size_t size);
+
+    bool HasBoard() const { return m_haveBoard; }
+
+    // By ID; a free ID has an empty symbol
+    const std::vector<DseQuote> &Board() const { return m_board; }
+
+    // What the last successful Apply did. A snapshot reports every symbol
+    // in Changes; SymbolsChanged is set by a snapshot, a new name or a
+    // removal (the set of symbols moved, not just their fields).
+    bool WasSnapshot() const { return m_wasSnapshot; }
+    bool SymbolsChanged() const { return m_symbolsChanged; }
+    const std::vector<Change> &Changes() const { return m_changes; }
+    const std::vector<uint32_t> &Removed() const { return m_removed; }
+
+    void Reset();
+
+  private:
+    bool Decode(const uint8_t *p, const uint8_t *end);
+    void Clear(uint32_t id);
+
+    std::vector<DseQuote> m_board;
+    std::vector<int64_t> m_ticks;  // by ID, kFieldCount each
+    std::vector<uint32_t> m_stamp; // by ID: last Apply that defined it
+    std::vector<Change> m_changes;
+    std::vector<uint32_t> m_removed;
+    uint32_t m_generation;
+    bool m_haveBoard;
+    bool m_wasSnapshot;
+    bool m_symbolsChanged;
+  };
+
+  /// Append a bars message for bars (any order; date order is smallest)
+  void EncodeBars(const DseBar *bars, size_t n, std::string &out);
+
+  /// Decode a bars message into out. False if malformed.
+  bool DecodeBars(const char *data, size_t size, std::vector<DseBar> &out);
+
+} // namespace QuoteCodec
+
+#endif // QUOTE_CODEC_H
@@ -15,6 +15,7 @@
 
 #include <atomic>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -22,6 +23,11 @@
 
 
 #include "DseDataEngine.h"
+#include "FeedSource.h"
+#include "IntradayAggregator.h"
+#include "PollScheduler.h"
+#include "SnapshotDiff.h"
+#include "SnapshotJournal.h"
 
 ///////////////////////////////////////////////////////////////////////////
 // RealtimeFeed — Manages the background polling thread
@@ -39,6 +45,12 @@ public:
   // Stop the polling thread
   void Stop();
 
+  // Use this snapshot source instead of the one chosen from config on the
+  // next Start (e.g. a ReplayFeedSource for a benchmark harness).
+  void SetFeedSource(std::unique_ptr<IFeedSource> source) {
+    m_source = std::move(source);
+  }
+
   // Check if the feed is running
   bool IsRunning() const { return m_running.load(); }
 
@@ -51,9 +63,15 @@ public:
   // Get connection state
   ConnectionState GetConnectionState() const;
 
-  // Set poll interval (milliseconds)
+  // Set base poll interval (milliseconds); the poll thread picks it up
   void SetPollInterval(int ms) { m_pollIntervalMs = ms; }
 
+  // Intraday bars built from the polled snapshots, compressed to intervalSec
+  bool GetIntradayBars(const char *symbol, int intervalSec,
+                       std::vector<DseIntradayBar> &outBars) const {
+    return m_intraday.GetBars(symbol, intervalSec, outBars);
+  }
+
   // Subscribe to a specific symbol (prioritize it in updates)
   void Subscribe(const char *symbol);
 
@@ -73,22 +91,79 @@ private:
   // Reconnect with exponential backoff
   bool TryReconnect();
 
+  // New feed date: start the session over (opens, scheduler, diff).
+  void RollSession(int date);
+
+  // Track per-session opens and whether anything traded since the open,
+  // from the rows that changed since the previous poll.
+  void TrackSession(const std::vector<DseQuote> &changed);
+
+  // Live market just closed: take the final snapshot and append it to the
+  // cache as today's provisional EOD bars.
+  void CaptureSessionClose();
+
+  // While closed, periodically swap provisional bars for archive data.
+  void MaybeReconcile();
+
+  // Open today's journal, replaying any snapshots already recorded in it.
+  void OpenJournal(const DseConfig &cfg);
+
+  // Engine config listener (reloading thread): picks up new poll and
+  // reconnect settings; scheduler changes are handed to the poll thread.
+  void OnConfigChanged(const DseConfig &oldCfg, const DseConfig &cfg);
+
+  // Poll thread: reconfigure the scheduler from the current snapshot.
+  void ApplySchedulerConfig(const DseConfig &cfg);
+
+  // Replay only: move the engine clock to the source's virtual time.
+  void SyncVirtualClock();
+
   // ─── Members ───────────────────────────────────────────
 
   HWND m_hMainWnd;                   // AmiBroker window
   DseDataEngine *m_engine;           // Shared data engine
+  std::unique_ptr<IFeedSource> m_source; // Live page or replay, plus clock
+  // During a replay the engine's MarketClock reads this (UTC ms), so
+  // GetQuotesEx and IsMarketOpen follow the recording; null when live
+  std::shared_ptr<std::atomic<int64_t>> m_virtualUtcMs;
   HANDLE m_hThread;                  // Worker thread handle
   std::atomic<bool> m_running;       // Thread running flag
-  std::atomic<bool> m_stopRequested; // Stop signal
+  StopSignal m_stop;                 // Set by Stop(); ends any wait at once
 
-  int m_pollIntervalMs; // Poll interval
+  std::atomic<int> m_pollIntervalMs; // Base poll interval (UI may change)
   int m_reconnectAttempts;
-  int m_maxReconnectAttempts;
+  std::atomic<int> m_maxReconnectAttempts;
+
+  int m_configListener;                 // engine listener id, 0 = none
+  std::atomic<bool> m_schedulerChanged; // set by OnConfigChanged
 
   // Latest quotes cache (symbol -> quote)
   std::map<std::string, DseQuote> m_latestQuotes;
   mutable std::mutex m_quotesMutex;
 
+  // Adaptive poll interval and exact open/close wake-ups
+  PollScheduler m_scheduler;
+
+  // Previous page by symbol ID and the change set of the latest poll
+  // (poll thread only; the set's buffers are reused from poll to poll)
+  SnapshotDiff m_diff;
+  SnapshotDiff::ChangeSet m_changes;
+  std::vector<size_t> m_deferred; // rows pushed after the subscribed ones
+
+  // Per-interval bars from snapshot volume deltas
+  IntradayAggregator m_intraday;
+
+  // On-disk record of every poll, replayed on start
+  SnapshotJournal m_journal;
+  uint64_t m_journalDropped; // journal drop count at the previous poll
+
+  // Session close capture (touched only by the poll thread)
+  bool m_wasMarketOpen;    // market state seen on the previous iteration
+  bool m_sessionTraded;    // volume moved since the open (false on holidays)
+  int m_sessionDate;       // YYYYMMDD of the session being tracked
+  std::map<std::string, double> m_sessionOpens; // first traded price
+  DWORD m_lastReconcileTick;
+
   // Subscribed symbols (for priority polling)
   std::vector<std::string> m_subscriptions;
   std::mutex m_subsMutex;
@@ -0,0 +1,45 @@
+///////////////////////////////////////////////////////////////////////////
+// SharedMemory.h — Named Read/Write Memory Shared Between Processes
+//
+// A page-file backed section every process on the workstation can map by
+// name (CreateFileMapping in the session's Local\ namespace on Windows,
+// shm_open elsewhere). The first process to open a name creates it
+// zero-filled at the requested size; later ones map whatever size the
+// creator chose. The section lives until the last Windows process closes
+// it; a POSIX segment persists until Remove().
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef SHARED_MEMORY_H
+#define SHARED_MEMORY_H
+
+#include <cstddef>
+
+class SharedMemory {
+public:
+  SharedMemory();
+  ~SharedMemory();
+
+  SharedMemory(const SharedMemory &) = delete;
+  SharedMemory &operator=(const SharedMemory &) = delete;
+
+  // Map name (letters, digits, '_'), creating it with size bytes if no
+  // process has yet. created reports which happened.
+  bool Open(const char *name, size_t size, bool &created);
+  void Close();
+
+  void *Data() const { return m_data; }
+  size_t Size() const { return m_size; }
+
+  // Delete the name so the next Open creates a fresh section (POSIX only;
+  // a Windows section goes away with its last handle)
+  static void Remove(const char *name);
+
+private:
+  void *m_data;
+  size_t m_size;
+#ifdef _WIN32
+  void *m_mapping; // HANDLE
+#endif
+};
+
+#endif // SHARED_MEMORY_H
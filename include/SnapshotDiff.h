@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////
+// SnapshotDiff.h — What Changed Between Two Polls of the Latest-Price Page
+//
+// Every poll parses the whole page (~400 rows) although only a handful of
+// symbols move between polls. SnapshotDiff keeps the previous board by
+// symbol ID and turns each new parse into a change set: the rows whose
+// fields differ (with the RI-style field bits of QuoteCodec.h), what kind
+// of move it was (new trade, price move, correction, newly listed) and the
+// volume/trade/value increments, plus the symbols that dropped off the
+// page. The poll thread hands only that set to session tracking, intraday
+// bars, the journal and AmiBroker, so downstream work follows the market's
+// activity rather than its size.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef SNAPSHOT_DIFF_H
+#define SNAPSHOT_DIFF_H
+
+#include "DseTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////
+// SnapshotDiff — previous board by symbol ID, diffed against each poll
+///////////////////////////////////////////////////////////////////////////
+class SnapshotDiff {
+public:
+  /// Kind of move, independent of which fields it touched
+  enum Flag : uint32_t {
+    kAppeared = 1u << 0,   // not on the previous page (or first poll)
+    kTraded = 1u << 1,     // cumulative volume grew
+    kPriceMoved = 1u << 2, // ltp changed
+    kCorrected = 1u << 3,  // cumulative volume fell (page correction)
+  };
+
+  struct Change {
+    uint32_t id;
+    uint32_t fields; // QuoteCodec k* bits; all of them for kAppeared
+    uint32_t flags;
+    double volumeDelta; // increments since the previous poll (0 when the
+    double tradeDelta;  // symbol just appeared)
+    double valueDelta;
+  };
+
+  struct ChangeSet {
+    std::vector<Change> changes;   // in page order
+    std::vector<DseQuote> quotes;  // new row of each change, same order
+    std::vector<std::string> halted; // on the previous page, not on this one
+    size_t symbols;                // rows on this page
+
+    ChangeSet() : symbols(0) {}
+
+    bool Empty() const { return changes.empty() && halted.empty(); }
+
+    // Whether the page itself updated: a trade, a price, or the symbol
+    // list moved. Corrections to other columns alone do not count.
+    bool PageMoved() const;
+  };
+
+  SnapshotDiff();
+
+  // Diff one parsed page against the previous Apply and replace out with
+  // the result. A repeated symbol keeps its first row. IDs are stable for
+  // the life of the object; a symbol that leaves and comes back keeps its
+  // ID and is reported as appeared again.
+  void Apply(const std::vector<DseQuote> &quotes, ChangeSet &out);
+
+  // Forget the board; the next Apply reports every row as appeared
+  void Reset();
+
+  // Symbols on the last page
+  size_t Symbols() const { return m_present; }
+
+  const char *Name(uint32_t id) const { return m_board[id].symbol; }
+
+private:
+  std::unordered_map<std::string, uint32_t> m_ids;
+  std::vector<DseQuote> m_board;  // by ID: last row seen
+  std::vector<uint32_t> m_stamp;  // by ID: last Apply that saw it
+  std::vector<uint8_t> m_onPage;  // by ID: on the last page
+  std::vector<uint32_t> m_order;  // ID at each row of the last Apply
+  uint32_t m_generation;
+  size_t m_present;
+};
+
+#endif // SNAPSHOT_DIFF_H
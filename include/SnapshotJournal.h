@@ -0,0 +1,122 @@
+///////////////////////////////////////////////////////////////////////////
+// SnapshotJournal.h — Append-Only Binary Journal of Live Snapshots
+//
+// One file per session (<dir>/YYYYMMDD.dsj) holding delta-encoded
+// per-symbol snapshots, plus an index of time offsets (<dir>/YYYYMMDD.dsx).
+// The poll thread hands snapshots over without blocking; a writer thread
+// encodes and appends them. Reading a journal back rebuilds the session
+// (feed restart) or drives an offline replay.
+//
+// File layout (little-endian):
+//   header  "DSJ1" u32 version u32 date
+//   record  u8 type, varint payloadLen, payload
+//     SYMBOL   varint id, u8 len, name bytes
+//     DELTA    varint secOfDay, varint n, n x { varint id, varint bitmap,
+//              zigzag varint per set bit: value - previous value (ticks) }
+//     KEYFRAME varint secOfDay, varint n, n x { varint id, u8 len, name,
+//              zigzag varint per field: absolute value (ticks) }
+// Index entry: u32 secOfDay, u32 record offset, u32 flags (1 = keyframe)
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef SNAPSHOT_JOURNAL_H
+#define SNAPSHOT_JOURNAL_H
+
+#include "DseTypes.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class SnapshotJournal {
+public:
+  // Called per decoded record with the quotes that changed in it (each one
+  // fully reconstructed, not just the changed fields).
+  typedef std::function<void(int secOfDay, const std::vector<DseQuote> &)>
+      SnapshotFn;
+
+  struct IndexEntry {
+    uint32_t secOfDay;
+    uint32_t offset;
+    uint32_t flags; // 1 = keyframe
+  };
+
+  SnapshotJournal();
+  ~SnapshotJournal();
+
+  // Open the journal for date in dir, creating the directory if needed. An
+  // existing file is decoded first (onReplay sees every record) so a
+  // restarted feed resumes the same session; a torn tail is cut off.
+  bool Open(const char *dir, int date, const SnapshotFn &onReplay,
+            int keyframeEvery = 60);
+
+  // Flush queued snapshots and stop the writer thread.
+  void Close();
+
+  bool IsOpen() const { return m_open; }
+
+  // Queue one snapshot for the writer thread. Never blocks on disk; if the
+  // writer falls far behind, the oldest queued snapshot is dropped.
+  void Append(int date, int secOfDay, const std::vector<DseQuote> &quotes);
+
+  // Number of snapshots dropped because the writer queue was full.
+  uint64_t GetDroppedCount() const { return m_dropped; }
+
+  // Decode a journal file read-only. fromSecOfDay > 0 seeks through the
+  // index to the last keyframe at or before that time.
+  static bool Replay(const char *path, const SnapshotFn &onSnapshot,
+                     int fromSecOfDay = 0);
+
+  // Read a journal's index file (<path minus .dsj>.dsx).
+  static bool ReadIndex(const char *path, std::vector<IndexEntry> &outIndex);
+
+  // <dir>/YYYYMMDD.dsj
+  static std::string SessionPath(const char *dir, int date);
+
+private:
+  struct Pending {
+    int date;
+    int secOfDay;
+    std::vector<DseQuote> quotes;
+  };
+
+  // Per-symbol encoder state, in ticks
+  struct SymbolState {
+    int64_t fields[9];
+  };
+
+  void WriterLoop();
+  bool OpenFile(int date, const SnapshotFn &onReplay);
+  void CloseFile();
+  void WriteSnapshot(const Pending &snap);
+
+  std::string m_dir;
+  int m_keyframeEvery;
+  std::atomic<bool> m_open;
+
+  // Writer-thread state
+  FILE *m_file;
+  FILE *m_indexFile;
+  int m_fileDate;
+  uint32_t m_fileSize;
+  int m_sinceKeyframe;
+  std::map<std::string, uint32_t> m_ids;
+  std::vector<std::string> m_names;
+  std::vector<SymbolState> m_state;
+
+  // Hand-off queue
+  std::deque<Pending> m_queue;
+  std::mutex m_queueMutex;
+  std::condition_variable m_queueCv;
+  bool m_stop;
+  std::atomic<uint64_t> m_dropped;
+  std::thread m_thread;
+};
+
+#endif // SNAPSHOT_JOURNAL_H
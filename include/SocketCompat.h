@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////
+// SocketCompat.h — Winsock and BSD Sockets Behind One Set of Names
+//
+// The network modules (MetricsServer, ProxyServer, ProxyClient) share
+// these: a socket handle type, close / non-blocking / timeout helpers, a
+// poll() wrapper (WSAPoll on Windows) and the "would block" test. Include
+// it before anything that pulls in <windows.h>: winsock2.h must come first.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef SOCKET_COMPAT_H
+#define SOCKET_COMPAT_H
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace Net {
+
+#ifdef _WIN32
+  typedef SOCKET Socket;
+  typedef int SockLen;
+  typedef WSAPOLLFD PollFd;
+  const Socket kInvalid = INVALID_SOCKET;
+  const int kSendFlags = 0;
+
+  inline void Close(Socket s) { closesocket(s); }
+  inline int Poll(PollFd *fds, size_t n, int timeoutMs) {
+    return WSAPoll(fds, (ULONG)n, timeoutMs);
+  }
+  inline bool WouldBlock() {
+    int e = WSAGetLastError();
+    return e == WSAEWOULDBLOCK || e == WSAEINPROGRESS;
+  }
+  inline bool SetNonBlocking(Socket s) {
+    u_long on = 1;
+    return ioctlsocket(s, FIONBIO, &on) == 0;
+  }
+  inline bool SetBlocking(Socket s) {
+    u_long off = 0;
+    return ioctlsocket(s, FIONBIO, &off) == 0;
+  }
+  inline void SetTimeouts(Socket s, int ms) {
+    DWORD timeout = (DWORD)ms;
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout,
+               sizeof(timeout));
+    setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, (const char *)&timeout,
+               sizeof(timeout));
+  }
+  // Winsock is reference counted: pair every Startup with a Cleanup
+  inline bool Startup() {
+    WSADATA wsa;
+    return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+  }
+  inline void Cleanup() { WSACleanup(); }
+#else
+  typedef int Socket;
+  typedef socklen_t SockLen;
+  typedef pollfd PollFd;
+  const Socket kInvalid = -1;
+  const int kSendFlags = MSG_NOSIGNAL;
+
+  inline void Close(Socket s) { close(s); }
+  inline int Poll(PollFd *fds, size_t n, int timeoutMs) {
+    return poll(fds, (nfds_t)n, timeoutMs);
+  }
+  inline bool WouldBlock() {
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS;
+  }
+  inline bool SetNonBlocking(Socket s) {
+    int flags = fcntl(s, F_GETFL, 0);
+    return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+  }
+  inline bool SetBlocking(Socket s) {
+    int flags = fcntl(s, F_GETFL, 0);
+    return flags >= 0 && fcntl(s, F_SETFL, flags & ~O_NONBLOCK) == 0;
+  }
+  inline void SetTimeouts(Socket s, int ms) {
+    timeval timeout = {ms / 1000, (ms % 1000) * 1000};
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+  }
+  inline bool Startup() { return true; }
+  inline void Cleanup() {}
+#endif
+
+  /// Push small frames out immediately instead of coalescing them
+  inline void SetNoDelay(Socket s) {
+    int one = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char *)&one, sizeof(one));
+  }
+
+} // namespace Net
+
+#endif // SOCKET_COMPAT_H
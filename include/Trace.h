@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////
+// Trace.h — Chrome trace_event Timeline of Plugin Threads
+//
+// Off by default. When started, every thread records spans, contended
+// lock waits and message posts into its own fixed-size ring (oldest
+// events are overwritten), and WriteJson() dumps all rings as a Chrome
+// trace_event file that chrome://tracing or ui.perfetto.dev can open.
+//
+//   Trace::SetThreadName("poll");
+//   {
+//     Trace::Span span("FetchLatest", "http");
+//     ...
+//   }
+//   Trace::Lock<std::mutex> lock(m_quotesMutex, "m_quotesMutex");
+//
+// Event and category names are stored by pointer: pass string literals.
+// Disabled, a span or instant costs one relaxed atomic load; Lock costs
+// nothing beyond the try_lock it starts with.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "Metrics.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace Trace {
+
+  extern std::atomic<bool> g_enabled;
+
+  inline bool Enabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+  /// Begin recording with a ring of eventsPerThread events per thread.
+  /// Clears what earlier sessions recorded.
+  void Start(size_t eventsPerThread);
+
+  /// Stop recording; the rings are kept for WriteJson
+  void Stop();
+
+  /// Label the calling thread in the timeline (kept even while stopped)
+  void SetThreadName(const char *name);
+
+  /// A complete event: [beginUs, beginUs + durUs) on the calling thread
+  void Complete(const char *name, const char *cat, uint64_t beginUs,
+                uint64_t durUs);
+
+  /// A zero-length marker on the calling thread
+  void Instant(const char *name, const char *cat);
+
+  /// Render every ring as Chrome trace_event JSON (object format)
+  std::string DumpJson();
+
+  /// DumpJson() written to path.tmp, then renamed over path
+  bool WriteJson(const std::string &path);
+
+  // ── Scoped helpers ───────────────────────────────────────────────────────
+
+  /// Records its own lifetime as one complete event
+  class Span {
+  public:
+    explicit Span(const char *name, const char *cat = "plugin")
+        : m_name(name), m_cat(cat), m_start(Enabled() ? Metrics::NowUs() : 0) {
+    }
+    ~Span() {
+      if (m_start)
+        Complete(m_name, m_cat, m_start, Metrics::NowUs() - m_start);
+    }
+
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+  private:
+    const char *m_name;
+    const char *m_cat;
+    uint64_t m_start;
+  };
+
+  /// lock_guard that records the wait when the mutex was contended
+  /// (category "lock", named after the mutex)
+  template <class Mutex> class Lock {
+  public:
+    Lock(Mutex &mutex, const char *name) : m_mutex(mutex) {
+      if (m_mutex.try_lock())
+        return;
+      if (!Enabled()) {
+        m_mutex.lock();
+        return;
+      }
+      uint64_t start = Metrics::NowUs();
+      m_mutex.lock();
+      Complete(name, "lock", start, Metrics::NowUs() - start);
+    }
+    ~Lock() { m_mutex.unlock(); }
+
+    Lock(const Lock &) = delete;
+    Lock &operator=(const Lock &) = delete;
+
+  private:
+    Mutex &m_mutex;
+  };
+
+} // namespace Trace
+
+#endif // TRACE_H
@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////
+// TradingCalendar.h — DSE Trading Days and Session Hours
+//
+// A weekly pattern (Sun–Thu by default) plus a holiday file. The file lists
+// one date per line; a date alone is a holiday, a date with hours is a
+// special session (shortened Ramadan hours, or a make-up trading day on a
+// weekend):
+//
+//   2026-03-26                 ; Independence Day
+//   2026-02-22 10:00-13:00     ; Ramadan hours
+//
+// Dates are YYYYMMDD integers throughout, times are seconds since midnight.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef TRADING_CALENDAR_H
+#define TRADING_CALENDAR_H
+
+#include <string>
+#include <vector>
+
+class TradingCalendar {
+public:
+  TradingCalendar();
+
+  // Weekly pattern: bit 0 = Sunday ... bit 6 = Saturday.
+  void SetWeekMask(unsigned mask) { m_weekMask = mask & 0x7F; }
+  unsigned GetWeekMask() const { return m_weekMask; }
+
+  // Parse "Sun,Mon,Tue,Wed,Thu" into a week mask (0 if nothing matched).
+  static unsigned ParseWeekdays(const char *list);
+
+  // Regular session hours for every trading day without its own entry.
+  void SetDefaultSession(int openSec, int closeSec);
+
+  // Load holidays and special sessions, replacing any loaded before.
+  // Returns false if the file cannot be opened (the weekly pattern still
+  // applies). Malformed lines are skipped and counted in outBadLines.
+  bool Load(const char *path, int *outBadLines = nullptr);
+
+  size_t GetHolidayCount() const { return m_holidays.size(); }
+
+  // ── Lookups ──────────────────────────────────────────────────────────────
+
+  bool IsTradingDay(int ymd) const;
+
+  // Session hours for ymd; false if ymd is not a trading day.
+  bool GetSession(int ymd, int &openSec, int &closeSec) const;
+
+  // First trading day strictly after / before ymd (0 if none within 5 years).
+  int NextTradingDay(int ymd) const;
+  int PrevTradingDay(int ymd) const;
+
+  // Next session open at or after (ymd, secOfDay). A session already in
+  // progress counts as "now".
+  bool NextSession(int ymd, int secOfDay, int &outYmd, int &outOpenSec) const;
+
+  // Trading days in [fromYmd, toYmd], inclusive; 0 if from > to.
+  int TradingDaysBetween(int fromYmd, int toYmd) const;
+
+  // ── Date arithmetic ──────────────────────────────────────────────────────
+
+  // Days since 1970-01-01 for a YYYYMMDD date, and back.
+  static int ToDayNumber(int ymd);
+  static int FromDayNumber(int dayNumber);
+
+  // 0 = Sunday ... 6 = Saturday
+  static int DayOfWeek(int ymd);
+
+private:
+  struct Special {
+    int day;      // day number
+    int openSec;  // -1 = holiday
+    int closeSec;
+  };
+
+  const Special *FindSpecial(int dayNumber) const;
+  bool IsTradingDayNumber(int dayNumber) const;
+  int CountPatternDays(int fromDay, int toDay) const;
+
+  unsigned m_weekMask;
+  int m_openSec, m_closeSec;
+
+  // Sorted by day; holidays and special sessions together
+  std::vector<Special> m_specials;
+  std::vector<int> m_holidays; // day numbers, sorted (for counting)
+};
+
+#endif // TRADING_CALENDAR_H
@@ -0,0 +1,41 @@
+///////////////////////////////////////////////////////////////////////////
+// WinInetHttpClient.h — HttpClient over WinInet (plugin build only)
+//
+// GETs try HTTPS first and retry without INTERNET_FLAG_SECURE; POSTs go
+// to the HTTPS port as application/x-www-form-urlencoded. Each request
+// records the Metrics HTTP stages (connect, TTFB, body).
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef WININET_HTTP_CLIENT_H
+#define WININET_HTTP_CLIENT_H
+
+#include "HttpClient.h"
+#include <windows.h>
+#include <wininet.h>
+
+class WinInetHttpClient : public HttpClient {
+public:
+  WinInetHttpClient();
+  ~WinInetHttpClient();
+
+  bool Open(const char *userAgent, int timeoutSec, const LogFn &log) override;
+  void Configure(const char *userAgent, int timeoutSec) override;
+  void Close() override;
+  bool IsOpen() const override { return m_hInternet != NULL; }
+
+  bool Get(const char *url, std::string &outBody) override;
+  bool Post(const char *url, const char *formPayload,
+            std::string &outBody) override;
+
+private:
+  void Emit(const char *fmt, ...) const;
+  // Returns when the first body byte arrived (Metrics::NowUs), 0 if none
+  static uint64_t ReadAll(HINTERNET h, std::string &outBody);
+  static void RecordTimings(uint64_t start, uint64_t responded,
+                            uint64_t firstByte);
+
+  HINTERNET m_hInternet;
+  LogFn m_log;
+};
+
+#endif // WININET_HTTP_CLIENT_H
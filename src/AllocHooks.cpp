@@ -0,0 +1,42 @@
+// AllocHooks.cpp — Count the Plugin's Heap Allocations (plugin build only)
+//
+// Replaces the global operator new/delete of the DLL so every allocation
+// bumps Metrics::kAllocations. A DLL's replacement covers only its own
+// code, so the counter reflects the plugin, not AmiBroker. Kept out of
+// dse_core so tools linking the library (dse_bench) can install their own.
+
+#include "Metrics.h"
+#include <cstdlib>
+#include <new>
+
+static void *CountedAlloc(size_t size) {
+  Metrics::Add(Metrics::kAllocations);
+  return malloc(size ? size : 1);
+}
+
+void *operator new(size_t size) {
+  if (void *p = CountedAlloc(size))
+    return p;
+  throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+  if (void *p = CountedAlloc(size))
+    return p;
+  throw std::bad_alloc();
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  return CountedAlloc(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  return CountedAlloc(size);
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { free(p); }
@@ -0,0 +1,412 @@
+// ArrowExport.cpp — Whole-Market Export as One Arrow IPC (Feather v2) File
+
+#include "ArrowExport.h"
+#include "PlatformCompat.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Minimal FlatBuffers writer
+//
+// Arrow's IPC metadata is FlatBuffers. Objects are laid out front to back:
+// a table is written first and its children after it, so every uoffset
+// points forward as the format requires. Child slots are patched once the
+// child's position is known.
+// ---------------------------------------------------------------------------
+
+class FbWriter;
+typedef std::function<size_t(FbWriter &)> FbObj; // writes, returns position
+
+struct FbField {
+  int id;
+  int size;      // scalar width in bytes; 0 = offset to child
+  uint64_t bits; // scalar value
+  FbObj child;
+};
+
+FbField Scalar(int id, int size, uint64_t bits) {
+  return FbField{id, size, bits, nullptr};
+}
+FbField Child(int id, FbObj child) { return FbField{id, 0, 0, child}; }
+
+class FbWriter {
+public:
+  std::string buf;
+
+  void Align(size_t a) {
+    while (buf.size() % a)
+      buf.push_back(0);
+  }
+
+  void Put(uint64_t v, int size) {
+    for (int i = 0; i < size; ++i)
+      buf.push_back((char)(uint8_t)(v >> (8 * i)));
+  }
+
+  void Patch(size_t at, uint64_t v, int size) {
+    for (int i = 0; i < size; ++i)
+      buf[at + i] = (char)(uint8_t)(v >> (8 * i));
+  }
+
+  // Write the child and point the 4-byte slot at 'slot' to it
+  void Link(size_t slot, const FbObj &child) {
+    size_t pos = child(*this);
+    Patch(slot, (uint64_t)(pos - slot), 4);
+  }
+
+  // Root: a uoffset to the table, then the table itself
+  std::string Finish(const FbObj &root) {
+    buf.clear();
+    Put(0, 4);
+    Link(0, root);
+    Align(8);
+    return buf;
+  }
+};
+
+FbObj Table(std::vector<FbField> fields) {
+  return [fields](FbWriter &w) -> size_t {
+    int maxId = -1;
+    for (const auto &f : fields)
+      maxId = f.id > maxId ? f.id : maxId;
+
+    // Field offsets within the table: soffset first, then widest first
+    std::vector<uint16_t> slots(maxId + 1, 0);
+    std::vector<size_t> order;
+    for (int width = 8; width >= 1; width /= 2)
+      for (size_t i = 0; i < fields.size(); ++i)
+        if ((fields[i].size ? fields[i].size : 4) == width)
+          order.push_back(i);
+    size_t size = 4;
+    for (size_t i : order) {
+      size_t width = fields[i].size ? fields[i].size : 4;
+      size = (size + width - 1) / width * width;
+      slots[fields[i].id] = (uint16_t)size;
+      size += width;
+    }
+
+    // vtable, then the table 8-aligned after it
+    w.Align(2);
+    size_t vt = w.buf.size();
+    w.Put(4 + 2 * slots.size(), 2);
+    w.Put(size, 2);
+    for (uint16_t s : slots)
+      w.Put(s, 2);
+    w.Align(8);
+    size_t table = w.buf.size();
+    w.Put((uint64_t)(uint32_t)(int32_t)(table - vt), 4);
+    w.buf.resize(table + size, 0);
+
+    for (const auto &f : fields)
+      if (f.size)
+        w.Patch(table + slots[f.id], f.bits, f.size);
+    for (const auto &f : fields)
+      if (!f.size)
+        w.Link(table + slots[f.id], f.child);
+    return table;
+  };
+}
+
+FbObj String(const std::string &s) {
+  return [s](FbWriter &w) -> size_t {
+    w.Align(4);
+    size_t pos = w.buf.size();
+    w.Put(s.size(), 4);
+    w.buf += s;
+    w.buf.push_back(0);
+    return pos;
+  };
+}
+
+FbObj Vector(std::vector<FbObj> items) {
+  return [items](FbWriter &w) -> size_t {
+    w.Align(4);
+    size_t pos = w.buf.size();
+    w.Put(items.size(), 4);
+    size_t slots = w.buf.size();
+    w.buf.resize(slots + 4 * items.size(), 0);
+    for (size_t i = 0; i < items.size(); ++i)
+      w.Link(slots + 4 * i, items[i]);
+    return pos;
+  };
+}
+
+// Vector of 8-aligned structs given as raw little-endian bytes
+FbObj StructVector(std::string bytes, size_t count) {
+  return [bytes, count](FbWriter &w) -> size_t {
+    while (w.buf.size() % 8 != 4)
+      w.buf.push_back(0);
+    size_t pos = w.buf.size();
+    w.Put(count, 4);
+    w.buf += bytes;
+    return pos;
+  };
+}
+
+void PutLE(std::string &out, uint64_t v, int size) {
+  for (int i = 0; i < size; ++i)
+    out.push_back((char)(uint8_t)(v >> (8 * i)));
+}
+
+// ---------------------------------------------------------------------------
+// Arrow schema and messages (format/Schema.fbs, format/Message.fbs)
+// ---------------------------------------------------------------------------
+
+const int kMetadataV5 = 4;
+const int kHeaderSchema = 1, kHeaderDictionary = 2, kHeaderRecordBatch = 3;
+const int kTypeInt = 2, kTypeFloat = 3, kTypeUtf8 = 5, kTypeTimestamp = 10;
+const int kNumFields = 7;
+
+FbObj IntType(int bits) {
+  return Table({Scalar(0, 4, bits), Scalar(1, 1, 1)});
+}
+
+FbObj Field(const char *name, int typeType, FbObj type, FbObj dict = nullptr) {
+  std::vector<FbField> f = {Child(0, String(name)), Scalar(1, 1, 0),
+                            Scalar(2, 1, typeType), Child(3, type),
+                            Child(5, Vector({}))};
+  if (dict)
+    f.push_back(Child(4, dict));
+  return Table(f);
+}
+
+FbObj Schema() {
+  // Timestamp unit 1 = MILLISECOND, no time zone; FloatingPoint 2 = DOUBLE
+  FbObj dbl = Table({Scalar(0, 2, 2)});
+  FbObj dict = Table({Scalar(0, 8, 0), Child(1, IntType(32))});
+  return Table(
+      {Scalar(0, 2, 0), // little-endian
+       Child(1, Vector({Field("symbol", kTypeUtf8, Table({}), dict),
+                        Field("date", kTypeTimestamp, Table({Scalar(0, 2, 1)})),
+                        Field("open", kTypeFloat, dbl),
+                        Field("high", kTypeFloat, dbl),
+                        Field("low", kTypeFloat, dbl),
+                        Field("close", kTypeFloat, dbl),
+                        Field("volume", kTypeInt, IntType(64))}))});
+}
+
+// nodes: (length, nullCount) pairs; buffers: (offset, length) pairs
+FbObj RecordBatch(size_t length, const std::vector<uint64_t> &nodes,
+                  const std::vector<uint64_t> &buffers) {
+  std::string n, b;
+  for (uint64_t v : nodes)
+    PutLE(n, v, 8);
+  for (uint64_t v : buffers)
+    PutLE(b, v, 8);
+  return Table({Scalar(0, 8, length),
+                Child(1, StructVector(n, nodes.size() / 2)),
+                Child(2, StructVector(b, buffers.size() / 2))});
+}
+
+std::string Message(int headerType, FbObj header, size_t bodyLength) {
+  FbWriter w;
+  return w.Finish(Table({Scalar(0, 2, kMetadataV5),
+                         Scalar(1, 1, headerType), Child(2, header),
+                         Scalar(3, 8, bodyLength)}));
+}
+
+size_t Pad8(size_t n) { return (n + 7) & ~(size_t)7; }
+
+// Days since 1970-01-01 (proleptic Gregorian)
+int32_t DaysFromCivil(int y, int m, int d) {
+  y -= m <= 2;
+  int era = (y >= 0 ? y : y - 399) / 400;
+  int yoe = y - era * 400;
+  int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+void AppendColumn(std::string &body, const void *data, size_t bytes) {
+  body.append((const char *)data, bytes);
+  body.resize(Pad8(body.size()), 0);
+}
+
+// ---------------------------------------------------------------------------
+// File output
+// ---------------------------------------------------------------------------
+
+struct Block {
+  uint64_t offset;
+  uint32_t metaLength;
+  uint64_t bodyLength;
+};
+
+class IpcFile {
+public:
+  explicit IpcFile(FILE *fp) : m_fp(fp), m_pos(0), m_ok(true) {}
+
+  void Raw(const void *p, size_t n) {
+    if (m_ok && n && fwrite(p, 1, n, m_fp) != n)
+      m_ok = false;
+    m_pos += n;
+  }
+  void Raw(const std::string &s) { Raw(s.data(), s.size()); }
+
+  // Encapsulated message: continuation marker, metadata length, metadata.
+  // The caller writes bodyLength bytes of body right after.
+  Block Meta(const std::string &meta, size_t bodyLength) {
+    Block b = {m_pos, (uint32_t)(8 + meta.size()), bodyLength};
+    std::string prefix;
+    PutLE(prefix, 0xFFFFFFFFu, 4);
+    PutLE(prefix, meta.size(), 4);
+    Raw(prefix);
+    Raw(meta);
+    return b;
+  }
+
+  uint64_t Pos() const { return m_pos; }
+  bool Ok() const { return m_ok; }
+
+private:
+  FILE *m_fp;
+  uint64_t m_pos;
+  bool m_ok;
+};
+
+std::string BlockBytes(const std::vector<Block> &blocks) {
+  std::string out;
+  for (const Block &b : blocks) {
+    PutLE(out, b.offset, 8);
+    PutLE(out, b.metaLength, 4);
+    PutLE(out, 0, 4);
+    PutLE(out, b.bodyLength, 8);
+  }
+  return out;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// ArrowBarWriter
+// ---------------------------------------------------------------------------
+
+void ArrowBarWriter::AddSeries(const std::string &symbol,
+                               const std::vector<DseBar> &bars) {
+  if (bars.empty())
+    return;
+  size_t n = bars.size();
+  Batch &b = m_batches[symbol];
+  m_rows -= b.rows;
+  b.rows = n;
+  b.body.clear();
+  b.body.reserve(6 * 8 * n);
+
+  std::vector<int64_t> dates(n);
+  for (size_t i = 0; i < n; ++i)
+    dates[i] = (int64_t)DaysFromCivil(bars[i].year, bars[i].month,
+                                      bars[i].day) *
+               86400000;
+  AppendColumn(b.body, dates.data(), 8 * n);
+
+  std::vector<double> col(n);
+  const double DseBar::*prices[] = {&DseBar::open, &DseBar::high,
+                                    &DseBar::low, &DseBar::close};
+  for (auto field : prices) {
+    for (size_t i = 0; i < n; ++i)
+      col[i] = bars[i].*field;
+    AppendColumn(b.body, col.data(), 8 * n);
+  }
+
+  std::vector<int64_t> vol(n);
+  for (size_t i = 0; i < n; ++i)
+    vol[i] = (int64_t)std::nearbyint(bars[i].volume);
+  AppendColumn(b.body, vol.data(), 8 * n);
+  m_rows += n;
+}
+
+bool ArrowBarWriter::Write(const char *path) const {
+  char tmpPath[1040];
+  sprintf_s(tmpPath, "%s.tmp", path);
+  FILE *fp = NULL;
+  if (fopen_s(&fp, tmpPath, "wb") != 0 || !fp)
+    return false;
+
+  IpcFile f(fp);
+  f.Raw("ARROW1\0\0", 8);
+  f.Meta(Message(kHeaderSchema, Schema(), 0), 0);
+
+  // Dictionary 0: every symbol, in the order of the batches below
+  std::vector<Block> dictBlocks;
+  {
+    std::string offsets, chars;
+    PutLE(offsets, 0, 4);
+    for (const auto &e : m_batches) {
+      chars += e.first;
+      PutLE(offsets, chars.size(), 4);
+    }
+    size_t count = m_batches.size();
+    size_t offLen = offsets.size(), charLen = chars.size();
+    offsets.resize(Pad8(offLen), 0);
+    chars.resize(Pad8(charLen), 0);
+    size_t bodyLen = offsets.size() + chars.size();
+    FbObj data = RecordBatch(count, {count, 0},
+                             {0, 0, 0, offLen, offsets.size(), charLen});
+    FbObj dict = Table({Scalar(0, 8, 0), Child(1, data)});
+    dictBlocks.push_back(f.Meta(Message(kHeaderDictionary, dict, bodyLen),
+                                bodyLen));
+    f.Raw(offsets);
+    f.Raw(chars);
+  }
+
+  // One record batch per symbol
+  std::vector<Block> batchBlocks;
+  std::vector<int32_t> indices;
+  int32_t index = 0;
+  for (const auto &e : m_batches) {
+    const Batch &b = e.second;
+    uint64_t n = b.rows;
+    size_t idxLen = Pad8(4 * n);
+    std::vector<uint64_t> nodes, buffers;
+    for (int i = 0; i < kNumFields; ++i) {
+      nodes.push_back(n);
+      nodes.push_back(0);
+    }
+    // Validity bitmaps are omitted (length 0): no column has nulls
+    uint64_t off = 0;
+    const uint64_t widths[kNumFields] = {4, 8, 8, 8, 8, 8, 8};
+    for (int i = 0; i < kNumFields; ++i) {
+      buffers.insert(buffers.end(), {off, 0, off, widths[i] * n});
+      off += Pad8(widths[i] * n);
+    }
+    size_t bodyLen = idxLen + b.body.size();
+    batchBlocks.push_back(f.Meta(
+        Message(kHeaderRecordBatch, RecordBatch(n, nodes, buffers), bodyLen),
+        bodyLen));
+
+    indices.assign(idxLen / 4, 0);
+    for (size_t i = 0; i < n; ++i)
+      indices[i] = index;
+    f.Raw(indices.data(), idxLen);
+    f.Raw(b.body);
+    ++index;
+  }
+
+  // End-of-stream marker, then the footer indexing every block
+  f.Raw("\xFF\xFF\xFF\xFF\0\0\0\0", 8);
+  FbWriter w;
+  std::string footer = w.Finish(
+      Table({Scalar(0, 2, kMetadataV5), Child(1, Schema()),
+             Child(2, StructVector(BlockBytes(dictBlocks), dictBlocks.size())),
+             Child(3, StructVector(BlockBytes(batchBlocks),
+                                   batchBlocks.size()))}));
+  std::string tail;
+  PutLE(tail, footer.size(), 4);
+  f.Raw(footer);
+  f.Raw(tail);
+  f.Raw("ARROW1", 6);
+
+  bool ok = (fclose(fp) == 0) && f.Ok();
+  if (!ok ||
+      !MoveFileExA(tmpPath, path,
+                   MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+    remove(tmpPath);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,92 @@
+// BarCache.cpp — Per-Symbol Bar Series, Sharded by Symbol Hash
+
+#include "BarCache.h"
+
+BarCache::BarCache(size_t shardCount) : m_version(0) {
+  if (shardCount == 0)
+    shardCount = 1;
+  m_shards.reserve(shardCount);
+  for (size_t i = 0; i < shardCount; ++i)
+    m_shards.emplace_back(new Shard);
+}
+
+BarCache::Shard &BarCache::ShardFor(const std::string &symbol) const {
+  size_t h = std::hash<std::string>()(symbol);
+  return *m_shards[h % m_shards.size()];
+}
+
+bool BarCache::Get(const std::string &symbol,
+                   std::vector<DseBar> &outBars) const {
+  Shard &s = ShardFor(symbol);
+  Trace::Lock<std::mutex> lock(s.mutex, "BarCache shard");
+  auto it = s.series.find(symbol);
+  if (it == s.series.end())
+    return false;
+  outBars = it->second.bars;
+  return true;
+}
+
+bool BarCache::Contains(const std::string &symbol) const {
+  Shard &s = ShardFor(symbol);
+  Trace::Lock<std::mutex> lock(s.mutex, "BarCache shard");
+  return s.series.find(symbol) != s.series.end();
+}
+
+void BarCache::Put(const std::string &symbol, std::vector<DseBar> bars) {
+  Shard &s = ShardFor(symbol);
+  Trace::Lock<std::mutex> lock(s.mutex, "BarCache shard");
+  // The old series leaves with 'bars', after the lock is released
+  Series &dst = s.series[symbol];
+  dst.bars.swap(bars);
+  dst.version = NextVersion();
+}
+
+void BarCache::ForEach(
+    const std::function<void(const std::string &, const std::vector<DseBar> &)>
+        &fn) const {
+  for (const auto &shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    for (const auto &e : shard->series)
+      fn(e.first, e.second.bars);
+  }
+}
+
+std::map<std::string, std::vector<DseBar>> BarCache::Snapshot() const {
+  std::map<std::string, std::vector<DseBar>> out;
+  ForEach([&out](const std::string &sym, const std::vector<DseBar> &bars) {
+    out[sym] = bars;
+  });
+  return out;
+}
+
+std::map<std::string, std::vector<DseBar>>
+BarCache::SnapshotSince(uint64_t since) const {
+  std::map<std::string, std::vector<DseBar>> out;
+  for (const auto &shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    for (const auto &e : shard->series)
+      if (e.second.version > since && !e.second.bars.empty())
+        out[e.first] = e.second.bars;
+  }
+  return out;
+}
+
+void BarCache::Count(size_t &symbols, size_t &bars) const {
+  symbols = 0;
+  bars = 0;
+  for (const auto &shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    symbols += shard->series.size();
+    for (const auto &e : shard->series)
+      bars += e.second.bars.size();
+  }
+}
+
+size_t BarCache::Size() const {
+  size_t n = 0;
+  for (const auto &shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    n += shard->series.size();
+  }
+  return n;
+}
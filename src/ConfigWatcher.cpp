@@ -0,0 +1,65 @@
+// ConfigWatcher.cpp — Notices Edits to dse_config.ini
+
+#include "ConfigWatcher.h"
+#include "Trace.h"
+#include <filesystem>
+
+ConfigWatcher::ConfigWatcher() : m_intervalMs(2000) {}
+
+ConfigWatcher::~ConfigWatcher() { Stop(); }
+
+bool ConfigWatcher::Start(const char *path, int intervalMs,
+                          std::function<void()> onChange) {
+  if (IsRunning() || !path || !path[0] || !onChange)
+    return false;
+  m_path = path;
+  SetIntervalMs(intervalMs);
+  m_onChange = std::move(onChange);
+  m_stop.Reset();
+  m_thread = std::thread(&ConfigWatcher::Run, this);
+  return true;
+}
+
+void ConfigWatcher::Stop() {
+  if (!IsRunning())
+    return;
+  m_stop.Set();
+  m_thread.join();
+}
+
+ConfigWatcher::Stamp ConfigWatcher::Read(const std::string &path) {
+  namespace fs = std::filesystem;
+  Stamp s = {false, 0, 0};
+  std::error_code ec;
+  auto mtime = fs::last_write_time(path, ec);
+  if (ec)
+    return s;
+  uint64_t size = fs::file_size(path, ec);
+  if (ec)
+    return s;
+  s.exists = true;
+  s.mtime = (int64_t)mtime.time_since_epoch().count();
+  s.size = size;
+  return s;
+}
+
+void ConfigWatcher::Run() {
+  Trace::SetThreadName("config-watch");
+  Stamp current = Read(m_path);
+  Stamp pending = current;
+
+  while (!m_stop.WaitFor(m_intervalMs.load())) {
+    Stamp now = Read(m_path);
+    if (!now.exists || now == current) {
+      pending = current;
+      continue;
+    }
+    // Report only once the new stamp has held for a whole interval
+    if (now != pending) {
+      pending = now;
+      continue;
+    }
+    current = now;
+    m_onChange();
+  }
+}
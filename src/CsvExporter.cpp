@@ -0,0 +1,170 @@
+// CsvExporter.cpp — Background CSV Export of Changed Symbols
+
+#include "CsvExporter.h"
+#include "CsvUtils.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "OsServices.h"
+
+CsvExporter::CsvExporter()
+    : m_stopping(false), m_append(false), m_pending(0), m_stats(),
+      m_passVersion(0), m_exportedVersion(0) {}
+
+CsvExporter::~CsvExporter() { Stop(); }
+
+void CsvExporter::Start(int threads) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_threads.empty())
+    return;
+  if (threads < 1)
+    threads = 1;
+  m_stopping = false;
+  for (int i = 0; i < threads; ++i)
+    m_threads.emplace_back(&CsvExporter::Worker, this);
+}
+
+void CsvExporter::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_threads.empty())
+      return;
+    m_stopping = true;
+  }
+  m_cv.notify_all();
+  for (auto &t : m_threads)
+    t.join();
+  m_threads.clear();
+}
+
+bool CsvExporter::IsBusy() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_pending > 0;
+}
+
+bool CsvExporter::Export(const BarCache &cache, const char *exportPath,
+                         bool all, bool append, DoneFn onDone) {
+  if (!exportPath || !exportPath[0])
+    return false;
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_pending > 0 || m_threads.empty())
+    return false;
+
+  // A different folder holds none of the earlier files
+  if (m_exportedPath != exportPath) {
+    all = true;
+    m_retry.clear();
+    m_marks.clear();
+  }
+  // Whole-file replacement invalidates every watermark
+  if (!append)
+    m_marks.clear();
+
+  // Read the version first: series written while the snapshot is taken
+  // are exported again next pass rather than missed
+  m_passVersion = cache.CurrentVersion();
+  std::map<std::string, std::vector<DseBar>> changed =
+      cache.SnapshotSince(all ? 0 : m_exportedVersion);
+  for (const auto &sym : m_retry) {
+    if (changed.find(sym) != changed.end())
+      continue;
+    std::vector<DseBar> bars;
+    if (cache.Get(sym, bars) && !bars.empty())
+      changed[sym].swap(bars);
+  }
+  m_retry.clear();
+
+  m_path = exportPath;
+  m_exportedPath = exportPath;
+  m_append = append;
+  if (changed.empty()) {
+    m_exportedVersion = m_passVersion;
+    return true;
+  }
+
+  for (auto &e : changed) {
+    Job job;
+    job.symbol = e.first;
+    job.bars.swap(e.second);
+    m_queue.push_back(std::move(job));
+  }
+  m_pending = (int)m_queue.size();
+  Metrics::Set(Metrics::kExportQueue, m_pending);
+  m_stats = Stats();
+  m_onDone = std::move(onDone);
+  m_passStart = std::chrono::steady_clock::now();
+  lock.unlock();
+  m_cv.notify_all();
+  return true;
+}
+
+void CsvExporter::Worker() {
+  Trace::SetThreadName("csv-export");
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for (;;) {
+    m_cv.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+    if (m_queue.empty())
+      return; // stopping, queue drained
+
+    Job job = std::move(m_queue.front());
+    m_queue.pop_front();
+    std::string path = m_path;
+    CsvWatermark *mark = m_append ? &m_marks[job.symbol] : nullptr;
+    lock.unlock();
+
+    CsvWriteResult result;
+    {
+      Trace::Span span("ExportSymbol", "export");
+      result = mark ? WriteAppend(job, path, *mark)
+                    : (CsvUtils::ExportBarsToCsv(job.symbol.c_str(),
+                                                 path.c_str(), job.bars)
+                           ? CSV_REWRITTEN
+                           : CSV_WRITE_FAILED);
+    }
+
+    lock.lock();
+    switch (result) {
+    case CSV_REWRITTEN:
+      ++m_stats.rewritten;
+      break;
+    case CSV_APPENDED:
+      ++m_stats.appended;
+      break;
+    case CSV_TAIL_REWRITTEN:
+      ++m_stats.tailRewritten;
+      break;
+    case CSV_UNCHANGED:
+      ++m_stats.unchanged;
+      break;
+    default:
+      ++m_stats.failed;
+      m_retry.insert(job.symbol);
+      break;
+    }
+    Metrics::Set(Metrics::kExportQueue, m_pending - 1);
+    if (--m_pending == 0) {
+      m_exportedVersion = m_passVersion;
+      DoneFn done = std::move(m_onDone);
+      m_onDone = nullptr;
+      Stats stats = m_stats;
+      stats.elapsedMs =
+          (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::steady_clock::now() - m_passStart)
+              .count();
+      lock.unlock();
+      if (done)
+        done(stats);
+      lock.lock();
+    }
+  }
+}
+
+CsvWriteResult CsvExporter::WriteAppend(const Job &job, const std::string &dir,
+                                        CsvWatermark &mark) {
+  std::string path = Os::JoinPath(dir, job.symbol + ".csv");
+  std::string content;
+  content.reserve(64 + job.bars.size() * 48);
+  content += CsvUtils::kCsvHeader;
+  CsvUtils::AppendBarRows(content, job.bars);
+  return CsvTailWriter::Write(path.c_str(), content, mark);
+}
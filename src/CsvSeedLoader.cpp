@@ -0,0 +1,507 @@
+// CsvSeedLoader.cpp — Fast, Parallel Loading of CSV Seed Files
+
+#include "CsvSeedLoader.h"
+#include "MappedFile.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+const char kPathSep = '\\';
+#else
+const char kPathSep = '/';
+#endif
+
+// ---------------------------------------------------------------------------
+// SWAR delimiter scan
+// ---------------------------------------------------------------------------
+
+const uint64_t kOnes = 0x0101010101010101ULL;
+const uint64_t kHighs = 0x8080808080808080ULL;
+const uint64_t kCommas = kOnes * (uint8_t)',';
+
+// High bit set in each zero byte of v. Bits above the first zero byte may
+// be false positives, so only the lowest set bit is meaningful.
+inline uint64_t ZeroBytes(uint64_t v) { return (v - kOnes) & ~v & kHighs; }
+
+inline unsigned LowestBit(uint64_t v) {
+#if defined(_MSC_VER)
+  unsigned long i;
+#if defined(_M_X64) || defined(_M_ARM64)
+  _BitScanForward64(&i, v);
+  return i;
+#else
+  if (_BitScanForward(&i, (unsigned long)v))
+    return i;
+  _BitScanForward(&i, (unsigned long)(v >> 32));
+  return i + 32;
+#endif
+#else
+  return (unsigned)__builtin_ctzll(v);
+#endif
+}
+
+// First ',' in [p, end), or end. Bytes are little-endian in the word, so
+// the lowest flagged byte is the earliest one.
+inline const char *FindComma(const char *p, const char *end) {
+  while (end - p >= 8) {
+    uint64_t w;
+    memcpy(&w, p, 8);
+    uint64_t hit = ZeroBytes(w ^ kCommas);
+    if (hit)
+      return p + (LowestBit(hit) >> 3);
+    p += 8;
+  }
+  while (p < end && *p != ',')
+    ++p;
+  return p;
+}
+
+// ---------------------------------------------------------------------------
+// Field parsers
+// ---------------------------------------------------------------------------
+
+const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                         1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                         1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+inline bool IsDigit(char c) { return (unsigned)(c - '0') < 10; }
+
+double SlowNumber(const char *p, const char *end) {
+  char buf[64];
+  size_t n = (size_t)(end - p);
+  if (n >= sizeof(buf))
+    n = sizeof(buf) - 1;
+  memcpy(buf, p, n);
+  buf[n] = 0;
+  return atof(buf);
+}
+
+// Same result as atof on the field. The digits form an exact integer and
+// 10^frac is exact, so one division rounds exactly as strtod would.
+double ParseNumber(const char *p, const char *end) {
+  const char *start = p;
+  while (p < end && (*p == ' ' || *p == '\t'))
+    ++p;
+  bool neg = false;
+  if (p < end && (*p == '-' || *p == '+'))
+    neg = (*p++ == '-');
+
+  uint64_t mant = 0;
+  int digits = 0, frac = 0;
+  bool any = false;
+  while (p < end && IsDigit(*p)) {
+    mant = mant * 10 + (uint64_t)(*p++ - '0');
+    digits += (mant != 0);
+    any = true;
+  }
+  if (p < end && *p == '.') {
+    ++p;
+    while (p < end && IsDigit(*p)) {
+      mant = mant * 10 + (uint64_t)(*p++ - '0');
+      digits += (mant != 0);
+      ++frac;
+      any = true;
+    }
+  }
+  if (digits > 15 || frac > 22 ||
+      (p < end && (*p == 'e' || *p == 'E' || (!any && *p != ' '))))
+    return SlowNumber(start, end);
+  double v = (double)mant / kPow10[frac];
+  return neg ? -v : v;
+}
+
+inline int TwoDigits(const char *p) { return (p[0] - '0') * 10 + (p[1] - '0'); }
+
+// YYYY?MM?DD at the start of [p, end), or a bare YYYYMMDD field
+bool ParseDate(const char *p, const char *end, DseBar &bar) {
+  if (end - p == 8) {
+    for (int i = 0; i < 8; ++i)
+      if (!IsDigit(p[i]))
+        return false;
+    bar.year = TwoDigits(p) * 100 + TwoDigits(p + 2);
+    bar.month = TwoDigits(p + 4);
+    bar.day = TwoDigits(p + 6);
+    return true;
+  }
+  if (end - p < 10)
+    return false;
+  for (int i : {0, 1, 2, 3, 5, 6, 8, 9})
+    if (!IsDigit(p[i]))
+      return false;
+  bar.year = TwoDigits(p) * 100 + TwoDigits(p + 2);
+  bar.month = TwoDigits(p + 5);
+  bar.day = TwoDigits(p + 8);
+  return true;
+}
+
+bool EqualsNoCase(const char *p, size_t n, const char *word) {
+  for (size_t i = 0; i < n; ++i, ++word) {
+    if (!*word)
+      return false;
+    char c = p[i];
+    if (c >= 'A' && c <= 'Z')
+      c = (char)(c - 'A' + 'a');
+    char w = *word;
+    if (w >= 'A' && w <= 'Z')
+      w = (char)(w - 'A' + 'a');
+    if (c != w)
+      return false;
+  }
+  return *word == 0;
+}
+
+inline bool IsAlpha(char c) {
+  return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+} // namespace
+
+namespace CsvSeedLoader {
+
+// ---------------------------------------------------------------------------
+// Parsing
+// ---------------------------------------------------------------------------
+
+bool ParseLine(const char *p, const char *end, DseBar &bar, const char **sym,
+               size_t *symLen) {
+  while (end > p && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t'))
+    --end;
+  if (p == end)
+    return false;
+
+  // Up to 7 fields: [Trading_Code,] Date, Open, High, Low, Close, Volume
+  const char *f[8];
+  const char *fe[8];
+  int n = 0;
+  const char *q = p;
+  while (n < 7) {
+    const char *c = FindComma(q, end);
+    f[n] = q;
+    fe[n] = c;
+    ++n;
+    if (c == end)
+      break;
+    q = c + 1;
+  }
+
+  size_t len0 = (size_t)(fe[0] - f[0]);
+  if (IsAlpha(p[0]) &&
+      (EqualsNoCase(p, len0, "Date") || EqualsNoCase(p, len0, "Ticker") ||
+       EqualsNoCase(p, len0, "Trading_Code")))
+    return false;
+
+  // Format B when the first field reads as a date in any accepted form
+  memset(&bar, 0, sizeof(bar));
+  bool firstIsDate = ParseDate(f[0], fe[0], bar);
+  int d = firstIsDate ? 0 : 1;
+  if (d >= n)
+    return false;
+  if (!firstIsDate && !ParseDate(f[1], fe[1], bar))
+    return false;
+  if (bar.year == 0 || bar.month == 0 || bar.day == 0)
+    return false;
+
+  double *dst[5] = {&bar.open, &bar.high, &bar.low, &bar.close, &bar.volume};
+  for (int i = 0; i < 5 && d + 1 + i < n; ++i)
+    *dst[i] = ParseNumber(f[d + 1 + i], fe[d + 1 + i]);
+
+  const double MIN_PRICE = 0.01;
+  if (!(bar.open >= MIN_PRICE && bar.high >= MIN_PRICE &&
+        bar.low >= MIN_PRICE && bar.close >= MIN_PRICE &&
+        bar.high >= bar.low && bar.year >= 1990 && bar.year <= 2100 &&
+        bar.month >= 1 && bar.month <= 12 && bar.day >= 1 && bar.day <= 31))
+    return false;
+  bar.valid = true;
+
+  if (symLen) {
+    *symLen = firstIsDate ? 0 : len0;
+    if (sym)
+      *sym = p;
+  }
+  return true;
+}
+
+size_t Parse(const char *data, size_t len, std::vector<DseBar> &outBars) {
+  const char *p = data;
+  const char *end = data + len;
+  size_t before = outBars.size();
+  outBars.reserve(before + len / 40);
+
+  DseBar bar;
+  while (p < end) {
+    const char *nl = (const char *)memchr(p, '\n', (size_t)(end - p));
+    const char *lineEnd = nl ? nl : end;
+    if (ParseLine(p, lineEnd, bar))
+      outBars.push_back(bar);
+    p = lineEnd + 1;
+  }
+  return outBars.size() - before;
+}
+
+bool LoadFile(const char *path, std::vector<DseBar> &outBars,
+              uint64_t *bytesRead) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp)
+    return false;
+
+  // One read for the whole file
+  std::string data;
+  if (fseek(fp, 0, SEEK_END) == 0) {
+    long size = ftell(fp);
+    if (size > 0) {
+      data.resize((size_t)size);
+      fseek(fp, 0, SEEK_SET);
+      data.resize(fread(&data[0], 1, data.size(), fp));
+    }
+  }
+  fclose(fp);
+
+  if (bytesRead)
+    *bytesRead = data.size();
+  Parse(data.data(), data.size(), outBars);
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Parallel load
+// ---------------------------------------------------------------------------
+
+Stats LoadMany(const char *dir, const std::vector<std::string> &symbols,
+               int threads,
+               std::map<std::string, std::vector<DseBar>> &outSeeds) {
+  Stats stats = Stats();
+  if (!dir || !dir[0] || symbols.empty())
+    return stats;
+  auto start = std::chrono::steady_clock::now();
+
+  if (threads <= 0)
+    threads = (int)std::thread::hardware_concurrency();
+  if (threads < 1)
+    threads = 1;
+  if ((size_t)threads > symbols.size())
+    threads = (int)symbols.size();
+
+  std::vector<std::vector<DseBar>> results(symbols.size());
+  std::atomic<size_t> next(0);
+  std::mutex statsMutex;
+  auto worker = [&]() {
+    int files = 0;
+    uint64_t bytes = 0;
+    std::string path;
+    for (size_t i; (i = next.fetch_add(1)) < symbols.size();) {
+      path.assign(dir);
+      path += kPathSep;
+      path += symbols[i];
+      path += ".csv";
+      uint64_t n = 0;
+      if (LoadFile(path.c_str(), results[i], &n)) {
+        ++files;
+        bytes += n;
+      }
+    }
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.files += files;
+    stats.bytes += bytes;
+  };
+
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads; ++t)
+    pool.emplace_back(worker);
+  worker();
+  for (auto &t : pool)
+    t.join();
+
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    if (results[i].empty())
+      continue;
+    stats.rows += results[i].size();
+    outSeeds[symbols[i]].swap(results[i]);
+  }
+  stats.seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  return stats;
+}
+
+// ---------------------------------------------------------------------------
+// Market-wide file
+// ---------------------------------------------------------------------------
+
+namespace {
+
+// One chunk's rows in file order, each tagged with a chunk-local symbol ID.
+// Rows are scattered into per-symbol series only once every chunk is done
+// and the final sizes are known, so no series ever reallocates.
+struct ChunkRows {
+  std::vector<std::string> names; // by ID
+  std::vector<DseBar> bars;
+  std::vector<uint32_t> ids;
+};
+
+void ParseMarketChunk(const char *p, const char *end, ChunkRows &out) {
+  // Keys point into the mapped file, which outlives the chunk
+  std::unordered_map<std::string_view, uint32_t> ids;
+  std::vector<std::string_view> byId;
+  uint32_t lastId = 0;
+
+  out.bars.reserve((size_t)(end - p) / 48);
+  out.ids.reserve(out.bars.capacity());
+  DseBar bar;
+  const char *sym;
+  size_t symLen;
+  while (p < end) {
+    const char *nl = (const char *)memchr(p, '\n', (size_t)(end - p));
+    const char *lineEnd = nl ? nl : end;
+    if (ParseLine(p, lineEnd, bar, &sym, &symLen) && symLen) {
+      // Dumps are grouped by symbol (same ID as the last row) or by date
+      // (symbols repeat in the same order, so the next ID); only a miss on
+      // both pays for a hash lookup
+      std::string_view key(sym, symLen);
+      if (byId.empty() || byId[lastId] != key) {
+        if (lastId + 1 < byId.size() && byId[lastId + 1] == key) {
+          ++lastId;
+        } else {
+          auto it = ids.find(key);
+          if (it == ids.end()) {
+            it = ids.emplace(key, (uint32_t)byId.size()).first;
+            byId.push_back(key);
+            out.names.emplace_back(key);
+          }
+          lastId = it->second;
+        }
+      }
+      out.bars.push_back(bar);
+      out.ids.push_back(lastId);
+    }
+    p = lineEnd + 1;
+  }
+}
+
+const char *LastNewline(const char *data, size_t size) {
+  for (const char *p = data + size; p > data;)
+    if (*--p == '\n')
+      return p;
+  return nullptr;
+}
+
+// Parse [data, data + size) on up to 'threads' threads and append its rows
+// to outSeeds in order. Returns rows added.
+size_t LoadMarketWindow(const char *data, size_t size, int threads,
+                        std::map<std::string, std::vector<DseBar>> &outSeeds) {
+  // A few chunks per thread evens out dense and sparse regions. Each
+  // boundary moves forward to just past a newline, so no row is split.
+  size_t chunkCount = (size_t)threads * 4;
+  if (chunkCount > size / kMinMarketChunk + 1)
+    chunkCount = size / kMinMarketChunk + 1;
+  std::vector<size_t> bounds(1, 0);
+  for (size_t i = 1; i < chunkCount; ++i) {
+    size_t at = size / chunkCount * i;
+    if (at <= bounds.back())
+      continue;
+    const char *nl = (const char *)memchr(data + at, '\n', size - at);
+    if (!nl)
+      break;
+    bounds.push_back((size_t)(nl - data) + 1);
+  }
+  bounds.push_back(size);
+  chunkCount = bounds.size() - 1;
+
+  std::vector<ChunkRows> chunks(chunkCount);
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t i; (i = next.fetch_add(1)) < chunkCount;)
+      ParseMarketChunk(data + bounds[i], data + bounds[i + 1], chunks[i]);
+  };
+  std::vector<std::thread> pool;
+  for (int t = 1; t < threads && (size_t)t < chunkCount; ++t)
+    pool.emplace_back(worker);
+  worker();
+  for (auto &t : pool)
+    t.join();
+
+  // Map chunk-local IDs to output series and size each series exactly
+  std::vector<std::vector<std::vector<DseBar> *>> target(chunkCount);
+  std::map<std::vector<DseBar> *, size_t> need;
+  for (size_t i = 0; i < chunkCount; ++i) {
+    ChunkRows &c = chunks[i];
+    for (const auto &name : c.names)
+      target[i].push_back(&outSeeds[name]);
+    std::vector<size_t> counts(c.names.size(), 0);
+    for (uint32_t id : c.ids)
+      ++counts[id];
+    for (size_t id = 0; id < counts.size(); ++id)
+      need[target[i][id]] += counts[id];
+  }
+  for (auto &e : need)
+    e.first->reserve(e.first->size() + e.second);
+
+  // Scatter in file order, releasing each chunk as it is consumed
+  size_t rows = 0;
+  for (size_t i = 0; i < chunkCount; ++i) {
+    ChunkRows &c = chunks[i];
+    for (size_t r = 0; r < c.bars.size(); ++r)
+      target[i][c.ids[r]]->push_back(c.bars[r]);
+    rows += c.bars.size();
+    c = ChunkRows();
+  }
+  return rows;
+}
+
+} // namespace
+
+Stats LoadMarketFile(const char *path, int threads,
+                     std::map<std::string, std::vector<DseBar>> &outSeeds) {
+  Stats stats = Stats();
+  auto start = std::chrono::steady_clock::now();
+  MappedFile file;
+  if (!path || !path[0] || !file.OpenUnmapped(path))
+    return stats;
+  stats.files = 1;
+  stats.bytes = file.FileSize();
+
+  if (threads <= 0)
+    threads = (int)std::thread::hardware_concurrency();
+  if (threads < 1)
+    threads = 1;
+
+  // Whole windows of complete lines; the partial line at the end of one
+  // window starts the next
+  uint64_t offset = 0;
+  while (offset < file.FileSize()) {
+    uint64_t left = file.FileSize() - offset;
+    size_t want = left < kMarketWindow ? (size_t)left : kMarketWindow;
+    if (!file.MapWindow(offset, want)) {
+      stats.files = 0; // cannot be read as a whole; report it as missing
+      break;
+    }
+    const char *data = file.Data();
+    size_t size = file.Size();
+    if (size < left) {
+      const char *nl = LastNewline(data, size);
+      if (nl)
+        size = (size_t)(nl - data) + 1; // a longer line is cut; skipped
+    }
+    stats.rows += LoadMarketWindow(data, size, threads, outSeeds);
+    offset += size;
+  }
+
+  stats.seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+  return stats;
+}
+
+} // namespace CsvSeedLoader
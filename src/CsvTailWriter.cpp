@@ -0,0 +1,157 @@
+// CsvTailWriter.cpp — Append-Only Updates to Exported CSV Files
+
+#include "CsvTailWriter.h"
+#include "CsvUtils.h"
+#include <cstdio>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+uint64_t HashBytes(const char *p, size_t n) {
+  uint64_t h = 14695981039346656037ULL; // FNV-1a
+  for (size_t i = 0; i < n; ++i) {
+    h ^= (unsigned char)p[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+bool TruncateFile(FILE *fp, long long size) {
+#ifdef _WIN32
+  return _chsize_s(_fileno(fp), size) == 0;
+#else
+  return ftruncate(fileno(fp), (off_t)size) == 0;
+#endif
+}
+
+// -1 if missing
+long long FileSize(const char *path) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp)
+    return -1;
+  fseek(fp, 0, SEEK_END);
+  long long size = ftell(fp);
+  fclose(fp);
+  return size;
+}
+
+bool ReadFile(const char *path, std::string &out) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp)
+    return false;
+  out.clear();
+  char buf[65536];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+    out.append(buf, n);
+  fclose(fp);
+  return true;
+}
+
+// Write content[from..] at offset from, dropping anything past its end
+bool WriteTail(const char *path, const std::string &content, size_t from,
+               uint64_t oldSize) {
+  FILE *fp = fopen(path, "r+b");
+  if (!fp)
+    return false;
+  bool ok = fseek(fp, (long)from, SEEK_SET) == 0 &&
+            fwrite(content.data() + from, 1, content.size() - from, fp) ==
+                content.size() - from;
+  if (ok && content.size() < oldSize)
+    ok = fflush(fp) == 0 && TruncateFile(fp, (long long)content.size());
+  ok = (fclose(fp) == 0) && ok;
+  return ok;
+}
+
+} // namespace
+
+namespace CsvTailWriter {
+
+void Index(const std::string &content, CsvWatermark &wm, size_t keep) {
+  if (keep > wm.blocks.size())
+    keep = wm.blocks.size();
+  wm.blocks.resize(keep);
+
+  size_t pos = keep ? wm.blocks.back().offset + wm.blocks.back().length : 0;
+  while (pos < content.size()) {
+    // Block 0 is the header line alone, so a header change is easy to spot
+    int lines = wm.blocks.empty() ? 1 : kRowsPerBlock;
+    size_t end = pos;
+    for (int i = 0; i < lines && end < content.size(); ++i) {
+      size_t nl = content.find('\n', end);
+      end = (nl == std::string::npos) ? content.size() : nl + 1;
+    }
+    CsvWatermark::Block b;
+    b.offset = pos;
+    b.length = (uint32_t)(end - pos);
+    b.hash = HashBytes(content.data() + pos, end - pos);
+    wm.blocks.push_back(b);
+    pos = end;
+  }
+  wm.size = content.size();
+  wm.valid = true;
+}
+
+CsvWriteResult Write(const char *path, const std::string &content,
+                     CsvWatermark &wm) {
+  // Unknown or externally modified file: index what is on disk
+  long long diskSize = FileSize(path);
+  if (diskSize < 0) {
+    wm = CsvWatermark();
+  } else if (!wm.valid || (uint64_t)diskSize != wm.size) {
+    std::string old;
+    wm = CsvWatermark();
+    if (ReadFile(path, old))
+      Index(old, wm);
+  }
+
+  if (!wm.valid) {
+    if (!CsvUtils::WriteFileAtomic(path, content))
+      return CSV_WRITE_FAILED;
+    Index(content, wm);
+    return CSV_REWRITTEN;
+  }
+
+  // First block whose bytes differ decides where writing starts
+  size_t keep = wm.blocks.size();
+  for (size_t i = 0; i < wm.blocks.size(); ++i) {
+    const CsvWatermark::Block &b = wm.blocks[i];
+    if (b.offset + b.length > content.size() ||
+        HashBytes(content.data() + b.offset, b.length) != b.hash) {
+      keep = i;
+      break;
+    }
+  }
+  size_t from = keep < wm.blocks.size() ? (size_t)wm.blocks[keep].offset
+                                        : (size_t)wm.size;
+
+  if (from == wm.size && content.size() == wm.size)
+    return CSV_UNCHANGED;
+
+  CsvWriteResult result;
+  if (from == 0) {
+    // Header changed: readers get the whole new file or none of it
+    if (!CsvUtils::WriteFileAtomic(path, content)) {
+      wm = CsvWatermark();
+      return CSV_WRITE_FAILED;
+    }
+    result = CSV_REWRITTEN;
+  } else {
+    if (!WriteTail(path, content, from, wm.size)) {
+      wm = CsvWatermark(); // re-index from disk next time
+      return CSV_WRITE_FAILED;
+    }
+    result = (from == wm.size) ? CSV_APPENDED : CSV_TAIL_REWRITTEN;
+  }
+
+  // The last kept block may have been partial; re-hash from there
+  Index(content, wm, keep ? keep - 1 : 0);
+  return result;
+}
+
+} // namespace CsvTailWriter
@@ -3,147 +3,168 @@
 ///////////////////////////////////////////////////////////////////////////
 
 #include "CsvUtils.h"
+#include "CsvSeedLoader.h"
 #include "DseTypes.h"
+#include "OsServices.h"
 #include <cstdio>
 #include <cstring>
+#include <cmath>
+#include <cstdint>
 #include <algorithm>
+#include "PlatformCompat.h"
 
 namespace CsvUtils {
 
-bool LoadCsvSeed(const char *symbol, const char *csvSeedPath,
-                 std::vector<DseBar> &outBars) {
-  if (!csvSeedPath || !csvSeedPath[0])
-    return false;
+// Export files are written in binary so byte offsets match the buffer;
+// Windows keeps the CRLF line ends the text-mode writer used to produce
+#ifdef _WIN32
+#define CSV_EOL "\r\n"
+#else
+#define CSV_EOL "\n"
+#endif
+
+const char kCsvHeader[] = "Date,Open,High,Low,Close,Volume" CSV_EOL;
+
+namespace {
+
+// Unsigned decimal, returns bytes written
+size_t WriteUInt(char *dst, uint64_t v) {
+  char tmp[24];
+  size_t n = 0;
+  do {
+    tmp[n++] = (char)('0' + v % 10);
+    v /= 10;
+  } while (v);
+  for (size_t i = 0; i < n; ++i)
+    dst[i] = tmp[n - 1 - i];
+  return n;
+}
 
-  char path[1024];
-  sprintf_s(path, "%s\\%s.csv", csvSeedPath, symbol);
+void Write2(char *dst, int v) {
+  dst[0] = (char)('0' + (v / 10) % 10);
+  dst[1] = (char)('0' + v % 10);
+}
 
-  FILE *fp = NULL;
-  errno_t err = fopen_s(&fp, path, "r");
-  if (err != 0 || !fp) {
-    return false;
+// Same digits as "%.2f". The integer part splits off exactly; fma recovers
+// the rounding error of fraction*100 so half-cent cases round the way
+// printf does (values beyond 1e15 fall back to printf).
+size_t WritePrice(char *dst, double v) {
+  if (!(std::fabs(v) < 1e15))
+    return (size_t)sprintf_s(dst, 400, "%.2f", v); // up to 1e308
+
+  size_t n = 0;
+  if (std::signbit(v))
+    dst[n++] = '-';
+  double a = std::fabs(v);
+  double whole = std::floor(a);
+  double frac = a - whole;
+  double p = frac * 100.0;
+  double err = std::fma(frac, 100.0, -p);
+  double r = std::floor(p);
+  double d = p - r;
+  int cents = (int)r;
+  if (d > 0.5 || (d == 0.5 && (err > 0 || (err == 0 && (cents & 1)))))
+    ++cents;
+  uint64_t w = (uint64_t)whole;
+  if (cents == 100) {
+    ++w;
+    cents = 0;
   }
 
-  char line[2048];
-  int rowCount = 0;
-
-  while (fgets(line, sizeof(line), fp)) {
-    // Trim trailing whitespace/newlines
-    char *p = line;
-    while (*p) p++;
-    p--;
-    while (p >= line && (*p == '\n' || *p == '\r' || *p == ' ' || *p == '\t'))
-      *p-- = 0;
-
-    if (line[0] == 0)
-      continue;
-
-    char tmp[2048];
-    strcpy_s(tmp, line);
-
-    char *ctx = NULL;
-    char *c1 = strtok_s(tmp, ",", &ctx);
-    if (!c1)
-      continue;
-
-    // Heuristic: Does the first token look like a date (YYYY-MM-DD)?
-    bool firstIsDate = false;
-    if (strlen(c1) >= 10 && c1[4] == '-' && c1[7] == '-') {
-      firstIsDate = true;
-    }
+  n += WriteUInt(dst + n, w);
+  dst[n++] = '.';
+  Write2(dst + n, cents);
+  return n + 2;
+}
 
-    // Header check - skip header rows
-    if (isalpha(static_cast<unsigned char>(c1[0]))) {
-      if (_stricmp(c1, "Date") == 0 || _stricmp(c1, "Ticker") == 0 ||
-          _stricmp(c1, "Trading_Code") == 0) {
-        continue;
-      }
-    }
+} // namespace
 
-    DseBar bar;
-    memset(&bar, 0, sizeof(bar));
+bool LoadCsvSeed(const char *symbol, const char *csvSeedPath,
+                 std::vector<DseBar> &outBars) {
+  if (!csvSeedPath || !csvSeedPath[0])
+    return false;
 
-    char *dateStr = NULL;
-    char *openStr = NULL;
-    char *highStr = NULL;
-    char *lowStr = NULL;
-    char *closeStr = NULL;
-    char *volStr = NULL;
-
-    if (firstIsDate) {
-      // Format B: Date,Open,High,Low,Close,Volume
-      dateStr = c1;
-      openStr = strtok_s(NULL, ",", &ctx);
-      highStr = strtok_s(NULL, ",", &ctx);
-      lowStr = strtok_s(NULL, ",", &ctx);
-      closeStr = strtok_s(NULL, ",", &ctx);
-      volStr = strtok_s(NULL, ",", &ctx);
-    } else {
-      // Format A: Ticker,Date,Open,High,Low,Close,Volume
-      dateStr = strtok_s(NULL, ",", &ctx);
-      openStr = strtok_s(NULL, ",", &ctx);
-      highStr = strtok_s(NULL, ",", &ctx);
-      lowStr = strtok_s(NULL, ",", &ctx);
-      closeStr = strtok_s(NULL, ",", &ctx);
-      volStr = strtok_s(NULL, ",", &ctx);
-    }
+  std::string path = Os::JoinPath(csvSeedPath, std::string(symbol) + ".csv");
+  return CsvSeedLoader::LoadFile(path.c_str(), outBars) && !outBars.empty();
+}
 
-    if (!dateStr || strlen(dateStr) < 10)
-      continue;
+bool ExportBarsToCsv(const char *symbol, const char *exportPath,
+                     const std::vector<DseBar> &bars) {
+  if (!exportPath || !exportPath[0] || bars.empty())
+    return false;
 
-    // Parse Date (YYYY-MM-DD)
-    bar.year = atoi(std::string(dateStr, 4).c_str());
-    bar.month = atoi(std::string(dateStr + 5, 2).c_str());
-    bar.day = atoi(std::string(dateStr + 8, 2).c_str());
-    if (bar.year == 0 || bar.month == 0 || bar.day == 0) {
-      continue;
-    }
+  std::string path = Os::JoinPath(exportPath, std::string(symbol) + ".csv");
 
-    if (openStr) bar.open = atof(openStr);
-    if (highStr) bar.high = atof(highStr);
-    if (lowStr) bar.low = atof(lowStr);
-    if (closeStr) bar.close = atof(closeStr);
-    if (volStr) bar.volume = atof(volStr);
+  std::string data;
+  data.reserve(sizeof(kCsvHeader) + bars.size() * 48);
+  data += kCsvHeader;
+  AppendBarRows(data, bars);
+  return WriteFileAtomic(path.c_str(), data);
+}
 
-    // Validate bar before adding
-    const double MIN_PRICE = 0.01;
-    bool valid = (bar.open >= MIN_PRICE && bar.high >= MIN_PRICE &&
-                  bar.low >= MIN_PRICE && bar.close >= MIN_PRICE &&
-                  bar.high >= bar.low &&
-                  bar.year >= 1990 && bar.year <= 2100 &&
-                  bar.month >= 1 && bar.month <= 12 &&
-                  bar.day >= 1 && bar.day <= 31);
-
-    if (valid) {
-      outBars.push_back(bar);
-      rowCount++;
-    }
+size_t FormatBarRow(char *dst, const DseBar &b) {
+  size_t n = 0;
+  if (b.year >= 0 && b.year <= 9999) {
+    dst[0] = (char)('0' + b.year / 1000);
+    dst[1] = (char)('0' + (b.year / 100) % 10);
+    dst[2] = (char)('0' + (b.year / 10) % 10);
+    dst[3] = (char)('0' + b.year % 10);
+    n = 4;
+  } else {
+    n = (size_t)sprintf_s(dst, kMaxCsvRow, "%04d", b.year);
   }
-
-  fclose(fp);
-  return !outBars.empty();
+  dst[n++] = '-';
+  Write2(dst + n, b.month);
+  n += 2;
+  dst[n++] = '-';
+  Write2(dst + n, b.day);
+  n += 2;
+  dst[n++] = ',';
+  n += WritePrice(dst + n, b.open);
+  dst[n++] = ',';
+  n += WritePrice(dst + n, b.high);
+  dst[n++] = ',';
+  n += WritePrice(dst + n, b.low);
+  dst[n++] = ',';
+  n += WritePrice(dst + n, b.close);
+  dst[n++] = ',';
+  if (std::fabs(b.volume) < 9e18 && !std::signbit(b.volume))
+    n += WriteUInt(dst + n, (uint64_t)std::nearbyint(b.volume)); // half-even
+  else
+    n += (size_t)sprintf_s(dst + n, kMaxCsvRow - n, "%.0f", b.volume);
+#ifdef _WIN32
+  dst[n++] = '\r';
+#endif
+  dst[n++] = '\n';
+  return n;
 }
 
-bool ExportBarsToCsv(const char *symbol, const char *exportPath,
-                     const std::vector<DseBar> &bars) {
-  if (!exportPath || !exportPath[0] || bars.empty())
-    return false;
+void AppendBarRows(std::string &out, const std::vector<DseBar> &bars,
+                   size_t from) {
+  char row[kMaxCsvRow];
+  for (size_t i = from; i < bars.size(); ++i)
+    out.append(row, FormatBarRow(row, bars[i]));
+}
 
-  char path[1024];
-  sprintf_s(path, "%s\\%s.csv", exportPath, symbol);
+bool WriteFileAtomic(const char *path, const std::string &data) {
+  char tmpPath[1040];
+  sprintf_s(tmpPath, "%s.tmp", path);
 
   FILE *fp = NULL;
-  if (fopen_s(&fp, path, "w") != 0 || !fp)
+  if (fopen_s(&fp, tmpPath, "wb") != 0 || !fp)
+    return false;
+  bool ok = fwrite(data.data(), 1, data.size(), fp) == data.size();
+  ok = (fclose(fp) == 0) && ok;
+  if (!ok) {
+    remove(tmpPath);
     return false;
-
-  fprintf(fp, "Date,Open,High,Low,Close,Volume\n");
-
-  for (const auto &b : bars) {
-    fprintf(fp, "%04d-%02d-%02d,%.2f,%.2f,%.2f,%.2f,%.0f\n",
-            b.year, b.month, b.day, b.open, b.high, b.low, b.close, b.volume);
   }
 
-  fclose(fp);
+  if (!MoveFileExA(tmpPath, path,
+                   MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+    remove(tmpPath);
+    return false;
+  }
   return true;
 }
 
@@ -0,0 +1,117 @@
+// CurlHttpClient.cpp — HttpClient over libcurl (dse_proxyd on Linux)
+
+#include "CurlHttpClient.h"
+#include "Metrics.h"
+#include <cstdio>
+#include <curl/curl.h>
+
+CurlHttpClient::CurlHttpClient() : m_open(false), m_timeoutSec(30) {}
+
+CurlHttpClient::~CurlHttpClient() { Close(); }
+
+bool CurlHttpClient::Open(const char *userAgent, int timeoutSec,
+                          const LogFn &log) {
+  Close();
+  // Reference counted by libcurl; paired with curl_global_cleanup in Close
+  if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK) {
+    if (log)
+      log("ERROR: CurlHttpClient — curl_global_init failed");
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_userAgent = userAgent ? userAgent : "";
+  m_timeoutSec = timeoutSec;
+  m_log = log;
+  m_open = true;
+  return true;
+}
+
+void CurlHttpClient::Configure(const char *userAgent, int timeoutSec) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_userAgent = userAgent ? userAgent : "";
+  m_timeoutSec = timeoutSec;
+}
+
+void CurlHttpClient::Close() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_open)
+    return;
+  m_open = false;
+  curl_global_cleanup();
+}
+
+bool CurlHttpClient::IsOpen() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_open;
+}
+
+static size_t AppendBody(char *data, size_t size, size_t count, void *user) {
+  ((std::string *)user)->append(data, size * count);
+  return size * count;
+}
+
+bool CurlHttpClient::Get(const char *url, std::string &outBody) {
+  return Perform(url, nullptr, outBody);
+}
+
+bool CurlHttpClient::Post(const char *url, const char *formPayload,
+                          std::string &outBody) {
+  return Perform(url, formPayload ? formPayload : "", outBody);
+}
+
+bool CurlHttpClient::Perform(const char *url, const char *formPayload,
+                             std::string &outBody) {
+  std::string userAgent;
+  int timeoutSec;
+  LogFn log;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_open)
+      return false;
+    userAgent = m_userAgent;
+    timeoutSec = m_timeoutSec;
+    log = m_log;
+  }
+
+  CURL *curl = curl_easy_init();
+  if (!curl)
+    return false;
+  outBody.clear();
+  curl_easy_setopt(curl, CURLOPT_URL, url);
+  curl_easy_setopt(curl, CURLOPT_USERAGENT, userAgent.c_str());
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)timeoutSec);
+  curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L); // safe from worker threads
+  curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, AppendBody);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &outBody);
+  if (formPayload)
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, formPayload);
+
+  CURLcode rc = curl_easy_perform(curl);
+  long status = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+
+  if (rc == CURLE_OK && Metrics::Enabled()) {
+    curl_off_t connect = 0, ttfb = 0, total = 0;
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &ttfb);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+    Metrics::Record(Metrics::kHttpConnect, (uint64_t)connect);
+    Metrics::Record(Metrics::kHttpTtfb, (uint64_t)ttfb);
+    Metrics::Record(Metrics::kHttpBody, (uint64_t)(total - ttfb));
+  }
+  curl_easy_cleanup(curl);
+
+  if (rc != CURLE_OK || status >= 400) {
+    if (log) {
+      char msg[512];
+      snprintf(msg, sizeof(msg), "ERROR: CurlHttpClient — %s: %s (HTTP %ld)",
+               url, rc != CURLE_OK ? curl_easy_strerror(rc) : "error status",
+               status);
+      log(msg);
+    }
+    return false;
+  }
+  return true;
+}
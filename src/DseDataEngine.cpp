@@ -5,15 +5,24 @@
 // data via CsvUtils, and caches results per symbol.
 
 #include "DseDataEngine.h"
+#include "ArrowExport.h"
+#include "CsvSeedLoader.h"
 #include "CsvUtils.h"
+#include "DsePageParser.h"
 #include "HtmlUtils.h"
+#include "IniFile.h"
+#include "Metrics.h"
+#include "OsServices.h"
+#include "PlatformCompat.h"
+#include "Trace.h"
 #include <algorithm>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
-#include <wininet.h>
+#include <system_error>
+#include <thread>
 
 #undef min
 #undef max
@@ -22,13 +31,22 @@
 // File-scope helpers
 // ---------------------------------------------------------------------------
 
-// Validates a parsed DseBar — rejects zero prices, bad dates, and inverted H/L.
-static bool ValidateBar(const DseBar &bar) {
-  const double MIN = 0.01;
-  return bar.open >= MIN && bar.high >= MIN && bar.low >= MIN &&
-         bar.close >= MIN && bar.high >= bar.low && bar.year >= 1990 &&
-         bar.year <= 2100 && bar.month >= 1 && bar.month <= 12 &&
-         bar.day >= 1 && bar.day <= 31;
+// YYYYMMDD integer used as the merge key for bars.
+static int BarDateKey(const DseBar &bar) {
+  return bar.year * 10000 + bar.month * 100 + bar.day;
+}
+
+// Parses "YYYY-MM-DD"; returns false on malformed input.
+static bool ParseYmd(const char *s, int &y, int &m, int &d) {
+  return s && sscanf_s(s, "%04d-%02d-%02d", &y, &m, &d) == 3 && m >= 1 &&
+         m <= 12 && d >= 1 && d <= 31;
+}
+
+static int DaysInMonth(int y, int m) {
+  static const int kDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  if (m == 2 && ((y % 4 == 0 && y % 100 != 0) || y % 400 == 0))
+    return 29;
+  return kDays[m - 1];
 }
 
 // ---------------------------------------------------------------------------
@@ -36,28 +54,44 @@ static bool ValidateBar(const DseBar &bar) {
 // ---------------------------------------------------------------------------
 
 DseDataEngine::DseDataEngine()
-    : m_hInternet(NULL), m_hConnect(NULL), m_connState(CONN_DISCONNECTED),
-      m_logFile(NULL) {
+    : m_nextListenerId(1), m_configSeq(0), m_dispatchedSeq(0),
+      m_connState(CONN_DISCONNECTED), m_logFile(NULL), m_lastFetchOkMs(0),
+      m_marketSeedsOk(false) {
   memset(&m_config, 0, sizeof(m_config));
+  m_configPath[0] = '\0';
 }
 
 DseDataEngine::~DseDataEngine() { Shutdown(); }
 
+void DseDataEngine::SetHttpClient(std::unique_ptr<HttpClient> client) {
+  std::unique_lock<std::shared_mutex> session(m_sessionMutex);
+  m_http = std::move(client);
+}
+
 // ---------------------------------------------------------------------------
 // Initialize / Shutdown
 // ---------------------------------------------------------------------------
 
 bool DseDataEngine::Initialize(const char *configPath) {
-  std::lock_guard<std::mutex> lock(m_mutex);
+  std::lock_guard<std::mutex> lock(m_initMutex);
 
   if (!LoadConfig(configPath)) {
     // Apply built-in defaults when no config file is present
     m_config.historyDays = 365;
+    m_config.historyChunkMonths = 12;
+    m_config.historyFetchThreads = 4;
+    m_config.historyChunkRetries = 2;
+    m_config.marketChunkMonths = 1;
     m_config.pollIntervalMs = 5000;
+    m_config.pollMinIntervalMs = 2000;
+    m_config.pollMaxIntervalMs = 30000;
+    m_config.pollJitterPct = 10;
+    m_config.pollAdaptive = true;
     m_config.marketOpenHour = 10;
     m_config.marketOpenMinute = 0;
     m_config.marketCloseHour = 14;
     m_config.marketCloseMinute = 30;
+    m_config.exchangeUtcOffsetMin = 360;
     m_config.maxReconnectAttempts = 10;
     m_config.httpTimeoutSec = 30;
     strcpy_s(m_config.userAgent,
@@ -68,60 +102,229 @@ bool DseDataEngine::Initialize(const char *configPath) {
              "https://www.dsebd.org/day_end_archive.php");
     strcpy_s(m_config.altLatestPriceUrl,
              "https://www.dsebd.org/latest_share_price_all_,ajax.php");
+    m_config.intradayBarSec = 60;
+    m_config.intradaySessions = 5;
+    strcpy_s(m_config.tradingWeekdays, "Sun,Mon,Tue,Wed,Thu");
+    strcpy_s(m_config.holidaysFile, "dse_holidays.txt");
+    m_config.journalEnabled = false;
+    strcpy_s(m_config.journalPath, "journal");
+    m_config.journalKeyframeEvery = 60;
+    m_config.replayEnabled = false;
+    m_config.replayPath[0] = '\0';
+    m_config.replaySpeed = 1;
+    m_config.recordPath[0] = '\0';
+    m_config.exportThreads = 4;
+    m_config.exportAppend = false;
+    m_config.seedThreads = 0;
+    m_config.marketSeedFile[0] = '\0';
+    m_config.arrowFile[0] = '\0';
+    m_config.configWatch = true;
+    m_config.configWatchMs = 2000;
+    m_config.metricsEnabled = true;
+    m_config.statsFile[0] = '\0';
+    m_config.statsIntervalSec = 60;
+    m_config.metricsPort = 0;
+    m_config.traceEnabled = false;
+    m_config.traceEventsPerThread = 65536;
+    strcpy_s(m_config.traceFile, "dse_trace.json");
+    m_config.sharedBusEnabled = false;
+    strcpy_s(m_config.sharedBusName, "DSE_QuoteBus");
+    m_config.sharedBarsMB = 32;
+    m_config.sharedBusLeaseSec = 60;
+    m_config.proxyServer[0] = '\0';
+    m_config.proxyTimeoutSec = 120;
     m_config.enableLogging = true;
   }
+  strcpy_s(m_configPath, configPath ? configPath : "");
 
   // Force logging on for this debug build
   m_config.enableLogging = true;
 
-  if (m_config.enableLogging && m_config.logFilePath[0])
-    fopen_s(&m_logFile, m_config.logFilePath, "a");
+  {
+    std::lock_guard<std::mutex> logLock(m_logMutex);
+    if (!m_logFile)
+      OpenLogFile();
+  }
+
+  // Readers see either the previous snapshot or this one, never a mix
+  std::shared_ptr<const DseConfig> snap = std::make_shared<DseConfig>(m_config);
+  std::atomic_store(&m_configSnap, snap);
+  {
+    // Listeners attached from here on start from this snapshot
+    std::lock_guard<std::mutex> dispatch(m_dispatchMutex);
+    m_dispatchedCfg = snap;
+  }
 
   m_lastExportTime = time(NULL);
+  m_exporter.Start(m_config.exportThreads);
   Log("DseDataEngine::Initialize — starting");
 
-  m_hInternet = InternetOpenA(m_config.userAgent, INTERNET_OPEN_TYPE_PRECONFIG,
-                              NULL, NULL, 0);
-  if (!m_hInternet) {
-    Log("ERROR: InternetOpen failed, error=%lu", GetLastError());
-    m_connState = CONN_ERROR;
-    return false;
+  LoadCalendar(configPath);
+  m_clock.SetUtcOffsetMinutes(m_config.exchangeUtcOffsetMin);
+  ApplyMetricsConfig();
+  ApplyTraceConfig();
+  ApplySharedBusConfig();
+  ApplyProxyConfig();
+
+  // Reopen the session once no request is using the old one
+  {
+    std::unique_lock<std::shared_mutex> session(m_sessionMutex);
+    if (!m_http) {
+      Log("WARNING: Initialize — no HTTP client installed, fetches disabled");
+      m_connState = CONN_DISCONNECTED;
+    } else if (!m_http->Open(m_config.userAgent, m_config.httpTimeoutSec,
+                             [this](const char *msg) { Log("%s", msg); })) {
+      m_connState = CONN_ERROR;
+      return false;
+    } else {
+      m_connState = CONN_CONNECTED;
+    }
   }
 
-  DWORD timeout = m_config.httpTimeoutSec * 1000;
-  InternetSetOptionA(m_hInternet, INTERNET_OPTION_CONNECT_TIMEOUT, &timeout,
-                     sizeof(timeout));
-  InternetSetOptionA(m_hInternet, INTERNET_OPTION_RECEIVE_TIMEOUT, &timeout,
-                     sizeof(timeout));
-  InternetSetOptionA(m_hInternet, INTERNET_OPTION_SEND_TIMEOUT, &timeout,
-                     sizeof(timeout));
+  // Reloads take m_initMutex, so the watcher is stopped before Shutdown
+  // takes it; a repeated Initialize leaves a running watcher alone
+  if (m_config.configWatch && m_configPath[0] && !m_watcher.IsRunning())
+    m_watcher.Start(m_configPath, m_config.configWatchMs,
+                    [this]() { ReloadConfig(); });
 
-  m_connState = CONN_CONNECTED;
   Log("DseDataEngine::Initialize — OK");
   return true;
 }
 
 void DseDataEngine::Shutdown() {
-  std::lock_guard<std::mutex> lock(m_mutex);
+  m_watcher.Stop();
+  m_exporter.Stop(); // lets queued files finish
+  m_statsWriter.Stop(); // writes the final report
+  m_metricsServer.Stop();
+  m_bus.Close(); // hands the poller role to another instance
+  m_proxy.Stop();
+
+  // Keep the tail of a traced session without needing the dialog
+  std::string tracePath;
+  if (DumpTrace(tracePath))
+    Log("Shutdown: trace written to %s", tracePath.c_str());
+  Trace::Stop();
+
+  std::lock_guard<std::mutex> lock(m_initMutex);
   Log("DseDataEngine::Shutdown");
 
-  if (m_hConnect) {
-    InternetCloseHandle(m_hConnect);
-    m_hConnect = NULL;
-  }
-  if (m_hInternet) {
-    InternetCloseHandle(m_hInternet);
-    m_hInternet = NULL;
+  {
+    std::unique_lock<std::shared_mutex> session(m_sessionMutex);
+    if (m_http)
+      m_http->Close();
   }
 
   m_connState = CONN_DISCONNECTED;
 
+  std::lock_guard<std::mutex> logLock(m_logMutex);
   if (m_logFile) {
     fclose(m_logFile);
     m_logFile = NULL;
   }
 }
 
+void DseDataEngine::OpenLogFile() {
+  if (m_config.enableLogging && m_config.logFilePath[0])
+    fopen_s(&m_logFile, m_config.logFilePath, "a");
+}
+
+// ---------------------------------------------------------------------------
+// Live Configuration
+// ---------------------------------------------------------------------------
+
+bool DseDataEngine::ReloadConfig() {
+  std::shared_ptr<const DseConfig> oldCfg, newCfg;
+  uint64_t seq;
+  {
+    std::lock_guard<std::mutex> lock(m_initMutex);
+    oldCfg = Config();
+    if (!oldCfg || !m_configPath[0])
+      return false; // not initialized
+
+    // An editor may have the file deleted mid-save; keep what we have
+    if (!Os::FileExists(m_configPath)) {
+      Log("WARNING: ReloadConfig — %s not found, keeping current settings",
+          m_configPath);
+      return false;
+    }
+
+    // Unlike Initialize, a reload honours EnableLogging, so logging can be
+    // switched off (or back on) in a running session
+    LoadConfig(m_configPath);
+
+    newCfg = std::make_shared<DseConfig>(m_config);
+    std::atomic_store(&m_configSnap, newCfg);
+    seq = ++m_configSeq;
+
+    // The holiday file may have changed even if the INI keys did not
+    LoadCalendar(m_configPath);
+    m_clock.SetUtcOffsetMinutes(m_config.exchangeUtcOffsetMin);
+    m_watcher.SetIntervalMs(m_config.configWatchMs);
+    ApplyMetricsConfig();
+    ApplyTraceConfig();
+    ApplySharedBusConfig();
+    ApplyProxyConfig();
+
+    // Options apply to requests opened from now on; in-flight ones finish
+    // with the old values
+    if (oldCfg->httpTimeoutSec != newCfg->httpTimeoutSec ||
+        strcmp(oldCfg->userAgent, newCfg->userAgent) != 0) {
+      std::shared_lock<std::shared_mutex> session(m_sessionMutex);
+      if (m_http && m_http->IsOpen())
+        m_http->Configure(m_config.userAgent, m_config.httpTimeoutSec);
+    }
+
+    if (oldCfg->enableLogging != newCfg->enableLogging ||
+        strcmp(oldCfg->logFilePath, newCfg->logFilePath) != 0) {
+      std::lock_guard<std::mutex> logLock(m_logMutex);
+      if (m_logFile) {
+        fclose(m_logFile);
+        m_logFile = NULL;
+      }
+      OpenLogFile();
+    }
+  }
+
+  Log("ReloadConfig: applied %s", m_configPath);
+
+  // Listeners run outside m_initMutex so they may call back into the
+  // engine. Two reloads (watcher and Configure dialog) can get here in
+  // either order; the older one must not land last and leave listeners on
+  // settings the engine no longer has.
+  std::lock_guard<std::mutex> dispatch(m_dispatchMutex);
+  if (seq <= m_dispatchedSeq)
+    return true; // a newer reload already told everyone
+  if (m_dispatchedCfg)
+    oldCfg = m_dispatchedCfg;
+  m_dispatchedSeq = seq;
+  m_dispatchedCfg = newCfg;
+
+  std::vector<ConfigListener> listeners;
+  {
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    for (const auto &e : m_listeners)
+      listeners.push_back(e.second);
+  }
+  for (const auto &fn : listeners)
+    fn(*oldCfg, *newCfg);
+  return true;
+}
+
+int DseDataEngine::AddConfigListener(ConfigListener listener) {
+  std::lock_guard<std::mutex> lock(m_listenerMutex);
+  int id = m_nextListenerId++;
+  m_listeners[id] = std::move(listener);
+  return id;
+}
+
+// Dispatch runs listeners from a copy under m_dispatchMutex; taking it here
+// lets a running notification finish before the owner may go away
+void DseDataEngine::RemoveConfigListener(int id) {
+  std::lock_guard<std::mutex> dispatch(m_dispatchMutex);
+  std::lock_guard<std::mutex> lock(m_listenerMutex);
+  m_listeners.erase(id);
+}
+
 // ---------------------------------------------------------------------------
 // Configuration
 // ---------------------------------------------------------------------------
@@ -130,63 +333,346 @@ bool DseDataEngine::LoadConfig(const char *path) {
   if (!path || !path[0])
     return false;
 
-  m_config.historyDays =
-      GetPrivateProfileIntA("Settings", "HistoryDays", 365, path);
-  m_config.pollIntervalMs =
-      GetPrivateProfileIntA("General", "PollIntervalMs", 5000, path);
-  m_config.marketOpenHour =
-      GetPrivateProfileIntA("General", "MarketOpenHour", 10, path);
-  m_config.marketOpenMinute =
-      GetPrivateProfileIntA("General", "MarketOpenMinute", 0, path);
-  m_config.marketCloseHour =
-      GetPrivateProfileIntA("General", "MarketCloseHour", 14, path);
-  m_config.marketCloseMinute =
-      GetPrivateProfileIntA("General", "MarketCloseMinute", 30, path);
+  // A missing file leaves every key at its default, as before
+  IniFile ini;
+  ini.Load(path);
+
+  m_config.historyDays = ini.GetInt("Settings", "HistoryDays", 365);
+  m_config.historyChunkMonths =
+      ini.GetInt("Settings", "HistoryChunkMonths", 12);
+  m_config.historyFetchThreads =
+      ini.GetInt("Settings", "HistoryFetchThreads", 4);
+  m_config.historyChunkRetries =
+      ini.GetInt("Settings", "HistoryChunkRetries", 2);
+  if (m_config.historyChunkMonths < 1)
+    m_config.historyChunkMonths = 1;
+  if (m_config.historyChunkMonths > 12)
+    m_config.historyChunkMonths = 12;
+  if (m_config.historyFetchThreads < 1)
+    m_config.historyFetchThreads = 1;
+  if (m_config.historyFetchThreads > 16)
+    m_config.historyFetchThreads = 16;
+  if (m_config.historyChunkRetries < 0)
+    m_config.historyChunkRetries = 0;
+  m_config.marketChunkMonths = ini.GetInt("Settings", "MarketChunkMonths", 1);
+  if (m_config.marketChunkMonths < 1)
+    m_config.marketChunkMonths = 1;
+  if (m_config.marketChunkMonths > 12)
+    m_config.marketChunkMonths = 12;
+  m_config.pollIntervalMs = ini.GetInt("General", "PollIntervalMs", 5000);
+  m_config.pollMinIntervalMs = ini.GetInt("General", "PollMinIntervalMs", 2000);
+  m_config.pollMaxIntervalMs =
+      ini.GetInt("General", "PollMaxIntervalMs", 30000);
+  m_config.pollJitterPct = ini.GetInt("General", "PollJitterPct", 10);
+  m_config.pollAdaptive = (ini.GetInt("General", "AdaptivePoll", 1) != 0);
+  m_config.marketOpenHour = ini.GetInt("General", "MarketOpenHour", 10);
+  m_config.marketOpenMinute = ini.GetInt("General", "MarketOpenMinute", 0);
+  m_config.marketCloseHour = ini.GetInt("General", "MarketCloseHour", 14);
+  m_config.marketCloseMinute = ini.GetInt("General", "MarketCloseMinute", 30);
+  m_config.exchangeUtcOffsetMin =
+      ini.GetInt("General", "ExchangeUtcOffsetMin", 360);
   m_config.maxReconnectAttempts =
-      GetPrivateProfileIntA("General", "MaxReconnectAttempts", 10, path);
-  m_config.httpTimeoutSec =
-      GetPrivateProfileIntA("General", "HttpTimeoutSec", 30, path);
+      ini.GetInt("General", "MaxReconnectAttempts", 10);
+  m_config.httpTimeoutSec = ini.GetInt("General", "HttpTimeoutSec", 30);
+
+  ini.GetString("General", "UserAgent",
+                "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36",
+                m_config.userAgent, sizeof(m_config.userAgent));
+
+  m_config.preferWebData = (ini.GetInt("General", "PreferWebData", 1) != 0);
+
+  ini.GetString("Endpoints", "LatestPrice",
+                "https://www.dsebd.org/latest_share_price_scroll_l.php",
+                m_config.latestPriceUrl, sizeof(m_config.latestPriceUrl));
+
+  ini.GetString("Endpoints", "DayEndArchive",
+                "https://www.dsebd.org/day_end_archive.php",
+                m_config.dayEndArchiveUrl, sizeof(m_config.dayEndArchiveUrl));
+
+  ini.GetString("Endpoints", "AltLatestPrice",
+                "https://www.dsebd.org/latest_share_price_all_,ajax.php",
+                m_config.altLatestPriceUrl, sizeof(m_config.altLatestPriceUrl));
+
+  m_config.enableLogging = (ini.GetInt("Debug", "EnableLogging", 0) != 0);
+
+  ini.GetString("Debug", "LogFilePath", "dse_plugin.log", m_config.logFilePath,
+                sizeof(m_config.logFilePath));
+
+  ini.GetString("DataSource", "CsvSeedPath",
+                "d:\\software\\dse_2000-2025\\separated_data",
+                m_config.csvSeedPath, sizeof(m_config.csvSeedPath));
+  m_config.seedThreads = ini.GetInt("DataSource", "SeedThreads", 0);
+  ini.GetString("DataSource", "MarketSeedFile", "", m_config.marketSeedFile,
+                sizeof(m_config.marketSeedFile));
+
+  ini.GetString("Export", "ExportPath", "", m_config.exportPath,
+                sizeof(m_config.exportPath));
+
+  m_config.exportIntervalSec = ini.GetInt("Export", "ExportIntervalSec", 0);
+  m_config.exportThreads = ini.GetInt("Export", "ExportThreads", 4);
+  if (m_config.exportThreads < 1)
+    m_config.exportThreads = 1;
+  if (m_config.exportThreads > 16)
+    m_config.exportThreads = 16;
+  char mode[32];
+  ini.GetString("Export", "Mode", "rewrite", mode, sizeof(mode));
+  m_config.exportAppend = _stricmp(mode, "append") == 0;
+  ini.GetString("Export", "ArrowFile", "", m_config.arrowFile,
+                sizeof(m_config.arrowFile));
+
+  m_config.intradayBarSec = ini.GetInt("Intraday", "BarIntervalSec", 60);
+  if (m_config.intradayBarSec < 5)
+    m_config.intradayBarSec = 5;
+  m_config.intradaySessions = ini.GetInt("Intraday", "Sessions", 5);
+  if (m_config.intradaySessions < 1)
+    m_config.intradaySessions = 1;
+
+  ini.GetString("Calendar", "TradingWeekdays", "Sun,Mon,Tue,Wed,Thu",
+                m_config.tradingWeekdays, sizeof(m_config.tradingWeekdays));
+  ini.GetString("Calendar", "HolidaysFile", "dse_holidays.txt",
+                m_config.holidaysFile, sizeof(m_config.holidaysFile));
+
+  m_config.journalEnabled = (ini.GetInt("Journal", "Enabled", 0) != 0);
+  ini.GetString("Journal", "Path", "journal", m_config.journalPath,
+                sizeof(m_config.journalPath));
+  m_config.journalKeyframeEvery = ini.GetInt("Journal", "KeyframeEvery", 60);
+  if (m_config.journalKeyframeEvery < 1)
+    m_config.journalKeyframeEvery = 1;
+
+  m_config.replayEnabled = (ini.GetInt("Replay", "Enabled", 0) != 0);
+  ini.GetString("Replay", "Path", "", m_config.replayPath,
+                sizeof(m_config.replayPath));
+  m_config.replaySpeed = ini.GetInt("Replay", "Speed", 1);
+  if (m_config.replaySpeed < 0)
+    m_config.replaySpeed = 0;
+  ini.GetString("Replay", "RecordPath", "", m_config.recordPath,
+                sizeof(m_config.recordPath));
+
+  m_config.configWatch = ini.GetInt("General", "WatchConfig", 1) != 0;
+  m_config.configWatchMs = ini.GetInt("General", "WatchConfigIntervalMs", 2000);
+  if (m_config.configWatchMs < 250)
+    m_config.configWatchMs = 250;
+
+  m_config.metricsEnabled = ini.GetInt("Metrics", "Enabled", 1) != 0;
+  ini.GetString("Metrics", "StatsFile", "", m_config.statsFile,
+                sizeof(m_config.statsFile));
+  m_config.statsIntervalSec = ini.GetInt("Metrics", "StatsIntervalSec", 60);
+  if (m_config.statsIntervalSec < 1)
+    m_config.statsIntervalSec = 1;
+  m_config.metricsPort = ini.GetInt("Metrics", "HttpPort", 0);
+  if (m_config.metricsPort < 0 || m_config.metricsPort > 65535)
+    m_config.metricsPort = 0;
+
+  m_config.traceEnabled = ini.GetInt("Trace", "Enabled", 0) != 0;
+  m_config.traceEventsPerThread =
+      ini.GetInt("Trace", "EventsPerThread", 65536);
+  if (m_config.traceEventsPerThread < 1024)
+    m_config.traceEventsPerThread = 1024;
+  ini.GetString("Trace", "File", "dse_trace.json", m_config.traceFile,
+                sizeof(m_config.traceFile));
+
+  m_config.sharedBusEnabled = ini.GetInt("SharedBus", "Enabled", 0) != 0;
+  ini.GetString("SharedBus", "Name", "DSE_QuoteBus", m_config.sharedBusName,
+                sizeof(m_config.sharedBusName));
+  m_config.sharedBarsMB = ini.GetInt("SharedBus", "BarArenaMB", 32);
+  if (m_config.sharedBarsMB < 1)
+    m_config.sharedBarsMB = 1;
+  if (m_config.sharedBarsMB > 1024)
+    m_config.sharedBarsMB = 1024;
+  m_config.sharedBusLeaseSec = ini.GetInt("SharedBus", "LeaseSec", 60);
+  if (m_config.sharedBusLeaseSec < 5)
+    m_config.sharedBusLeaseSec = 5;
+
+  ini.GetString("Proxy", "Server", "", m_config.proxyServer,
+                sizeof(m_config.proxyServer));
+  m_config.proxyTimeoutSec = ini.GetInt("Proxy", "TimeoutSec", 120);
+  if (m_config.proxyTimeoutSec < 1)
+    m_config.proxyTimeoutSec = 1;
 
-  GetPrivateProfileStringA(
-      "General", "UserAgent",
-      "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36",
-      m_config.userAgent, sizeof(m_config.userAgent), path);
+  return true;
+}
+
+void DseDataEngine::LoadCalendar(const char *configPath) {
+  unsigned mask = TradingCalendar::ParseWeekdays(m_config.tradingWeekdays);
+  if (!mask) {
+    Log("WARNING: LoadCalendar — bad TradingWeekdays '%s', using Sun–Thu",
+        m_config.tradingWeekdays);
+    mask = 0x1F;
+  }
+  auto calendar = std::make_shared<TradingCalendar>();
+  calendar->SetWeekMask(mask);
+  calendar->SetDefaultSession(
+      (m_config.marketOpenHour * 60 + m_config.marketOpenMinute) * 60,
+      (m_config.marketCloseHour * 60 + m_config.marketCloseMinute) * 60);
+
+  if (m_config.holidaysFile[0])
+    LoadHolidays(*calendar, configPath);
 
-  m_config.preferWebData =
-      (GetPrivateProfileIntA("General", "PreferWebData", 1, path) != 0);
+  std::atomic_store(&m_calendar,
+                    std::shared_ptr<const TradingCalendar>(calendar));
+}
 
-  GetPrivateProfileStringA(
-      "Endpoints", "LatestPrice",
-      "https://www.dsebd.org/latest_share_price_scroll_l.php",
-      m_config.latestPriceUrl, sizeof(m_config.latestPriceUrl), path);
+void DseDataEngine::LoadHolidays(TradingCalendar &calendar,
+                                 const char *configPath) {
 
-  GetPrivateProfileStringA(
-      "Endpoints", "DayEndArchive", "https://www.dsebd.org/day_end_archive.php",
-      m_config.dayEndArchiveUrl, sizeof(m_config.dayEndArchiveUrl), path);
+  // Relative paths sit next to dse_config.ini
+  const char *file = m_config.holidaysFile;
+  std::string dir = Os::DirName(configPath);
+  std::string path = Os::IsAbsolutePath(file) || dir.empty()
+                         ? std::string(file)
+                         : Os::JoinPath(dir, file);
 
-  GetPrivateProfileStringA(
-      "Endpoints", "AltLatestPrice",
-      "https://www.dsebd.org/latest_share_price_all_,ajax.php",
-      m_config.altLatestPriceUrl, sizeof(m_config.altLatestPriceUrl), path);
+  int bad = 0;
+  if (!calendar.Load(path.c_str(), &bad)) {
+    Log("WARNING: LoadCalendar — cannot open %s, weekly pattern only",
+        path.c_str());
+    return;
+  }
+  Log("LoadCalendar: %zu holidays from %s%s", calendar.GetHolidayCount(),
+      path.c_str(), bad ? " (some lines skipped)" : "");
+  if (bad)
+    Log("WARNING: LoadCalendar — %d malformed lines in %s", bad,
+        path.c_str());
+}
 
-  m_config.enableLogging =
-      (GetPrivateProfileIntA("Debug", "EnableLogging", 0, path) != 0);
+std::string DseDataEngine::ResolveConfigRelative(const char *file) const {
+  std::string dir = Os::DirName(m_configPath);
+  return Os::IsAbsolutePath(file) || dir.empty() ? std::string(file)
+                                                 : Os::JoinPath(dir, file);
+}
 
-  GetPrivateProfileStringA("Debug", "LogFilePath", "dse_plugin.log",
-                           m_config.logFilePath, sizeof(m_config.logFilePath),
-                           path);
+void DseDataEngine::ApplyMetricsConfig() {
+  Metrics::SetEnabled(m_config.metricsEnabled);
+
+  if (m_config.metricsPort <= 0) {
+    m_metricsServer.Stop();
+  } else if (m_metricsServer.Port() != m_config.metricsPort) {
+    if (m_metricsServer.Start(
+            m_config.metricsPort,
+            [this](std::string &out) { AppendHealthMetrics(out); },
+            [this](const char *msg) { Log("%s", msg); }))
+      Log("ApplyMetricsConfig: serving http://127.0.0.1:%d/metrics",
+          m_metricsServer.Port());
+  }
 
-  GetPrivateProfileStringA("DataSource", "CsvSeedPath",
-                           "d:\\software\\dse_2000-2025\\separated_data",
-                           m_config.csvSeedPath, sizeof(m_config.csvSeedPath),
-                           path);
+  if (!m_config.statsFile[0]) {
+    m_statsWriter.Stop();
+    return;
+  }
+  std::string path = ResolveConfigRelative(m_config.statsFile);
+  m_statsWriter.Configure(path, m_config.statsIntervalSec);
+  Log("ApplyMetricsConfig: stats to %s every %d s", path.c_str(),
+      m_config.statsIntervalSec);
+}
 
-  GetPrivateProfileStringA("Export", "ExportPath", "", m_config.exportPath,
-                           sizeof(m_config.exportPath), path);
+void DseDataEngine::AppendHealthMetrics(std::string &out) {
+  size_t symbols = 0, bars = 0;
+  m_cache.Count(symbols, bars);
+  std::shared_ptr<const std::vector<std::string>> known =
+      std::atomic_load(&m_symbols);
+  uint64_t lastOk = m_lastFetchOkMs.load();
+  double age = lastOk ? (Os::MonotonicMs() - lastOk) / 1000.0 : -1.0;
+
+  char buf[768];
+  sprintf_s(buf,
+            "# HELP dse_connection_state 0 disconnected, 1 connecting, "
+            "2 connected, 3 reconnecting, 4 error.\n"
+            "# TYPE dse_connection_state gauge\n"
+            "dse_connection_state %d\n"
+            "# HELP dse_last_fetch_age_seconds Since the last request that "
+            "returned data (-1 = none yet).\n"
+            "# TYPE dse_last_fetch_age_seconds gauge\n"
+            "dse_last_fetch_age_seconds %.3f\n"
+            "# TYPE dse_cache_symbols gauge\n"
+            "dse_cache_symbols %zu\n"
+            "# TYPE dse_cache_bars gauge\n"
+            "dse_cache_bars %zu\n"
+            "# TYPE dse_known_symbols gauge\n"
+            "dse_known_symbols %zu\n"
+            "# TYPE dse_process_resident_bytes gauge\n"
+            "dse_process_resident_bytes %llu\n",
+            (int)m_connState.load(), age, symbols, bars,
+            known ? known->size() : (size_t)0,
+            (unsigned long long)Os::ResidentBytes());
+  out += buf;
+}
 
-  m_config.exportIntervalSec =
-      GetPrivateProfileIntA("Export", "ExportIntervalSec", 0, path);
+void DseDataEngine::ApplyTraceConfig() {
+  // A reload that leaves tracing on keeps the events recorded so far
+  if (m_config.traceEnabled && !Trace::Enabled()) {
+    Trace::Start((size_t)m_config.traceEventsPerThread);
+    Log("ApplyTraceConfig: tracing on, %d events per thread",
+        m_config.traceEventsPerThread);
+  } else if (!m_config.traceEnabled && Trace::Enabled()) {
+    Trace::Stop();
+    Log("ApplyTraceConfig: tracing off");
+  }
+}
 
+void DseDataEngine::ApplySharedBusConfig() {
+  if (!m_config.sharedBusEnabled) {
+    if (m_bus.IsOpen()) {
+      m_bus.Close();
+      Log("ApplySharedBusConfig: left %s", m_busName.c_str());
+    }
+    m_busName.clear();
+    return;
+  }
+  if (m_bus.IsOpen() && m_busName == m_config.sharedBusName)
+    return;
+
+  // Only the instance that creates the section sizes the arena
+  m_busName = m_config.sharedBusName;
+  if (!m_bus.Open(m_config.sharedBusName,
+                  (size_t)m_config.sharedBarsMB * 1024 * 1024,
+                  m_config.sharedBusLeaseSec * 1000)) {
+    Log("WARNING: ApplySharedBusConfig — cannot map %s, polling alone",
+        m_config.sharedBusName);
+    m_busName.clear();
+    return;
+  }
+  Log("ApplySharedBusConfig: joined %s (lease %d s)", m_config.sharedBusName,
+      m_config.sharedBusLeaseSec);
+}
+
+void DseDataEngine::ApplyProxyConfig() {
+  if (m_proxyServer == m_config.proxyServer)
+    return;
+  m_proxyServer = m_config.proxyServer;
+  m_proxy.Stop();
+  if (m_proxyServer.empty()) {
+    Log("ApplyProxyConfig: scraping dsebd.org directly");
+    return;
+  }
+
+  // "host:port", or just "host" for the default port
+  std::string host = m_proxyServer;
+  int port = kDefaultProxyPort;
+  size_t colon = host.rfind(':');
+  if (colon != std::string::npos) {
+    port = atoi(host.c_str() + colon + 1);
+    host.resize(colon);
+  }
+  if (host.empty() || port <= 0 || port > 65535) {
+    Log("ERROR: ApplyProxyConfig — bad [Proxy] Server '%s'",
+        m_proxyServer.c_str());
+    return;
+  }
+  m_proxy.Start(host, port, [this](const char *msg) { Log("%s", msg); });
+  Log("ApplyProxyConfig: using dse_proxyd at %s:%d", host.c_str(), port);
+}
+
+bool DseDataEngine::DumpTrace(std::string &outPath) {
+  outPath.clear();
+  std::shared_ptr<const DseConfig> cfg = Config();
+  if (!cfg || !cfg->traceEnabled || !cfg->traceFile[0])
+    return false;
+  outPath = ResolveConfigRelative(cfg->traceFile);
+  if (!Trace::WriteJson(outPath)) {
+    Log("ERROR: DumpTrace — cannot write %s", outPath.c_str());
+    return false;
+  }
+  Log("DumpTrace: %s", outPath.c_str());
   return true;
 }
 
@@ -195,48 +681,30 @@ bool DseDataEngine::LoadConfig(const char *path) {
 // ---------------------------------------------------------------------------
 
 bool DseDataEngine::HttpGet(const char *url, std::string &outBody) {
-  if (!m_hInternet) {
-    Log("ERROR: HttpGet — no WinInet session");
+  Trace::Span span("HttpGet", "http");
+  std::shared_lock<std::shared_mutex> session(m_sessionMutex);
+  if (!m_http || !m_http->IsOpen()) {
+    Log("ERROR: HttpGet — no HTTP session");
     return false;
   }
 
   Log("HttpGet: %s", url);
+  Metrics::Add(Metrics::kHttpRequests);
 
-  // Try HTTPS first, fall back to plain HTTP on failure
-  HINTERNET hUrl =
-      InternetOpenUrlA(m_hInternet, url, NULL, 0,
-                       INTERNET_FLAG_RELOAD | INTERNET_FLAG_NO_CACHE_WRITE |
-                           INTERNET_FLAG_PRAGMA_NOCACHE | INTERNET_FLAG_SECURE,
-                       0);
-
-  if (!hUrl) {
-    Log("WARNING: HttpGet HTTPS failed (err=%lu), retrying without SECURE",
-        GetLastError());
-    hUrl = InternetOpenUrlA(m_hInternet, url, NULL, 0,
-                            INTERNET_FLAG_RELOAD | INTERNET_FLAG_NO_CACHE_WRITE,
-                            0);
-    if (!hUrl) {
-      m_connState = CONN_ERROR;
-      return false;
-    }
-  }
-
-  outBody.clear();
-  char buffer[8192];
-  DWORD bytesRead = 0;
-  while (InternetReadFile(hUrl, buffer, sizeof(buffer) - 1, &bytesRead) &&
-         bytesRead > 0) {
-    buffer[bytesRead] = '\0';
-    outBody.append(buffer, bytesRead);
-    bytesRead = 0;
+  if (!m_http->Get(url, outBody)) {
+    Metrics::Add(Metrics::kHttpErrors);
+    m_connState = CONN_ERROR;
+    return false;
   }
-  InternetCloseHandle(hUrl);
 
   if (outBody.empty()) {
+    Metrics::Add(Metrics::kHttpErrors);
     Log("WARNING: HttpGet — empty response");
     return false;
   }
 
+  Metrics::Add(Metrics::kHttpBytes, outBody.size());
+  m_lastFetchOkMs = Os::MonotonicMs();
   m_connState = CONN_CONNECTED;
   Log("HttpGet: received %zu bytes", outBody.size());
   return true;
@@ -244,75 +712,29 @@ bool DseDataEngine::HttpGet(const char *url, std::string &outBody) {
 
 bool DseDataEngine::HttpPost(const char *url, const char *payload,
                              std::string &outBody) {
-  if (!m_hInternet) {
-    Log("ERROR: HttpPost — no WinInet session");
+  Trace::Span span("HttpPost", "http");
+  std::shared_lock<std::shared_mutex> session(m_sessionMutex);
+  if (!m_http || !m_http->IsOpen()) {
+    Log("ERROR: HttpPost — no HTTP session");
     return false;
   }
 
   Log("HttpPost: %s (payload %zu bytes)", url, strlen(payload));
+  Metrics::Add(Metrics::kHttpRequests);
 
-  URL_COMPONENTSA urlComp = {0};
-  char host[256] = {0};
-  char path[1024] = {0};
-  urlComp.dwStructSize = sizeof(urlComp);
-  urlComp.lpszHostName = host;
-  urlComp.dwHostNameLength = sizeof(host);
-  urlComp.lpszUrlPath = path;
-  urlComp.dwUrlPathLength = sizeof(path);
-
-  if (!InternetCrackUrlA(url, 0, 0, &urlComp)) {
-    Log("ERROR: InternetCrackUrl failed, error=%lu", GetLastError());
-    return false;
-  }
-
-  HINTERNET hConnect =
-      InternetConnectA(m_hInternet, host, INTERNET_DEFAULT_HTTPS_PORT, NULL,
-                       NULL, INTERNET_SERVICE_HTTP, 0, 0);
-  if (!hConnect) {
-    Log("ERROR: InternetConnect failed, error=%lu", GetLastError());
-    return false;
-  }
-
-  const char *acceptTypes[] = {"*/*", NULL};
-  HINTERNET hRequest =
-      HttpOpenRequestA(hConnect, "POST", path, NULL, NULL, acceptTypes,
-                       INTERNET_FLAG_RELOAD | INTERNET_FLAG_NO_CACHE_WRITE |
-                           INTERNET_FLAG_SECURE,
-                       0);
-  if (!hRequest) {
-    Log("ERROR: HttpOpenRequest failed, error=%lu", GetLastError());
-    InternetCloseHandle(hConnect);
+  if (!m_http->Post(url, payload, outBody)) {
+    Metrics::Add(Metrics::kHttpErrors);
     return false;
   }
 
-  const char *headers = "Content-Type: application/x-www-form-urlencoded";
-  DWORD headersLen = (DWORD)strlen(headers);
-  if (!HttpSendRequestA(hRequest, headers, headersLen, (LPVOID)payload,
-                        (DWORD)strlen(payload))) {
-    Log("ERROR: HttpSendRequest failed, error=%lu", GetLastError());
-    InternetCloseHandle(hRequest);
-    InternetCloseHandle(hConnect);
-    return false;
-  }
-
-  outBody.clear();
-  char buffer[8192];
-  DWORD bytesRead = 0;
-  while (InternetReadFile(hRequest, buffer, sizeof(buffer) - 1, &bytesRead) &&
-         bytesRead > 0) {
-    buffer[bytesRead] = '\0';
-    outBody.append(buffer, bytesRead);
-    bytesRead = 0;
-  }
-
-  InternetCloseHandle(hRequest);
-  InternetCloseHandle(hConnect);
-
   if (outBody.empty()) {
+    Metrics::Add(Metrics::kHttpErrors);
     Log("WARNING: HttpPost — empty response");
     return false;
   }
 
+  Metrics::Add(Metrics::kHttpBytes, outBody.size());
+  m_lastFetchOkMs = Os::MonotonicMs();
   m_connState = CONN_CONNECTED;
   Log("HttpPost: received %zu bytes", outBody.size());
   return true;
@@ -327,7 +749,7 @@ std::string DseDataEngine::BuildHistoryUrl(const char *symbol,
                                            const char *endDate) {
   // Format:
   // day_end_archive.php?startDate=YYYY-MM-DD&endDate=YYYY-MM-DD&inst=SYM&archive=data
-  std::string url = m_config.dayEndArchiveUrl;
+  std::string url = Config()->dayEndArchiveUrl;
   url += "?startDate=";
   url += startDate;
   url += "&endDate=";
@@ -341,229 +763,245 @@ std::string DseDataEngine::BuildHistoryUrl(const char *symbol,
 }
 
 // ---------------------------------------------------------------------------
-// HTML Parsers
+// Chunked History Download
 // ---------------------------------------------------------------------------
 
-bool DseDataEngine::ParseHistoricalHtml(const std::string &html,
-                                        std::vector<DseBar> &outBars) {
-  Log("ParseHistoricalHtml: input=%zu bytes", html.size());
-
-  std::string tableHtml = HtmlUtils::ExtractTargetTable(html);
-  auto rows = HtmlUtils::ExtractTableRows(tableHtml);
-  Log("ParseHistoricalHtml: %zu rows extracted", rows.size());
-
-  // Detect column indices from header row
-  int colDate = -1, colOpen = -1, colHigh = -1, colLow = -1;
-  int colClose = -1, colVol = -1, headerRow = -1;
-
-  for (int r = 0; r < (int)rows.size() && r <= 300; ++r) {
-    auto cells = HtmlUtils::ParseTableRow(rows[r]);
-    if (cells.size() < 5)
-      continue;
-
-    for (int i = 0; i < (int)cells.size(); ++i) {
-      std::string h = cells[i];
-      std::transform(h.begin(), h.end(), h.begin(), ::toupper);
-
-      if (h.find("DATE") != std::string::npos)
-        colDate = i;
-      else if (h.find("OPENP") != std::string::npos ||
-               h.find("OPEN") != std::string::npos)
-        colOpen = i;
-      else if (h.find("HIGH") != std::string::npos)
-        colHigh = i;
-      else if (h.find("LOW") != std::string::npos)
-        colLow = i;
-      else if ((h.find("CLOSE") != std::string::npos ||
-                h.find("LTP") != std::string::npos) &&
-               h.find("YCP") == std::string::npos)
-        colClose = i;
-      else if (h.find("VOLUME") != std::string::npos ||
-               h.find("VOL") != std::string::npos)
-        colVol = i;
+// Chunks are aligned to calendar periods (years for 12 months, quarters for 3)
+// so the first and last chunk may be partial.
+std::vector<DseDataEngine::HistoryChunk>
+DseDataEngine::SplitHistoryRange(const char *startDate, const char *endDate,
+                                 int months) {
+  std::vector<HistoryChunk> chunks;
+  int y, m, d, ey, em, ed;
+  if (!ParseYmd(startDate, y, m, d) || !ParseYmd(endDate, ey, em, ed) ||
+      months < 1)
+    return chunks;
+  const int endKey = ey * 10000 + em * 100 + ed;
+
+  while (y * 10000 + m * 100 + d <= endKey) {
+    // Last day of the period that contains (y, m)
+    int py = y;
+    int pm = ((m - 1) / months) * months + months;
+    while (pm > 12) {
+      pm -= 12;
+      ++py;
     }
-
-    if (colDate != -1 && colClose != -1 && colVol != -1) {
-      headerRow = r;
-      Log("ParseHistoricalHtml: header at row %d "
-          "(Date=%d Open=%d High=%d Low=%d Close=%d Vol=%d)",
-          r, colDate, colOpen, colHigh, colLow, colClose, colVol);
-      break;
+    int pd = DaysInMonth(py, pm);
+    if (py * 10000 + pm * 100 + pd > endKey) {
+      py = ey;
+      pm = em;
+      pd = ed;
     }
-  }
 
-  if (headerRow == -1) {
-    // Fallback: assume known DSE column layout from observed pages
-    Log("ParseHistoricalHtml: no header found, using fallback column indices");
-    colDate = 1;
-    colOpen = 6;
-    colHigh = 4;
-    colLow = 5;
-    colClose = 7;
-    colVol = 11;
-    for (int r = 0; r < (int)rows.size() && r <= 300; ++r) {
-      if ((int)HtmlUtils::ParseTableRow(rows[r]).size() > 11) {
-        headerRow = r - 1;
-        break;
+    HistoryChunk chunk;
+    sprintf_s(chunk.startDate, "%04d-%02d-%02d", y, m, d);
+    sprintf_s(chunk.endDate, "%04d-%02d-%02d", py, pm, pd);
+    chunk.ok = false;
+    chunks.push_back(chunk);
+
+    // Advance to the day after this chunk
+    y = py;
+    m = pm;
+    d = pd + 1;
+    if (d > DaysInMonth(y, m)) {
+      d = 1;
+      if (++m > 12) {
+        m = 1;
+        ++y;
       }
     }
   }
+  return chunks;
+}
 
-  if (headerRow == -1) {
-    Log("ParseHistoricalHtml: could not find usable table structure");
-    return false;
+bool DseDataEngine::FetchHistoryChunk(const char *symbol, HistoryChunk &chunk) {
+  Trace::Span span("FetchHistoryChunk", "history");
+  // A window with no trading days (e.g. Eid holidays) has nothing to fetch
+  int sy, sm, sd, ey, em, ed;
+  if (ParseYmd(chunk.startDate, sy, sm, sd) &&
+      ParseYmd(chunk.endDate, ey, em, ed) &&
+      GetCalendar()->TradingDaysBetween(sy * 10000 + sm * 100 + sd,
+                                        ey * 10000 + em * 100 + ed) == 0) {
+    chunk.ok = true;
+    return true;
   }
 
-  int validCount = 0;
-  for (size_t r = (size_t)(headerRow + 1); r < rows.size(); ++r) {
-    auto cells = HtmlUtils::ParseTableRow(rows[r]);
+  std::string url = BuildHistoryUrl(symbol, chunk.startDate, chunk.endDate);
 
-    int maxIdx = std::max({colDate, colClose, colVol});
-    if ((int)cells.size() <= maxIdx)
-      continue;
+  const int retries = Config()->historyChunkRetries;
+  for (int attempt = 0; attempt <= retries; ++attempt) {
+    if (attempt > 0) {
+      Log("FetchHistoryChunk: retry %d for %s [%s -> %s]", attempt, symbol,
+          chunk.startDate, chunk.endDate);
+      Os::SleepMs(1000 * attempt);
+    }
 
-    const std::string &dateStr = cells[colDate];
-    if (dateStr.size() < 10)
+    std::string html;
+    if (!HttpGet(url.c_str(), html))
       continue;
 
-    DseBar bar;
-    memset(&bar, 0, sizeof(bar));
-    bar.year = (int)HtmlUtils::SafeStod(dateStr.substr(0, 4));
-    bar.month = (int)HtmlUtils::SafeStod(dateStr.substr(5, 2));
-    bar.day = (int)HtmlUtils::SafeStod(dateStr.substr(8, 2));
-
-    if (colOpen != -1 && colOpen < (int)cells.size())
-      bar.open = HtmlUtils::SafeStod(cells[colOpen]);
-    if (colHigh != -1 && colHigh < (int)cells.size())
-      bar.high = HtmlUtils::SafeStod(cells[colHigh]);
-    if (colLow != -1 && colLow < (int)cells.size())
-      bar.low = HtmlUtils::SafeStod(cells[colLow]);
-    if (colClose != -1 && colClose < (int)cells.size())
-      bar.close = HtmlUtils::SafeStod(cells[colClose]);
-    if (colVol != -1 && colVol < (int)cells.size())
-      bar.volume = HtmlUtils::SafeStod(cells[colVol]);
-
-    bar.valid = ValidateBar(bar);
-    if (bar.valid) {
-      outBars.push_back(bar);
-      ++validCount;
+    // Parse on arrival so the body is released before the next request.
+    // An archive table with no rows (e.g. a holiday-only quarter) is final;
+    // a page without one (error, maintenance, new layout) is retried.
+    bool foundTable = false;
+    if (symbol[0]) {
+      chunk.bars.clear();
+      ParseHistoricalHtml(html, chunk.bars, &foundTable);
+    } else {
+      chunk.bySymbol.clear();
+      ParseMarketHistoryHtml(html, chunk.bySymbol, &foundTable);
+    }
+    if (foundTable) {
+      chunk.ok = true;
+      return true;
     }
   }
+  return false;
+}
 
-  Log("ParseHistoricalHtml: %d valid bars", validCount);
-  return !outBars.empty();
+void DseDataEngine::ChunkWorker(ChunkFetchContext *ctx) {
+  for (;;) {
+    size_t idx = ctx->next.fetch_add(1);
+    if (idx >= ctx->chunks->size())
+      break;
+    ctx->engine->FetchHistoryChunk(ctx->symbol, (*ctx->chunks)[idx]);
+  }
 }
 
-bool DseDataEngine::ParseLatestPriceHtml(const std::string &html,
-                                         std::vector<DseQuote> &outQuotes) {
-  // Expected columns: # | TRADING CODE | LTP | HIGH | LOW | CLOSE |
-  //                   YCP | CHANGE | TRADE | VALUE(mn) | VOLUME
-  auto rows = HtmlUtils::ExtractTableRows(html);
-  if (rows.size() < 2) {
-    Log("ParseLatestPriceHtml: too few rows (%zu)", rows.size());
-    return false;
+void DseDataEngine::RunChunkWorkers(const char *symbol,
+                                    std::vector<HistoryChunk> &chunks) {
+  int threads = Config()->historyFetchThreads;
+  if (threads > (int)chunks.size())
+    threads = (int)chunks.size();
+
+  ChunkFetchContext ctx;
+  ctx.engine = this;
+  ctx.symbol = symbol;
+  ctx.chunks = &chunks;
+  ctx.next = 0;
+
+  std::vector<std::thread> workers;
+  for (int i = 0; i < threads; ++i) {
+    try {
+      workers.emplace_back([&ctx]() {
+        Trace::SetThreadName("history-chunk");
+        ChunkWorker(&ctx);
+      });
+    } catch (const std::system_error &) {
+      break;
+    }
   }
+  // If no worker could be created, drain the queue on this thread
+  if (workers.empty())
+    ChunkWorker(&ctx);
+  for (std::thread &t : workers)
+    t.join();
+}
 
-  int colSymbol = -1, colLtp = -1, colHigh = -1, colLow = -1;
-  int colClose = -1, colYcp = -1, colChange = -1;
-  int colTrade = -1, colValue = -1, colVolume = -1;
-
-  auto headerCells = HtmlUtils::ParseTableRow(rows[0]);
-  for (int i = 0; i < (int)headerCells.size(); ++i) {
-    std::string h = headerCells[i];
-    for (auto &c : h)
-      c = (char)toupper((unsigned char)c);
-
-    if (h.find("TRADING") != std::string::npos)
-      colSymbol = i;
-    else if (h.find("LTP") != std::string::npos)
-      colLtp = i;
-    else if (h.find("HIGH") != std::string::npos)
-      colHigh = i;
-    else if (h.find("LOW") != std::string::npos)
-      colLow = i;
-    else if (h.find("CLOSE") != std::string::npos &&
-             h.find("YCP") == std::string::npos)
-      colClose = i;
-    else if (h.find("YCP") != std::string::npos)
-      colYcp = i;
-    else if (h.find("CHANGE") != std::string::npos)
-      colChange = i;
-    else if (h.find("TRADE") != std::string::npos &&
-             h.find("TRADING") == std::string::npos)
-      colTrade = i;
-    else if (h.find("VALUE") != std::string::npos)
-      colValue = i;
-    else if (h.find("VOLUME") != std::string::npos)
-      colVolume = i;
-  }
-
-  // Fallback to observed column positions on dsebd.org
-  if (colSymbol < 0)
-    colSymbol = 1;
-  if (colLtp < 0)
-    colLtp = 2;
-  if (colHigh < 0)
-    colHigh = 3;
-  if (colLow < 0)
-    colLow = 4;
-  if (colClose < 0)
-    colClose = 5;
-  if (colYcp < 0)
-    colYcp = 6;
-  if (colChange < 0)
-    colChange = 7;
-  if (colTrade < 0)
-    colTrade = 8;
-  if (colValue < 0)
-    colValue = 9;
-  if (colVolume < 0)
-    colVolume = 10;
-
-  for (size_t r = 1; r < rows.size(); ++r) {
-    auto cells = HtmlUtils::ParseTableRow(rows[r]);
-    if (cells.empty())
-      continue;
+bool DseDataEngine::FetchWebHistory(const char *symbol, const char *startDate,
+                                    const char *endDate,
+                                    std::vector<DseBar> &outBars) {
+  std::vector<HistoryChunk> chunks =
+      SplitHistoryRange(startDate, endDate, Config()->historyChunkMonths);
+
+  // Unparseable dates or a short window: single request as before
+  if (chunks.size() <= 1) {
+    std::string url = BuildHistoryUrl(symbol, startDate, endDate);
+    std::string html;
+    if (!HttpGet(url.c_str(), html)) {
+      Log("ERROR: FetchWebHistory — HTTP failed for %s", symbol);
+      return false;
+    }
+    return ParseHistoricalHtml(html, outBars);
+  }
 
-    int maxCol = (int)cells.size();
-    DseQuote q;
-    memset(&q, 0, sizeof(q));
-    q.valid = true;
+  Log("FetchWebHistory: %s split into %zu chunks", symbol, chunks.size());
+  RunChunkWorkers(symbol, chunks);
 
-    if (colSymbol < maxCol) {
-      std::string sym = HtmlUtils::Trim(cells[colSymbol]);
-      strncpy_s(q.symbol, sym.c_str(), sizeof(q.symbol) - 1);
+  // Merge by date; chunks do not overlap, but pages can repeat boundary rows
+  std::map<int, DseBar> merged;
+  int failed = 0;
+  for (const auto &c : chunks) {
+    if (!c.ok) {
+      ++failed;
+      Log("WARNING: FetchWebHistory — chunk [%s -> %s] failed for %s",
+          c.startDate, c.endDate, symbol);
+      continue;
     }
+    for (const auto &b : c.bars)
+      merged[BarDateKey(b)] = b;
+  }
 
-    if (colLtp < maxCol)
-      q.ltp = HtmlUtils::SafeStod(cells[colLtp]);
-    if (colHigh < maxCol)
-      q.high = HtmlUtils::SafeStod(cells[colHigh]);
-    if (colLow < maxCol)
-      q.low = HtmlUtils::SafeStod(cells[colLow]);
-    if (colClose < maxCol)
-      q.close = HtmlUtils::SafeStod(cells[colClose]);
-    if (colYcp < maxCol)
-      q.ycp = HtmlUtils::SafeStod(cells[colYcp]);
-    if (colChange < maxCol)
-      q.change = HtmlUtils::SafeStod(cells[colChange]);
-    if (colTrade < maxCol)
-      q.trade = HtmlUtils::SafeStod(cells[colTrade]);
-    if (colValue < maxCol)
-      q.value = HtmlUtils::SafeStod(cells[colValue]);
-    if (colVolume < maxCol)
-      q.volume = HtmlUtils::SafeStod(cells[colVolume]);
+  outBars.reserve(outBars.size() + merged.size());
+  for (const auto &e : merged)
+    outBars.push_back(e.second);
 
-    if (q.ycp > 0)
-      q.changePercent = ((q.ltp - q.ycp) / q.ycp) * 100.0;
-    q.open = q.ycp; // open defaults to previous close when not provided
+  Log("FetchWebHistory: %zu bars for %s (%d/%zu chunks failed)",
+      outBars.size(), symbol, failed, chunks.size());
+  // A failed window would be cached as a hole that incremental backfill
+  // (dates after the last bar) never revisits, so the fetch as a whole
+  // fails and is retried
+  return failed == 0 && !outBars.empty();
+}
 
-    if (q.symbol[0] && q.ltp > 0)
-      outQuotes.push_back(q);
-  }
+// ---------------------------------------------------------------------------
+// HTML Parsers
+// ---------------------------------------------------------------------------
 
-  Log("ParseLatestPriceHtml: parsed %zu quotes", outQuotes.size());
-  return !outQuotes.empty();
+int DseDataEngine::ParseArchiveTable(
+    const std::string &html,
+    const std::function<void(const std::string &, const DseBar &)> &onRow) {
+  return DsePageParser::ParseArchiveTable(
+      html, onRow, [this](const char *msg) { Log("%s", msg); });
+}
+
+bool DseDataEngine::ParseHistoricalHtml(const std::string &html,
+                                        std::vector<DseBar> &outBars,
+                                        bool *foundTable) {
+  Metrics::ScopedTimer timer(Metrics::kHtmlParse);
+  size_t before = outBars.size();
+  int rows = ParseArchiveTable(
+      html, [&outBars](const std::string &, const DseBar &bar) {
+        outBars.push_back(bar);
+      });
+  if (foundTable)
+    *foundTable = rows >= 0;
+  if (rows < 0)
+    Metrics::Add(Metrics::kParseFailures);
+  Metrics::Add(Metrics::kHtmlBars, outBars.size() - before);
+  return !outBars.empty();
+}
+
+bool DseDataEngine::ParseMarketHistoryHtml(
+    const std::string &html,
+    std::map<std::string, std::vector<DseBar>> &outBySymbol,
+    bool *foundTable) {
+  Metrics::ScopedTimer timer(Metrics::kHtmlParse);
+  int rows = ParseArchiveTable(
+      html, [&outBySymbol](const std::string &sym, const DseBar &bar) {
+        if (!sym.empty())
+          outBySymbol[sym].push_back(bar);
+      });
+  if (foundTable)
+    *foundTable = rows >= 0;
+  if (rows < 0)
+    Metrics::Add(Metrics::kParseFailures);
+  else
+    Metrics::Add(Metrics::kHtmlBars, (uint64_t)rows);
+  Log("ParseMarketHistoryHtml: %d rows into %zu symbols", rows,
+      outBySymbol.size());
+  return !outBySymbol.empty();
+}
+
+bool DseDataEngine::ParseLatestPriceHtml(const std::string &html,
+                                         std::vector<DseQuote> &outQuotes) {
+  Metrics::ScopedTimer timer(Metrics::kHtmlParse);
+  bool ok = DsePageParser::ParseLatestPriceHtml(
+      html, outQuotes, [this](const char *msg) { Log("%s", msg); });
+  Metrics::Add(Metrics::kQuotes, outQuotes.size());
+  if (!ok)
+    Metrics::Add(Metrics::kParseFailures);
+  return ok;
 }
 
 // ---------------------------------------------------------------------------
@@ -575,6 +1013,7 @@ bool DseDataEngine::FetchHistoricalData(const char *symbol,
                                         const char *endDate,
                                         std::vector<DseBar> &outBars,
                                         std::function<void()> onProgress) {
+  Trace::Span span("FetchHistoricalData", "history");
   Log("FetchHistoricalData: %s [%s -> %s]", symbol, startDate, endDate);
   outBars.clear();
 
@@ -583,9 +1022,12 @@ bool DseDataEngine::FetchHistoricalData(const char *symbol,
     return FetchAmarstockIndexData(symbol, startDate, endDate, outBars,
                                    onProgress);
 
+  // One config snapshot for the whole fetch
+  std::shared_ptr<const DseConfig> cfg = Config();
+
   // 1. Load local CSV seed
   std::vector<DseBar> seedBars;
-  if (CsvUtils::LoadCsvSeed(symbol, m_config.csvSeedPath, seedBars)) {
+  if (LoadSeed(symbol, *cfg, seedBars)) {
     std::sort(seedBars.begin(), seedBars.end(),
               [](const DseBar &a, const DseBar &b) {
                 if (a.year != b.year)
@@ -598,39 +1040,65 @@ bool DseDataEngine::FetchHistoricalData(const char *symbol,
         symbol);
   }
 
-  // 2. Fetch from web
-  std::string url = BuildHistoryUrl(symbol, startDate, endDate);
-  std::string html;
+  // 2. Fetch from web (long windows are split into parallel chunks),
+  // unless another instance already downloaded this window or the desk's
+  // dse_proxyd can answer
   std::vector<DseBar> webBars;
+  int y, m, d;
+  int startKey = ParseYmd(startDate, y, m, d) ? y * 10000 + m * 100 + d : 0;
+  int endKey = ParseYmd(endDate, y, m, d) ? y * 10000 + m * 100 + d : 0;
+  bool shareable = startKey && endKey;
   bool webSuccess = false;
-
-  if (HttpGet(url.c_str(), html)) {
-    if (ParseHistoricalHtml(html, webBars)) {
-      Log("FetchHistoricalData: %zu bars from web for %s", webBars.size(),
-          symbol);
+  if (shareable && m_bus.ReadBars(symbol, startKey, endKey, webBars)) {
+    webSuccess = true;
+    Metrics::Add(Metrics::kBusBarHits, 1);
+    Log("FetchHistoricalData: %zu bars from %s for %s", webBars.size(),
+        cfg->sharedBusName, symbol);
+  } else {
+    if (m_proxy.IsConnected() &&
+        m_proxy.FetchHistory(symbol, startDate, endDate, webBars,
+                             cfg->proxyTimeoutSec * 1000)) {
       webSuccess = true;
+      Metrics::Add(Metrics::kProxyHistory, 1);
+      Log("FetchHistoricalData: %zu bars from dse_proxyd for %s",
+          webBars.size(), symbol);
     } else {
-      Log("WARNING: FetchHistoricalData — HTML parse failed for %s", symbol);
+      webSuccess = FetchWebHistory(symbol, startDate, endDate, webBars);
+      if (webSuccess)
+        Log("FetchHistoricalData: %zu bars from web for %s", webBars.size(),
+            symbol);
+    }
+    if (webSuccess) {
+      if (shareable)
+        m_bus.PublishBars(symbol, startKey, endKey, webBars);
+    } else {
+      // Partial chunks must not reach the cache as a series with holes
+      webBars.clear();
+      Log("WARNING: FetchHistoricalData — no web data for %s", symbol);
     }
-  } else {
-    Log("ERROR: FetchHistoricalData — HTTP failed for %s", symbol);
   }
 
   if (seedBars.empty() && !webSuccess)
     return false;
 
   // 3. Merge by date key, preferWebData controls which source wins on overlap
+  Metrics::ScopedTimer mergeTimer(Metrics::kCacheMerge);
   std::map<int, DseBar> merged;
-  if (m_config.preferWebData) {
+  if (cfg->preferWebData) {
     for (const auto &b : seedBars)
-      merged[b.year * 10000 + b.month * 100 + b.day] = b;
+      merged[BarDateKey(b)] = b;
     for (const auto &b : webBars)
-      merged[b.year * 10000 + b.month * 100 + b.day] = b;
+      merged[BarDateKey(b)] = b;
   } else {
     for (const auto &b : webBars)
-      merged[b.year * 10000 + b.month * 100 + b.day] = b;
-    for (const auto &b : seedBars)
-      merged[b.year * 10000 + b.month * 100 + b.day] = b;
+      merged[BarDateKey(b)] = b;
+    // A cached seed (market file) may end in provisional bars; the
+    // archive's rows replace them
+    for (const auto &b : seedBars) {
+      auto cur = merged.find(BarDateKey(b));
+      if (cur == merged.end() || !b.provisional)
+        merged[BarDateKey(b)] = b;
+    }
   }
 
   outBars.clear();
@@ -641,36 +1109,351 @@ bool DseDataEngine::FetchHistoricalData(const char *symbol,
   Log("FetchHistoricalData: merged %zu bars for %s", outBars.size(), symbol);
 
   // 4. Update cache
-  {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_cache[symbol] = outBars;
+  m_cache.Put(symbol, outBars);
+  Metrics::Add(Metrics::kBarsMerged, outBars.size());
+
+  return true;
+}
+
+bool DseDataEngine::LoadSeed(const char *symbol, const DseConfig &cfg,
+                             std::vector<DseBar> &outBars) {
+  if (!cfg.marketSeedFile[0]) {
+    Metrics::ScopedTimer timer(Metrics::kCsvParse);
+    bool ok = CsvUtils::LoadCsvSeed(symbol, cfg.csvSeedPath, outBars);
+    Metrics::Add(Metrics::kCsvBars, outBars.size());
+    return ok;
   }
 
+  // The market file's series already live in the cache; the cached series
+  // (seed plus anything fetched since) is this symbol's seed
+  if (!HandOverMarketSeeds(cfg))
+    return false;
+  return m_cache.Get(symbol, outBars) && !outBars.empty();
+}
+
+bool DseDataEngine::HandOverMarketSeeds(const DseConfig &cfg) {
+  // Callers racing the first load wait for it rather than parse twice
+  std::lock_guard<std::mutex> lock(m_seedMutex);
+  if (m_marketSeedPath == cfg.marketSeedFile)
+    return m_marketSeedsOk;
+
+  std::map<std::string, std::vector<DseBar>> seeds;
+  CsvSeedLoader::Stats st = CsvSeedLoader::LoadMarketFile(
+      cfg.marketSeedFile, cfg.seedThreads, seeds);
+  m_marketSeedPath = cfg.marketSeedFile;
+  m_marketSeedsOk = st.files > 0;
+  if (!m_marketSeedsOk) {
+    Log("ERROR: MarketSeeds — cannot read %s", cfg.marketSeedFile);
+    return false;
+  }
+  Metrics::Record(Metrics::kCsvParse, (uint64_t)(st.seconds * 1e6));
+  Metrics::Add(Metrics::kCsvBars, st.rows);
+  Log("MarketSeeds: %s — %zu symbols, %zu rows, %.1f MB in %.0f ms "
+      "(%.0f rows/s, %.1f MB/s)",
+      cfg.marketSeedFile, seeds.size(), st.rows,
+      st.bytes / (1024.0 * 1024.0), st.seconds * 1000.0, st.RowsPerSec(),
+      st.MBPerSec());
+
+  // One copy of the history, not one here and one in the cache. Seed rows
+  // fill dates the cache lacks and replace provisional bars; on other
+  // overlaps preferWebData decides, as in FetchHistoricalData.
+  const bool preferWeb = cfg.preferWebData;
+  Metrics::ScopedTimer timer(Metrics::kCacheMerge);
+  for (auto it = seeds.begin(); it != seeds.end(); it = seeds.erase(it)) {
+    std::sort(it->second.begin(), it->second.end(),
+              [](const DseBar &a, const DseBar &b) {
+                return BarDateKey(a) < BarDateKey(b);
+              });
+    m_cache.Update(it->first, true, [&](std::vector<DseBar> &dst) {
+      if (dst.empty()) {
+        dst.swap(it->second);
+        return;
+      }
+      std::map<int, DseBar> merged;
+      for (const auto &b : dst)
+        merged[BarDateKey(b)] = b;
+      for (const auto &b : it->second) {
+        auto cur = merged.find(BarDateKey(b));
+        if (cur == merged.end() || !preferWeb || cur->second.provisional)
+          merged[BarDateKey(b)] = b;
+      }
+      dst.clear();
+      dst.reserve(merged.size());
+      for (const auto &m : merged)
+        dst.push_back(m.second);
+    });
+  }
   return true;
 }
 
+int DseDataEngine::FetchMarketHistory(const char *startDate,
+                                      const char *endDate,
+                                      int *failedWindows) {
+  Trace::Span span("FetchMarketHistory", "history");
+  Log("FetchMarketHistory: [%s -> %s]", startDate, endDate);
+  std::shared_ptr<const DseConfig> cfg = Config();
+
+  std::vector<HistoryChunk> chunks =
+      SplitHistoryRange(startDate, endDate, cfg->marketChunkMonths);
+  if (chunks.empty()) {
+    Log("ERROR: FetchMarketHistory — invalid date range");
+    if (failedWindows)
+      *failedWindows = 0;
+    return 0;
+  }
+  RunChunkWorkers("", chunks);
+
+  // One more round for windows that exhausted their retries while the
+  // others were downloading (server overload is the usual cause)
+  std::vector<HistoryChunk> again;
+  for (const auto &c : chunks)
+    if (!c.ok)
+      again.push_back(c);
+  if (!again.empty()) {
+    Log("FetchMarketHistory: retrying %zu failed windows", again.size());
+    RunChunkWorkers("", again);
+    size_t k = 0;
+    for (auto &c : chunks)
+      if (!c.ok)
+        c = std::move(again[k++]);
+  }
+
+  // Gather every chunk's rows per symbol, keyed by date
+  std::map<std::string, std::map<int, DseBar>> bySymbol;
+  int failed = 0;
+  for (auto &c : chunks) {
+    if (!c.ok) {
+      ++failed;
+      Log("WARNING: FetchMarketHistory — chunk [%s -> %s] failed",
+          c.startDate, c.endDate);
+      continue;
+    }
+    for (auto &e : c.bySymbol) {
+      auto &dst = bySymbol[e.first];
+      for (const auto &b : e.second)
+        dst[BarDateKey(b)] = b;
+    }
+    c.bySymbol.clear();
+  }
+
+  // Only scatter into symbols the plugin knows about (the archive also lists
+  // bonds and debentures that never appear on the live page)
+  std::shared_ptr<const std::vector<std::string>> known =
+      std::atomic_load(&m_symbols);
+  if (known && !known->empty()) {
+    for (auto it = bySymbol.begin(); it != bySymbol.end();) {
+      if (!std::binary_search(known->begin(), known->end(), it->first))
+        it = bySymbol.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  // Symbols seen for the first time get their CSV seed loaded (outside any
+  // lock, in parallel) so the merged series matches what
+  // FetchHistoricalData would build. A market-wide seed file goes straight
+  // into the cache, so the merge below builds on it.
+  std::map<std::string, std::vector<DseBar>> seeds;
+  std::vector<std::string> unseeded;
+  if (cfg->marketSeedFile[0])
+    HandOverMarketSeeds(*cfg);
+  for (const auto &e : bySymbol) {
+    if (!m_cache.Contains(e.first))
+      unseeded.push_back(e.first);
+  }
+  if (!unseeded.empty() && !cfg->marketSeedFile[0] && cfg->csvSeedPath[0]) {
+    CsvSeedLoader::Stats st = CsvSeedLoader::LoadMany(
+        cfg->csvSeedPath, unseeded, cfg->seedThreads, seeds);
+    Metrics::Record(Metrics::kCsvParse, (uint64_t)(st.seconds * 1e6));
+    Metrics::Add(Metrics::kCsvBars, st.rows);
+    Log("FetchMarketHistory: %d seed files, %zu rows in %.0f ms "
+        "(%.0f rows/s, %.1f MB/s)",
+        st.files, st.rows, st.seconds * 1000.0, st.RowsPerSec(),
+        st.MBPerSec());
+  }
+
+  // Each symbol is merged under its own shard lock, so GetQuotesEx on other
+  // symbols keeps running while a large backfill lands
+  int updated = 0;
+  const bool preferWeb = cfg->preferWebData;
+  for (auto &e : bySymbol) {
+    auto seed = seeds.find(e.first);
+    Metrics::ScopedTimer timer(Metrics::kCacheMerge);
+    m_cache.Update(e.first, true, [&](std::vector<DseBar> &dst) {
+      std::map<int, DseBar> merged;
+      if (!dst.empty()) {
+        for (const auto &b : dst)
+          merged[BarDateKey(b)] = b;
+      } else if (seed != seeds.end()) {
+        for (const auto &b : seed->second)
+          merged[BarDateKey(b)] = b;
+      }
+
+      // preferWebData decides overlaps; otherwise web only fills the gaps.
+      // Provisional bars from the live page always yield to the archive.
+      for (const auto &w : e.second) {
+        auto cur = merged.find(w.first);
+        if (preferWeb || cur == merged.end() || cur->second.provisional)
+          merged[w.first] = w.second;
+      }
+
+      dst.clear();
+      dst.reserve(merged.size());
+      for (const auto &m : merged)
+        dst.push_back(m.second);
+      Metrics::Add(Metrics::kBarsMerged, dst.size());
+    });
+    ++updated;
+  }
+
+  Log("FetchMarketHistory: %d symbols updated from %zu requests "
+      "(%d failed)",
+      updated, chunks.size(), failed);
+  if (failedWindows)
+    *failedWindows = failed;
+  return updated;
+}
+
+int DseDataEngine::AppendSessionBars(const std::vector<DseQuote> &quotes,
+                                     int year, int month, int day) {
+  Metrics::ScopedTimer timer(Metrics::kCacheMerge);
+  Trace::Span span("AppendSessionBars", "feed");
+  int appended = 0;
+
+  for (const auto &q : quotes) {
+    // Symbols that did not trade today have no archive row either
+    if (!q.symbol[0] || q.ltp <= 0 || q.volume <= 0)
+      continue;
+
+    DseBar bar;
+    memset(&bar, 0, sizeof(bar));
+    bar.year = year;
+    bar.month = month;
+    bar.day = day;
+    bar.close = (q.close > 0) ? q.close : q.ltp;
+    bar.high = (q.high > 0) ? q.high : bar.close;
+    bar.low = (q.low > 0) ? q.low : bar.close;
+    bar.open = (q.open > 0) ? q.open : bar.close;
+    if (bar.open > bar.high)
+      bar.open = bar.high;
+    if (bar.open < bar.low)
+      bar.open = bar.low;
+    bar.volume = q.volume;
+    bar.trade = q.trade;
+    bar.value = q.value;
+    bar.valid = DsePageParser::ValidateBar(bar);
+    bar.provisional = true;
+    if (!bar.valid)
+      continue;
+
+    // Only extend series that already hold history; a lone bar would make
+    // GetQuotesEx believe the symbol is backfilled
+    bool changed = false;
+    m_cache.Update(q.symbol, false, [&](std::vector<DseBar> &series) {
+      if (series.empty())
+        return false;
+      const int key = BarDateKey(bar);
+      const int lastKey = BarDateKey(series.back());
+      if (key > lastKey) {
+        series.push_back(bar);
+      } else if (key == lastKey) {
+        if (!series.back().provisional)
+          return false; // archive data already present for this date
+        series.back() = bar;
+      } else {
+        return false; // never rewrite the middle of a series
+      }
+      changed = true;
+      return true;
+    });
+    if (changed)
+      ++appended;
+  }
+
+  Metrics::Add(Metrics::kBarsMerged, (uint64_t)appended);
+  Log("AppendSessionBars: %04d-%02d-%02d — %d provisional bars appended",
+      year, month, day, appended);
+  return appended;
+}
+
+bool DseDataEngine::HasProvisionalBars() {
+  bool found = false;
+  m_cache.ForEach(
+      [&found](const std::string &, const std::vector<DseBar> &bars) {
+        if (!bars.empty() && bars.back().provisional)
+          found = true;
+      });
+  return found;
+}
+
+int DseDataEngine::ReconcileProvisionalBars() {
+  int minKey = 0, maxKey = 0;
+  m_cache.ForEach([&](const std::string &, const std::vector<DseBar> &bars) {
+    // Provisional bars are only ever appended at the tail
+    for (auto it = bars.rbegin(); it != bars.rend() && it->provisional; ++it) {
+      int key = BarDateKey(*it);
+      if (!minKey || key < minKey)
+        minKey = key;
+      if (key > maxKey)
+        maxKey = key;
+    }
+  });
+  if (!minKey)
+    return 0;
+
+  char startDate[16], endDate[16];
+  sprintf_s(startDate, "%04d-%02d-%02d", minKey / 10000, (minKey / 100) % 100,
+            minKey % 100);
+  sprintf_s(endDate, "%04d-%02d-%02d", maxKey / 10000, (maxKey / 100) % 100,
+            maxKey % 100);
+  Log("ReconcileProvisionalBars: [%s -> %s]", startDate, endDate);
+  return FetchMarketHistory(startDate, endDate);
+}
+
 bool DseDataEngine::GetCachedBars(const char *symbol,
                                   std::vector<DseBar> &outBars) {
-  std::lock_guard<std::mutex> lock(m_mutex);
-  auto it = m_cache.find(symbol);
-  if (it == m_cache.end())
-    return false;
-  outBars = it->second;
-  return !outBars.empty();
+  return m_cache.Get(symbol, outBars) && !outBars.empty();
 }
 
 // ---------------------------------------------------------------------------
 // Real-Time Data
 // ---------------------------------------------------------------------------
 
-bool DseDataEngine::FetchLatestQuotes(std::vector<DseQuote> &outQuotes) {
+bool DseDataEngine::FetchLatestQuotes(std::vector<DseQuote> &outQuotes,
+                                      std::string *outPage) {
+  // The desk's dse_proxyd pushes the board; a caller recording pages
+  // needs the page itself
+  uint64_t seq = 0;
+  if (!outPage && m_proxy.GetQuotes(outQuotes, seq)) {
+    Metrics::Add(Metrics::kProxyQuoteReads, 1);
+    Log("FetchLatestQuotes: %zu quotes from dse_proxyd #%llu",
+        outQuotes.size(), (unsigned long long)seq);
+    return true;
+  }
+
+  // Another instance on this workstation may be polling already
+  bool writer = m_bus.TryAcquireWriter();
+  if (!writer && !outPage && m_bus.ReadQuotes(outQuotes, seq)) {
+    Metrics::Add(Metrics::kBusQuoteReads, 1);
+    Log("FetchLatestQuotes: %zu quotes from %s #%llu", outQuotes.size(),
+        Config()->sharedBusName, (unsigned long long)seq);
+    return true;
+  }
+
   Log("FetchLatestQuotes: fetching all");
   std::string html;
-  if (!HttpGet(m_config.latestPriceUrl, html)) {
+  if (!HttpGet(Config()->latestPriceUrl, html)) {
     Log("ERROR: FetchLatestQuotes — HTTP failed");
     return false;
   }
-  return ParseLatestPriceHtml(html, outQuotes);
+  if (outPage)
+    *outPage = html;
+  if (!ParseLatestPriceHtml(html, outQuotes))
+    return false;
+  if (writer && !m_bus.PublishQuotes(outQuotes))
+    Log("WARNING: FetchLatestQuotes — lost the %s writer role",
+        Config()->sharedBusName);
+  return true;
 }
 
 bool DseDataEngine::FetchLatestQuote(const char *symbol, DseQuote &outQuote) {
@@ -692,10 +1475,17 @@ bool DseDataEngine::FetchLatestQuote(const char *symbol, DseQuote &outQuote) {
 // Symbol Management
 // ---------------------------------------------------------------------------
 
-const std::vector<std::string> &DseDataEngine::GetSymbolList() {
-  if (m_symbols.empty())
+std::shared_ptr<const std::vector<std::string>>
+DseDataEngine::GetSymbolList() {
+  std::shared_ptr<const std::vector<std::string>> symbols =
+      std::atomic_load(&m_symbols);
+  if (!symbols || symbols->empty()) {
     RefreshSymbolList();
-  return m_symbols;
+    symbols = std::atomic_load(&m_symbols);
+  }
+  if (!symbols)
+    symbols = std::make_shared<const std::vector<std::string>>();
+  return symbols;
 }
 
 bool DseDataEngine::RefreshSymbolList() {
@@ -704,22 +1494,24 @@ bool DseDataEngine::RefreshSymbolList() {
   if (!FetchLatestQuotes(quotes))
     return false;
 
-  std::lock_guard<std::mutex> lock(m_mutex);
-  std::vector<std::string> fetched;
+  auto fetched = std::make_shared<std::vector<std::string>>();
   for (const auto &q : quotes)
     if (q.symbol[0])
-      fetched.push_back(q.symbol);
+      fetched->push_back(q.symbol);
 
   // Amarstock indices are not listed on the DSE live page — inject them
   // manually
-  fetched.push_back("00DS30");
-  fetched.push_back("00DSES");
-  fetched.push_back("00DSEX");
-  fetched.push_back("00DSMEX");
-
-  std::sort(fetched.begin(), fetched.end());
-  m_symbols = fetched;
-  Log("RefreshSymbolList: %zu symbols", m_symbols.size());
+  fetched->push_back("00DS30");
+  fetched->push_back("00DSES");
+  fetched->push_back("00DSEX");
+  fetched->push_back("00DSMEX");
+
+  std::sort(fetched->begin(), fetched->end());
+
+  // Readers holding the previous list keep it until they drop it
+  std::atomic_store(&m_symbols,
+                    std::shared_ptr<const std::vector<std::string>>(fetched));
+  Log("RefreshSymbolList: %zu symbols", fetched->size());
   return true;
 }
 
@@ -728,19 +1520,15 @@ bool DseDataEngine::RefreshSymbolList() {
 // ---------------------------------------------------------------------------
 
 bool DseDataEngine::IsMarketOpen() const {
-  SYSTEMTIME st;
-  GetLocalTime(&st);
-
-  // Convert to minutes-since-midnight for easy range check
-  int now = st.wHour * 60 + st.wMinute;
-  int open = m_config.marketOpenHour * 60 + m_config.marketOpenMinute;
-  int close = m_config.marketCloseHour * 60 + m_config.marketCloseMinute;
+  MarketClock::Time now = m_clock.Now();
 
-  // DSE trades Sunday–Thursday (wDayOfWeek: Sun=0 ... Sat=6)
-  if (st.wDayOfWeek == 5 || st.wDayOfWeek == 6)
+  // Weekends and holidays come from the calendar, as do special hours
+  int openSec, closeSec;
+  if (!GetCalendar()->GetSession(now.date, openSec, closeSec))
     return false;
 
-  return (now >= open && now <= close);
+  // Open through the whole closing minute
+  return (now.secOfDay >= openSec && now.secOfDay < closeSec + 60);
 }
 
 // ---------------------------------------------------------------------------
@@ -769,51 +1557,36 @@ bool DseDataEngine::FetchAmarstockIndexData(const char *symbol,
     return false;
   }
 
-  SYSTEMTIME st = {0}, endSt = {0};
-  st.wYear = (WORD)sy;
-  st.wMonth = (WORD)sm;
-  st.wDay = (WORD)sd;
-  endSt.wYear = (WORD)ey;
-  endSt.wMonth = (WORD)em;
-  endSt.wDay = (WORD)ed;
-
-  FILETIME ftCur, ftEnd;
-  SystemTimeToFileTime(&st, &ftCur);
-  SystemTimeToFileTime(&endSt, &ftEnd);
-
-  ULARGE_INTEGER uCur, uEnd;
-  uCur.LowPart = ftCur.dwLowDateTime;
-  uCur.HighPart = ftCur.dwHighDateTime;
-  uEnd.LowPart = ftEnd.dwLowDateTime;
-  uEnd.HighPart = ftEnd.dwHighDateTime;
+  int curDay = TradingCalendar::ToDayNumber(sy * 10000 + sm * 100 + sd);
+  int endDay = TradingCalendar::ToDayNumber(ey * 10000 + em * 100 + ed);
 
   // Seed outBars with whatever is already cached
-  {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto it = m_cache.find(symbol);
-    if (it != m_cache.end())
-      outBars = it->second;
-  }
+  m_cache.Get(symbol, outBars);
+  std::shared_ptr<const TradingCalendar> calendar = GetCalendar();
 
   int daysFetched = 0, missingDays = 0;
 
-  while (uCur.QuadPart <= uEnd.QuadPart) {
-    FileTimeToSystemTime(&ftCur, &st);
+  for (; curDay <= endDay; ++curDay) {
+    int ymd = TradingCalendar::FromDayNumber(curDay);
+    int year = ymd / 10000, month = (ymd / 100) % 100, day = ymd % 100;
 
     // Skip if this day is already in cache
     bool haveIt = false;
     for (const auto &bar : outBars) {
-      if (bar.year == st.wYear && bar.month == st.wMonth &&
-          bar.day == st.wDay) {
+      if (bar.year == year && bar.month == month && bar.day == day) {
         haveIt = true;
         break;
       }
     }
 
+    // No index bar exists for weekends and holidays; don't ask
+    if (!haveIt && !calendar->IsTradingDay(ymd))
+      haveIt = true;
+
     if (!haveIt) {
       ++missingDays;
       char curDate[32];
-      sprintf_s(curDate, "%04d-%02d-%02d", st.wYear, st.wMonth, st.wDay);
+      sprintf_s(curDate, "%04d-%02d-%02d", year, month, day);
 
       char payload[256];
       sprintf_s(payload, "date=%s&type=adjusted", curDate);
@@ -823,7 +1596,13 @@ bool DseDataEngine::FetchAmarstockIndexData(const char *symbol,
                    body) &&
           body.size() > 50) {
         std::vector<DseBar> parsed;
-        if (CsvUtils::ParseAmarstockCsv(body, symbol, parsed)) {
+        bool ok;
+        {
+          Metrics::ScopedTimer timer(Metrics::kCsvParse);
+          ok = CsvUtils::ParseAmarstockCsv(body, symbol, parsed);
+        }
+        Metrics::Add(Metrics::kCsvBars, parsed.size());
+        if (ok) {
           outBars.insert(outBars.end(), parsed.begin(), parsed.end());
           ++daysFetched;
           Log("FetchAmarstockIndexData: bar for %s (total=%zu)", curDate,
@@ -832,19 +1611,15 @@ bool DseDataEngine::FetchAmarstockIndexData(const char *symbol,
           // Insert a placeholder so we don't re-fetch this empty day
           DseBar placeholder;
           memset(&placeholder, 0, sizeof(placeholder));
-          placeholder.year = st.wYear;
-          placeholder.month = st.wMonth;
-          placeholder.day = st.wDay;
+          placeholder.year = year;
+          placeholder.month = month;
+          placeholder.day = day;
           placeholder.valid = false;
           outBars.push_back(placeholder);
         }
       }
-      Sleep(50); // gentle rate-limiting
+      Os::SleepMs(50); // gentle rate-limiting
     }
-
-    uCur.QuadPart += 864000000000ULL; // advance by one day (100-ns units)
-    ftCur.dwLowDateTime = uCur.LowPart;
-    ftCur.dwHighDateTime = uCur.HighPart;
   }
 
   // Sort and update cache in one shot
@@ -856,10 +1631,7 @@ bool DseDataEngine::FetchAmarstockIndexData(const char *symbol,
                 return a.month < b.month;
               return a.day < b.day;
             });
-  {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_cache[symbol] = outBars;
-  }
+  m_cache.Put(symbol, outBars);
 
   Log("FetchAmarstockIndexData: done — requested=%d fetched=%d total=%zu",
       missingDays, daysFetched, outBars.size());
@@ -875,34 +1647,72 @@ bool DseDataEngine::FetchAmarstockIndexData(const char *symbol,
 // ---------------------------------------------------------------------------
 
 void DseDataEngine::CheckAutoExport() {
-  if (m_config.exportIntervalSec <= 0 || !m_config.exportPath[0])
+  std::shared_ptr<const DseConfig> cfg = Config();
+  if (cfg->exportIntervalSec <= 0 || !cfg->exportPath[0])
     return;
   time_t now = time(NULL);
-  if (now - m_lastExportTime >= m_config.exportIntervalSec) {
-    ExportAllDataToCsv();
+  if (now - m_lastExportTime < cfg->exportIntervalSec)
+    return;
+
+  // Only symbols written since the last pass; a pass still running just
+  // pushes this one to the next call
+  std::string path = cfg->exportPath;
+  if (m_exporter.Export(m_cache, path.c_str(), false, cfg->exportAppend,
+                        [this, path](const CsvExporter::Stats &st) {
+                          LogExportStats("CheckAutoExport", path, st);
+                          WriteArrowFile(path);
+                        }))
     m_lastExportTime = now;
-  }
 }
 
 void DseDataEngine::ExportAllDataToCsv() {
-  if (!m_config.exportPath[0])
+  std::shared_ptr<const DseConfig> cfg = Config();
+  if (!cfg->exportPath[0])
     return;
 
-  // Snapshot the cache so we hold the lock for minimum time
-  std::map<std::string, std::vector<DseBar>> snapshot;
-  {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    snapshot = m_cache;
-  }
-
-  if (snapshot.empty()) {
+  if (m_cache.Size() == 0) {
     Log("ExportAllDataToCsv: cache empty, nothing to export");
     return;
   }
 
-  int count = CsvUtils::ExportAllDataToCsv(snapshot, m_config.exportPath);
-  Log("ExportAllDataToCsv: exported %d files to %s", count,
-      m_config.exportPath);
+  std::string path = cfg->exportPath;
+  if (!m_exporter.Export(m_cache, path.c_str(), true, cfg->exportAppend,
+                         [this, path](const CsvExporter::Stats &st) {
+                           LogExportStats("ExportAllDataToCsv", path, st);
+                           WriteArrowFile(path);
+                         }))
+    Log("WARNING: ExportAllDataToCsv — an export is already running");
+}
+
+void DseDataEngine::LogExportStats(const char *who, const std::string &path,
+                                   const CsvExporter::Stats &st) {
+  Log("%s: %s in %d ms — %d rewritten, %d appended, %d tail-rewritten, "
+      "%d unchanged, %d failed",
+      who, path.c_str(), st.elapsedMs, st.rewritten, st.appended,
+      st.tailRewritten, st.unchanged, st.failed);
+}
+
+void DseDataEngine::WriteArrowFile(const std::string &dir) {
+  std::shared_ptr<const DseConfig> cfg = Config();
+  if (!cfg->arrowFile[0])
+    return;
+
+  // Back-to-back passes finish on different workers; one file at a time
+  std::lock_guard<std::mutex> lock(m_arrowMutex);
+  uint64_t start = Os::MonotonicMs();
+  ArrowBarWriter writer;
+  m_cache.ForEach([&writer](const std::string &sym,
+                            const std::vector<DseBar> &bars) {
+    writer.AddSeries(sym, bars);
+  });
+  std::string path = Os::JoinPath(dir, cfg->arrowFile);
+  if (!writer.Write(path.c_str())) {
+    Log("ERROR: WriteArrowFile — could not write %s", path.c_str());
+    return;
+  }
+  Log("WriteArrowFile: %s — %zu symbols, %zu rows in %lu ms", path.c_str(),
+      writer.SymbolCount(), writer.RowCount(),
+      (unsigned long)(Os::MonotonicMs() - start));
 }
 
 // ---------------------------------------------------------------------------
@@ -910,15 +1720,15 @@ void DseDataEngine::ExportAllDataToCsv() {
 // ---------------------------------------------------------------------------
 
 void DseDataEngine::Log(const char *fmt, ...) {
-  if (!m_config.enableLogging && !m_logFile)
+  std::shared_ptr<const DseConfig> cfg = Config();
+  if (cfg && !cfg->enableLogging && !m_logFile)
     return;
 
-  SYSTEMTIME st;
-  GetLocalTime(&st);
+  Os::LocalTime st = Os::LocalNow();
 
   char timestamp[64];
-  sprintf_s(timestamp, "[%04d-%02d-%02d %02d:%02d:%02d] ", st.wYear, st.wMonth,
-            st.wDay, st.wHour, st.wMinute, st.wSecond);
+  sprintf_s(timestamp, "[%04d-%02d-%02d %02d:%02d:%02d] ", st.year, st.month,
+            st.day, st.hour, st.minute, st.second);
 
   va_list args;
   va_start(args, fmt);
@@ -926,12 +1736,15 @@ void DseDataEngine::Log(const char *fmt, ...) {
   vsnprintf(message, sizeof(message), fmt, args);
   va_end(args);
 
-  if (m_logFile) {
-    fprintf(m_logFile, "%s%s\n", timestamp, message);
-    fflush(m_logFile);
+  {
+    std::lock_guard<std::mutex> lock(m_logMutex);
+    if (m_logFile) {
+      fprintf(m_logFile, "%s%s\n", timestamp, message);
+      fflush(m_logFile);
+    }
   }
 
-  OutputDebugStringA(timestamp);
-  OutputDebugStringA(message);
-  OutputDebugStringA("\n");
+  Os::DebugOutput(timestamp);
+  Os::DebugOutput(message);
+  Os::DebugOutput("\n");
 }
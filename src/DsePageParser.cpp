@@ -0,0 +1,284 @@
+// DsePageParser.cpp — dsebd.org Page Parsers
+
+#include "DsePageParser.h"
+#include "HtmlUtils.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// Format and hand one line to log; free when no sink is attached
+void Emit(const DsePageParser::LogFn &log, const char *fmt, ...) {
+  if (!log)
+    return;
+  char buf[512];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  log(buf);
+}
+
+} // namespace
+
+namespace DsePageParser {
+
+bool ValidateBar(const DseBar &bar) {
+  const double MIN = 0.01;
+  return bar.open >= MIN && bar.high >= MIN && bar.low >= MIN &&
+         bar.close >= MIN && bar.high >= bar.low && bar.year >= 1990 &&
+         bar.year <= 2100 && bar.month >= 1 && bar.month <= 12 &&
+         bar.day >= 1 && bar.day <= 31;
+}
+
+// Walks the day_end_archive table once and hands every valid row to onRow
+// together with its TRADING CODE cell (empty when the page has no such
+// column). Shared by the per-symbol and the market-wide parsers.
+int ParseArchiveTable(const std::string &html, const RowFn &onRow,
+                      const LogFn &log) {
+  Emit(log, "ParseArchiveTable: input=%zu bytes", html.size());
+
+  std::string tableHtml = HtmlUtils::ExtractTargetTable(html);
+  auto rows = HtmlUtils::ExtractTableRows(tableHtml);
+  Emit(log, "ParseArchiveTable: %zu rows extracted", rows.size());
+
+  // Detect column indices from header row
+  int colDate = -1, colOpen = -1, colHigh = -1, colLow = -1;
+  int colClose = -1, colVol = -1, headerRow = -1;
+  int colSymbol = -1, colTrade = -1, colValue = -1;
+
+  for (int r = 0; r < (int)rows.size() && r <= 300; ++r) {
+    auto cells = HtmlUtils::ParseTableRow(rows[r]);
+    if (cells.size() < 5)
+      continue;
+
+    for (int i = 0; i < (int)cells.size(); ++i) {
+      std::string h = cells[i];
+      std::transform(h.begin(), h.end(), h.begin(), ::toupper);
+
+      if (h.find("TRADING") != std::string::npos ||
+          h.find("CODE") != std::string::npos)
+        colSymbol = i;
+      else if (h.find("DATE") != std::string::npos)
+        colDate = i;
+      else if (h.find("OPENP") != std::string::npos ||
+               h.find("OPEN") != std::string::npos)
+        colOpen = i;
+      else if (h.find("HIGH") != std::string::npos)
+        colHigh = i;
+      else if (h.find("LOW") != std::string::npos)
+        colLow = i;
+      else if ((h.find("CLOSE") != std::string::npos ||
+                h.find("LTP") != std::string::npos) &&
+               h.find("YCP") == std::string::npos)
+        colClose = i;
+      else if (h.find("VOLUME") != std::string::npos ||
+               h.find("VOL") != std::string::npos)
+        colVol = i;
+      else if (h.find("TRADE") != std::string::npos)
+        colTrade = i;
+      else if (h.find("VALUE") != std::string::npos)
+        colValue = i;
+    }
+
+    if (colDate != -1 && colClose != -1 && colVol != -1) {
+      headerRow = r;
+      Emit(log, "ParseArchiveTable: header at row %d "
+          "(Date=%d Code=%d Open=%d High=%d Low=%d Close=%d Vol=%d)",
+          r, colDate, colSymbol, colOpen, colHigh, colLow, colClose, colVol);
+      break;
+    }
+  }
+
+  if (headerRow == -1) {
+    // Fallback: assume known DSE column layout from observed pages
+    // # | DATE | TRADING CODE | LTP | HIGH | LOW | OPENP | CLOSEP | YCP |
+    // TRADE | VALUE (mn) | VOLUME
+    Emit(log, "ParseArchiveTable: no header found, using fallback column indices");
+    colDate = 1;
+    colSymbol = 2;
+    colOpen = 6;
+    colHigh = 4;
+    colLow = 5;
+    colClose = 7;
+    colTrade = 9;
+    colValue = 10;
+    colVol = 11;
+    for (int r = 0; r < (int)rows.size() && r <= 300; ++r) {
+      if ((int)HtmlUtils::ParseTableRow(rows[r]).size() > 11) {
+        headerRow = r - 1;
+        break;
+      }
+    }
+  }
+
+  if (headerRow == -1) {
+    Emit(log, "ParseArchiveTable: could not find usable table structure");
+    return -1;
+  }
+
+  static const std::string kNoSymbol;
+  int validCount = 0;
+  for (size_t r = (size_t)(headerRow + 1); r < rows.size(); ++r) {
+    auto cells = HtmlUtils::ParseTableRow(rows[r]);
+
+    int maxIdx = std::max({colDate, colClose, colVol});
+    if ((int)cells.size() <= maxIdx)
+      continue;
+
+    const std::string &dateStr = cells[colDate];
+    if (dateStr.size() < 10)
+      continue;
+
+    DseBar bar;
+    memset(&bar, 0, sizeof(bar));
+    bar.year = (int)HtmlUtils::SafeStod(dateStr.substr(0, 4));
+    bar.month = (int)HtmlUtils::SafeStod(dateStr.substr(5, 2));
+    bar.day = (int)HtmlUtils::SafeStod(dateStr.substr(8, 2));
+
+    if (colOpen != -1 && colOpen < (int)cells.size())
+      bar.open = HtmlUtils::SafeStod(cells[colOpen]);
+    if (colHigh != -1 && colHigh < (int)cells.size())
+      bar.high = HtmlUtils::SafeStod(cells[colHigh]);
+    if (colLow != -1 && colLow < (int)cells.size())
+      bar.low = HtmlUtils::SafeStod(cells[colLow]);
+    if (colClose != -1 && colClose < (int)cells.size())
+      bar.close = HtmlUtils::SafeStod(cells[colClose]);
+    if (colVol != -1 && colVol < (int)cells.size())
+      bar.volume = HtmlUtils::SafeStod(cells[colVol]);
+    if (colTrade != -1 && colTrade < (int)cells.size())
+      bar.trade = HtmlUtils::SafeStod(cells[colTrade]);
+    if (colValue != -1 && colValue < (int)cells.size())
+      bar.value = HtmlUtils::SafeStod(cells[colValue]);
+
+    bar.valid = ValidateBar(bar);
+    if (bar.valid) {
+      if (colSymbol != -1 && colSymbol < (int)cells.size())
+        onRow(cells[colSymbol], bar);
+      else
+        onRow(kNoSymbol, bar);
+      ++validCount;
+    }
+  }
+
+  Emit(log, "ParseArchiveTable: %d valid rows", validCount);
+  return validCount;
+}
+
+bool ParseLatestPriceHtml(const std::string &html,
+                          std::vector<DseQuote> &outQuotes, const LogFn &log) {
+  // Expected columns: # | TRADING CODE | LTP | HIGH | LOW | CLOSE |
+  //                   YCP | CHANGE | TRADE | VALUE(mn) | VOLUME
+  auto rows = HtmlUtils::ExtractTableRows(html);
+  if (rows.size() < 2) {
+    Emit(log, "ParseLatestPriceHtml: too few rows (%zu)", rows.size());
+    return false;
+  }
+
+  int colSymbol = -1, colLtp = -1, colHigh = -1, colLow = -1;
+  int colClose = -1, colYcp = -1, colChange = -1;
+  int colTrade = -1, colValue = -1, colVolume = -1;
+
+  auto headerCells = HtmlUtils::ParseTableRow(rows[0]);
+  for (int i = 0; i < (int)headerCells.size(); ++i) {
+    std::string h = headerCells[i];
+    for (auto &c : h)
+      c = (char)toupper((unsigned char)c);
+
+    if (h.find("TRADING") != std::string::npos)
+      colSymbol = i;
+    else if (h.find("LTP") != std::string::npos)
+      colLtp = i;
+    else if (h.find("HIGH") != std::string::npos)
+      colHigh = i;
+    else if (h.find("LOW") != std::string::npos)
+      colLow = i;
+    else if (h.find("CLOSE") != std::string::npos &&
+             h.find("YCP") == std::string::npos)
+      colClose = i;
+    else if (h.find("YCP") != std::string::npos)
+      colYcp = i;
+    else if (h.find("CHANGE") != std::string::npos)
+      colChange = i;
+    else if (h.find("TRADE") != std::string::npos &&
+             h.find("TRADING") == std::string::npos)
+      colTrade = i;
+    else if (h.find("VALUE") != std::string::npos)
+      colValue = i;
+    else if (h.find("VOLUME") != std::string::npos)
+      colVolume = i;
+  }
+
+  // Fallback to observed column positions on dsebd.org
+  if (colSymbol < 0)
+    colSymbol = 1;
+  if (colLtp < 0)
+    colLtp = 2;
+  if (colHigh < 0)
+    colHigh = 3;
+  if (colLow < 0)
+    colLow = 4;
+  if (colClose < 0)
+    colClose = 5;
+  if (colYcp < 0)
+    colYcp = 6;
+  if (colChange < 0)
+    colChange = 7;
+  if (colTrade < 0)
+    colTrade = 8;
+  if (colValue < 0)
+    colValue = 9;
+  if (colVolume < 0)
+    colVolume = 10;
+
+  for (size_t r = 1; r < rows.size(); ++r) {
+    auto cells = HtmlUtils::ParseTableRow(rows[r]);
+    if (cells.empty())
+      continue;
+
+    int maxCol = (int)cells.size();
+    DseQuote q;
+    memset(&q, 0, sizeof(q));
+    q.valid = true;
+
+    if (colSymbol < maxCol) {
+      std::string sym = HtmlUtils::Trim(cells[colSymbol]);
+      size_t n = std::min(sym.size(), sizeof(q.symbol) - 1);
+      memcpy(q.symbol, sym.data(), n); // q is zeroed, so terminated
+    }
+
+    if (colLtp < maxCol)
+      q.ltp = HtmlUtils::SafeStod(cells[colLtp]);
+    if (colHigh < maxCol)
+      q.high = HtmlUtils::SafeStod(cells[colHigh]);
+    if (colLow < maxCol)
+      q.low = HtmlUtils::SafeStod(cells[colLow]);
+    if (colClose < maxCol)
+      q.close = HtmlUtils::SafeStod(cells[colClose]);
+    if (colYcp < maxCol)
+      q.ycp = HtmlUtils::SafeStod(cells[colYcp]);
+    if (colChange < maxCol)
+      q.change = HtmlUtils::SafeStod(cells[colChange]);
+    if (colTrade < maxCol)
+      q.trade = HtmlUtils::SafeStod(cells[colTrade]);
+    if (colValue < maxCol)
+      q.value = HtmlUtils::SafeStod(cells[colValue]);
+    if (colVolume < maxCol)
+      q.volume = HtmlUtils::SafeStod(cells[colVolume]);
+
+    if (q.ycp > 0)
+      q.changePercent = ((q.ltp - q.ycp) / q.ycp) * 100.0;
+    q.open = q.ycp; // open defaults to previous close when not provided
+
+    if (q.symbol[0] && q.ltp > 0)
+      outQuotes.push_back(q);
+  }
+
+  Emit(log, "ParseLatestPriceHtml: parsed %zu quotes", outQuotes.size());
+  return !outQuotes.empty();
+}
+
+} // namespace DsePageParser
@@ -0,0 +1,264 @@
+// FeedSource.cpp — Live and Replay Snapshot Sources
+//
+// The replay clock only moves when a frame is delivered: Fetch jumps to the
+// frame's recorded time and Wait sleeps for the recorded gap to the next
+// frame, divided by the speed factor. Every frame is delivered exactly once
+// and in order, so two runs over the same recording push identical data.
+
+#include "FeedSource.h"
+#include "DseDataEngine.h"
+#include "OsServices.h"
+#include "PlatformCompat.h"
+#include "SnapshotJournal.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// ---------------------------------------------------------------------------
+// File-scope helpers
+// ---------------------------------------------------------------------------
+
+namespace {
+
+bool EndsWith(const std::string &s, const char *suffix) {
+  size_t n = strlen(suffix);
+  if (s.size() < n)
+    return false;
+  for (size_t i = 0; i < n; ++i)
+    if (tolower((unsigned char)s[s.size() - n + i]) != suffix[i])
+      return false;
+  return true;
+}
+
+// "...YYYYMMDD_HHMMSS.html" -> date, secOfDay
+bool ParseFrameName(const std::string &name, int &date, int &secOfDay) {
+  size_t dot = name.rfind('.');
+  if (dot == std::string::npos || dot < 15)
+    return false;
+  int d, hh, mm, ss;
+  if (sscanf(name.c_str() + dot - 15, "%8d_%2d%2d%2d", &d, &hh, &mm, &ss) !=
+      4)
+    return false;
+  date = d;
+  secOfDay = hh * 3600 + mm * 60 + ss;
+  return true;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// LiveFeedSource
+// ---------------------------------------------------------------------------
+
+LiveFeedSource::LiveFeedSource(DseDataEngine *engine, const char *recordDir)
+    : m_engine(engine), m_recordDir(recordDir ? recordDir : ""),
+      m_proxySeq(0) {
+  if (!m_recordDir.empty())
+    Os::MakeDir(m_recordDir.c_str());
+}
+
+bool LiveFeedSource::Fetch(std::vector<DseQuote> &outQuotes) {
+  // A push that lands while this fetch runs ends the next Wait at once
+  m_proxySeq = m_engine->GetProxy().Sequence();
+  if (m_recordDir.empty())
+    return m_engine->FetchLatestQuotes(outQuotes);
+
+  std::string page;
+  bool ok = m_engine->FetchLatestQuotes(outQuotes, &page);
+  if (ok && !page.empty()) {
+    MarketClock::Time t = m_engine->GetClock().Now();
+    char name[32];
+    sprintf_s(name, "%08d_%06d.html", t.date, t.hhmmss());
+    std::string path = Os::JoinPath(m_recordDir, name);
+    FILE *fp = nullptr;
+    if (fopen_s(&fp, path.c_str(), "wb") == 0 && fp) {
+      fwrite(page.data(), 1, page.size(), fp);
+      fclose(fp);
+    } else {
+      m_engine->Log("WARNING: LiveFeedSource — cannot write %s", path.c_str());
+    }
+  }
+  return ok;
+}
+
+bool LiveFeedSource::IsMarketOpen() { return m_engine->IsMarketOpen(); }
+
+void LiveFeedSource::Now(int &date, int &secOfDay) {
+  MarketClock::Time t = m_engine->GetClock().Now();
+  date = t.date;
+  secOfDay = t.secOfDay;
+}
+
+void LiveFeedSource::Wait(int ms, StopSignal &stop) {
+  ProxyClient &proxy = m_engine->GetProxy();
+  if (!proxy.IsConnected()) {
+    stop.WaitFor(ms);
+    return;
+  }
+
+  // dse_proxyd pushes each change: fetch as soon as one arrives rather
+  // than at the end of the interval
+  uint64_t deadline = Os::MonotonicMs() + (ms > 0 ? ms : 0);
+  for (;;) {
+    if (stop.IsSet())
+      return;
+    uint64_t now = Os::MonotonicMs();
+    if (now >= deadline)
+      return;
+    int slice = (int)std::min<uint64_t>(deadline - now, 250);
+    if (proxy.WaitForUpdate(m_proxySeq, slice))
+      return;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// ReplayFeedSource
+// ---------------------------------------------------------------------------
+
+ReplayFeedSource::ReplayFeedSource(DseDataEngine *engine, const char *path,
+                                   int speed)
+    : m_engine(engine), m_path(path ? path : ""), m_speed(speed < 0 ? 0 : speed),
+      m_next(0), m_date(0), m_secOfDay(0), m_quotesDelivered(0),
+      m_reported(false) {}
+
+bool ReplayFeedSource::Load() {
+  m_frames.clear();
+  m_next = 0;
+  m_board.clear();
+  m_boardIndex.clear();
+  bool ok = EndsWith(m_path, ".dsj") ? LoadJournal() : LoadPages();
+  if (!ok || m_frames.empty()) {
+    m_engine->Log("ERROR: ReplayFeedSource — nothing to replay in '%s'",
+                  m_path.c_str());
+    return false;
+  }
+
+  m_date = m_frames[0].date;
+  m_secOfDay = m_frames[0].secOfDay;
+  m_startTime = std::chrono::steady_clock::now();
+  m_engine->Log("ReplayFeedSource: %zu frames from %s, speed %dx%s",
+                m_frames.size(), m_path.c_str(), m_speed,
+                m_speed == 0 ? " (max)" : "");
+  return true;
+}
+
+bool ReplayFeedSource::LoadPages() {
+  std::vector<std::string> names = Os::ListFiles(m_path);
+  for (const auto &name : names) {
+    if (!EndsWith(name, ".html") && !EndsWith(name, ".htm"))
+      continue;
+    Frame f;
+    if (!ParseFrameName(name, f.date, f.secOfDay))
+      continue;
+    f.pagePath = Os::JoinPath(m_path, name);
+    m_frames.push_back(std::move(f));
+  }
+  return true;
+}
+
+bool ReplayFeedSource::LoadJournal() {
+  // Session date comes from the file name (YYYYMMDD.dsj)
+  int date = 0;
+  size_t slash = m_path.find_last_of("\\/");
+  std::string base =
+      (slash == std::string::npos) ? m_path : m_path.substr(slash + 1);
+  if (sscanf(base.c_str(), "%8d", &date) != 1)
+    return false;
+
+  return SnapshotJournal::Replay(
+      m_path.c_str(),
+      [&](int secOfDay, const std::vector<DseQuote> &quotes) {
+        Frame f;
+        f.date = date;
+        f.secOfDay = secOfDay;
+        f.quotes = quotes;
+        m_frames.push_back(std::move(f));
+      });
+}
+
+bool ReplayFeedSource::Fetch(std::vector<DseQuote> &outQuotes) {
+  outQuotes.clear();
+  if (m_next >= m_frames.size())
+    return false;
+
+  Frame &f = m_frames[m_next++];
+  m_date = f.date;
+  m_secOfDay = f.secOfDay;
+
+  bool ok;
+  if (f.pagePath.empty()) {
+    // A journal record holds only the rows that changed; fold it into the
+    // board so every frame is the whole page, like a live poll (otherwise
+    // SnapshotDiff reports everything else as halted)
+    for (const auto &q : f.quotes) {
+      if (!q.symbol[0])
+        continue;
+      std::string name(q.symbol, strnlen(q.symbol, sizeof(q.symbol)));
+      auto it = m_boardIndex.find(name);
+      if (it != m_boardIndex.end()) {
+        m_board[it->second] = q;
+      } else {
+        m_boardIndex.emplace(name, m_board.size());
+        m_board.push_back(q);
+      }
+    }
+    outQuotes = m_board;
+    ok = !outQuotes.empty();
+  } else {
+    std::string html;
+    FILE *fp = nullptr;
+    ok = false;
+    if (fopen_s(&fp, f.pagePath.c_str(), "rb") == 0 && fp) {
+      char buf[65536];
+      size_t n;
+      while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+        html.append(buf, n);
+      fclose(fp);
+      ok = m_engine->ParseLatestPriceHtml(html, outQuotes);
+    }
+  }
+  if (ok)
+    m_quotesDelivered += outQuotes.size();
+  return ok;
+}
+
+// The virtual session lasts until the last frame has been delivered.
+bool ReplayFeedSource::IsMarketOpen() {
+  if (m_next < m_frames.size())
+    return true;
+
+  if (!m_reported) {
+    m_reported = true;
+    double sec = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - m_startTime)
+                     .count();
+    m_engine->Log("ReplayFeedSource: done, %zu frames / %zu quotes in %.2f s "
+                  "(%.0f quotes/s)",
+                  m_frames.size(), m_quotesDelivered, sec,
+                  sec > 0 ? m_quotesDelivered / sec : 0.0);
+  }
+  return false;
+}
+
+void ReplayFeedSource::Now(int &date, int &secOfDay) {
+  date = m_date;
+  secOfDay = m_secOfDay;
+}
+
+// Between frames: the recorded gap scaled by speed (the configured poll
+// interval is ignored so the recording's own cadence is reproduced). After
+// the last frame: real time, so the idle feed does not spin.
+void ReplayFeedSource::Wait(int ms, StopSignal &stop) {
+  if (m_next >= m_frames.size()) {
+    stop.WaitFor(ms);
+    return;
+  }
+  if (m_speed == 0)
+    return;
+
+  const Frame &next = m_frames[m_next];
+  int gapSec = next.secOfDay - m_secOfDay;
+  if (next.date != m_date || gapSec < 0)
+    gapSec = 0;
+  stop.WaitFor(gapSec * 1000 / m_speed);
+}
@@ -0,0 +1,111 @@
+// IniFile.cpp — Portable Reader for dse_config.ini
+
+#include "IniFile.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+std::string Trim(const std::string &s) {
+  size_t b = s.find_first_not_of(" \t\r\n");
+  if (b == std::string::npos)
+    return std::string();
+  size_t e = s.find_last_not_of(" \t\r\n");
+  return s.substr(b, e - b + 1);
+}
+
+void Lower(std::string &s) {
+  for (char &c : s)
+    c = (char)tolower((unsigned char)c);
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Load
+// ---------------------------------------------------------------------------
+
+bool IniFile::Load(const char *path) {
+  m_values.clear();
+  FILE *fp = path && path[0] ? fopen(path, "rb") : nullptr;
+  if (!fp)
+    return false;
+
+  std::string section;
+  char buf[4096];
+  bool first = true;
+  while (fgets(buf, sizeof(buf), fp)) {
+    const char *p = buf;
+    if (first && (unsigned char)p[0] == 0xEF && (unsigned char)p[1] == 0xBB &&
+        (unsigned char)p[2] == 0xBF)
+      p += 3; // UTF-8 BOM
+    first = false;
+
+    std::string line = Trim(p);
+    if (line.empty() || line[0] == ';')
+      continue;
+
+    if (line[0] == '[') {
+      size_t close = line.find(']');
+      section = Trim(line.substr(1, close == std::string::npos
+                                        ? std::string::npos
+                                        : close - 1));
+      Lower(section);
+      continue;
+    }
+
+    size_t eq = line.find('=');
+    if (eq == std::string::npos)
+      continue;
+    std::string key = Trim(line.substr(0, eq));
+    std::string value = Trim(line.substr(eq + 1));
+    if (value.size() >= 2 && (value[0] == '"' || value[0] == '\'') &&
+        value.back() == value[0])
+      value = value.substr(1, value.size() - 2);
+    Lower(key);
+
+    // First occurrence wins
+    m_values.insert(std::make_pair(section + '\n' + key, value));
+  }
+  fclose(fp);
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Lookups
+// ---------------------------------------------------------------------------
+
+std::string IniFile::MakeKey(const char *section, const char *key) {
+  std::string k = Trim(section ? section : "") + '\n' + Trim(key ? key : "");
+  Lower(k);
+  return k;
+}
+
+bool IniFile::Has(const char *section, const char *key) const {
+  return m_values.count(MakeKey(section, key)) != 0;
+}
+
+int IniFile::GetInt(const char *section, const char *key, int def) const {
+  auto it = m_values.find(MakeKey(section, key));
+  if (it == m_values.end())
+    return def;
+  const char *s = it->second.c_str();
+  bool hex = s[0] == '0' && (s[1] == 'x' || s[1] == 'X');
+  return (int)strtol(hex ? s + 2 : s, nullptr, hex ? 16 : 10);
+}
+
+void IniFile::GetString(const char *section, const char *key,
+                        const char *def, char *out, size_t size) const {
+  if (!out || size == 0)
+    return;
+  auto it = m_values.find(MakeKey(section, key));
+  const char *src = it != m_values.end() ? it->second.c_str()
+                                         : (def ? def : "");
+  size_t n = strlen(src);
+  if (n > size - 1)
+    n = size - 1;
+  memcpy(out, src, n);
+  out[n] = '\0';
+}
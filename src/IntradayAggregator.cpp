@@ -0,0 +1,210 @@
+// IntradayAggregator.cpp — Intraday OHLCV Bars from Polled Snapshots
+//
+// Each poll delivers cumulative day totals. A bar is opened or extended only
+// when a symbol's cumulative volume grows, so intervals without trades leave
+// no bar (AmiBroker pads those itself).
+
+#include "IntradayAggregator.h"
+#include <cstring>
+
+IntradayAggregator::IntradayAggregator()
+    : m_intervalSec(60), m_openSec(10 * 3600), m_capacity(5 * 270) {}
+
+void IntradayAggregator::Configure(int barIntervalSec, int sessions,
+                                   int openSec, int closeSec) {
+  if (barIntervalSec < 1)
+    barIntervalSec = 60;
+  if (sessions < 1)
+    sessions = 1;
+  int sessionSec = closeSec - openSec;
+  if (sessionSec <= 0)
+    sessionSec = 270 * 60;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_intervalSec = barIntervalSec;
+  m_openSec = openSec;
+  // One extra bar per session for the post-close print
+  m_capacity =
+      (size_t)sessions * (size_t)(sessionSec / barIntervalSec + 1 + 1);
+  m_series.clear();
+}
+
+void IntradayAggregator::SetCalendar(
+    std::shared_ptr<const TradingCalendar> calendar) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_calendar = std::move(calendar);
+}
+
+void IntradayAggregator::Clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_series.clear();
+}
+
+DseIntradayBar &IntradayAggregator::Newest(Series &s) {
+  if (s.ring.size() < m_capacity)
+    return s.ring.back();
+  return s.ring[(s.head + s.ring.size() - 1) % s.ring.size()];
+}
+
+void IntradayAggregator::Append(Series &s, const DseIntradayBar &bar) {
+  if (s.ring.size() < m_capacity) {
+    s.ring.push_back(bar);
+    return;
+  }
+  s.ring[s.head] = bar;
+  s.head = (s.head + 1) % s.ring.size();
+}
+
+void IntradayAggregator::OnSnapshot(const std::vector<DseQuote> &quotes,
+                                    int date, int secOfDay) {
+  const int barStart = secOfDay - (secOfDay % m_intervalSec);
+  const int barTime = (barStart / 3600) * 10000 + ((barStart / 60) % 60) * 100 +
+                      barStart % 60;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  int openSec = m_openSec, closeSec;
+  if (m_calendar)
+    m_calendar->GetSession(date, openSec, closeSec); // keeps m_openSec if shut
+  for (const auto &q : quotes) {
+    if (!q.symbol[0] || q.ltp <= 0)
+      continue;
+
+    auto it = m_series.find(q.symbol);
+    if (it == m_series.end() || it->second.lastDate != date) {
+      Series *s;
+      bool sessionStart = secOfDay <= openSec + m_intervalSec;
+      if (it == m_series.end()) {
+        s = &m_series[q.symbol];
+        s->head = 0;
+      } else {
+        s = &it->second;
+      }
+      s->lastDate = date;
+      s->lastHigh = q.high;
+      s->lastLow = q.low;
+      // Joining mid-session: the first snapshot only sets the baseline, or
+      // the whole morning's volume would land in one bar
+      if (!sessionStart) {
+        s->lastVolume = q.volume;
+        s->lastTrade = q.trade;
+        s->lastValue = q.value;
+        continue;
+      }
+      s->lastVolume = s->lastTrade = s->lastValue = 0;
+      it = m_series.find(q.symbol);
+    }
+
+    Series &s = it->second;
+    double dVol = q.volume - s.lastVolume;
+    if (dVol < 0) {
+      // Page correction — rebase without emitting a bar
+      s.lastVolume = q.volume;
+      s.lastTrade = q.trade;
+      s.lastValue = q.value;
+      continue;
+    }
+    if (dVol == 0)
+      continue;
+
+    double dTrade = q.trade - s.lastTrade;
+    double dValue = q.value - s.lastValue;
+    if (dTrade < 0)
+      dTrade = 0;
+    if (dValue < 0)
+      dValue = 0;
+
+    // A new day high/low between polls must have printed in this interval
+    double hi = q.ltp, lo = q.ltp;
+    if (q.high > s.lastHigh && q.high > hi)
+      hi = q.high;
+    if (s.lastLow > 0 && q.low > 0 && q.low < s.lastLow && q.low < lo)
+      lo = q.low;
+
+    DseIntradayBar *bar = nullptr;
+    if (!s.ring.empty()) {
+      DseIntradayBar &last = Newest(s);
+      if (last.date == date && last.time == barTime)
+        bar = &last;
+    }
+
+    if (bar) {
+      if (hi > bar->high)
+        bar->high = hi;
+      if (lo < bar->low)
+        bar->low = lo;
+      bar->close = q.ltp;
+      bar->volume += dVol;
+      bar->trade += dTrade;
+      bar->value += dValue;
+    } else {
+      DseIntradayBar nb;
+      nb.date = date;
+      nb.time = barTime;
+      nb.open = q.ltp;
+      nb.high = hi;
+      nb.low = lo;
+      nb.close = q.ltp;
+      nb.volume = dVol;
+      nb.trade = dTrade;
+      nb.value = dValue;
+      Append(s, nb);
+    }
+
+    s.lastVolume = q.volume;
+    s.lastTrade = q.trade;
+    s.lastValue = q.value;
+    s.lastHigh = q.high;
+    s.lastLow = q.low;
+  }
+}
+
+bool IntradayAggregator::GetBars(const char *symbol, int intervalSec,
+                                 std::vector<DseIntradayBar> &outBars) const {
+  outBars.clear();
+  if (!symbol || !symbol[0])
+    return false;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_series.find(symbol);
+  if (it == m_series.end() || it->second.ring.empty())
+    return false;
+
+  const Series &s = it->second;
+  const size_t n = s.ring.size();
+
+  int step = m_intervalSec;
+  if (intervalSec > m_intervalSec)
+    step = ((intervalSec + m_intervalSec - 1) / m_intervalSec) * m_intervalSec;
+
+  outBars.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    const DseIntradayBar &b = s.ring[(s.head + i) % n];
+    if (step == m_intervalSec) {
+      outBars.push_back(b);
+      continue;
+    }
+
+    int sec = (b.time / 10000) * 3600 + ((b.time / 100) % 100) * 60 +
+              b.time % 100;
+    sec -= sec % step;
+    int t = (sec / 3600) * 10000 + ((sec / 60) % 60) * 100 + sec % 60;
+
+    if (!outBars.empty() && outBars.back().date == b.date &&
+        outBars.back().time == t) {
+      DseIntradayBar &c = outBars.back();
+      if (b.high > c.high)
+        c.high = b.high;
+      if (b.low < c.low)
+        c.low = b.low;
+      c.close = b.close;
+      c.volume += b.volume;
+      c.trade += b.trade;
+      c.value += b.value;
+    } else {
+      DseIntradayBar c = b;
+      c.time = t;
+      outBars.push_back(c);
+    }
+  }
+  return true;
+}
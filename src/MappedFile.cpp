@@ -0,0 +1,164 @@
+// MappedFile.cpp — Read-Only Memory-Mapped File
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+    : m_data(nullptr), m_size(0), m_fileSize(0), m_base(nullptr),
+      m_baseSize(0), m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr) {}
+
+bool MappedFile::OpenUnmapped(const char *path) {
+  Close();
+  HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+  m_file = file;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    Close();
+    return false;
+  }
+  m_fileSize = (uint64_t)size.QuadPart;
+  if (m_fileSize == 0)
+    return true;
+
+  m_mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!m_mapping) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+bool MappedFile::MapWindow(uint64_t offset, size_t length) {
+  Unmap();
+  if (offset >= m_fileSize || length == 0)
+    return offset <= m_fileSize;
+  if (length > m_fileSize - offset)
+    length = (size_t)(m_fileSize - offset);
+
+  // Views start on the allocation granularity (64 KB)
+  SYSTEM_INFO si;
+  GetSystemInfo(&si);
+  uint64_t base = offset - offset % si.dwAllocationGranularity;
+  size_t lead = (size_t)(offset - base);
+  if (length > (size_t)-1 - lead)
+    return false;
+  void *p = MapViewOfFile(m_mapping, FILE_MAP_READ, (DWORD)(base >> 32),
+                          (DWORD)base, lead + length);
+  if (!p)
+    return false;
+  m_base = p;
+  m_baseSize = lead + length;
+  m_data = (const char *)p + lead;
+  m_size = length;
+  return true;
+}
+
+void MappedFile::Unmap() {
+  if (m_base)
+    UnmapViewOfFile(m_base);
+  m_base = nullptr;
+  m_baseSize = 0;
+  m_data = nullptr;
+  m_size = 0;
+}
+
+void MappedFile::Close() {
+  Unmap();
+  if (m_mapping)
+    CloseHandle(m_mapping);
+  if (m_file != INVALID_HANDLE_VALUE)
+    CloseHandle(m_file);
+  m_fileSize = 0;
+  m_mapping = nullptr;
+  m_file = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MappedFile::MappedFile()
+    : m_data(nullptr), m_size(0), m_fileSize(0), m_base(nullptr),
+      m_baseSize(0), m_fd(-1) {}
+
+bool MappedFile::OpenUnmapped(const char *path) {
+  Close();
+  m_fd = open(path, O_RDONLY);
+  if (m_fd < 0)
+    return false;
+
+  struct stat st;
+  if (fstat(m_fd, &st) != 0) {
+    Close();
+    return false;
+  }
+  m_fileSize = (uint64_t)st.st_size;
+  return true;
+}
+
+bool MappedFile::MapWindow(uint64_t offset, size_t length) {
+  Unmap();
+  if (offset >= m_fileSize || length == 0)
+    return offset <= m_fileSize;
+  if (length > m_fileSize - offset)
+    length = (size_t)(m_fileSize - offset);
+
+  uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+  uint64_t base = offset - offset % page;
+  size_t lead = (size_t)(offset - base);
+  if (length > (size_t)-1 - lead)
+    return false;
+  void *p = mmap(nullptr, lead + length, PROT_READ, MAP_PRIVATE, m_fd,
+                 (off_t)base);
+  if (p == MAP_FAILED)
+    return false;
+  madvise(p, lead + length, MADV_SEQUENTIAL);
+  m_base = p;
+  m_baseSize = lead + length;
+  m_data = (const char *)p + lead;
+  m_size = length;
+  return true;
+}
+
+void MappedFile::Unmap() {
+  if (m_base)
+    munmap(m_base, m_baseSize);
+  m_base = nullptr;
+  m_baseSize = 0;
+  m_data = nullptr;
+  m_size = 0;
+}
+
+void MappedFile::Close() {
+  Unmap();
+  if (m_fd >= 0)
+    close(m_fd);
+  m_fileSize = 0;
+  m_fd = -1;
+}
+
+#endif
+
+bool MappedFile::Open(const char *path) {
+  if (!OpenUnmapped(path))
+    return false;
+  if (m_fileSize > (size_t)-1 || !MapWindow(0, (size_t)m_fileSize)) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+MappedFile::~MappedFile() { Close(); }
@@ -0,0 +1,77 @@
+// MarketClock.cpp — Exchange Time from UTC plus a Fixed Offset
+
+#include "MarketClock.h"
+#include "TradingCalendar.h"
+#include <chrono>
+
+namespace {
+
+const int64_t kMsPerDay = 86400000;
+
+// Floor division that stays correct before 1970
+int64_t FloorDiv(int64_t a, int64_t b) {
+  int64_t q = a / b;
+  return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+} // namespace
+
+MarketClock::MarketClock() : m_offsetMin(360), m_cachedDay(-1) {}
+
+void MarketClock::SetUtcOffsetMinutes(int minutes) {
+  m_offsetMin = minutes;
+  m_cachedDay = -1;
+}
+
+void MarketClock::SetUtcSource(UtcSource source) {
+  std::shared_ptr<UtcSource> p;
+  if (source)
+    p = std::make_shared<UtcSource>(std::move(source));
+  std::atomic_store(&m_source, p);
+  m_cachedDay = -1;
+}
+
+int64_t MarketClock::SystemUtcMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+int64_t MarketClock::NowUtcMs() const {
+  std::shared_ptr<UtcSource> p = std::atomic_load(&m_source);
+  return p ? (*p)() : SystemUtcMs();
+}
+
+MarketClock::Time MarketClock::ToExchange(int64_t utcMs) const {
+  int64_t local = utcMs + (int64_t)m_offsetMin.load() * 60000;
+  int64_t day = FloorDiv(local, kMsPerDay);
+  int64_t msOfDay = local - day * kMsPerDay;
+
+  Time t;
+  t.date = TradingCalendar::FromDayNumber((int)day);
+  t.secOfDay = (int)(msOfDay / 1000);
+  t.ms = (int)(msOfDay % 1000);
+  t.dayOfWeek = (int)(((day % 7) + 11) % 7); // 1970-01-01 was a Thursday
+  return t;
+}
+
+int64_t MarketClock::ToUtcMs(int date, int secOfDay) const {
+  int64_t local = (int64_t)TradingCalendar::ToDayNumber(date) * kMsPerDay +
+                  (int64_t)secOfDay * 1000;
+  return local - (int64_t)m_offsetMin.load() * 60000;
+}
+
+MarketClock::Time MarketClock::Now() const { return ToExchange(NowUtcMs()); }
+
+int MarketClock::Today() const {
+  int64_t local = NowUtcMs() + (int64_t)m_offsetMin.load() * 60000;
+  int64_t day = FloorDiv(local, kMsPerDay);
+
+  int64_t cached = m_cachedDay.load(std::memory_order_relaxed);
+  if (cached >= 0 && (cached >> 32) == day)
+    return (int)(cached & 0xFFFFFFFF);
+
+  int ymd = TradingCalendar::FromDayNumber((int)day);
+  m_cachedDay.store((day << 32) | (int64_t)ymd, std::memory_order_relaxed);
+  return ymd;
+}
@@ -0,0 +1,299 @@
+// Metrics.cpp — Hot-Path Latency Histograms and Counters
+
+#include "Metrics.h"
+#include "CsvUtils.h"
+#include "PlatformCompat.h"
+#include "Trace.h"
+#include <cstdio>
+
+namespace Metrics {
+
+// ---------------------------------------------------------------------------
+// Storage (static, zero-initialised before any constructor runs)
+// ---------------------------------------------------------------------------
+
+static Histogram g_stages[kStageCount];
+static std::atomic<uint64_t> g_counters[kCounterCount];
+static std::atomic<int64_t> g_gauges[kGaugeCount];
+static std::atomic<bool> g_enabled(true);
+
+static const char *const kStageNames[kStageCount] = {
+    "http_connect",  "http_ttfb",       "http_body",
+    "html_parse",    "csv_parse",       "cache_merge",
+    "get_quotes_ex", "get_recent_info", "streaming_update",
+    "poll",          "snapshot_diff"};
+
+static const char *const kCounterNames[kCounterCount] = {
+    "http_requests", "http_errors",       "http_bytes",
+    "html_bars",     "quotes",            "csv_bars",
+    "bars_merged",   "streaming_updates", "allocations",
+    "polls",         "poll_failures",     "parse_failures",
+    "bus_quote_reads", "bus_bar_hits", "proxy_quote_reads",
+    "proxy_history", "quotes_changed", "quotes_appeared",
+    "quotes_halted"};
+
+static const char *const kGaugeNames[kGaugeCount] = {
+    "export_queue", "journal_queue", "backfills"};
+
+const char *StageName(Stage s) { return kStageNames[s]; }
+const char *CounterName(Counter c) { return kCounterNames[c]; }
+const char *GaugeName(Gauge g) { return kGaugeNames[g]; }
+
+// ---------------------------------------------------------------------------
+// Histogram
+// ---------------------------------------------------------------------------
+
+// Values below 2^(kSubBits+1) get a bucket each; above that, each power of
+// two is split into 2^kSubBits equal buckets keyed by the bits under the
+// leading one.
+int Histogram::BucketOf(uint64_t us) {
+  const uint64_t linear = 2ull << kSubBits;
+  if (us < linear)
+    return (int)us;
+  if (us >= (1ull << kMaxBits))
+    us = (1ull << kMaxBits) - 1;
+  int msb = 63;
+  while (!(us >> msb))
+    --msb;
+  int shift = msb - kSubBits;
+  return shift * (1 << kSubBits) + (int)(us >> shift);
+}
+
+uint64_t Histogram::BucketUpper(int bucket) {
+  const int sub = 1 << kSubBits;
+  if (bucket < 2 * sub)
+    return (uint64_t)bucket;
+  int shift = bucket / sub - 1;
+  uint64_t mantissa = (uint64_t)(bucket % sub + sub);
+  return ((mantissa + 1) << shift) - 1;
+}
+
+void Histogram::Record(uint64_t us) {
+  m_buckets[BucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  m_sum.fetch_add(us, std::memory_order_relaxed);
+  uint64_t prev = m_max.load(std::memory_order_relaxed);
+  while (us > prev &&
+         !m_max.compare_exchange_weak(prev, us, std::memory_order_relaxed)) {
+  }
+}
+
+void Histogram::Reset() {
+  for (int i = 0; i < kBuckets; ++i)
+    m_buckets[i].store(0, std::memory_order_relaxed);
+  m_count.store(0, std::memory_order_relaxed);
+  m_sum.store(0, std::memory_order_relaxed);
+  m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t Histogram::PercentileUs(double p) const {
+  // Sum the buckets rather than trusting m_count: recorders update the two
+  // separately, so they can disagree for a moment
+  uint64_t counts[kBuckets];
+  uint64_t total = 0;
+  for (int i = 0; i < kBuckets; ++i) {
+    counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0)
+    return 0;
+
+  uint64_t rank = (uint64_t)(p / 100.0 * (double)total + 0.5);
+  if (rank < 1)
+    rank = 1;
+  if (rank > total)
+    rank = total;
+
+  uint64_t seen = 0;
+  for (int i = 0; i < kBuckets; ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      uint64_t upper = BucketUpper(i);
+      uint64_t max = MaxUs();
+      return (max && upper > max) ? max : upper;
+    }
+  }
+  return MaxUs();
+}
+
+// ---------------------------------------------------------------------------
+// Recording
+// ---------------------------------------------------------------------------
+
+void SetEnabled(bool enabled) {
+  g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Enabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+void Record(Stage s, uint64_t us) {
+  if (Enabled())
+    g_stages[s].Record(us);
+}
+
+void Add(Counter c, uint64_t n) {
+  g_counters[c].fetch_add(n, std::memory_order_relaxed);
+}
+
+void Set(Gauge g, int64_t value) {
+  g_gauges[g].store(value, std::memory_order_relaxed);
+}
+
+void Adjust(Gauge g, int64_t delta) {
+  g_gauges[g].fetch_add(delta, std::memory_order_relaxed);
+}
+
+const Histogram &Get(Stage s) { return g_stages[s]; }
+
+uint64_t Get(Counter c) {
+  return g_counters[c].load(std::memory_order_relaxed);
+}
+
+int64_t Get(Gauge g) { return g_gauges[g].load(std::memory_order_relaxed); }
+
+void Reset() {
+  for (int i = 0; i < kStageCount; ++i)
+    g_stages[i].Reset();
+  for (int i = 0; i < kCounterCount; ++i)
+    g_counters[i].store(0, std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// Reporting
+// ---------------------------------------------------------------------------
+
+std::string FormatReport(const char *eol) {
+  std::string out;
+  char line[256];
+
+  sprintf_s(line, "%-18s %10s %10s %10s %10s %10s %10s%s", "stage (us)",
+            "count", "p50", "p90", "p99", "max", "mean", eol);
+  out += line;
+  for (int i = 0; i < kStageCount; ++i) {
+    const Histogram &h = g_stages[i];
+    uint64_t n = h.Count();
+    sprintf_s(line, "%-18s %10llu %10llu %10llu %10llu %10llu %10llu%s",
+              kStageNames[i], (unsigned long long)n,
+              (unsigned long long)h.PercentileUs(50),
+              (unsigned long long)h.PercentileUs(90),
+              (unsigned long long)h.PercentileUs(99),
+              (unsigned long long)h.MaxUs(),
+              (unsigned long long)(n ? h.SumUs() / n : 0), eol);
+    out += line;
+  }
+
+  out += eol;
+  for (int i = 0; i < kCounterCount; ++i) {
+    sprintf_s(line, "%-18s %10llu%s", kCounterNames[i],
+              (unsigned long long)Get((Counter)i), eol);
+    out += line;
+  }
+  for (int i = 0; i < kGaugeCount; ++i) {
+    sprintf_s(line, "%-18s %10lld%s", kGaugeNames[i],
+              (long long)Get((Gauge)i), eol);
+    out += line;
+  }
+  if (!Enabled()) {
+    out += "(latency recording is disabled: [Metrics] Enabled=0)";
+    out += eol;
+  }
+  return out;
+}
+
+std::string FormatPrometheus() {
+  static const double kQuantiles[] = {0.5, 0.9, 0.99};
+  std::string out;
+  char line[256];
+
+  out += "# HELP dse_stage_latency_seconds Hot-path stage latency.\n"
+         "# TYPE dse_stage_latency_seconds summary\n";
+  for (int i = 0; i < kStageCount; ++i) {
+    const Histogram &h = g_stages[i];
+    for (double q : kQuantiles) {
+      sprintf_s(line,
+                "dse_stage_latency_seconds{stage=\"%s\",quantile=\"%g\"} "
+                "%.6f\n",
+                kStageNames[i], q, h.PercentileUs(q * 100.0) / 1e6);
+      out += line;
+    }
+    sprintf_s(line,
+              "dse_stage_latency_seconds_sum{stage=\"%s\"} %.6f\n"
+              "dse_stage_latency_seconds_count{stage=\"%s\"} %llu\n",
+              kStageNames[i], h.SumUs() / 1e6, kStageNames[i],
+              (unsigned long long)h.Count());
+    out += line;
+  }
+
+  for (int i = 0; i < kCounterCount; ++i) {
+    sprintf_s(line, "# TYPE dse_%s_total counter\ndse_%s_total %llu\n",
+              kCounterNames[i], kCounterNames[i],
+              (unsigned long long)Get((Counter)i));
+    out += line;
+  }
+  for (int i = 0; i < kGaugeCount; ++i) {
+    sprintf_s(line, "# TYPE dse_%s gauge\ndse_%s %lld\n", kGaugeNames[i],
+              kGaugeNames[i], (long long)Get((Gauge)i));
+    out += line;
+  }
+  return out;
+}
+
+// ---------------------------------------------------------------------------
+// StatsFileWriter
+// ---------------------------------------------------------------------------
+
+#ifdef _WIN32
+static const char *const kFileEol = "\r\n";
+#else
+static const char *const kFileEol = "\n";
+#endif
+
+StatsFileWriter::StatsFileWriter() : m_intervalSec(60), m_stop(false) {}
+
+StatsFileWriter::~StatsFileWriter() { Stop(); }
+
+bool StatsFileWriter::WriteNow(const std::string &path) {
+  return CsvUtils::WriteFileAtomic(path.c_str(), FormatReport(kFileEol));
+}
+
+void StatsFileWriter::Configure(const std::string &path, int intervalSec) {
+  if (path.empty()) {
+    Stop();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_path = path;
+    m_intervalSec = intervalSec > 0 ? intervalSec : 60;
+    m_stop = false;
+  }
+  if (m_thread.joinable())
+    m_cv.notify_all(); // pick up the new interval now
+  else
+    m_thread = std::thread(&StatsFileWriter::Loop, this);
+}
+
+void StatsFileWriter::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  if (m_thread.joinable())
+    m_thread.join();
+}
+
+void StatsFileWriter::Loop() {
+  Trace::SetThreadName("stats-file");
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_stop) {
+    m_cv.wait_for(lock, std::chrono::seconds(m_intervalSec));
+    std::string path = m_path;
+    lock.unlock();
+    // One last write on stop, so the file reflects the whole session
+    WriteNow(path);
+    lock.lock();
+  }
+}
+
+} // namespace Metrics
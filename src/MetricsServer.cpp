@@ -0,0 +1,180 @@
+// MetricsServer.cpp — Loopback Prometheus Endpoint
+
+// winsock2.h must precede anything that pulls in windows.h
+#include "SocketCompat.h"
+
+#include "MetricsServer.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include <cstdio>
+#include <cstring>
+
+// Longest request head read; anything larger is answered 400
+static const size_t kMaxRequest = 8192;
+
+MetricsServer::MetricsServer()
+    : m_stop(false), m_listen((uintptr_t)Net::kInvalid), m_port(0) {}
+
+MetricsServer::~MetricsServer() { Stop(); }
+
+// ---------------------------------------------------------------------------
+// Lifecycle
+// ---------------------------------------------------------------------------
+
+bool MetricsServer::Start(int port, AppendFn extra, const LogFn &log) {
+  Stop();
+  m_extra = std::move(extra);
+  m_log = log;
+
+  if (!Net::Startup())
+    return false;
+
+  Net::Socket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (s == Net::kInvalid) {
+    Net::Cleanup();
+    return false;
+  }
+#ifndef _WIN32
+  int one = 1;
+  setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#endif
+
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons((unsigned short)port);
+  Net::SockLen len = sizeof(addr);
+  if (bind(s, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(s, 8) != 0 ||
+      getsockname(s, (sockaddr *)&addr, &len) != 0) {
+    if (m_log) {
+      char msg[128];
+      snprintf(msg, sizeof(msg),
+               "ERROR: MetricsServer — cannot listen on 127.0.0.1:%d", port);
+      m_log(msg);
+    }
+    Net::Close(s);
+    Net::Cleanup();
+    return false;
+  }
+
+  m_listen = (uintptr_t)s;
+  m_port = ntohs(addr.sin_port);
+  m_stop = false;
+  m_thread = std::thread(&MetricsServer::Loop, this);
+  return true;
+}
+
+void MetricsServer::Stop() {
+  if (!m_thread.joinable())
+    return;
+  m_stop = true;
+  m_thread.join();
+  Net::Close((Net::Socket)m_listen);
+  m_listen = (uintptr_t)Net::kInvalid;
+  m_port = 0;
+  Net::Cleanup();
+}
+
+// ---------------------------------------------------------------------------
+// Serving
+// ---------------------------------------------------------------------------
+
+std::string MetricsServer::Render() const {
+  std::string body = Metrics::FormatPrometheus();
+  if (m_extra)
+    m_extra(body);
+  return body;
+}
+
+void MetricsServer::Loop() {
+  Trace::SetThreadName("metrics-http");
+  Net::Socket listener = (Net::Socket)m_listen;
+  while (!m_stop) {
+    // Wake up regularly to notice Stop()
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(listener, &readable);
+    timeval tv = {0, 250 * 1000};
+    int ready = select((int)listener + 1, &readable, nullptr, nullptr, &tv);
+    if (ready <= 0)
+      continue;
+
+    Net::Socket client = accept(listener, nullptr, nullptr);
+    if (client == Net::kInvalid)
+      continue;
+    Serve((uintptr_t)client);
+    Net::Close(client);
+  }
+}
+
+static bool SendAll(Net::Socket s, const char *data, size_t size) {
+  while (size > 0) {
+    int n = send(s, data, (int)size, Net::kSendFlags);
+    if (n <= 0)
+      return false;
+    data += n;
+    size -= (size_t)n;
+  }
+  return true;
+}
+
+void MetricsServer::Serve(uintptr_t clientHandle) {
+  Net::Socket client = (Net::Socket)clientHandle;
+
+  // A stalled client must not hold the endpoint for long
+  Net::SetTimeouts(client, 2000);
+
+  // Only the request line matters; read until the end of the headers
+  std::string request;
+  char buf[1024];
+  while (request.find("\r\n\r\n") == std::string::npos &&
+         request.find("\n\n") == std::string::npos) {
+    if (request.size() > kMaxRequest)
+      break;
+    int n = recv(client, buf, sizeof(buf), 0);
+    if (n <= 0)
+      break;
+    request.append(buf, (size_t)n);
+  }
+
+  const char *status = "200 OK";
+  std::string body;
+  bool head = false;
+  size_t eol = request.find_first_of("\r\n");
+  std::string line = request.substr(0, eol);
+  size_t sp1 = line.find(' ');
+  size_t sp2 = sp1 == std::string::npos ? sp1 : line.find(' ', sp1 + 1);
+  if (sp2 == std::string::npos) {
+    status = "400 Bad Request";
+  } else {
+    std::string method = line.substr(0, sp1);
+    std::string path = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    size_t query = path.find('?');
+    if (query != std::string::npos)
+      path.resize(query);
+    head = method == "HEAD";
+    if (method != "GET" && !head)
+      status = "405 Method Not Allowed";
+    else if (path == "/metrics")
+      body = Render();
+    else if (path == "/")
+      body = "DSE Data Plugin metrics: /metrics\n";
+    else
+      status = "404 Not Found";
+  }
+  if (body.empty() && strcmp(status, "200 OK") != 0) {
+    body = status;
+    body += '\n';
+  }
+
+  char header[256];
+  snprintf(header, sizeof(header),
+           "HTTP/1.1 %s\r\n"
+           "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+           "Content-Length: %zu\r\n"
+           "Connection: close\r\n\r\n",
+           status, body.size());
+  if (SendAll(client, header, strlen(header)) && !head)
+    SendAll(client, body.data(), body.size());
+}
@@ -0,0 +1,215 @@
+// OsServices.cpp — Clock, File and Debug-Output Primitives
+
+#include "OsServices.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <cerrno>
+#include <dirent.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace Os {
+
+// ---------------------------------------------------------------------------
+// Clock
+// ---------------------------------------------------------------------------
+
+LocalTime LocalNow() {
+  LocalTime t;
+#ifdef _WIN32
+  SYSTEMTIME st;
+  GetLocalTime(&st);
+  t.year = st.wYear;
+  t.month = st.wMonth;
+  t.day = st.wDay;
+  t.hour = st.wHour;
+  t.minute = st.wMinute;
+  t.second = st.wSecond;
+  t.ms = st.wMilliseconds;
+#else
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  struct tm tm;
+  localtime_r(&tv.tv_sec, &tm);
+  t.year = tm.tm_year + 1900;
+  t.month = tm.tm_mon + 1;
+  t.day = tm.tm_mday;
+  t.hour = tm.tm_hour;
+  t.minute = tm.tm_min;
+  t.second = tm.tm_sec;
+  t.ms = (int)(tv.tv_usec / 1000);
+#endif
+  return t;
+}
+
+uint64_t MonotonicMs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void SleepMs(int ms) {
+  if (ms > 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// ---------------------------------------------------------------------------
+// Files
+// ---------------------------------------------------------------------------
+
+#ifdef _WIN32
+const char kPathSep = '\\';
+#else
+const char kPathSep = '/';
+#endif
+
+bool FileExists(const char *path) {
+  if (!path || !path[0])
+    return false;
+#ifdef _WIN32
+  return GetFileAttributesA(path) != INVALID_FILE_ATTRIBUTES;
+#else
+  struct stat st;
+  return stat(path, &st) == 0;
+#endif
+}
+
+bool MakeDir(const char *path) {
+  if (!path || !path[0])
+    return false;
+#ifdef _WIN32
+  CreateDirectoryA(path, NULL);
+  DWORD attr = GetFileAttributesA(path);
+  return attr != INVALID_FILE_ATTRIBUTES && (attr & FILE_ATTRIBUTE_DIRECTORY);
+#else
+  mkdir(path, 0755);
+  struct stat st;
+  return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+#endif
+}
+
+std::vector<std::string> ListFiles(const std::string &dir) {
+  std::vector<std::string> names;
+#ifdef _WIN32
+  WIN32_FIND_DATAA fd;
+  HANDLE h = FindFirstFileA((dir + "\\*").c_str(), &fd);
+  if (h == INVALID_HANDLE_VALUE)
+    return names;
+  do {
+    if (!(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+      names.push_back(fd.cFileName);
+  } while (FindNextFileA(h, &fd));
+  FindClose(h);
+#else
+  DIR *d = opendir(dir.c_str());
+  if (!d)
+    return names;
+  while (struct dirent *e = readdir(d)) {
+    if (e->d_name[0] == '.')
+      continue;
+    struct stat st;
+    if (stat(JoinPath(dir, e->d_name).c_str(), &st) == 0 &&
+        S_ISREG(st.st_mode))
+      names.push_back(e->d_name);
+  }
+  closedir(d);
+#endif
+  std::sort(names.begin(), names.end());
+  return names;
+}
+
+bool IsAbsolutePath(const char *path) {
+  if (!path || !path[0])
+    return false;
+  return path[0] == '\\' || path[0] == '/' || strchr(path, ':') != nullptr;
+}
+
+std::string JoinPath(const std::string &dir, const std::string &name) {
+  if (dir.empty())
+    return name;
+  char last = dir[dir.size() - 1];
+  if (last == '\\' || last == '/')
+    return dir + name;
+  return dir + kPathSep + name;
+}
+
+std::string DirName(const char *path) {
+  if (!path)
+    return std::string();
+  const char *slash = nullptr;
+  for (const char *p = path; *p; ++p)
+    if (*p == '\\' || *p == '/')
+      slash = p;
+  return slash ? std::string(path, slash - path) : std::string();
+}
+
+// ---------------------------------------------------------------------------
+// Diagnostics
+// ---------------------------------------------------------------------------
+
+void DebugOutput(const char *text) {
+#ifdef _WIN32
+  OutputDebugStringA(text);
+#else
+  (void)text;
+#endif
+}
+
+uint64_t ResidentBytes() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+    return 0;
+  return pmc.WorkingSetSize;
+#else
+  // statm: size resident shared text lib data dt, in pages
+  FILE *fp = fopen("/proc/self/statm", "r");
+  if (!fp)
+    return 0;
+  unsigned long long size = 0, resident = 0;
+  int n = fscanf(fp, "%llu %llu", &size, &resident);
+  fclose(fp);
+  if (n != 2)
+    return 0;
+  return resident * (uint64_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Processes
+// ---------------------------------------------------------------------------
+
+uint32_t ProcessId() {
+#ifdef _WIN32
+  return (uint32_t)GetCurrentProcessId();
+#else
+  return (uint32_t)getpid();
+#endif
+}
+
+bool ProcessAlive(uint32_t pid) {
+#ifdef _WIN32
+  HANDLE h = OpenProcess(SYNCHRONIZE, FALSE, pid);
+  if (!h)
+    return GetLastError() == ERROR_ACCESS_DENIED;
+  DWORD wait = WaitForSingleObject(h, 0);
+  CloseHandle(h);
+  return wait == WAIT_TIMEOUT;
+#else
+  return kill((pid_t)pid, 0) == 0 || errno == EPERM;
+#endif
+}
+
+} // namespace Os
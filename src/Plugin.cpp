@@ -6,7 +6,10 @@
 
 #include "Plugin.h"
 #include "DseDataEngine.h"
+#include "Metrics.h"
+#include "Trace.h"
 #include "RealtimeFeed.h"
+#include "WinInetHttpClient.h"
 #include <commctrl.h>
 #include <mutex>
 #include <set>
@@ -83,36 +86,35 @@ static void FindConfigPath() {
   }
 }
 
-static std::string DateDaysAgo(int days) {
-  SYSTEMTIME st;
-  GetLocalTime(&st);
-
-  FILETIME ft;
-  SystemTimeToFileTime(&st, &ft);
-
-  ULARGE_INTEGER ul;
-  ul.LowPart = ft.dwLowDateTime;
-  ul.HighPart = ft.dwHighDateTime;
-
-  // Subtract 'days' (864000000000 100-ns intervals per day)
-  ul.QuadPart -= (10000000ULL * 60 * 60 * 24) * days;
-
-  ft.dwLowDateTime = ul.LowPart;
-  ft.dwHighDateTime = ul.HighPart;
-  FileTimeToSystemTime(&ft, &st);
-
+// YYYYMMDD -> "YYYY-MM-DD"
+static std::string FormatYmd(int ymd) {
   char buf[16];
-  sprintf_s(buf, "%04d-%02d-%02d", st.wYear, st.wMonth, st.wDay);
+  sprintf_s(buf, "%04d-%02d-%02d", ymd / 10000, (ymd / 100) % 100, ymd % 100);
   return std::string(buf);
 }
 
-static std::string DateToday() {
-  SYSTEMTIME st;
-  GetLocalTime(&st);
+// Dates below are exchange dates (DSE time), whatever the workstation's
+// time zone.
+static std::string DateDaysAgo(int days) {
+  int today = g_engine.GetClock().Today();
+  return FormatYmd(
+      TradingCalendar::FromDayNumber(TradingCalendar::ToDayNumber(today) - days));
+}
 
-  char buf[16];
-  sprintf_s(buf, "%04d-%02d-%02d", st.wYear, st.wMonth, st.wDay);
-  return std::string(buf);
+static std::string DateToday() { return FormatYmd(g_engine.GetClock().Today()); }
+
+// Most recent trading day on or before today, as "YYYY-MM-DD". Ends history
+// windows on a day the archive can actually have rows for.
+static std::string LastTradingDate() {
+  int ymd = g_engine.GetClock().Today();
+
+  std::shared_ptr<const TradingCalendar> cal = g_engine.GetCalendar();
+  if (!cal->IsTradingDay(ymd)) {
+    int prev = cal->PrevTradingDay(ymd);
+    if (prev)
+      ymd = prev;
+  }
+  return FormatYmd(ymd);
 }
 
 // LazyBackfill — fetch historical data for symbol in the background.
@@ -134,6 +136,16 @@ static void LazyBackfill(const char *symbol) {
     char lastDate[16];
     sprintf_s(lastDate, "%04d-%02d-%02d", last.year, last.month, last.day);
 
+    // No trading day since the last bar (weekend, holiday) — nothing new
+    // can exist, so skip the request entirely
+    int lastYmd = last.year * 10000 + last.month * 100 + last.day;
+    int nextYmd = g_engine.GetCalendar()->NextTradingDay(lastYmd);
+    if (!nextYmd || nextYmd > g_engine.GetClock().Today()) {
+      g_engine.Log("LazyBackfill: %s up to date (no session since %s)",
+                   symbol, lastDate);
+      return;
+    }
+
     // Fetch from last cached date to today
     std::vector<DseBar> newBars;
     g_engine.FetchHistoricalData(
@@ -163,9 +175,9 @@ static void LazyBackfill(const char *symbol) {
                  symbol, newBars.size());
   } else {
     // No cached data — full backfill
-    int days = g_engine.GetConfig().historyDays;
+    int days = g_engine.GetConfig()->historyDays;
     std::string startDate = DateDaysAgo(days);
-    std::string endDate = DateToday();
+    std::string endDate = LastTradingDate();
 
     std::vector<DseBar> bars;
     g_engine.FetchHistoricalData(
@@ -201,17 +213,21 @@ struct BackfillParams {
 };
 
 static DWORD WINAPI BackfillThreadProc(LPVOID lpParam) {
+  Trace::SetThreadName("backfill");
+  Trace::Span span("Backfill", "backfill");
   BackfillParams *p = (BackfillParams *)lpParam;
   char symbol[64];
   strncpy_s(symbol, p->symbol, sizeof(symbol) - 1);
   symbol[sizeof(symbol) - 1] = '\0';
   LazyBackfill(p->symbol);
   delete p;
+  Metrics::Adjust(Metrics::kBackfills, -1);
 
   // Tell AmiBroker to refresh
   if (g_hAmiBrokerWnd && IsWindow(g_hAmiBrokerWnd)) {
     g_engine.Log("DEBUG: BackfillThreadProc done, posting final "
                  "WM_USER_STREAMING_UPDATE");
+    Trace::Instant("PostMessage", "msg");
     RecentInfo *ri = new RecentInfo;
     memset(ri, 0, sizeof(RecentInfo));
     ri->nStructSize = sizeof(RecentInfo);
@@ -227,25 +243,55 @@ static DWORD WINAPI BackfillThreadProc(LPVOID lpParam) {
 // Thread for handling bulk synchronization of all symbols
 static DWORD WINAPI BulkSyncThreadProc(LPVOID lpParam) {
   int syncType = (int)(intptr_t)lpParam; // 1 = DSE, 2 = Amarstock
+  Trace::SetThreadName("bulk-sync");
+  Trace::Span span("BulkSync", "backfill");
   g_engine.Log("BulkSync: Starting full database synchronization (Type %d)...",
                syncType);
 
-  // We need a stable copy of the symbol list to iterate over
-  std::vector<std::string> syms = g_engine.GetSymbolList();
-
-  if (syms.empty()) {
-    g_engine.RefreshSymbolList();
-    syms = g_engine.GetSymbolList();
-  }
+  // A published list never changes, so iterating the snapshot is safe
+  std::shared_ptr<const std::vector<std::string>> symList =
+      g_engine.GetSymbolList();
+  const std::vector<std::string> &syms = *symList;
 
   int successCount = 0;
   int processedTargetCount = 0;
+
+  // DSE symbols: pull the whole market per date window in a handful of
+  // archive requests instead of one request per symbol. Falls back to the
+  // per-symbol loop below if any market-wide window cannot be fetched, so
+  // no series is left with a hole.
+  bool marketDone = false;
+  if (syncType == 1) {
+    int days = g_engine.GetConfig()->historyDays;
+    std::string startDate = DateDaysAgo(days);
+    std::string endDate = LastTradingDate();
+    int failedWindows = 0;
+    int updated = g_engine.FetchMarketHistory(
+        startDate.c_str(), endDate.c_str(), &failedWindows);
+    if (updated > 0 && failedWindows > 0) {
+      g_engine.Log("BulkSync: %d market-wide windows failed, falling back "
+                   "to per-symbol requests",
+                   failedWindows);
+    } else if (updated > 0) {
+      marketDone = true;
+      successCount = updated;
+      for (const auto &sym : syms) {
+        if (!g_engine.IsAmarstockIndex(sym.c_str()))
+          processedTargetCount++;
+      }
+      g_engine.Log("BulkSync: market-wide ingestion updated %d symbols",
+                   updated);
+    } else {
+      g_engine.Log("BulkSync: market-wide ingestion failed, falling back to "
+                   "per-symbol requests");
+    }
+  }
+
   for (const auto &sym : syms) {
-    bool isAmarstock = (_stricmp(sym.c_str(), "00DS30") == 0 ||
-                        _stricmp(sym.c_str(), "00DSES") == 0 ||
-                        _stricmp(sym.c_str(), "00DSEX") == 0 ||
-                        _stricmp(sym.c_str(), "00DSMEX") == 0);
+    if (marketDone)
+      break;
 
+    bool isAmarstock = g_engine.IsAmarstockIndex(sym.c_str());
     if (syncType == 1 && isAmarstock)
       continue;
     if (syncType == 2 && !isAmarstock)
@@ -258,9 +304,9 @@ static DWORD WINAPI BulkSyncThreadProc(LPVOID lpParam) {
     // LazyBackfill will handle creating individual threads or synchronous
     // backfill To prevent 400 simultaneous threads, we call FetchHistoricalData
     // directly in this loop
-    int days = g_engine.GetConfig().historyDays;
+    int days = g_engine.GetConfig()->historyDays;
     std::string startDate = DateDaysAgo(days);
-    std::string endDate = DateToday();
+    std::string endDate = LastTradingDate();
 
     std::vector<DseBar> bars;
     bool success = g_engine.FetchHistoricalData(sym.c_str(), startDate.c_str(),
@@ -352,7 +398,9 @@ extern "C" __declspec(dllexport) int Init(void) {
   // Find configuration file
   FindConfigPath();
 
-  // Initialize the data engine
+  // Initialize the data engine; it is platform-neutral, so the plugin
+  // supplies the HTTP transport
+  g_engine.SetHttpClient(std::unique_ptr<HttpClient>(new WinInetHttpClient()));
   if (!g_engine.Initialize(g_configPath)) {
     g_engine.Log("Plugin::Init — engine initialization failed");
     // Continue anyway with defaults
@@ -414,6 +462,10 @@ extern "C" __declspec(dllexport) int Release(void) {
 #define ID_BTN_SYNC 1011
 #define ID_BTN_BROWSE 1012
 #define ID_BTN_SYNC_INDICES 1013
+#define ID_BTN_STATS 1014
+#define ID_EDIT_STATS 1015
+#define ID_BTN_STATS_REFRESH 1016
+#define ID_BTN_TRACE 1017
 
 // Helper function for adding controls
 static void AddCtrl(WORD *&p, DWORD style, short x, short y, short cx, short cy,
@@ -446,6 +498,76 @@ static void AddCtrl(WORD *&p, DWORD style, short x, short y, short cx, short cy,
     p++;
 }
 
+// Performance Stats viewer: the Metrics report in a read-only fixed-pitch
+// edit box, re-rendered on Refresh.
+static void FillStatsText(HWND hDlg) {
+  std::string report = Metrics::FormatReport("\r\n");
+  SetDlgItemTextA(hDlg, ID_EDIT_STATS, report.c_str());
+}
+
+static INT_PTR CALLBACK StatsDlgProc(HWND hDlg, UINT msg, WPARAM wParam,
+                                     LPARAM lParam) {
+  switch (msg) {
+  case WM_INITDIALOG:
+    SendDlgItemMessageA(hDlg, ID_EDIT_STATS, WM_SETFONT,
+                        (WPARAM)GetStockObject(ANSI_FIXED_FONT), FALSE);
+    FillStatsText(hDlg);
+    return TRUE;
+
+  case WM_COMMAND:
+    switch (LOWORD(wParam)) {
+    case ID_BTN_STATS_REFRESH:
+      FillStatsText(hDlg);
+      return TRUE;
+    case IDOK:
+    case IDCANCEL:
+      EndDialog(hDlg, IDOK);
+      return TRUE;
+    }
+    break;
+
+  case WM_CLOSE:
+    EndDialog(hDlg, IDOK);
+    return TRUE;
+  }
+  return FALSE;
+}
+
+static void ShowStatsDialog(HWND hParent) {
+  WORD dlgTemplate[1024];
+  memset(dlgTemplate, 0, sizeof(dlgTemplate));
+  WORD *p = dlgTemplate;
+
+  DLGTEMPLATE *pDlg = (DLGTEMPLATE *)p;
+  pDlg->style = WS_POPUP | WS_CAPTION | WS_SYSMENU | DS_MODALFRAME | DS_CENTER |
+                WS_VISIBLE;
+  pDlg->cdit = 3;
+  pDlg->cx = 440;
+  pDlg->cy = 230;
+  p += sizeof(DLGTEMPLATE) / sizeof(WORD);
+
+  *p++ = 0; // menu
+  *p++ = 0; // class
+  const wchar_t *title = L"DSE Data Plugin — Performance Stats";
+  size_t titleLen = wcslen(title) + 1;
+  memcpy(p, title, titleLen * sizeof(WORD));
+  p += titleLen;
+  if ((ULONG_PTR)p & 2)
+    p++;
+
+  AddCtrl(p,
+          WS_BORDER | WS_VSCROLL | WS_HSCROLL | ES_MULTILINE | ES_READONLY |
+              ES_AUTOHSCROLL | ES_AUTOVSCROLL,
+          10, 10, 420, 186, ID_EDIT_STATS, L"EDIT", L"");
+  AddCtrl(p, WS_TABSTOP | BS_PUSHBUTTON, 300, 206, 60, 14,
+          ID_BTN_STATS_REFRESH, L"BUTTON", L"Refresh");
+  AddCtrl(p, WS_TABSTOP | BS_DEFPUSHBUTTON, 370, 206, 60, 14, IDOK, L"BUTTON",
+          L"OK");
+
+  DialogBoxIndirectParamA(g_hInstance, (DLGTEMPLATE *)dlgTemplate, hParent,
+                          StatsDlgProc, 0);
+}
+
 static INT_PTR CALLBACK ConfigDlgProc(HWND hDlg, UINT msg, WPARAM wParam,
                                       LPARAM lParam) {
   switch (msg) {
@@ -454,11 +576,12 @@ static INT_PTR CALLBACK ConfigDlgProc(HWND hDlg, UINT msg, WPARAM wParam,
     SetWindowLongPtr(hDlg, GWLP_USERDATA, (LONG_PTR)lParam);
 
     // Fill current config values
+    std::shared_ptr<const DseConfig> cfg = g_engine.GetConfig();
     char buf[64];
-    sprintf_s(buf, "%d", g_engine.GetConfig().historyDays);
+    sprintf_s(buf, "%d", cfg->historyDays);
     SetDlgItemTextA(hDlg, ID_EDIT_YEARS, buf);
 
-    sprintf_s(buf, "%d", g_engine.GetConfig().pollIntervalMs);
+    sprintf_s(buf, "%d", cfg->pollIntervalMs);
     SetDlgItemTextA(hDlg, ID_EDIT_POLL, buf);
 
     // Connection status
@@ -469,14 +592,13 @@ static INT_PTR CALLBACK ConfigDlgProc(HWND hDlg, UINT msg, WPARAM wParam,
 
     // Set Checkbox
     CheckDlgButton(hDlg, ID_CHK_PREFER_WEB,
-                   g_engine.GetConfig().preferWebData ? BST_CHECKED
-                                                      : BST_UNCHECKED);
+                   cfg->preferWebData ? BST_CHECKED : BST_UNCHECKED);
 
     // Set Export Path
-    SetDlgItemTextA(hDlg, ID_EDIT_EXPORT_PATH, g_engine.GetConfig().exportPath);
+    SetDlgItemTextA(hDlg, ID_EDIT_EXPORT_PATH, cfg->exportPath);
 
     // Set Export Interval
-    sprintf_s(buf, "%d", g_engine.GetConfig().exportIntervalSec);
+    sprintf_s(buf, "%d", cfg->exportIntervalSec);
     SetDlgItemTextA(hDlg, ID_EDIT_EXPORT_INT, buf);
 
     return TRUE;
@@ -491,7 +613,7 @@ static INT_PTR CALLBACK ConfigDlgProc(HWND hDlg, UINT msg, WPARAM wParam,
 
       // Save just this setting temporarily to config file so engine can reload
       WritePrivateProfileStringA("Export", "ExportPath", path, g_configPath);
-      g_engine.Initialize(g_configPath); // Reloads config
+      g_engine.ReloadConfig();
 
       g_engine.ExportAllDataToCsv();
       MessageBoxA(hDlg, "Export started! Check logs/files.", "DSE Plugin",
@@ -559,11 +681,9 @@ static INT_PTR CALLBACK ConfigDlgProc(HWND hDlg, UINT msg, WPARAM wParam,
       WritePrivateProfileStringA("Export", "ExportIntervalSec", exportIntBuf,
                                  g_configPath);
 
-      // Reload config
-      g_engine.Initialize(g_configPath);
-
-      // Update feed interval
-      g_feed.SetPollInterval(pollMs);
+      // Apply live; the feed picks up the new interval through its config
+      // listener without restarting
+      g_engine.ReloadConfig();
 
       EndDialog(hDlg, IDOK);
       return TRUE;
@@ -573,13 +693,35 @@ static INT_PTR CALLBACK ConfigDlgProc(HWND hDlg, UINT msg, WPARAM wParam,
       EndDialog(hDlg, IDCANCEL);
       return TRUE;
 
+    case ID_BTN_STATS:
+      ShowStatsDialog(hDlg);
+      return TRUE;
+
+    case ID_BTN_TRACE: {
+      std::string path;
+      if (g_engine.DumpTrace(path)) {
+        std::string msg = "Trace written to:\n" + path +
+                          "\n\nOpen it in ui.perfetto.dev or chrome://tracing.";
+        MessageBoxA(hDlg, msg.c_str(), "DSE Plugin", MB_OK);
+      } else if (path.empty()) {
+        MessageBoxA(hDlg,
+                    "Tracing is off. Set [Trace] Enabled=1 in "
+                    "dse_config.ini, reproduce the stall, then dump again.",
+                    "DSE Plugin", MB_OK | MB_ICONINFORMATION);
+      } else {
+        std::string msg = "Could not write " + path;
+        MessageBoxA(hDlg, msg.c_str(), "DSE Plugin", MB_OK | MB_ICONERROR);
+      }
+      return TRUE;
+    }
+
     case ID_BTN_REFRESH: {
       // Force refresh symbol list
       g_engine.RefreshSymbolList();
-      auto &syms = g_engine.GetSymbolList();
+      auto syms = g_engine.GetSymbolList();
 
       char msg[128];
-      sprintf_s(msg, "Refreshed: %zu symbols found", syms.size());
+      sprintf_s(msg, "Refreshed: %zu symbols found", syms->size());
       SetDlgItemTextA(hDlg, ID_STATIC_STATUS, msg);
       return TRUE;
     }
@@ -592,11 +734,9 @@ static INT_PTR CALLBACK ConfigDlgProc(HWND hDlg, UINT msg, WPARAM wParam,
         return TRUE;
       }
 
-      const std::vector<std::string> *pSyms = &g_engine.GetSymbolList();
-      if (pSyms->empty()) {
-        g_engine.RefreshSymbolList();
-        pSyms = &g_engine.GetSymbolList();
-      }
+      // GetSymbolList refreshes from DSE when nothing is loaded yet
+      std::shared_ptr<const std::vector<std::string>> pSyms =
+          g_engine.GetSymbolList();
 
       if (pSyms->empty()) {
         MessageBoxA(hDlg, "No symbols found to sync. Try Refresh first.",
@@ -649,11 +789,9 @@ static INT_PTR CALLBACK ConfigDlgProc(HWND hDlg, UINT msg, WPARAM wParam,
         return TRUE;
       }
 
-      const std::vector<std::string> *pSyms = &g_engine.GetSymbolList();
-      if (pSyms->empty()) {
-        g_engine.RefreshSymbolList();
-        pSyms = &g_engine.GetSymbolList();
-      }
+      // GetSymbolList refreshes from DSE when nothing is loaded yet
+      std::shared_ptr<const std::vector<std::string>> pSyms =
+          g_engine.GetSymbolList();
 
       int added = 0;
       int targetCount = 0;
@@ -722,7 +860,7 @@ PLUGINAPI int Configure(LPCTSTR pszPath, struct InfoSite *pSite) {
   pDlg->style = WS_POPUP | WS_CAPTION | WS_SYSMENU | DS_MODALFRAME | DS_CENTER |
                 WS_VISIBLE;
   pDlg->dwExtendedStyle = 0;
-  pDlg->cdit = 18; // Number of controls
+  pDlg->cdit = 20; // Number of controls
   pDlg->x = 0;
   pDlg->y = 0;
   pDlg->cx = 300;
@@ -796,6 +934,12 @@ PLUGINAPI int Configure(LPCTSTR pszPath, struct InfoSite *pSite) {
   AddCtrl(p, WS_TABSTOP | BS_PUSHBUTTON, 120, 155, 100, 14, ID_BTN_SAVE_NOW,
           L"BUTTON", L"Save CSVs Now");
 
+  // Hot-path latency histograms and counters
+  AddCtrl(p, WS_TABSTOP | BS_PUSHBUTTON, 10, 180, 110, 14, ID_BTN_STATS,
+          L"BUTTON", L"Performance Stats...");
+  AddCtrl(p, WS_TABSTOP | BS_PUSHBUTTON, 130, 180, 110, 14, ID_BTN_TRACE,
+          L"BUTTON", L"Dump Trace");
+
   // OK / Cancel
   AddCtrl(p, WS_TABSTOP | BS_DEFPUSHBUTTON, 150, 236, 60, 14, ID_BTN_OK,
           L"BUTTON", L"OK");
@@ -809,6 +953,16 @@ PLUGINAPI int Configure(LPCTSTR pszPath, struct InfoSite *pSite) {
   return 1;
 }
 
+// AmiBroker calls in on its own threads; name each in the trace once
+// rather than on every call.
+static void NameAmiBrokerThread() {
+  static thread_local bool named = false;
+  if (named)
+    return;
+  named = true;
+  Trace::SetThreadName("amibroker");
+}
+
 // GetQuotesEx — deliver OHLCV bar array to AmiBroker.
 // Merges cached data with any live real-time quote, triggers a background
 // backfill if no cached data exists for this symbol.
@@ -819,6 +973,10 @@ PLUGINAPI int GetQuotesEx(const char *pszTicker, int nPeriodicity,
   if (!pszTicker || !pszTicker[0] || !pQuotes || nSize <= 0)
     return (nLastValid < 0) ? 0 : nLastValid + 1;
 
+  Metrics::ScopedTimer timer(Metrics::kGetQuotesEx);
+  NameAmiBrokerThread();
+  Trace::Span span("GetQuotesEx", "amibroker");
+
   // Get cached bars
   std::vector<DseBar> bars;
 
@@ -865,7 +1023,14 @@ PLUGINAPI int GetQuotesEx(const char *pszTicker, int nPeriodicity,
         BackfillParams *p = new BackfillParams;
         strncpy_s(p->symbol, pszTicker, sizeof(p->symbol) - 1);
         g_engine.Log("DEBUG: GetQuotesEx: Creating thread for %s", pszTicker);
-        CreateThread(NULL, 0, BackfillThreadProc, p, 0, NULL);
+        Metrics::Adjust(Metrics::kBackfills, 1);
+        HANDLE hThread = CreateThread(NULL, 0, BackfillThreadProc, p, 0, NULL);
+        if (hThread) {
+          CloseHandle(hThread);
+        } else {
+          Metrics::Adjust(Metrics::kBackfills, -1);
+          delete p;
+        }
       } else {
         g_engine.Log("DEBUG: GetQuotesEx - Backfill already enqueued for %s",
                      pszTicker);
@@ -928,6 +1093,41 @@ PLUGINAPI int GetQuotesEx(const char *pszTicker, int nPeriodicity,
     mergedQuotes[key] = q;
   }
 
+  // 3b. Intraday databases: replace the daily bars of every day covered by
+  // the snapshot aggregator with its true per-interval bars
+  bool servedIntraday = false;
+  if (nPeriodicity > 0 && nPeriodicity < PERIODICITY_EOD) {
+    std::vector<DseIntradayBar> ibars;
+    if (g_feed.GetIntradayBars(pszTicker, nPeriodicity, ibars)) {
+      const DseIntradayBar &first = ibars.front();
+      AmiDate firstDay = PackAmiDate(first.date / 10000,
+                                     (first.date / 100) % 100,
+                                     first.date % 100, 0, 0, 0);
+      mergedQuotes.erase(mergedQuotes.lower_bound(firstDay.Date),
+                         mergedQuotes.end());
+
+      for (const auto &b : ibars) {
+        AmiDate ad = PackAmiDate(b.date / 10000, (b.date / 100) % 100,
+                                 b.date % 100, b.time / 10000,
+                                 (b.time / 100) % 100, b.time % 100);
+        Quotation q;
+        memset(&q, 0, sizeof(q));
+        q.DateTime = ad;
+        q.Open = (float)b.open;
+        q.High = (float)b.high;
+        q.Low = (float)b.low;
+        q.Price = (float)b.close;
+        q.Volume = (float)b.volume;
+        q.AuxData1 = (float)b.trade;
+        q.AuxData2 = (float)b.value;
+        mergedQuotes[ad.Date] = q;
+      }
+      servedIntraday = true;
+      g_engine.Log("DEBUG: GetQuotesEx - %zu intraday bars (%ds) for %s",
+                   ibars.size(), nPeriodicity, pszTicker);
+    }
+  }
+
   // 4. Fill the Quotation array with the merged data
   // AmiBroker expects data from oldest (index 0) to newest (index N)
   int count = (int)mergedQuotes.size();
@@ -950,21 +1150,21 @@ PLUGINAPI int GetQuotesEx(const char *pszTicker, int nPeriodicity,
       break;
   }
 
-  // If we have a real-time quote, update the last bar
+  // If we have a real-time quote, update the last bar (intraday bars from
+  // the aggregator already include the latest snapshot)
   DseQuote liveQuote;
-  if (g_feed.GetLatestQuote(pszTicker, liveQuote) && count > 0) {
+  if (!servedIntraday && g_feed.GetLatestQuote(pszTicker, liveQuote) &&
+      count > 0) {
     int lastIdx = count - 1;
 
-    // Only update if it's the same day
-    SYSTEMTIME st;
-    GetLocalTime(&st);
+    // Only update if it's the same (exchange) day
+    MarketClock::Time now = g_engine.GetClock().Now();
 
     int lastYear, lastMonth, lastDay, h, m, s;
     UnpackAmiDate(pQuotes[lastIdx].DateTime, &lastYear, &lastMonth, &lastDay,
                   &h, &m, &s);
 
-    if (lastYear == (int)st.wYear && lastMonth == (int)st.wMonth &&
-        lastDay == (int)st.wDay) {
+    if (lastYear * 10000 + lastMonth * 100 + lastDay == now.date) {
       // Update today's bar with live data
       if (liveQuote.ltp > 0)
         pQuotes[lastIdx].Price = (float)liveQuote.ltp;
@@ -977,17 +1177,19 @@ PLUGINAPI int GetQuotesEx(const char *pszTicker, int nPeriodicity,
 
       // Update time if intraday
       if (g_timeBase < 86400) {
-        pQuotes[lastIdx].DateTime = PackAmiDate(
-            st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond);
+        pQuotes[lastIdx].DateTime =
+            PackAmiDate(now.date / 10000, (now.date / 100) % 100,
+                        now.date % 100, now.hour(), now.minute(), now.second());
       }
     } else if (g_engine.IsMarketOpen()) {
       // It's a new day — add a new bar
       if (count < nSize) {
         int newIdx = count;
+        bool intraday = g_timeBase < 86400;
         pQuotes[newIdx].DateTime = PackAmiDate(
-            st.wYear, st.wMonth, st.wDay, (g_timeBase < 86400) ? st.wHour : 0,
-            (g_timeBase < 86400) ? st.wMinute : 0,
-            (g_timeBase < 86400) ? st.wSecond : 0);
+            now.date / 10000, (now.date / 100) % 100, now.date % 100,
+            intraday ? now.hour() : 0, intraday ? now.minute() : 0,
+            intraday ? now.second() : 0);
 
         pQuotes[newIdx].Open = (float)liveQuote.open;
         pQuotes[newIdx].High = (float)liveQuote.high;
@@ -1142,6 +1344,8 @@ PLUGINAPI int Notify(struct PluginNotification *pNotification) {
 
   case REASON_SETTINGS_CHANGE:
     g_engine.Log("Notify: settings change");
+    if (g_initialized)
+      g_engine.ReloadConfig();
     break;
   }
 
@@ -1149,6 +1353,9 @@ PLUGINAPI int Notify(struct PluginNotification *pNotification) {
 }
 
 PLUGINAPI struct RecentInfo *GetRecentInfo(const char *pszTicker) {
+  Metrics::ScopedTimer timer(Metrics::kGetRecentInfo);
+  NameAmiBrokerThread();
+  Trace::Span span("GetRecentInfo", "amibroker");
   bool isAmarstock = false;
   if (pszTicker && pszTicker[0]) {
     isAmarstock = (_stricmp(pszTicker, "00DS30") == 0 ||
@@ -0,0 +1,131 @@
+// PollScheduler.cpp — Adaptive Poll Interval and Session Edges
+//
+// The page cadence is estimated from the gaps between polls that saw the
+// page move. Polling at half that cadence catches each update within
+// half a period; since measured gaps are never shorter than the current
+// interval, the estimate converges downward from a long interval too.
+
+#include "PollScheduler.h"
+#include <chrono>
+
+PollScheduler::PollScheduler()
+    : m_baseMs(5000), m_minMs(2000), m_maxMs(30000), m_jitterPct(10),
+      m_adaptive(true), m_openSec(10 * 3600), m_closeEdgeSec(14 * 3600 + 1860),
+      m_calendar(),
+      m_intervalMs(5000), m_cadenceMs(0), m_lastChangeSec(-1),
+      m_unchanged(0),
+      m_rng((unsigned)std::chrono::steady_clock::now()
+                .time_since_epoch()
+                .count()) {}
+
+void PollScheduler::Configure(int baseMs, int minMs, int maxMs, int jitterPct,
+                              bool adaptive, int openSec, int closeSec) {
+  if (minMs < 100)
+    minMs = 100;
+  if (maxMs < minMs)
+    maxMs = minMs;
+  if (baseMs < minMs)
+    baseMs = minMs;
+  if (baseMs > maxMs)
+    baseMs = maxMs;
+  if (jitterPct < 0)
+    jitterPct = 0;
+  if (jitterPct > 50)
+    jitterPct = 50;
+
+  m_baseMs = baseMs;
+  m_minMs = minMs;
+  m_maxMs = maxMs;
+  m_jitterPct = jitterPct;
+  m_adaptive = adaptive;
+  m_openSec = openSec;
+  m_closeEdgeSec = closeSec + 60;
+  Reset();
+}
+
+void PollScheduler::Reset() {
+  m_intervalMs = m_baseMs;
+  m_cadenceMs = 0;
+  m_lastChangeSec = -1;
+  m_unchanged = 0;
+}
+
+void PollScheduler::SetBaseIntervalMs(int ms) {
+  if (ms < m_minMs)
+    ms = m_minMs;
+  if (ms > m_maxMs)
+    ms = m_maxMs;
+  m_baseMs = ms;
+  if (!m_adaptive || !m_cadenceMs)
+    m_intervalMs = ms;
+}
+
+void PollScheduler::OnPoll(bool pageMoved, int secOfDay) {
+  if (m_lastChangeSec < 0 || secOfDay < m_lastChangeSec) {
+    // First poll of the session (or the clock went backwards)
+    m_lastChangeSec = secOfDay;
+    m_unchanged = 0;
+    return;
+  }
+
+  if (pageMoved) {
+    int gapMs = (secOfDay - m_lastChangeSec) * 1000;
+    if (gapMs > 0)
+      m_cadenceMs = m_cadenceMs ? (m_cadenceMs * 3 + gapMs) / 4 : gapMs;
+    m_lastChangeSec = secOfDay;
+    m_unchanged = 0;
+  } else {
+    ++m_unchanged;
+  }
+
+  if (!m_adaptive)
+    return;
+
+  int target = m_cadenceMs ? m_cadenceMs / 2 : m_baseMs;
+  // Back off while the page sits still: +50% per unchanged poll after two
+  for (int i = 2; i < m_unchanged && target < m_maxMs; ++i)
+    target += target / 2;
+
+  if (target < m_minMs)
+    target = m_minMs;
+  if (target > m_maxMs)
+    target = m_maxMs;
+  m_intervalMs = target;
+}
+
+int PollScheduler::NextOpenDelayMs(int date, int secOfDay) {
+  int delay = m_intervalMs;
+  if (m_jitterPct > 0) {
+    int span = delay * m_jitterPct / 100;
+    std::uniform_int_distribution<int> dist(-span, span);
+    delay += dist(m_rng);
+  }
+
+  // Land on the close edge instead of polling past it
+  int closeEdgeSec = m_closeEdgeSec;
+  int openSec, closeSec;
+  if (m_calendar && m_calendar->GetSession(date, openSec, closeSec))
+    closeEdgeSec = closeSec + 60;
+  int untilCloseMs = (closeEdgeSec - secOfDay) * 1000;
+  if (untilCloseMs > 0 && delay > untilCloseMs)
+    delay = untilCloseMs;
+  return delay > 0 ? delay : 0;
+}
+
+int PollScheduler::NextClosedDelayMs(int date, int secOfDay) const {
+  long long untilSec = (secOfDay < m_openSec) ? m_openSec - secOfDay
+                                              : 86400 - secOfDay + m_openSec;
+  int nextDate, openSec;
+  if (m_calendar && date > 0 &&
+      m_calendar->NextSession(date, secOfDay, nextDate, openSec)) {
+    int days = TradingCalendar::ToDayNumber(nextDate) -
+               TradingCalendar::ToDayNumber(date);
+    untilSec = (long long)days * 86400 + openSec - secOfDay;
+  }
+  long long ms = untilSec * 1000;
+  if (ms > kMaxClosedWaitMs)
+    ms = kMaxClosedWaitMs;
+  if (ms < 1000)
+    ms = 1000;
+  return (int)ms;
+}
@@ -0,0 +1,374 @@
+// ProxyClient.cpp — Plugin Side of a dse_proxyd Connection
+
+// winsock2.h must precede anything that pulls in windows.h
+#include "SocketCompat.h"
+
+#include "ProxyClient.h"
+#include "OsServices.h"
+#include "PlatformCompat.h"
+#include "ProxyProtocol.h"
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+using namespace ProxyProtocol;
+
+// The daemon heartbeats every 5 s; this much silence means it is gone
+static const uint64_t kSilenceMs = 15000;
+
+static const int kConnectTimeoutMs = 3000;
+static const int kMaxBackoffMs = 30000;
+
+ProxyClient::ProxyClient()
+    : m_stop(false), m_port(0), m_sock((uintptr_t)Net::kInvalid),
+      m_connected(false), m_haveBoard(false), m_resyncSent(false), m_seq(0),
+      m_nextReqId(1) {}
+
+ProxyClient::~ProxyClient() { Stop(); }
+
+void ProxyClient::Log(const char *fmt, ...) {
+  if (!m_log)
+    return;
+  char msg[512];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(msg, sizeof(msg), fmt, args);
+  va_end(args);
+  m_log(msg);
+}
+
+// ---------------------------------------------------------------------------
+// Lifecycle
+// ---------------------------------------------------------------------------
+
+void ProxyClient::Start(const std::string &host, int port, const LogFn &log) {
+  Stop();
+  m_host = host;
+  m_port = port;
+  m_log = log;
+  m_stop = false;
+  m_thread = std::thread(&ProxyClient::Loop, this);
+}
+
+void ProxyClient::Stop() {
+  if (!m_thread.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  m_thread.join();
+}
+
+bool ProxyClient::IsConnected() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_connected;
+}
+
+// ---------------------------------------------------------------------------
+// Reading the board
+// ---------------------------------------------------------------------------
+
+bool ProxyClient::GetQuotes(std::vector<DseQuote> &outQuotes,
+                            uint64_t &seq) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_connected || !m_haveBoard)
+    return false;
+  outQuotes = m_board;
+  seq = m_seq;
+  return true;
+}
+
+uint64_t ProxyClient::Sequence() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_seq;
+}
+
+bool ProxyClient::WaitForUpdate(uint64_t seenSeq, int ms) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_cv.wait_for(lock, std::chrono::milliseconds(ms > 0 ? ms : 0), [&] {
+    return m_stop || (m_haveBoard && m_seq != seenSeq);
+  });
+  return !m_stop && m_haveBoard && m_seq != seenSeq;
+}
+
+bool ProxyClient::FetchHistory(const char *symbol, const char *startDate,
+                               const char *endDate,
+                               std::vector<DseBar> &outBars, int timeoutMs) {
+  outBars.clear();
+  Pending pending;
+  uint32_t id;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_connected)
+      return false;
+    id = m_nextReqId++;
+    m_pending[id] = &pending;
+  }
+
+  Writer w;
+  w.U32(id);
+  w.Str(symbol);
+  w.Str(startDate);
+  w.Str(endDate);
+  bool sent = Send(MakeFrame(kHistoryRequest, w.Data()));
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (sent)
+    m_cv.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                  [&] { return pending.done || m_stop; });
+  m_pending.erase(id);
+  if (!pending.done || !pending.ok)
+    return false;
+  outBars.swap(pending.bars);
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Connection loop
+// ---------------------------------------------------------------------------
+
+void ProxyClient::Loop() {
+  Trace::SetThreadName("proxy-client");
+  if (!Net::Startup())
+    return;
+  int backoffMs = 1000;
+  bool warned = false;
+  while (!m_stop) {
+    uintptr_t sock = Connect();
+    if (sock != (uintptr_t)Net::kInvalid) {
+      Log("ProxyClient: connected to %s:%d", m_host.c_str(), m_port);
+      backoffMs = 1000;
+      warned = false;
+      Session(sock);
+      Disconnected();
+      Net::Close((Net::Socket)sock);
+      if (m_stop)
+        break;
+      Log("WARNING: ProxyClient — lost %s:%d, scraping until it returns",
+          m_host.c_str(), m_port);
+    } else if (!warned) {
+      Log("WARNING: ProxyClient — cannot reach %s:%d, retrying",
+          m_host.c_str(), m_port);
+      warned = true;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait_for(lock, std::chrono::milliseconds(backoffMs),
+                  [this] { return m_stop.load(); });
+    backoffMs = std::min(backoffMs * 2, kMaxBackoffMs);
+  }
+  Net::Cleanup();
+}
+
+uintptr_t ProxyClient::Connect() {
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  char port[16];
+  snprintf(port, sizeof(port), "%d", m_port);
+  addrinfo *res = nullptr;
+  if (getaddrinfo(m_host.c_str(), port, &hints, &res) != 0 || !res)
+    return (uintptr_t)Net::kInvalid;
+
+  Net::Socket s = socket(res->ai_family, SOCK_STREAM, IPPROTO_TCP);
+  bool ok = s != Net::kInvalid && Net::SetNonBlocking(s);
+  if (ok && connect(s, res->ai_addr, (int)res->ai_addrlen) != 0) {
+    // Bounded wait instead of the OS's long connect timeout
+    ok = Net::WouldBlock();
+    if (ok) {
+      Net::PollFd pfd;
+      memset(&pfd, 0, sizeof(pfd));
+      pfd.fd = s;
+      pfd.events = POLLOUT;
+      int err = 0;
+      Net::SockLen len = sizeof(err);
+      ok = Net::Poll(&pfd, 1, kConnectTimeoutMs) == 1 &&
+           getsockopt(s, SOL_SOCKET, SO_ERROR, (char *)&err, &len) == 0 &&
+           err == 0;
+    }
+  }
+  freeaddrinfo(res);
+  if (!ok || !Net::SetBlocking(s)) {
+    if (s != Net::kInvalid)
+      Net::Close(s);
+    return (uintptr_t)Net::kInvalid;
+  }
+  Net::SetNoDelay(s);
+  Net::SetTimeouts(s, 5000);
+  return (uintptr_t)s;
+}
+
+void ProxyClient::Session(uintptr_t sockHandle) {
+  Net::Socket s = (Net::Socket)sockHandle;
+  {
+    std::lock_guard<std::mutex> lock(m_sendMutex);
+    m_sock = sockHandle;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_connected = true;
+    m_haveBoard = false;
+    m_resyncSent = false;
+  }
+
+  Writer hello;
+  hello.U32(kMagic);
+  hello.U16(kVersion);
+  hello.U16(kWantQuotes);
+  if (!Send(MakeFrame(kHello, hello.Data())))
+    return;
+
+  std::string in;
+  char buf[16384];
+  uint64_t lastHeard = Os::MonotonicMs();
+  while (!m_stop) {
+    // Wake up regularly to notice Stop() and a silent daemon
+    Net::PollFd pfd;
+    memset(&pfd, 0, sizeof(pfd));
+    pfd.fd = s;
+    pfd.events = POLLIN;
+    int ready = Net::Poll(&pfd, 1, 250);
+    if (ready < 0)
+      return;
+    if (ready == 0) {
+      if (Os::MonotonicMs() - lastHeard > kSilenceMs)
+        return;
+      continue;
+    }
+    int n = recv(s, buf, sizeof(buf), 0);
+    if (n <= 0)
+      return;
+    lastHeard = Os::MonotonicMs();
+    in.append(buf, (size_t)n);
+
+    uint8_t type;
+    std::string payload;
+    bool bad = false;
+    while (PopFrame(in, type, payload, bad))
+      HandleFrame(type, payload);
+    if (bad) {
+      Log("ERROR: ProxyClient — oversized frame from %s:%d", m_host.c_str(),
+          m_port);
+      return;
+    }
+  }
+}
+
+bool ProxyClient::Send(const std::string &frame) {
+  std::lock_guard<std::mutex> lock(m_sendMutex);
+  Net::Socket s = (Net::Socket)m_sock;
+  if (s == Net::kInvalid)
+    return false;
+  const char *p = frame.data();
+  size_t left = frame.size();
+  while (left > 0) {
+    int n = send(s, p, (int)left, Net::kSendFlags);
+    if (n <= 0)
+      return false;
+    p += n;
+    left -= (size_t)n;
+  }
+  return true;
+}
+
+void ProxyClient::Disconnected() {
+  {
+    std::lock_guard<std::mutex> lock(m_sendMutex);
+    m_sock = (uintptr_t)Net::kInvalid;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_connected = false;
+  m_haveBoard = false;
+  m_decoder.Reset();
+  for (auto &p : m_pending)
+    p.second->done = true; // ok stays false
+  m_cv.notify_all();
+}
+
+// ---------------------------------------------------------------------------
+// Messages
+// ---------------------------------------------------------------------------
+
+void ProxyClient::HandleFrame(uint8_t type, const std::string &payload) {
+  Reader r(payload.data(), payload.size());
+  switch (type) {
+  case kSnapshot:
+  case kDelta: {
+    uint64_t seq = r.U64();
+    r.I32(); // date
+    r.I32(); // sec
+    if (!r.Ok()) {
+      Log("WARNING: ProxyClient — truncated quote message");
+      break;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    bool follows = type == kSnapshot || (m_haveBoard && seq == m_seq + 1);
+    if (!follows || !m_decoder.Apply(r.Rest(), r.Remaining())) {
+      if (follows)
+        Log("WARNING: ProxyClient — undecodable %s",
+            type == kSnapshot ? "snapshot" : "delta");
+      // Missed something: ask once for a full board
+      if (!m_resyncSent) {
+        m_resyncSent = true;
+        lock.unlock();
+        Send(MakeFrame(kResync, std::string()));
+      }
+      break;
+    }
+
+    // Keep the symbol-ordered copy: rebuild it when symbols come or go,
+    // otherwise patch the rows that changed
+    const std::vector<DseQuote> &byId = m_decoder.Board();
+    if (m_decoder.SymbolsChanged()) {
+      std::vector<uint32_t> ids;
+      for (uint32_t id = 0; id < (uint32_t)byId.size(); ++id)
+        if (byId[id].symbol[0])
+          ids.push_back(id);
+      std::sort(ids.begin(), ids.end(), [&byId](uint32_t a, uint32_t b) {
+        return strcmp(byId[a].symbol, byId[b].symbol) < 0;
+      });
+      m_board.resize(ids.size());
+      m_pos.assign(byId.size(), 0);
+      for (size_t i = 0; i < ids.size(); ++i) {
+        m_board[i] = byId[ids[i]];
+        m_pos[ids[i]] = i;
+      }
+    } else {
+      for (const auto &c : m_decoder.Changes())
+        m_board[m_pos[c.id]] = byId[c.id];
+    }
+    m_seq = seq;
+    m_haveBoard = true;
+    m_resyncSent = false;
+    m_cv.notify_all();
+    break;
+  }
+  case kHistoryReply: {
+    uint32_t id = r.U32();
+    bool ok = r.U8() != 0;
+    std::vector<DseBar> bars;
+    ok = ok && r.Ok() &&
+         QuoteCodec::DecodeBars(r.Rest(), r.Remaining(), bars);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_pending.find(id);
+    if (it == m_pending.end())
+      break; // timed out already
+    it->second->ok = ok;
+    it->second->bars.swap(bars);
+    it->second->done = true;
+    m_cv.notify_all();
+    break;
+  }
+  case kWelcome:
+  case kHeartbeat:
+  default:
+    break;
+  }
+}
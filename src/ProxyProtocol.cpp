@@ -0,0 +1,133 @@
+// ProxyProtocol.cpp — Framing Between dse_proxyd and Plugin Instances
+
+#include "ProxyProtocol.h"
+#include <cstring>
+
+namespace ProxyProtocol {
+
+// ---------------------------------------------------------------------------
+// Writer / Reader
+// ---------------------------------------------------------------------------
+
+void Writer::U16(uint16_t v) {
+  m_buf += (char)(v & 0xFF);
+  m_buf += (char)(v >> 8);
+}
+
+void Writer::U32(uint32_t v) {
+  for (int i = 0; i < 4; ++i)
+    m_buf += (char)((v >> (8 * i)) & 0xFF);
+}
+
+void Writer::U64(uint64_t v) {
+  for (int i = 0; i < 8; ++i)
+    m_buf += (char)((v >> (8 * i)) & 0xFF);
+}
+
+void Writer::Str(const char *s) {
+  size_t n = s ? strlen(s) : 0;
+  if (n > 255)
+    n = 255;
+  U8((uint8_t)n);
+  m_buf.append(s ? s : "", n);
+}
+
+const char *Reader::Take(size_t n) {
+  if (!m_ok || (size_t)(m_end - m_p) < n) {
+    m_ok = false;
+    return nullptr;
+  }
+  const char *p = m_p;
+  m_p += n;
+  return p;
+}
+
+uint8_t Reader::U8() {
+  const char *p = Take(1);
+  return p ? (uint8_t)p[0] : 0;
+}
+
+uint16_t Reader::U16() {
+  const char *p = Take(2);
+  if (!p)
+    return 0;
+  return (uint16_t)((uint8_t)p[0] | ((uint8_t)p[1] << 8));
+}
+
+uint32_t Reader::U32() {
+  const char *p = Take(4);
+  if (!p)
+    return 0;
+  uint32_t v = 0;
+  for (int i = 3; i >= 0; --i)
+    v = (v << 8) | (uint8_t)p[i];
+  return v;
+}
+
+uint64_t Reader::U64() {
+  const char *p = Take(8);
+  if (!p)
+    return 0;
+  uint64_t v = 0;
+  for (int i = 7; i >= 0; --i)
+    v = (v << 8) | (uint8_t)p[i];
+  return v;
+}
+
+void Reader::Str(char *out, size_t size) {
+  size_t n = U8();
+  const char *p = Take(n);
+  if (!p)
+    n = 0;
+  size_t copy = n < size - 1 ? n : size - 1;
+  if (copy)
+    memcpy(out, p, copy);
+  out[copy] = '\0';
+}
+
+// ---------------------------------------------------------------------------
+// Frames
+// ---------------------------------------------------------------------------
+
+std::string MakeFrame(MsgType type, const std::string &payload) {
+  Writer w;
+  w.Data().reserve(kHeaderSize + payload.size());
+  w.U32((uint32_t)payload.size());
+  w.U8((uint8_t)type);
+  w.Data() += payload;
+  return std::move(w.Data());
+}
+
+bool PopFrame(std::string &buf, uint8_t &type, std::string &payload,
+              bool &bad) {
+  bad = false;
+  if (buf.size() < kHeaderSize)
+    return false;
+  Reader r(buf.data(), kHeaderSize);
+  uint32_t len = r.U32();
+  type = r.U8();
+  if (len > kMaxPayload) {
+    bad = true;
+    return false;
+  }
+  if (buf.size() < kHeaderSize + len)
+    return false;
+  payload.assign(buf, kHeaderSize, len);
+  buf.erase(0, kHeaderSize + len);
+  return true;
+}
+
+std::string MakeQuotesFrame(MsgType type, uint64_t seq, int date, int sec,
+                            const std::string &encoded) {
+  Writer w;
+  w.Data().reserve(kHeaderSize + 16 + encoded.size());
+  w.U32((uint32_t)(16 + encoded.size()));
+  w.U8((uint8_t)type);
+  w.U64(seq);
+  w.I32(date);
+  w.I32(sec);
+  w.Data() += encoded;
+  return std::move(w.Data());
+}
+
+} // namespace ProxyProtocol
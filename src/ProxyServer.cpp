@@ -0,0 +1,485 @@
+// ProxyServer.cpp — Push Fan-Out of Quotes and History to Plugin Instances
+
+// winsock2.h must precede anything that pulls in windows.h
+#include "SocketCompat.h"
+
+#include "ProxyServer.h"
+#include "OsServices.h"
+#include "PlatformCompat.h"
+#include "ProxyProtocol.h"
+#include "QuoteCodec.h"
+#include "Trace.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+using namespace ProxyProtocol;
+
+// A subscriber with this much unsent data is dropped rather than buffered
+// further (several full snapshots)
+static const size_t kMaxQueuedBytes = 8 * 1024 * 1024;
+
+// Connections beyond this are refused
+static const size_t kMaxClients = 1000;
+
+// Idle subscribers hear from us this often, so they can tell a quiet
+// market from a dead daemon
+static const uint64_t kHeartbeatMs = 5000;
+
+// Pending history requests per server; more are answered with failure
+static const size_t kMaxHistoryJobs = 256;
+
+// Longest trading code accepted in a history request
+static const size_t kMaxTickerLen = 20;
+
+// A DSE trading code: letters, digits and a little punctuation. The symbol
+// ends up in seed/export file names and in the archive URL, so nothing
+// that could walk a path or break out of a query parameter gets through.
+static bool IsTicker(const char *s) {
+  size_t n = 0;
+  for (; s[n]; ++n) {
+    char ch = s[n];
+    bool ok = (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') ||
+              (ch >= '0' && ch <= '9') || ch == '-' || ch == '_' ||
+              (ch == '.' && n > 0);
+    if (!ok || n >= kMaxTickerLen)
+      return false;
+  }
+  return n > 0;
+}
+
+// "YYYY-MM-DD" with a plausible month and day
+static bool IsIsoDate(const char *s) {
+  if (strlen(s) != 10 || s[4] != '-' || s[7] != '-')
+    return false;
+  for (int i = 0; i < 10; ++i)
+    if (i != 4 && i != 7 && (s[i] < '0' || s[i] > '9'))
+      return false;
+  int month = (s[5] - '0') * 10 + (s[6] - '0');
+  int day = (s[8] - '0') * 10 + (s[9] - '0');
+  return month >= 1 && month <= 12 && day >= 1 && day <= 31;
+}
+
+ProxyServer::ProxyServer()
+    : m_stop(false), m_listen((uintptr_t)Net::kInvalid), m_port(0),
+      m_snapshotEvery(60), m_nextClientId(1), m_seq(0), m_date(0), m_sec(0),
+      m_sinceSnapshot(0), m_lastHeartbeatMs(0) {}
+
+ProxyServer::~ProxyServer() { Stop(); }
+
+void ProxyServer::Log(const char *fmt, ...) {
+  if (!m_log)
+    return;
+  char msg[512];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(msg, sizeof(msg), fmt, args);
+  va_end(args);
+  m_log(msg);
+}
+
+// ---------------------------------------------------------------------------
+// Lifecycle
+// ---------------------------------------------------------------------------
+
+bool ProxyServer::Start(const char *bindAddr, int port, int snapshotEvery,
+                        HistoryFn history, const LogFn &log) {
+  Stop();
+  m_history = std::move(history);
+  m_log = log;
+  m_snapshotEvery = snapshotEvery < 1 ? 1 : snapshotEvery;
+
+  if (!Net::Startup())
+    return false;
+  Net::Socket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (s == Net::kInvalid) {
+    Net::Cleanup();
+    return false;
+  }
+#ifndef _WIN32
+  int one = 1;
+  setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#endif
+
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons((unsigned short)port);
+  if (!bindAddr || !bindAddr[0] ||
+      inet_pton(AF_INET, bindAddr, &addr.sin_addr) != 1)
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  Net::SockLen len = sizeof(addr);
+  if (bind(s, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(s, 64) != 0 ||
+      getsockname(s, (sockaddr *)&addr, &len) != 0 ||
+      !Net::SetNonBlocking(s)) {
+    Log("ERROR: ProxyServer — cannot listen on %s:%d",
+        bindAddr && bindAddr[0] ? bindAddr : "0.0.0.0", port);
+    Net::Close(s);
+    Net::Cleanup();
+    return false;
+  }
+
+  m_listen = (uintptr_t)s;
+  m_port = ntohs(addr.sin_port);
+  m_stop = false;
+  m_thread = std::thread(&ProxyServer::Loop, this);
+  m_historyThread = std::thread(&ProxyServer::HistoryLoop, this);
+  return true;
+}
+
+void ProxyServer::Stop() {
+  if (!m_thread.joinable())
+    return;
+  m_stop = true;
+  m_jobCv.notify_all();
+  m_thread.join();
+  m_historyThread.join();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto &c : m_clients)
+    Net::Close((Net::Socket)c->sock);
+  m_clients.clear();
+  Net::Close((Net::Socket)m_listen);
+  m_listen = (uintptr_t)Net::kInvalid;
+  m_port = 0;
+  {
+    std::lock_guard<std::mutex> jobLock(m_jobMutex);
+    m_jobs.clear();
+  }
+  Net::Cleanup();
+}
+
+size_t ProxyServer::ClientCount() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_clients.size();
+}
+
+// ---------------------------------------------------------------------------
+// Publishing
+// ---------------------------------------------------------------------------
+
+void ProxyServer::PublishQuotes(const std::vector<DseQuote> &quotes, int date,
+                                int sec) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  // The encoder diffs against the previous publish
+  std::string delta;
+  bool changed = m_encoder.Update(quotes.data(), quotes.size(), delta);
+  bool dayChanged = date != m_date;
+  m_date = date;
+  m_sec = sec;
+  if (!changed && !dayChanged && m_seq)
+    return;
+
+  ++m_seq;
+  m_snapshot.reset();
+  Frame frame;
+  if (++m_sinceSnapshot >= m_snapshotEvery || m_seq == 1) {
+    m_sinceSnapshot = 0;
+    frame = SnapshotFrame();
+  } else {
+    frame = std::make_shared<const std::string>(
+        MakeQuotesFrame(kDelta, m_seq, date, sec, delta));
+  }
+
+  for (auto &c : m_clients) {
+    if (!c->subscribed || c->dead)
+      continue;
+    Queue(*c, frame);
+    Flush(*c);
+  }
+}
+
+ProxyServer::Frame ProxyServer::SnapshotFrame() {
+  if (!m_snapshot) {
+    std::string encoded;
+    m_encoder.Snapshot(encoded);
+    m_snapshot = std::make_shared<const std::string>(
+        MakeQuotesFrame(kSnapshot, m_seq, m_date, m_sec, encoded));
+  }
+  return m_snapshot;
+}
+
+void ProxyServer::Queue(Client &c, const Frame &frame) {
+  if (c.dead)
+    return;
+  if (c.queued + frame->size() > kMaxQueuedBytes) {
+    Log("WARNING: ProxyServer — %s too slow (%zu bytes queued), dropped",
+        c.peer.c_str(), c.queued);
+    c.dead = true;
+    return;
+  }
+  c.out.push_back(frame);
+  c.queued += frame->size();
+}
+
+void ProxyServer::Flush(Client &c) {
+  Net::Socket s = (Net::Socket)c.sock;
+  while (!c.dead && !c.out.empty()) {
+    const std::string &f = *c.out.front();
+    int n = send(s, f.data() + c.outOffset, (int)(f.size() - c.outOffset),
+                 Net::kSendFlags);
+    if (n < 0) {
+      if (!Net::WouldBlock())
+        c.dead = true;
+      return; // the loop resumes once the socket drains
+    }
+    c.outOffset += (size_t)n;
+    c.queued -= (size_t)n;
+    if (c.outOffset == f.size()) {
+      c.out.pop_front();
+      c.outOffset = 0;
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Connection loop
+// ---------------------------------------------------------------------------
+
+void ProxyServer::Loop() {
+  Trace::SetThreadName("proxy-server");
+  std::vector<Net::PollFd> fds;
+  std::vector<uint64_t> ids;
+
+  while (!m_stop) {
+    fds.clear();
+    ids.clear();
+    Net::PollFd lfd;
+    memset(&lfd, 0, sizeof(lfd));
+    lfd.fd = (Net::Socket)m_listen;
+    lfd.events = POLLIN;
+    fds.push_back(lfd);
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      for (auto &c : m_clients) {
+        Net::PollFd pfd;
+        memset(&pfd, 0, sizeof(pfd));
+        pfd.fd = (Net::Socket)c->sock;
+        pfd.events = POLLIN;
+        if (!c->out.empty())
+          pfd.events |= POLLOUT;
+        fds.push_back(pfd);
+        ids.push_back(c->id);
+      }
+    }
+
+    // Short timeout: Stop() and heartbeats need no wake-up channel
+    int ready = Net::Poll(fds.data(), fds.size(), 200);
+    if (m_stop)
+      break;
+
+    if (ready > 0 && (fds[0].revents & POLLIN))
+      AcceptAll();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (ready > 0) {
+      // Clients are only erased below, so positions still match
+      for (size_t i = 0; i < ids.size(); ++i) {
+        Client &c = *m_clients[i];
+        short ev = fds[i + 1].revents;
+        if (ev & (POLLIN | POLLHUP | POLLERR))
+          ReadFrom(c);
+        if (ev & POLLOUT)
+          Flush(c);
+      }
+    }
+
+    uint64_t now = Os::MonotonicMs();
+    if (now - m_lastHeartbeatMs >= kHeartbeatMs) {
+      m_lastHeartbeatMs = now;
+      Writer w;
+      w.U64(m_seq);
+      Frame beat =
+          std::make_shared<const std::string>(MakeFrame(kHeartbeat, w.Data()));
+      for (auto &c : m_clients) {
+        if (c->subscribed && c->out.empty()) {
+          Queue(*c, beat);
+          Flush(*c);
+        }
+      }
+    }
+
+    for (auto it = m_clients.begin(); it != m_clients.end();) {
+      if ((*it)->dead) {
+        Log("ProxyServer: %s disconnected", (*it)->peer.c_str());
+        Net::Close((Net::Socket)(*it)->sock);
+        it = m_clients.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+}
+
+void ProxyServer::AcceptAll() {
+  for (;;) {
+    sockaddr_in addr;
+    Net::SockLen len = sizeof(addr);
+    Net::Socket s =
+        accept((Net::Socket)m_listen, (sockaddr *)&addr, &len);
+    if (s == Net::kInvalid)
+      return;
+
+    char ip[INET_ADDRSTRLEN] = "?";
+    inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+    char peer[64];
+    snprintf(peer, sizeof(peer), "%s:%d", ip, ntohs(addr.sin_port));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_clients.size() >= kMaxClients || !Net::SetNonBlocking(s)) {
+      Log("WARNING: ProxyServer — refused %s (%zu clients)", peer,
+          m_clients.size());
+      Net::Close(s);
+      continue;
+    }
+    Net::SetNoDelay(s);
+    std::unique_ptr<Client> c(new Client);
+    c->id = m_nextClientId++;
+    c->sock = (uintptr_t)s;
+    c->peer = peer;
+    m_clients.push_back(std::move(c));
+    Log("ProxyServer: %s connected (%zu clients)", peer, m_clients.size());
+  }
+}
+
+void ProxyServer::ReadFrom(Client &c) {
+  char buf[4096];
+  for (;;) {
+    int n = recv((Net::Socket)c.sock, buf, sizeof(buf), 0);
+    if (n == 0) {
+      c.dead = true;
+      return;
+    }
+    if (n < 0) {
+      if (!Net::WouldBlock())
+        c.dead = true;
+      break;
+    }
+    c.in.append(buf, (size_t)n);
+  }
+
+  uint8_t type;
+  std::string payload;
+  bool bad = false;
+  while (!c.dead && PopFrame(c.in, type, payload, bad))
+    HandleFrame(c, type, payload);
+  if (bad) {
+    Log("WARNING: ProxyServer — oversized frame from %s", c.peer.c_str());
+    c.dead = true;
+  }
+}
+
+void ProxyServer::HandleFrame(Client &c, uint8_t type,
+                              const std::string &payload) {
+  Reader r(payload.data(), payload.size());
+  switch (type) {
+  case kHello: {
+    uint32_t magic = r.U32();
+    uint16_t version = r.U16();
+    uint16_t flags = r.U16();
+    if (!r.Ok() || magic != kMagic || version != kVersion) {
+      Log("WARNING: ProxyServer — %s speaks another protocol (v%u)",
+          c.peer.c_str(), version);
+      c.dead = true;
+      return;
+    }
+    Writer w;
+    w.U16(kVersion);
+    w.U64(m_seq);
+    Queue(c, std::make_shared<const std::string>(MakeFrame(kWelcome, w.Data())));
+    c.greeted = true;
+    c.subscribed = (flags & kWantQuotes) != 0;
+    if (c.subscribed && m_seq)
+      Queue(c, SnapshotFrame());
+    Flush(c);
+    break;
+  }
+  case kResync:
+    if (c.subscribed && m_seq) {
+      Queue(c, SnapshotFrame());
+      Flush(c);
+    }
+    break;
+  case kHistoryRequest: {
+    if (!c.greeted)
+      break; // nothing is served before the handshake
+    HistoryJob job;
+    job.clientId = c.id;
+    job.reqId = r.U32();
+    char symbol[32], start[16], end[16];
+    r.Str(symbol, sizeof(symbol));
+    r.Str(start, sizeof(start));
+    r.Str(end, sizeof(end));
+    if (!r.Ok()) {
+      c.dead = true;
+      return;
+    }
+    bool valid = IsTicker(symbol) && IsIsoDate(start) && IsIsoDate(end) &&
+                 strcmp(start, end) <= 0;
+    if (!valid)
+      Log("WARNING: ProxyServer — rejected history request from %s",
+          c.peer.c_str());
+    job.symbol = symbol;
+    job.startDate = start;
+    job.endDate = end;
+    std::lock_guard<std::mutex> jobLock(m_jobMutex);
+    if (!valid || m_jobs.size() >= kMaxHistoryJobs || !m_history) {
+      Writer w;
+      w.U32(job.reqId);
+      w.U8(0);
+      QuoteCodec::EncodeBars(nullptr, 0, w.Data());
+      Queue(c, std::make_shared<const std::string>(
+                   MakeFrame(kHistoryReply, w.Data())));
+      Flush(c);
+      break;
+    }
+    m_jobs.push_back(std::move(job));
+    m_jobCv.notify_one();
+    break;
+  }
+  default:
+    break; // unknown types are ignored for forward compatibility
+  }
+}
+
+// ---------------------------------------------------------------------------
+// History worker
+// ---------------------------------------------------------------------------
+
+void ProxyServer::HistoryLoop() {
+  Trace::SetThreadName("proxy-history");
+  for (;;) {
+    HistoryJob job;
+    {
+      std::unique_lock<std::mutex> lock(m_jobMutex);
+      m_jobCv.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+      if (m_stop)
+        return;
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+
+    std::vector<DseBar> bars;
+    bool ok = m_history(job.symbol, job.startDate, job.endDate, bars);
+
+    Writer w;
+    w.Data().reserve(16 + bars.size() * 16);
+    w.U32(job.reqId);
+    w.U8(ok ? 1 : 0);
+    if (!ok)
+      bars.clear();
+    QuoteCodec::EncodeBars(bars.data(), bars.size(), w.Data());
+    Frame frame =
+        std::make_shared<const std::string>(MakeFrame(kHistoryReply, w.Data()));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &c : m_clients) {
+      if (c->id == job.clientId) {
+        Queue(*c, frame);
+        Flush(*c);
+        break;
+      }
+    }
+  }
+}
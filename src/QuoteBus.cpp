@@ -0,0 +1,499 @@
+// QuoteBus.cpp — Quote Board and Bar Series Shared Between Plugin Instances
+
+#include "QuoteBus.h"
+#include "OsServices.h"
+#include <cstddef>
+#include <cstring>
+#include <thread>
+
+// The section is read by other processes: every atomic in it must be a
+// plain machine word, never a lock hidden in this process
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "QuoteBus needs lock-free 32-bit atomics");
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "QuoteBus needs lock-free 64-bit atomics");
+
+static const uint32_t kMagic = 0x42455344; // "DSEB"
+static const uint32_t kVersion = 1;
+
+// Sized for the whole DSE board (about 600 instruments) with room to spare;
+// open addressing stays short at this load
+static const uint32_t kQuoteSlots = 2048;
+static const uint32_t kBarSlots = 4096;
+
+// Seqlock retries before a slot is treated as unreadable (its writer died
+// half-way through an update)
+static const int kMaxSeqRetries = 10000;
+
+// A bar publisher holding the arena lock longer than this is presumed dead
+static const uint32_t kBarLockStaleMs = 10000;
+
+// ---------------------------------------------------------------------------
+// Layout
+// ---------------------------------------------------------------------------
+
+struct QuoteBus::Header {
+  std::atomic<uint32_t> magic; // stored last by the creator
+  uint32_t version;
+  uint32_t quoteSize; // sizeof(DseQuote) of the creating build
+  uint32_t barSize;   // sizeof(DseBar)
+  uint32_t quoteSlots;
+  uint32_t barSlots;
+  uint64_t quoteSlotsOffset;
+  uint64_t orderOffset;
+  uint64_t barSlotsOffset;
+  uint64_t arenaOffset;
+  uint64_t arenaBytes;
+
+  // Writer lease: pid << 32 | low 32 bits of its last heartbeat (ms)
+  std::atomic<uint64_t> lease;
+
+  // Quote board
+  std::atomic<uint64_t> quoteSeq;  // last completed publish
+  std::atomic<uint64_t> publishMs; // Os::MonotonicMs() of that publish
+  std::atomic<uint32_t> quoteCount; // claimed slots listed in the order table
+
+  // Bar arena: lock word as for the lease
+  std::atomic<uint64_t> barLock;
+  std::atomic<uint32_t> arenaGen; // bumped each time the arena starts over
+  std::atomic<uint64_t> arenaUsed;
+};
+
+struct QuoteBus::QuoteSlot {
+  std::atomic<uint32_t> seq; // odd while being written; 0 = never used
+  uint32_t pad;
+  uint64_t pubSeq; // publish that last carried this symbol
+  DseQuote quote;
+};
+
+struct QuoteBus::BarSlot {
+  std::atomic<uint32_t> seq;
+  uint32_t count;
+  char symbol[32];
+  int32_t startKey, endKey;
+  uint32_t gen; // arena generation the bars were written in
+  uint32_t pad;
+  uint64_t offset; // into the arena
+};
+
+static uint64_t AlignUp(uint64_t n) { return (n + 63) & ~(uint64_t)63; }
+
+static uint64_t PackOwner(uint32_t pid, uint64_t nowMs) {
+  return ((uint64_t)pid << 32) | (uint32_t)nowMs;
+}
+
+static uint32_t OwnerPid(uint64_t word) { return (uint32_t)(word >> 32); }
+
+static uint32_t OwnerAgeMs(uint64_t word, uint64_t nowMs) {
+  return (uint32_t)nowMs - (uint32_t)word; // wraps correctly
+}
+
+static uint32_t HashSymbol(const char *symbol) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < 32 && symbol[i]; ++i) {
+    h ^= (unsigned char)symbol[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+// ---------------------------------------------------------------------------
+// Seqlock primitives
+// ---------------------------------------------------------------------------
+
+static void SeqWrite(std::atomic<uint32_t> &seq, void *dst, const void *src,
+                     size_t size) {
+  uint32_t s = seq.load(std::memory_order_relaxed);
+  if (s & 1)
+    ++s; // a previous writer died mid-update; start from an even count
+  seq.store(s + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(dst, src, size);
+  seq.store(s + 2, std::memory_order_release);
+}
+
+// Copy a consistent record; false if the slot is empty or stuck
+static bool SeqRead(const std::atomic<uint32_t> &seq, void *dst,
+                    const void *src, size_t size) {
+  for (int i = 0; i < kMaxSeqRetries; ++i) {
+    uint32_t s1 = seq.load(std::memory_order_acquire);
+    if (s1 == 0)
+      return false;
+    if (s1 & 1) {
+      std::this_thread::yield();
+      continue;
+    }
+    memcpy(dst, src, size);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq.load(std::memory_order_relaxed) == s1)
+      return true;
+  }
+  return false;
+}
+
+// ---------------------------------------------------------------------------
+// Lifecycle
+// ---------------------------------------------------------------------------
+
+QuoteBus::QuoteBus() : m_pid(Os::ProcessId()), m_leaseMs(0), m_writer(false) {}
+
+QuoteBus::~QuoteBus() { Close(); }
+
+bool QuoteBus::Open(const char *name, size_t barArenaBytes, int leaseMs) {
+  Close();
+  std::unique_lock<std::shared_mutex> lock(m_mapMutex);
+
+  uint64_t quoteSlotsOffset = AlignUp(sizeof(Header));
+  uint64_t orderOffset =
+      AlignUp(quoteSlotsOffset + (uint64_t)kQuoteSlots * sizeof(QuoteSlot));
+  uint64_t barSlotsOffset =
+      AlignUp(orderOffset + (uint64_t)kQuoteSlots * sizeof(uint32_t));
+  uint64_t arenaOffset =
+      AlignUp(barSlotsOffset + (uint64_t)kBarSlots * sizeof(BarSlot));
+  uint64_t total = arenaOffset + barArenaBytes;
+  if (total > (size_t)-1)
+    return false;
+
+  bool created = false;
+  if (!m_shm.Open(name, (size_t)total, created))
+    return false;
+  if (m_shm.Size() < sizeof(Header)) {
+    m_shm.Close();
+    return false;
+  }
+
+  Header *h = (Header *)m_shm.Data();
+  if (created) {
+    h->version = kVersion;
+    h->quoteSize = sizeof(DseQuote);
+    h->barSize = sizeof(DseBar);
+    h->quoteSlots = kQuoteSlots;
+    h->barSlots = kBarSlots;
+    h->quoteSlotsOffset = quoteSlotsOffset;
+    h->orderOffset = orderOffset;
+    h->barSlotsOffset = barSlotsOffset;
+    h->arenaOffset = arenaOffset;
+    h->arenaBytes = barArenaBytes;
+    h->magic.store(kMagic, std::memory_order_release);
+  } else {
+    // The creator may still be filling the header in
+    for (int i = 0;
+         i < 100 && h->magic.load(std::memory_order_acquire) != kMagic; ++i)
+      Os::SleepMs(10);
+  }
+
+  bool valid = h->magic.load(std::memory_order_acquire) == kMagic &&
+               h->version == kVersion && h->quoteSize == sizeof(DseQuote) &&
+               h->barSize == sizeof(DseBar) &&
+               h->arenaOffset + h->arenaBytes <= m_shm.Size() &&
+               h->barSlotsOffset + (uint64_t)h->barSlots * sizeof(BarSlot) <=
+                   h->arenaOffset &&
+               h->orderOffset + (uint64_t)h->quoteSlots * sizeof(uint32_t) <=
+                   h->barSlotsOffset &&
+               h->quoteSlots > 0 && h->barSlots > 0;
+  if (!valid) {
+    m_shm.Close();
+    return false;
+  }
+  m_leaseMs = leaseMs;
+  m_writer = false;
+  return true;
+}
+
+void QuoteBus::Close() {
+  ReleaseWriter();
+  std::unique_lock<std::shared_mutex> lock(m_mapMutex);
+  m_shm.Close();
+}
+
+bool QuoteBus::IsOpen() const {
+  std::shared_lock<std::shared_mutex> lock(m_mapMutex);
+  return m_shm.Data() != nullptr;
+}
+
+QuoteBus::Header *QuoteBus::Hdr() const { return (Header *)m_shm.Data(); }
+
+QuoteBus::QuoteSlot *QuoteBus::QuoteSlots() const {
+  return (QuoteSlot *)((char *)m_shm.Data() + Hdr()->quoteSlotsOffset);
+}
+
+uint32_t *QuoteBus::QuoteOrder() const {
+  return (uint32_t *)((char *)m_shm.Data() + Hdr()->orderOffset);
+}
+
+QuoteBus::BarSlot *QuoteBus::BarSlots() const {
+  return (BarSlot *)((char *)m_shm.Data() + Hdr()->barSlotsOffset);
+}
+
+char *QuoteBus::Arena() const {
+  return (char *)m_shm.Data() + Hdr()->arenaOffset;
+}
+
+// ---------------------------------------------------------------------------
+// Writer election
+// ---------------------------------------------------------------------------
+
+bool QuoteBus::TryAcquireWriter() {
+  std::shared_lock<std::shared_mutex> lock(m_mapMutex);
+  if (!m_shm.Data())
+    return false;
+  Header *h = Hdr();
+
+  for (int attempt = 0; attempt < 4; ++attempt) {
+    uint64_t now = Os::MonotonicMs();
+    uint64_t cur = h->lease.load(std::memory_order_acquire);
+    uint32_t owner = OwnerPid(cur);
+    if (owner != 0 && owner != m_pid &&
+        OwnerAgeMs(cur, now) <= (uint32_t)m_leaseMs &&
+        Os::ProcessAlive(owner)) {
+      m_writer = false;
+      return false;
+    }
+    // Ours to renew, free, expired, or left by an exited process
+    if (h->lease.compare_exchange_strong(cur, PackOwner(m_pid, now),
+                                         std::memory_order_acq_rel)) {
+      m_writer = true;
+      return true;
+    }
+  }
+  m_writer = false;
+  return false;
+}
+
+void QuoteBus::ReleaseWriter() {
+  std::shared_lock<std::shared_mutex> lock(m_mapMutex);
+  if (!m_shm.Data() || !m_writer)
+    return;
+  uint64_t cur = Hdr()->lease.load(std::memory_order_acquire);
+  if (OwnerPid(cur) == m_pid)
+    Hdr()->lease.compare_exchange_strong(cur, 0, std::memory_order_acq_rel);
+  m_writer = false;
+}
+
+bool QuoteBus::IsWriter() const { return m_writer; }
+
+// ---------------------------------------------------------------------------
+// Quote board
+// ---------------------------------------------------------------------------
+
+bool QuoteBus::PublishQuotes(const std::vector<DseQuote> &quotes) {
+  std::lock_guard<std::mutex> publishLock(m_publishMutex);
+  std::shared_lock<std::shared_mutex> lock(m_mapMutex);
+  if (!m_shm.Data())
+    return false;
+  Header *h = Hdr();
+  if (OwnerPid(h->lease.load(std::memory_order_acquire)) != m_pid) {
+    m_writer = false;
+    return false;
+  }
+
+  QuoteSlot *slots = QuoteSlots();
+  uint32_t *order = QuoteOrder();
+  uint32_t n = h->quoteSlots;
+  uint64_t pubSeq = h->quoteSeq.load(std::memory_order_relaxed) + 1;
+
+  QuoteSlot staged;
+  for (const auto &q : quotes) {
+    if (!q.symbol[0])
+      continue;
+    // Only this process writes, so a claimed slot's symbol is stable
+    uint32_t idx = HashSymbol(q.symbol) % n;
+    uint32_t probes = 0;
+    for (; probes < n; ++probes, idx = (idx + 1) % n) {
+      QuoteSlot &s = slots[idx];
+      if (s.seq.load(std::memory_order_acquire) == 0) {
+        uint32_t count = h->quoteCount.load(std::memory_order_relaxed);
+        order[count] = idx;
+        h->quoteCount.store(count + 1, std::memory_order_release);
+        break;
+      }
+      if (strncmp(s.quote.symbol, q.symbol, sizeof(q.symbol)) == 0)
+        break;
+    }
+    if (probes == n)
+      break; // board full; the rest of this snapshot is not shared
+
+    staged.pubSeq = pubSeq;
+    staged.quote = q;
+    SeqWrite(slots[idx].seq, &slots[idx].pubSeq, &staged.pubSeq,
+             sizeof(QuoteSlot) - offsetof(QuoteSlot, pubSeq));
+  }
+
+  uint64_t now = Os::MonotonicMs();
+  h->publishMs.store(now, std::memory_order_relaxed);
+  h->quoteSeq.store(pubSeq, std::memory_order_release);
+
+  // Publishing is the heartbeat
+  uint64_t cur = h->lease.load(std::memory_order_acquire);
+  if (OwnerPid(cur) == m_pid)
+    h->lease.compare_exchange_strong(cur, PackOwner(m_pid, now),
+                                     std::memory_order_acq_rel);
+  return true;
+}
+
+bool QuoteBus::ReadQuotes(std::vector<DseQuote> &outQuotes,
+                          uint64_t &seq) const {
+  outQuotes.clear();
+  std::shared_lock<std::shared_mutex> lock(m_mapMutex);
+  if (!m_shm.Data())
+    return false;
+  Header *h = Hdr();
+  seq = h->quoteSeq.load(std::memory_order_acquire);
+  if (seq == 0)
+    return false;
+  uint64_t now = Os::MonotonicMs();
+  uint64_t published = h->publishMs.load(std::memory_order_relaxed);
+  if (now > published && now - published > (uint64_t)m_leaseMs)
+    return false;
+
+  const QuoteSlot *slots = QuoteSlots();
+  const uint32_t *order = QuoteOrder();
+  uint32_t count = h->quoteCount.load(std::memory_order_acquire);
+  if (count > h->quoteSlots)
+    count = h->quoteSlots;
+  outQuotes.reserve(count);
+
+  QuoteSlot copy;
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t idx = order[i];
+    if (idx >= h->quoteSlots)
+      continue;
+    const QuoteSlot &s = slots[idx];
+    if (!SeqRead(s.seq, &copy.pubSeq, &s.pubSeq,
+                 sizeof(QuoteSlot) - offsetof(QuoteSlot, pubSeq)))
+      continue;
+    // Symbols missing from the latest snapshot are left out; a publish
+    // still in progress may already have refreshed some slots
+    if (copy.pubSeq >= seq) {
+      copy.quote.symbol[sizeof(copy.quote.symbol) - 1] = '\0';
+      outQuotes.push_back(copy.quote);
+    }
+  }
+  return !outQuotes.empty();
+}
+
+// ---------------------------------------------------------------------------
+// Bar series
+// ---------------------------------------------------------------------------
+
+bool QuoteBus::LockBars() {
+  Header *h = Hdr();
+  for (int i = 0; i < 2000; ++i) {
+    uint64_t now = Os::MonotonicMs();
+    uint64_t cur = h->barLock.load(std::memory_order_acquire);
+    bool free = cur == 0 ||
+                (OwnerPid(cur) != m_pid &&
+                 (OwnerAgeMs(cur, now) > kBarLockStaleMs ||
+                  !Os::ProcessAlive(OwnerPid(cur))));
+    if (free && h->barLock.compare_exchange_strong(
+                    cur, PackOwner(m_pid, now), std::memory_order_acq_rel))
+      return true;
+    Os::SleepMs(1);
+  }
+  return false;
+}
+
+void QuoteBus::UnlockBars() {
+  Hdr()->barLock.store(0, std::memory_order_release);
+}
+
+bool QuoteBus::PublishBars(const char *symbol, int startKey, int endKey,
+                           const std::vector<DseBar> &bars) {
+  if (!symbol || !symbol[0] || bars.empty())
+    return false;
+  std::lock_guard<std::mutex> publishLock(m_publishMutex);
+  std::shared_lock<std::shared_mutex> lock(m_mapMutex);
+  if (!m_shm.Data())
+    return false;
+  Header *h = Hdr();
+  uint64_t need = AlignUp((uint64_t)bars.size() * sizeof(DseBar));
+  if (need > h->arenaBytes || !LockBars())
+    return false;
+
+  BarSlot *slots = BarSlots();
+  uint32_t n = h->barSlots;
+  uint32_t idx = HashSymbol(symbol) % n;
+  uint32_t probes = 0;
+  for (; probes < n; ++probes, idx = (idx + 1) % n) {
+    BarSlot &s = slots[idx];
+    // Claimed slots only change under the arena lock, which we hold
+    if (s.seq.load(std::memory_order_acquire) == 0 ||
+        strncmp(s.symbol, symbol, sizeof(s.symbol)) == 0)
+      break;
+  }
+  if (probes == n) {
+    UnlockBars();
+    return false;
+  }
+
+  uint64_t used = h->arenaUsed.load(std::memory_order_relaxed);
+  uint32_t gen = h->arenaGen.load(std::memory_order_relaxed);
+  if (used + need > h->arenaBytes) {
+    // Start over: readers of any older series see the generation move
+    ++gen;
+    h->arenaGen.store(gen, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    used = 0;
+  }
+  memcpy(Arena() + used, bars.data(), bars.size() * sizeof(DseBar));
+
+  BarSlot staged;
+  staged.count = (uint32_t)bars.size();
+  memset(staged.symbol, 0, sizeof(staged.symbol));
+  strncpy(staged.symbol, symbol, sizeof(staged.symbol) - 1);
+  staged.startKey = startKey;
+  staged.endKey = endKey;
+  staged.gen = gen;
+  staged.pad = 0;
+  staged.offset = used;
+  SeqWrite(slots[idx].seq, &slots[idx].count, &staged.count,
+           sizeof(BarSlot) - offsetof(BarSlot, count));
+  h->arenaUsed.store(used + need, std::memory_order_relaxed);
+
+  UnlockBars();
+  return true;
+}
+
+bool QuoteBus::ReadBars(const char *symbol, int startKey, int endKey,
+                        std::vector<DseBar> &outBars) const {
+  outBars.clear();
+  if (!symbol || !symbol[0])
+    return false;
+  std::shared_lock<std::shared_mutex> lock(m_mapMutex);
+  if (!m_shm.Data())
+    return false;
+  Header *h = Hdr();
+
+  const BarSlot *slots = BarSlots();
+  uint32_t n = h->barSlots;
+  uint32_t idx = HashSymbol(symbol) % n;
+  BarSlot meta;
+  bool found = false;
+  for (uint32_t probes = 0; probes < n; ++probes, idx = (idx + 1) % n) {
+    const BarSlot &s = slots[idx];
+    if (!SeqRead(s.seq, &meta.count, &s.count,
+                 sizeof(BarSlot) - offsetof(BarSlot, count)))
+      return false; // empty slot ends the probe
+    if (strncmp(meta.symbol, symbol, sizeof(meta.symbol)) == 0) {
+      found = true;
+      break;
+    }
+  }
+  if (!found || meta.count == 0 || meta.startKey > startKey ||
+      meta.endKey < endKey)
+    return false;
+
+  uint64_t bytes = (uint64_t)meta.count * sizeof(DseBar);
+  if (meta.offset + bytes > h->arenaBytes ||
+      meta.gen != h->arenaGen.load(std::memory_order_acquire))
+    return false;
+  outBars.resize(meta.count);
+  memcpy(outBars.data(), Arena() + meta.offset, (size_t)bytes);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  // The arena started over while we copied: the bars may be overwritten
+  if (meta.gen != h->arenaGen.load(std::memory_order_relaxed)) {
+    outBars.clear();
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,496 @@
+// QuoteCodec.cpp — Compact Binary Delta Encoding of Quotes and Bars
+//
+// Prices travel as integer ticks (paisa), volumes and trade counts as
+// whole numbers and value (mn) in thousandths, the resolution dsebd.org
+// publishes; a poll where a few dozen symbols traded costs a few hundred
+// bytes instead of one fixed-width record per symbol.
+
+#include "QuoteCodec.h"
+#include "ByteCodec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace QuoteCodec {
+
+// ---------------------------------------------------------------------------
+// Field table
+// ---------------------------------------------------------------------------
+
+namespace {
+
+// Wire order; the valid flag (index kFieldCount - 1) is handled apart
+double DseQuote::*const kMember[kFieldCount - 1] = {
+    &DseQuote::ltp,   &DseQuote::open,   &DseQuote::high, &DseQuote::low,
+    &DseQuote::trade, &DseQuote::volume, &DseQuote::ycp,  &DseQuote::change,
+    &DseQuote::close, &DseQuote::value};
+
+const double kScale[kFieldCount - 1] = {100, 100, 100, 100, 1,
+                                        1,   100, 100, 100, 1000};
+
+// Bit -> the run of fields it covers, in wire order
+struct Group {
+  uint32_t bit;
+  int first, last; // [first, last)
+};
+
+const Group kGroups[] = {{kLast, 0, 1},       {kOpen, 1, 2},
+                         {kHighLow, 2, 4},    {kTradeVol, 4, 5},
+                         {kTotalVol, 5, 6},   {kPrevChange, 6, 8},
+                         {kClose, 8, 9},      {kValue, 9, 10},
+                         {kValid, 10, 11}};
+
+const uint32_t kAllFields = kRecentInfoFields | kClose | kValue | kValid;
+
+const size_t kMaxName = sizeof(DseQuote::symbol) - 1;
+
+// Tick arithmetic wraps (unsigned) so hostile input cannot overflow; honest
+// values never come near the limits
+int64_t Add(int64_t a, int64_t b) {
+  return (int64_t)((uint64_t)a + (uint64_t)b);
+}
+
+int64_t Sub(int64_t a, int64_t b) {
+  return (int64_t)((uint64_t)a - (uint64_t)b);
+}
+
+// Round half away from zero, like llround; anything that is not a finite
+// number in int64 range travels as 0
+int64_t ToTicks(double v, double scale) {
+  double t = v * scale;
+  if (t > -4.0e15 && t < 4.0e15) // exact halves, no libm call
+    return t < 0 ? -(int64_t)(0.5 - t) : (int64_t)(t + 0.5);
+  if (!(t > -9.0e18 && t < 9.0e18))
+    return 0;
+  return (int64_t)std::llround(t);
+}
+
+void QuoteTicks(const DseQuote &q, int64_t *t) {
+  for (int i = 0; i < kFieldCount - 1; ++i)
+    t[i] = ToTicks(q.*kMember[i], kScale[i]);
+  t[kFieldCount - 1] = q.valid ? 1 : 0;
+}
+
+// Field bits whose ticks differ between a and b
+uint32_t DiffFields(const int64_t *a, const int64_t *b) {
+  uint32_t fields = 0;
+  for (const Group &g : kGroups)
+    for (int i = g.first; i < g.last; ++i)
+      if (a[i] != b[i]) {
+        fields |= g.bit;
+        break;
+      }
+  return fields;
+}
+
+// fields, then the tick delta (to - from) of every field they cover
+void PutFields(std::string &out, uint32_t fields, const int64_t *from,
+               const int64_t *to) {
+  ByteCodec::PutVarint(out, fields);
+  for (const Group &g : kGroups)
+    if (fields & g.bit)
+      for (int i = g.first; i < g.last; ++i)
+        ByteCodec::PutVarint(out, ByteCodec::ZigZag(Sub(to[i], from[i])));
+}
+
+void PutName(std::string &out, uint32_t id, const std::string &name) {
+  ByteCodec::PutVarint(out, id);
+  out.push_back((char)(uint8_t)name.size());
+  out += name;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Encoder
+// ---------------------------------------------------------------------------
+
+Encoder::Encoder() : m_generation(0) {}
+
+void Encoder::Reset() {
+  m_ids.clear();
+  m_names.clear();
+  m_ticks.clear();
+  m_stamp.clear();
+  m_free.clear();
+  m_order.clear();
+  m_generation = 0;
+}
+
+bool Encoder::Update(const DseQuote *quotes, size_t n, std::string &out) {
+  if (++m_generation == 0) {
+    std::fill(m_stamp.begin(), m_stamp.end(), 0);
+    m_generation = 1;
+  }
+  m_nameBuf.clear();
+  m_bodyBuf.clear();
+  uint32_t nameCount = 0, changeCount = 0;
+  int64_t t[kFieldCount];
+
+  for (size_t k = 0; k < n; ++k) {
+    const DseQuote &q = quotes[k];
+    if (!q.symbol[0])
+      continue;
+    size_t len = strnlen(q.symbol, kMaxName);
+
+    // Rows usually arrive in the order of the previous update, so try the
+    // ID seen at this position before hashing the name
+    uint32_t id = k < m_order.size() ? m_order[k] : UINT32_MAX;
+    bool found = id < m_names.size() && m_names[id].size() == len &&
+                 memcmp(m_names[id].data(), q.symbol, len) == 0;
+    std::string name;
+    if (!found) {
+      name.assign(q.symbol, len);
+      auto it = m_ids.find(name);
+      found = it != m_ids.end();
+      if (found)
+        id = it->second;
+    }
+    if (k < m_order.size())
+      m_order[k] = UINT32_MAX;
+    if (found) {
+      if (m_stamp[id] == m_generation)
+        continue; // repeated row; the first wins
+    } else {
+      if (m_ids.size() >= kMaxSymbols)
+        continue;
+      if (!m_free.empty()) {
+        id = m_free.back();
+        m_free.pop_back();
+      } else {
+        id = (uint32_t)m_names.size();
+        m_names.emplace_back();
+        m_ticks.resize(m_ticks.size() + kFieldCount);
+        m_stamp.push_back(0);
+      }
+      m_ids.emplace(name, id);
+      m_names[id] = name;
+      std::fill_n(&m_ticks[(size_t)id * kFieldCount], kFieldCount, 0);
+      PutName(m_nameBuf, id, name);
+      ++nameCount;
+    }
+    m_stamp[id] = m_generation;
+    if (k >= m_order.size())
+      m_order.resize(k + 1, UINT32_MAX);
+    m_order[k] = id;
+
+    int64_t *prev = &m_ticks[(size_t)id * kFieldCount];
+    QuoteTicks(q, t);
+    uint32_t fields = DiffFields(prev, t);
+    if (!fields)
+      continue;
+    ByteCodec::PutVarint(m_bodyBuf, id);
+    PutFields(m_bodyBuf, fields, prev, t);
+    std::copy(t, t + kFieldCount, prev);
+    ++changeCount;
+  }
+
+  out.push_back((char)kVersion);
+  out.push_back((char)kDelta);
+  ByteCodec::PutVarint(out, nameCount);
+  out += m_nameBuf;
+
+  // Symbols this update did not carry left the board
+  uint32_t removedCount = 0;
+  m_nameBuf.clear();
+  for (uint32_t id = 0; id < (uint32_t)m_names.size(); ++id) {
+    if (m_names[id].empty() || m_stamp[id] == m_generation)
+      continue;
+    ByteCodec::PutVarint(m_nameBuf, id);
+    m_ids.erase(m_names[id]);
+    m_names[id].clear();
+    m_free.push_back(id);
+    ++removedCount;
+  }
+  ByteCodec::PutVarint(out, removedCount);
+  out += m_nameBuf;
+
+  ByteCodec::PutVarint(out, changeCount);
+  out += m_bodyBuf;
+  return nameCount || removedCount || changeCount;
+}
+
+void Encoder::Snapshot(std::string &out) const {
+  out.push_back((char)kVersion);
+  out.push_back((char)kSnapshot);
+  ByteCodec::PutVarint(out, m_ids.size());
+  for (uint32_t id = 0; id < (uint32_t)m_names.size(); ++id)
+    if (!m_names[id].empty())
+      PutName(out, id, m_names[id]);
+  ByteCodec::PutVarint(out, 0); // no removals
+
+  // Absolute state: the delta from an all-zero symbol
+  static const int64_t kZero[kFieldCount] = {};
+  uint32_t changeCount = 0;
+  for (uint32_t id = 0; id < (uint32_t)m_names.size(); ++id)
+    if (!m_names[id].empty() &&
+        DiffFields(kZero, &m_ticks[(size_t)id * kFieldCount]))
+      ++changeCount;
+  ByteCodec::PutVarint(out, changeCount);
+  for (uint32_t id = 0; id < (uint32_t)m_names.size(); ++id) {
+    if (m_names[id].empty())
+      continue;
+    const int64_t *t = &m_ticks[(size_t)id * kFieldCount];
+    uint32_t fields = DiffFields(kZero, t);
+    if (!fields)
+      continue;
+    ByteCodec::PutVarint(out, id);
+    PutFields(out, fields, kZero, t);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Decoder
+// ---------------------------------------------------------------------------
+
+Decoder::Decoder()
+    : m_generation(0), m_haveBoard(false), m_wasSnapshot(false),
+      m_symbolsChanged(false) {}
+
+void Decoder::Reset() {
+  m_board.clear();
+  m_ticks.clear();
+  m_stamp.clear();
+  m_changes.clear();
+  m_removed.clear();
+  m_generation = 0;
+  m_haveBoard = false;
+  m_wasSnapshot = false;
+  m_symbolsChanged = false;
+}
+
+void Decoder::Clear(uint32_t id) {
+  memset(&m_board[id], 0, sizeof(DseQuote));
+  std::fill_n(&m_ticks[(size_t)id * kFieldCount], kFieldCount, 0);
+}
+
+bool Decoder::Apply(const char *data, size_t size) {
+  m_changes.clear();
+  m_removed.clear();
+  if (!Decode((const uint8_t *)data, (const uint8_t *)data + size)) {
+    Reset();
+    return false;
+  }
+  m_haveBoard = true;
+  return true;
+}
+
+bool Decoder::Decode(const uint8_t *p, const uint8_t *end) {
+  if (end - p < 2 || p[0] != kVersion)
+    return false;
+  uint8_t kind = p[1];
+  p += 2;
+  if (kind != kSnapshot && (kind != kDelta || !m_haveBoard))
+    return false;
+  m_wasSnapshot = kind == kSnapshot;
+  if (++m_generation == 0) {
+    std::fill(m_stamp.begin(), m_stamp.end(), 0);
+    m_generation = 1;
+  }
+  if (m_wasSnapshot) {
+    m_board.clear();
+    m_ticks.clear();
+    m_stamp.clear();
+  }
+
+  uint64_t count, id;
+  if (!ByteCodec::GetVarint(p, end, count))
+    return false;
+  m_symbolsChanged = m_wasSnapshot || count > 0;
+
+  // Removals come after names on the wire but apply first, so read ahead
+  // past the names
+  const uint8_t *names = p;
+  for (uint64_t k = 0; k < count; ++k) {
+    if (!ByteCodec::GetVarint(p, end, id) || p >= end)
+      return false;
+    uint8_t len = *p++;
+    if (end - p < len)
+      return false;
+    p += len;
+  }
+  uint64_t removedCount;
+  if (!ByteCodec::GetVarint(p, end, removedCount))
+    return false;
+  for (uint64_t k = 0; k < removedCount; ++k) {
+    if (!ByteCodec::GetVarint(p, end, id) || id >= m_board.size() ||
+        !m_board[id].symbol[0])
+      return false;
+    Clear((uint32_t)id);
+    m_removed.push_back((uint32_t)id);
+  }
+  m_symbolsChanged = m_symbolsChanged || removedCount > 0;
+  const uint8_t *changes = p;
+
+  p = names;
+  for (uint64_t k = 0; k < count; ++k) {
+    ByteCodec::GetVarint(p, end, id); // checked above
+    uint8_t len = *p++;
+    if (id >= kMaxSymbols || len == 0 || len > kMaxName || memchr(p, 0, len))
+      return false;
+    if (id >= m_board.size()) {
+      m_board.resize(id + 1);
+      m_ticks.resize((id + 1) * kFieldCount);
+      m_stamp.resize(id + 1);
+    }
+    Clear((uint32_t)id);
+    memcpy(m_board[id].symbol, p, len);
+    p += len;
+    m_stamp[id] = m_generation;
+    Change c = {(uint32_t)id, kAllFields};
+    m_changes.push_back(c);
+  }
+
+  p = changes;
+  if (!ByteCodec::GetVarint(p, end, count))
+    return false;
+  for (uint64_t k = 0; k < count; ++k) {
+    uint64_t fields;
+    if (!ByteCodec::GetVarint(p, end, id) || id >= m_board.size() ||
+        !m_board[id].symbol[0] || !ByteCodec::GetVarint(p, end, fields) ||
+        (fields & ~(uint64_t)kAllFields))
+      return false;
+
+    DseQuote &q = m_board[id];
+    int64_t *t = &m_ticks[(size_t)id * kFieldCount];
+    for (const Group &g : kGroups) {
+      if (!(fields & g.bit))
+        continue;
+      for (int i = g.first; i < g.last; ++i) {
+        uint64_t z;
+        if (!ByteCodec::GetVarint(p, end, z))
+          return false;
+        t[i] = Add(t[i], ByteCodec::UnZigZag(z));
+        if (i < kFieldCount - 1)
+          q.*kMember[i] = (double)t[i] / kScale[i];
+        else
+          q.valid = t[i] != 0;
+      }
+    }
+    if (fields & (kLast | kPrevChange))
+      q.changePercent = q.ycp > 0 ? ((q.ltp - q.ycp) / q.ycp) * 100.0 : 0;
+
+    if (m_stamp[id] != m_generation) { // new names already report all
+      Change c = {(uint32_t)id, (uint32_t)fields};
+      m_changes.push_back(c);
+    }
+  }
+  return p == end;
+}
+
+// ---------------------------------------------------------------------------
+// Bars
+// ---------------------------------------------------------------------------
+
+namespace {
+
+const int kBarFields = 7; // open, high, low, close, volume, trade, value
+const int kMaxDecimals = 6;
+const double kPow10[kMaxDecimals + 1] = {1, 10, 100, 1e3, 1e4, 1e5, 1e6};
+
+void BarValues(const DseBar &b, double *v) {
+  v[0] = b.open;
+  v[1] = b.high;
+  v[2] = b.low;
+  v[3] = b.close;
+  v[4] = b.volume;
+  v[5] = b.trade;
+  v[6] = b.value;
+}
+
+// Which decimals slot each bar field uses: price, volume, value
+const int kBarSlot[kBarFields] = {0, 0, 0, 0, 1, 1, 2};
+
+bool Exact(double v, int decimals) {
+  double scale = kPow10[decimals];
+  return (double)ToTicks(v, scale) / scale == v;
+}
+
+} // namespace
+
+void EncodeBars(const DseBar *bars, size_t n, std::string &out) {
+  int decimals[3] = {0, 0, 0};
+  double v[kBarFields];
+  for (size_t k = 0; k < n; ++k) {
+    BarValues(bars[k], v);
+    for (int i = 0; i < kBarFields; ++i) {
+      int &d = decimals[kBarSlot[i]];
+      while (d < kMaxDecimals && !Exact(v[i], d))
+        ++d;
+    }
+  }
+
+  out.push_back((char)kVersion);
+  for (int d : decimals)
+    out.push_back((char)d);
+  ByteCodec::PutVarint(out, n);
+
+  int64_t prevKey = 0;
+  int64_t prev[kBarFields] = {};
+  for (size_t k = 0; k < n; ++k) {
+    const DseBar &b = bars[k];
+    int64_t key = (int64_t)b.year * 10000 + b.month * 100 + b.day;
+    ByteCodec::PutVarint(out, ByteCodec::ZigZag(Sub(key, prevKey)));
+    prevKey = key;
+    out.push_back((char)((b.valid ? 1 : 0) | (b.provisional ? 2 : 0)));
+    BarValues(b, v);
+    for (int i = 0; i < kBarFields; ++i) {
+      int64_t t = ToTicks(v[i], kPow10[decimals[kBarSlot[i]]]);
+      ByteCodec::PutVarint(out, ByteCodec::ZigZag(Sub(t, prev[i])));
+      prev[i] = t;
+    }
+  }
+}
+
+bool DecodeBars(const char *data, size_t size, std::vector<DseBar> &out) {
+  out.clear();
+  const uint8_t *p = (const uint8_t *)data;
+  const uint8_t *end = p + size;
+  if (size < 4 || p[0] != kVersion)
+    return false;
+  double scale[3];
+  for (int s = 0; s < 3; ++s) {
+    if (p[1 + s] > kMaxDecimals)
+      return false;
+    scale[s] = kPow10[p[1 + s]];
+  }
+  p += 4;
+
+  // Each bar takes at least 9 bytes, which bounds n before reserving
+  uint64_t n;
+  if (!ByteCodec::GetVarint(p, end, n) || n > (uint64_t)(end - p) / 9)
+    return false;
+  out.reserve((size_t)n);
+
+  int64_t key = 0;
+  int64_t t[kBarFields] = {};
+  for (uint64_t k = 0; k < n; ++k) {
+    uint64_t z;
+    if (!ByteCodec::GetVarint(p, end, z) || p >= end)
+      return false;
+    key = Add(key, ByteCodec::UnZigZag(z));
+    if (key < 0 || key > 99991231)
+      return false;
+    uint8_t flags = *p++;
+
+    DseBar b;
+    memset(&b, 0, sizeof(b));
+    b.year = (int)(key / 10000);
+    b.month = (int)(key / 100 % 100);
+    b.day = (int)(key % 100);
+    b.valid = (flags & 1) != 0;
+    b.provisional = (flags & 2) != 0;
+    double *dst[kBarFields] = {&b.open,   &b.high,  &b.low,  &b.close,
+                               &b.volume, &b.trade, &b.value};
+    for (int i = 0; i < kBarFields; ++i) {
+      if (!ByteCodec::GetVarint(p, end, z))
+        return false;
+      t[i] = Add(t[i], ByteCodec::UnZigZag(z));
+      *dst[i] = (double)t[i] / scale[kBarSlot[i]];
+    }
+    out.push_back(b);
+  }
+  return p == end;
+}
+
+} // namespace QuoteCodec
@@ -1,22 +1,37 @@
 // RealtimeFeed.cpp — Background Polling Thread
 //
-// Runs a background thread that polls FetchLatestQuotes() at the configured
-// interval during market hours and pushes each update to AmiBroker via
+// Runs a background thread that polls the feed source (the live DSE page, or
+// a recorded session on a virtual clock) at the configured interval during
+// market hours and pushes each update to AmiBroker via
 // PostMessage(WM_USER_STREAMING_UPDATE).
 
 #include "RealtimeFeed.h"
 #include "Plugin.h"
+#include "Metrics.h"
+#include "QuoteCodec.h"
+#include "Trace.h"
+#include <algorithm>
 #include <cstring>
 #include <windows.h>
 
+// Decoded QuoteCodec change sets read as RecentInfo bitmaps
+static_assert(QuoteCodec::kLast == RI_LAST && QuoteCodec::kOpen == RI_OPEN &&
+                  QuoteCodec::kHighLow == RI_HIGHLOW &&
+                  QuoteCodec::kTradeVol == RI_TRADEVOL &&
+                  QuoteCodec::kTotalVol == RI_TOTALVOL &&
+                  QuoteCodec::kPrevChange == RI_PREVCHANGE,
+              "QuoteCodec field bits must keep the RI_* values");
+
 // ---------------------------------------------------------------------------
 // Constructor / Destructor
 // ---------------------------------------------------------------------------
 
 RealtimeFeed::RealtimeFeed()
     : m_hMainWnd(NULL), m_engine(nullptr), m_hThread(NULL), m_running(false),
-      m_stopRequested(false), m_pollIntervalMs(5000), m_reconnectAttempts(0),
-      m_maxReconnectAttempts(10) {}
+      m_pollIntervalMs(5000), m_reconnectAttempts(0),
+      m_maxReconnectAttempts(10), m_configListener(0),
+      m_schedulerChanged(false), m_journalDropped(0), m_wasMarketOpen(false),
+      m_sessionTraded(false), m_sessionDate(0), m_lastReconcileTick(0) {}
 
 RealtimeFeed::~RealtimeFeed() { Stop(); }
 
@@ -30,17 +45,64 @@ bool RealtimeFeed::Start(HWND hMainWnd, DseDataEngine *engine) {
 
   m_hMainWnd = hMainWnd;
   m_engine = engine;
-  m_stopRequested = false;
+  m_stop.Reset();
   m_reconnectAttempts = 0;
 
   if (engine) {
-    m_pollIntervalMs = engine->GetConfig().pollIntervalMs;
-    m_maxReconnectAttempts = engine->GetConfig().maxReconnectAttempts;
+    std::shared_ptr<const DseConfig> cfgSnap = engine->GetConfig();
+    const DseConfig &cfg = *cfgSnap;
+    m_pollIntervalMs = cfg.pollIntervalMs;
+    m_maxReconnectAttempts = cfg.maxReconnectAttempts;
+    m_intraday.Configure(
+        cfg.intradayBarSec, cfg.intradaySessions,
+        (cfg.marketOpenHour * 60 + cfg.marketOpenMinute) * 60,
+        (cfg.marketCloseHour * 60 + cfg.marketCloseMinute) * 60);
+    m_intraday.SetCalendar(engine->GetCalendar());
+    ApplySchedulerConfig(cfg);
+    m_schedulerChanged = false;
+    m_configListener = engine->AddConfigListener(
+        [this](const DseConfig &oldCfg, const DseConfig &newCfg) {
+          OnConfigChanged(oldCfg, newCfg);
+        });
+
+    if (!m_source && cfg.replayEnabled) {
+      std::unique_ptr<ReplayFeedSource> replay(
+          new ReplayFeedSource(engine, cfg.replayPath, cfg.replaySpeed));
+      if (replay->Load())
+        m_source = std::move(replay);
+      else
+        engine->Log("WARNING: RealtimeFeed::Start — replay unavailable, "
+                    "using live feed");
+    }
+    if (!m_source)
+      m_source.reset(new LiveFeedSource(engine, cfg.recordPath));
+
+    // A replay must not write its virtual session into the live journal
+    if (cfg.journalEnabled && m_source->IsLive())
+      OpenJournal(cfg);
+
+    // Same-day and market-hours checks outside the poll loop read the
+    // engine clock; during a replay it runs on the recording's time
+    if (!m_source->IsLive()) {
+      m_virtualUtcMs = std::make_shared<std::atomic<int64_t>>(0);
+      SyncVirtualClock();
+      std::shared_ptr<std::atomic<int64_t>> virtualUtcMs = m_virtualUtcMs;
+      engine->GetClock().SetUtcSource(
+          [virtualUtcMs]() { return virtualUtcMs->load(); });
+    }
   }
 
   m_hThread = CreateThread(NULL, 0, ThreadProc, this, 0, NULL);
   if (!m_hThread) {
     m_engine->Log("ERROR: RealtimeFeed::Start — CreateThread failed");
+    if (m_virtualUtcMs) {
+      m_engine->GetClock().SetUtcSource(nullptr);
+      m_virtualUtcMs.reset();
+    }
+    if (m_configListener) {
+      m_engine->RemoveConfigListener(m_configListener);
+      m_configListener = 0;
+    }
     return false;
   }
 
@@ -53,7 +115,12 @@ void RealtimeFeed::Stop() {
   if (!m_running.load())
     return;
 
-  m_stopRequested = true;
+  m_stop.Set();
+
+  if (m_engine && m_configListener) {
+    m_engine->RemoveConfigListener(m_configListener);
+    m_configListener = 0;
+  }
 
   if (m_hThread) {
     DWORD result = WaitForSingleObject(m_hThread, 10000);
@@ -63,16 +130,75 @@ void RealtimeFeed::Stop() {
     m_hThread = NULL;
   }
 
+  m_journal.Close();
+  if (m_virtualUtcMs) {
+    m_engine->GetClock().SetUtcSource(nullptr); // back to the system clock
+    m_virtualUtcMs.reset();
+  }
+  m_source.reset();
+
   m_running = false;
   if (m_engine)
     m_engine->Log("RealtimeFeed::Stop — polling thread stopped");
 }
 
+// ---------------------------------------------------------------------------
+// Live Configuration
+// ---------------------------------------------------------------------------
+
+void RealtimeFeed::OnConfigChanged(const DseConfig &oldCfg,
+                                   const DseConfig &cfg) {
+  // Only a changed key overrides what SetPollInterval may have set
+  if (cfg.pollIntervalMs != oldCfg.pollIntervalMs)
+    m_pollIntervalMs = cfg.pollIntervalMs;
+  m_maxReconnectAttempts = cfg.maxReconnectAttempts;
+
+  if (cfg.pollMinIntervalMs != oldCfg.pollMinIntervalMs ||
+      cfg.pollMaxIntervalMs != oldCfg.pollMaxIntervalMs ||
+      cfg.pollJitterPct != oldCfg.pollJitterPct ||
+      cfg.pollAdaptive != oldCfg.pollAdaptive ||
+      cfg.marketOpenHour != oldCfg.marketOpenHour ||
+      cfg.marketOpenMinute != oldCfg.marketOpenMinute ||
+      cfg.marketCloseHour != oldCfg.marketCloseHour ||
+      cfg.marketCloseMinute != oldCfg.marketCloseMinute)
+    m_schedulerChanged = true;
+
+  // These own files or in-memory bars; switching them mid-session would
+  // lose data, so they wait for the next Start
+  if (cfg.intradayBarSec != oldCfg.intradayBarSec ||
+      cfg.intradaySessions != oldCfg.intradaySessions ||
+      cfg.journalEnabled != oldCfg.journalEnabled ||
+      strcmp(cfg.journalPath, oldCfg.journalPath) != 0 ||
+      cfg.replayEnabled != oldCfg.replayEnabled ||
+      strcmp(cfg.replayPath, oldCfg.replayPath) != 0 ||
+      strcmp(cfg.recordPath, oldCfg.recordPath) != 0)
+    m_engine->Log("RealtimeFeed: intraday/journal/replay settings changed — "
+                  "applied when the feed next starts");
+}
+
+void RealtimeFeed::SyncVirtualClock() {
+  if (!m_virtualUtcMs)
+    return;
+  int date, secOfDay;
+  m_source->Now(date, secOfDay);
+  m_virtualUtcMs->store(m_engine->GetClock().ToUtcMs(date, secOfDay));
+}
+
+void RealtimeFeed::ApplySchedulerConfig(const DseConfig &cfg) {
+  m_scheduler.Configure(
+      m_pollIntervalMs.load(), cfg.pollMinIntervalMs, cfg.pollMaxIntervalMs,
+      cfg.pollJitterPct, cfg.pollAdaptive,
+      (cfg.marketOpenHour * 60 + cfg.marketOpenMinute) * 60,
+      (cfg.marketCloseHour * 60 + cfg.marketCloseMinute) * 60);
+  m_scheduler.SetCalendar(m_engine->GetCalendar());
+}
+
 // ---------------------------------------------------------------------------
 // Thread Entry
 // ---------------------------------------------------------------------------
 
 DWORD WINAPI RealtimeFeed::ThreadProc(LPVOID lpParam) {
+  Trace::SetThreadName("poll");
   static_cast<RealtimeFeed *>(lpParam)->PollLoop();
   return 0;
 }
@@ -84,63 +210,259 @@ DWORD WINAPI RealtimeFeed::ThreadProc(LPVOID lpParam) {
 void RealtimeFeed::PollLoop() {
   m_engine->Log("PollLoop: entering");
 
-  while (!m_stopRequested.load()) {
+  while (!m_stop.IsSet()) {
+
+    if (m_schedulerChanged.exchange(false))
+      ApplySchedulerConfig(*m_engine->GetConfig());
+    int baseMs = m_pollIntervalMs.load();
+    if (baseMs != m_scheduler.GetBaseIntervalMs())
+      m_scheduler.SetBaseIntervalMs(baseMs);
+    m_scheduler.SetCalendar(m_engine->GetCalendar());
+    m_intraday.SetCalendar(m_engine->GetCalendar());
+
+    // Queues changed symbols only; the files are written off this thread
+    if (m_source->IsLive())
+      m_engine->CheckAutoExport();
+
+    // A replayed close would land in the live bar cache as provisional
+    // bars that nothing reconciles, so only the exchange's own is captured
+    bool marketOpen = m_source->IsMarketOpen();
+    if (m_source->IsLive()) {
+      if (m_wasMarketOpen && !marketOpen)
+        CaptureSessionClose();
+      m_wasMarketOpen = marketOpen;
+    }
 
-    if (m_engine->IsMarketOpen()) {
+    if (marketOpen) {
+      Trace::Span pollSpan("Poll", "feed");
+      uint64_t pollStart = Metrics::NowUs();
       std::vector<DseQuote> quotes;
-      bool ok = m_engine->FetchLatestQuotes(quotes);
+      bool ok;
+      {
+        Trace::Span fetchSpan("Fetch", "feed");
+        ok = m_source->Fetch(quotes);
+      }
+      SyncVirtualClock();
 
       if (ok) {
         m_reconnectAttempts = 0;
 
-        // Update quote cache
+        int date, secOfDay;
+        m_source->Now(date, secOfDay);
+        RollSession(date);
         {
-          std::lock_guard<std::mutex> lock(m_quotesMutex);
-          for (const auto &q : quotes)
+          Trace::Span diffSpan("Diff", "feed");
+          Metrics::ScopedTimer timer(Metrics::kSnapshotDiff);
+          m_diff.Apply(quotes, m_changes);
+        }
+
+        // Everything downstream sees only the rows that changed
+        const std::vector<DseQuote> &changed = m_changes.quotes;
+        TrackSession(changed);
+        m_scheduler.OnPoll(m_changes.PageMoved(), secOfDay);
+        m_intraday.OnSnapshot(changed, date, secOfDay);
+
+        // A dropped journal entry leaves the file behind the page; the
+        // whole page brings it level again
+        uint64_t dropped = m_journal.GetDroppedCount();
+        m_journal.Append(date, secOfDay,
+                         dropped != m_journalDropped ? quotes : changed);
+        m_journalDropped = dropped;
+
+        // Update quote cache (symbols that left the page keep their last
+        // quote)
+        {
+          Trace::Lock<std::mutex> lock(m_quotesMutex, "m_quotesMutex");
+          for (const auto &q : changed)
             m_latestQuotes[q.symbol] = q;
         }
 
-        // Push subscribed symbols first (priority), then all others
+        // Push changed subscribed symbols first (priority), then the rest
+        m_deferred.clear();
         {
-          std::lock_guard<std::mutex> subLock(m_subsMutex);
-          for (const auto &sym : m_subscriptions) {
-            auto it = m_latestQuotes.find(sym);
-            if (it != m_latestQuotes.end())
-              SendStreamingUpdate(it->second);
+          Trace::Lock<std::mutex> subLock(m_subsMutex, "m_subsMutex");
+          for (size_t i = 0; i < changed.size(); ++i) {
+            if (std::find(m_subscriptions.begin(), m_subscriptions.end(),
+                          changed[i].symbol) != m_subscriptions.end())
+              SendStreamingUpdate(changed[i]);
+            else
+              m_deferred.push_back(i);
           }
         }
-        for (const auto &q : quotes)
-          SendStreamingUpdate(q);
-
-        m_engine->Log("PollLoop: pushed %zu quotes", quotes.size());
+        for (size_t i : m_deferred)
+          SendStreamingUpdate(changed[i]);
+
+        size_t appeared = 0;
+        for (const auto &ch : m_changes.changes)
+          if (ch.flags & SnapshotDiff::kAppeared)
+            ++appeared;
+        Metrics::Add(Metrics::kPolls);
+        Metrics::Add(Metrics::kQuotesChanged, m_changes.changes.size());
+        Metrics::Add(Metrics::kQuotesAppeared, appeared);
+        Metrics::Add(Metrics::kQuotesHalted, m_changes.halted.size());
+        Metrics::Record(Metrics::kPoll, Metrics::NowUs() - pollStart);
+        if (!m_changes.halted.empty())
+          m_engine->Log("PollLoop: %zu symbols left the page (first: %s)",
+                        m_changes.halted.size(),
+                        m_changes.halted[0].c_str());
+        m_engine->Log("PollLoop: pushed %zu of %zu quotes (interval %d ms)",
+                      changed.size(), m_changes.symbols,
+                      m_scheduler.GetIntervalMs());
 
       } else {
+        Metrics::Add(Metrics::kPollFailures);
         m_engine->Log("PollLoop: fetch failed, attempting reconnect");
         if (!TryReconnect()) {
           m_engine->Log("PollLoop: max reconnects reached, sleeping 60s");
-          for (int i = 0; i < 60 && !m_stopRequested.load(); ++i)
-            Sleep(1000);
+          m_source->Wait(60000, m_stop);
           m_reconnectAttempts = 0;
           continue;
         }
       }
 
-      // Sleep for poll interval in 100 ms chunks (responsive to stop signal)
-      int chunks = m_pollIntervalMs / 100;
-      for (int i = 0; i < chunks && !m_stopRequested.load(); ++i)
-        Sleep(100);
+      int date, secOfDay;
+      m_source->Now(date, secOfDay);
+      m_source->Wait(m_scheduler.NextOpenDelayMs(date, secOfDay), m_stop);
 
     } else {
-      // Market is closed — check again in 60 s
-      m_engine->Log("PollLoop: market closed, sleeping 60s");
-      for (int i = 0; i < 60 && !m_stopRequested.load(); ++i)
-        Sleep(1000);
+      if (m_source->IsLive())
+        MaybeReconcile();
+
+      // Market is closed — sleep until the next open edge
+      int date, secOfDay;
+      m_source->Now(date, secOfDay);
+      int waitMs = m_scheduler.NextClosedDelayMs(date, secOfDay);
+      m_engine->Log("PollLoop: market closed, next check in %d s",
+                    waitMs / 1000);
+      m_source->Wait(waitMs, m_stop);
     }
   }
 
   m_engine->Log("PollLoop: exiting");
 }
 
+// ---------------------------------------------------------------------------
+// Session Close
+// ---------------------------------------------------------------------------
+
+// Runs before the poll is diffed, so the first poll of a new date is
+// reported in full and rebuilds the session from scratch.
+void RealtimeFeed::RollSession(int date) {
+  if (date == m_sessionDate)
+    return;
+  m_sessionDate = date;
+  m_sessionTraded = false;
+  m_sessionOpens.clear();
+  m_scheduler.Reset();
+  m_diff.Reset();
+}
+
+// Must run before the new snapshot is copied into m_latestQuotes, since it
+// compares cumulative volume against the previous poll. Rows that did not
+// change hold nothing new for either check.
+void RealtimeFeed::TrackSession(const std::vector<DseQuote> &changed) {
+  Trace::Lock<std::mutex> lock(m_quotesMutex, "m_quotesMutex");
+  for (const auto &q : changed) {
+    if (q.volume <= 0 || q.ltp <= 0)
+      continue;
+    // First traded price seen this session stands in for the open, which
+    // the latest-price page does not publish
+    if (m_sessionOpens.find(q.symbol) == m_sessionOpens.end())
+      m_sessionOpens[q.symbol] = q.ltp;
+    auto prev = m_latestQuotes.find(q.symbol);
+    if (prev != m_latestQuotes.end() && prev->second.volume != q.volume)
+      m_sessionTraded = true;
+  }
+}
+
+void RealtimeFeed::CaptureSessionClose() {
+  // A holiday still looks "open" by the clock, but the page never moves;
+  // appending its stale snapshot would fabricate a bar
+  if (!m_sessionTraded) {
+    m_engine->Log("CaptureSessionClose: no trading seen this session, skip");
+    return;
+  }
+
+  std::vector<DseQuote> quotes;
+  if (!m_source->Fetch(quotes)) {
+    // Fall back to the last in-session snapshot
+    Trace::Lock<std::mutex> lock(m_quotesMutex, "m_quotesMutex");
+    for (const auto &e : m_latestQuotes)
+      quotes.push_back(e.second);
+  } else {
+    Trace::Lock<std::mutex> lock(m_quotesMutex, "m_quotesMutex");
+    for (const auto &q : quotes)
+      m_latestQuotes[q.symbol] = q;
+  }
+
+  for (auto &q : quotes) {
+    auto it = m_sessionOpens.find(q.symbol);
+    if (it != m_sessionOpens.end())
+      q.open = it->second;
+  }
+
+  int appended =
+      m_engine->AppendSessionBars(quotes, m_sessionDate / 10000,
+                                  (m_sessionDate / 100) % 100,
+                                  m_sessionDate % 100);
+  m_engine->Log("CaptureSessionClose: %d EOD bars from %zu quotes", appended,
+                quotes.size());
+
+  m_sessionTraded = false;
+  m_lastReconcileTick = GetTickCount();
+}
+
+// The archive publishes the day's rows some time after the close, so retry
+// at most every 30 minutes until no provisional bar is left.
+void RealtimeFeed::MaybeReconcile() {
+  const DWORD kRetryMs = 30 * 60 * 1000;
+  if (GetTickCount() - m_lastReconcileTick < kRetryMs)
+    return;
+  m_lastReconcileTick = GetTickCount();
+
+  if (!m_engine->HasProvisionalBars())
+    return;
+
+  int updated = m_engine->ReconcileProvisionalBars();
+  m_engine->Log("MaybeReconcile: %d symbols reconciled with archive",
+                updated);
+}
+
+// ---------------------------------------------------------------------------
+// Snapshot Journal
+// ---------------------------------------------------------------------------
+
+// Runs before the poll thread starts, so replayed snapshots feed the same
+// session tracking and intraday bars a live poll would have. Each record
+// already holds only the symbols that changed, so it is consumed as a
+// change set; the diff starts empty and the first live poll covers the
+// whole page.
+void RealtimeFeed::OpenJournal(const DseConfig &cfg) {
+  int today, secOfDay;
+  m_source->Now(today, secOfDay);
+  RollSession(today);
+
+  size_t replayed = 0;
+  auto onReplay = [&](int secOfDay, const std::vector<DseQuote> &quotes) {
+    TrackSession(quotes);
+    m_intraday.OnSnapshot(quotes, today, secOfDay);
+    Trace::Lock<std::mutex> lock(m_quotesMutex, "m_quotesMutex");
+    for (const auto &q : quotes)
+      m_latestQuotes[q.symbol] = q;
+    ++replayed;
+  };
+
+  if (!m_journal.Open(cfg.journalPath, today, onReplay,
+                      cfg.journalKeyframeEvery)) {
+    m_engine->Log("WARNING: OpenJournal — cannot open journal in '%s'",
+                  cfg.journalPath);
+    return;
+  }
+  m_engine->Log("OpenJournal: %s, replayed %zu snapshots",
+                SnapshotJournal::SessionPath(cfg.journalPath, today).c_str(),
+                replayed);
+}
+
 // ---------------------------------------------------------------------------
 // Streaming Update
 // ---------------------------------------------------------------------------
@@ -152,6 +474,8 @@ void RealtimeFeed::SendStreamingUpdate(const DseQuote &quote) {
   if (!m_hMainWnd || !IsWindow(m_hMainWnd))
     return;
 
+  Metrics::ScopedTimer timer(Metrics::kStreamingUpdate);
+  Metrics::Add(Metrics::kStreamingUpdates);
   RecentInfo *ri = new RecentInfo;
   memset(ri, 0, sizeof(RecentInfo));
 
@@ -168,12 +492,14 @@ void RealtimeFeed::SendStreamingUpdate(const DseQuote &quote) {
   ri->iTradeVol = (int)quote.trade;
   ri->nBitmap = 0xFFFF; // all fields valid
 
-  SYSTEMTIME st;
-  GetLocalTime(&st);
-  ri->nDateUpdate = (st.wYear * 10000) + (st.wMonth * 100) + st.wDay;
-  ri->nTimeUpdate = (st.wHour * 10000) + (st.wMinute * 100) + st.wSecond;
+  int date, secOfDay;
+  m_source->Now(date, secOfDay);
+  ri->nDateUpdate = date;
+  ri->nTimeUpdate = (secOfDay / 3600) * 10000 + ((secOfDay / 60) % 60) * 100 +
+                    secOfDay % 60;
   ri->nStatus = (m_engine->GetConnectionState() == CONN_CONNECTED) ? 1 : 2;
 
+  Trace::Instant("PostMessage", "msg");
   PostMessage(m_hMainWnd, WM_USER_STREAMING_UPDATE, (WPARAM)ri->Name,
               (LPARAM)ri);
 }
@@ -184,6 +510,10 @@ void RealtimeFeed::SendStreamingUpdate(const DseQuote &quote) {
 
 // Exponential backoff: 5 s, 10 s, 20 s, ... capped at 60 s.
 bool RealtimeFeed::TryReconnect() {
+  // A replayed page that fails to parse is simply skipped
+  if (!m_source->IsLive())
+    return true;
+
   if (m_reconnectAttempts >= m_maxReconnectAttempts)
     return false;
 
@@ -193,14 +523,12 @@ bool RealtimeFeed::TryReconnect() {
     backoffMs = 60000;
 
   m_engine->Log("TryReconnect: attempt %d/%d, waiting %d ms",
-                m_reconnectAttempts, m_maxReconnectAttempts, backoffMs);
+                m_reconnectAttempts, m_maxReconnectAttempts.load(), backoffMs);
 
-  int chunks = backoffMs / 100;
-  for (int i = 0; i < chunks && !m_stopRequested.load(); ++i)
-    Sleep(100);
+  m_source->Wait(backoffMs, m_stop);
 
   std::vector<DseQuote> test;
-  return m_engine->FetchLatestQuotes(test);
+  return m_source->Fetch(test);
 }
 
 // ---------------------------------------------------------------------------
@@ -208,7 +536,7 @@ bool RealtimeFeed::TryReconnect() {
 // ---------------------------------------------------------------------------
 
 bool RealtimeFeed::GetLatestQuote(const char *symbol, DseQuote &outQuote) {
-  std::lock_guard<std::mutex> lock(m_quotesMutex);
+  Trace::Lock<std::mutex> lock(m_quotesMutex, "m_quotesMutex");
   auto it = m_latestQuotes.find(symbol);
   if (it == m_latestQuotes.end())
     return false;
@@ -229,7 +557,7 @@ ConnectionState RealtimeFeed::GetConnectionState() const {
 // ---------------------------------------------------------------------------
 
 void RealtimeFeed::Subscribe(const char *symbol) {
-  std::lock_guard<std::mutex> lock(m_subsMutex);
+  Trace::Lock<std::mutex> lock(m_subsMutex, "m_subsMutex");
   std::string sym(symbol);
   for (const auto &s : m_subscriptions)
     if (s == sym)
@@ -240,7 +568,7 @@ void RealtimeFeed::Subscribe(const char *symbol) {
 }
 
 void RealtimeFeed::Unsubscribe(const char *symbol) {
-  std::lock_guard<std::mutex> lock(m_subsMutex);
+  Trace::Lock<std::mutex> lock(m_subsMutex, "m_subsMutex");
   std::string sym(symbol);
   m_subscriptions.erase(
       std::remove(m_subscriptions.begin(), m_subscriptions.end(), sym),
@@ -0,0 +1,132 @@
+// SharedMemory.cpp — Named Read/Write Memory Shared Between Processes
+
+#include "SharedMemory.h"
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SharedMemory::~SharedMemory() { Close(); }
+
+#ifdef _WIN32
+
+SharedMemory::SharedMemory() : m_data(nullptr), m_size(0), m_mapping(nullptr) {}
+
+bool SharedMemory::Open(const char *name, size_t size, bool &created) {
+  Close();
+  created = false;
+  std::string fullName = std::string("Local\\") + name;
+  unsigned long long size64 = size;
+  HANDLE mapping = CreateFileMappingA(
+      INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)(size64 >> 32),
+      (DWORD)(size64 & 0xFFFFFFFF), fullName.c_str());
+  if (!mapping)
+    return false;
+  created = GetLastError() != ERROR_ALREADY_EXISTS;
+  m_mapping = mapping;
+
+  // An existing section keeps its creator's size: map all of it
+  void *view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+  if (!view) {
+    Close();
+    return false;
+  }
+  MEMORY_BASIC_INFORMATION info;
+  if (VirtualQuery(view, &info, sizeof(info)) == 0) {
+    UnmapViewOfFile(view);
+    Close();
+    return false;
+  }
+  m_data = view;
+  m_size = info.RegionSize;
+  return true;
+}
+
+void SharedMemory::Close() {
+  if (m_data)
+    UnmapViewOfFile(m_data);
+  if (m_mapping)
+    CloseHandle(m_mapping);
+  m_data = nullptr;
+  m_size = 0;
+  m_mapping = nullptr;
+}
+
+void SharedMemory::Remove(const char *) {}
+
+#else
+
+SharedMemory::SharedMemory() : m_data(nullptr), m_size(0) {}
+
+static std::string PosixName(const char *name) {
+  return std::string("/") + name;
+}
+
+bool SharedMemory::Open(const char *name, size_t size, bool &created) {
+  Close();
+  created = false;
+  std::string fullName = PosixName(name);
+  int fd = shm_open(fullName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd >= 0) {
+    if (ftruncate(fd, (off_t)size) != 0) {
+      close(fd);
+      shm_unlink(fullName.c_str());
+      return false;
+    }
+    created = true;
+  } else {
+    if (errno != EEXIST)
+      return false;
+    fd = shm_open(fullName.c_str(), O_RDWR, 0600);
+    if (fd < 0)
+      return false;
+    // The creator sizes the segment right after creating it
+    struct stat st;
+    for (int i = 0; i < 100; ++i) {
+      if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+      }
+      if (st.st_size > 0)
+        break;
+      usleep(10 * 1000);
+    }
+    if (st.st_size <= 0) {
+      close(fd);
+      return false;
+    }
+    size = (size_t)st.st_size;
+  }
+
+  void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    if (created)
+      shm_unlink(fullName.c_str());
+    created = false;
+    return false;
+  }
+  m_data = p;
+  m_size = size;
+  return true;
+}
+
+void SharedMemory::Close() {
+  if (m_data)
+    munmap(m_data, m_size);
+  m_data = nullptr;
+  m_size = 0;
+}
+
+void SharedMemory::Remove(const char *name) {
+  shm_unlink(PosixName(name).c_str());
+}
+
+#endif
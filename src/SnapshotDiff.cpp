@@ -0,0 +1,165 @@
+// SnapshotDiff.cpp — Change Sets Between Successive Latest-Price Polls
+//
+// Rows are matched to IDs the way QuoteCodec::Encoder does it: the page
+// keeps its row order from poll to poll, so the ID seen at the same row
+// last time is tried before the name is hashed. Fields are compared as
+// parsed; the same page text always parses to the same doubles.
+
+#include "SnapshotDiff.h"
+#include "QuoteCodec.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+using namespace QuoteCodec;
+
+// Every field bit, reported for a symbol that just appeared
+static const uint32_t kAllFields = kLast | kOpen | kHighLow | kTradeVol |
+                                   kTotalVol | kPrevChange | kClose | kValue |
+                                   kValid;
+
+// NaN never equals itself; two NaNs are no change
+static inline bool Differs(double a, double b) {
+  return a != b && (a == a || b == b);
+}
+
+// Bytes from ltp through valid; bitwise equal means nothing changed
+static const size_t kFieldBytes =
+    offsetof(DseQuote, valid) + sizeof(bool) - offsetof(DseQuote, ltp);
+
+static uint32_t DiffFields(const DseQuote &a, const DseQuote &b) {
+  // Most rows sit still between polls
+  if (memcmp(&a.ltp, &b.ltp, kFieldBytes) == 0)
+    return 0;
+  uint32_t fields = 0;
+  if (Differs(a.ltp, b.ltp))
+    fields |= kLast;
+  if (Differs(a.open, b.open))
+    fields |= kOpen;
+  if (Differs(a.high, b.high) || Differs(a.low, b.low))
+    fields |= kHighLow;
+  if (Differs(a.trade, b.trade))
+    fields |= kTradeVol;
+  if (Differs(a.volume, b.volume))
+    fields |= kTotalVol;
+  if (Differs(a.ycp, b.ycp) || Differs(a.change, b.change) ||
+      Differs(a.changePercent, b.changePercent))
+    fields |= kPrevChange;
+  if (Differs(a.close, b.close))
+    fields |= kClose;
+  if (Differs(a.value, b.value))
+    fields |= kValue;
+  if (a.valid != b.valid)
+    fields |= kValid;
+  return fields;
+}
+
+bool SnapshotDiff::ChangeSet::PageMoved() const {
+  if (!halted.empty())
+    return true;
+  for (const auto &c : changes)
+    if ((c.flags & kAppeared) || (c.fields & (kLast | kTradeVol | kTotalVol)))
+      return true;
+  return false;
+}
+
+SnapshotDiff::SnapshotDiff() : m_generation(0), m_present(0) {}
+
+void SnapshotDiff::Reset() {
+  m_ids.clear();
+  m_board.clear();
+  m_stamp.clear();
+  m_onPage.clear();
+  m_order.clear();
+  m_generation = 0;
+  m_present = 0;
+}
+
+void SnapshotDiff::Apply(const std::vector<DseQuote> &quotes,
+                         ChangeSet &out) {
+  out.changes.clear();
+  out.quotes.clear();
+  out.halted.clear();
+  out.symbols = 0;
+
+  if (++m_generation == 0) {
+    std::fill(m_stamp.begin(), m_stamp.end(), 0);
+    m_generation = 1;
+  }
+
+  const size_t before = m_present;
+  size_t stillHere = 0; // rows that were also on the previous page
+  for (size_t k = 0; k < quotes.size(); ++k) {
+    const DseQuote &q = quotes[k];
+    if (!q.symbol[0])
+      continue;
+    size_t len = strnlen(q.symbol, sizeof(q.symbol));
+
+    uint32_t id = k < m_order.size() ? m_order[k] : UINT32_MAX;
+    bool found = id < m_board.size() &&
+                 strncmp(m_board[id].symbol, q.symbol, sizeof(q.symbol)) == 0;
+    if (!found) {
+      std::string name(q.symbol, len);
+      auto it = m_ids.find(name);
+      found = it != m_ids.end();
+      if (found) {
+        id = it->second;
+      } else {
+        id = (uint32_t)m_board.size();
+        m_ids.emplace(name, id);
+        m_board.push_back(q);
+        m_stamp.push_back(0);
+        m_onPage.push_back(0);
+      }
+    }
+    if (m_stamp[id] == m_generation)
+      continue; // repeated row; the first wins
+    m_stamp[id] = m_generation;
+    if (k >= m_order.size())
+      m_order.resize(k + 1, UINT32_MAX);
+    m_order[k] = id;
+    ++out.symbols;
+
+    Change c;
+    c.id = id;
+    c.volumeDelta = c.tradeDelta = c.valueDelta = 0;
+    if (!m_onPage[id]) {
+      m_onPage[id] = 1;
+      ++m_present;
+      c.fields = kAllFields;
+      c.flags = kAppeared;
+    } else {
+      ++stillHere;
+      DseQuote &prev = m_board[id];
+      c.fields = DiffFields(prev, q);
+      if (!c.fields)
+        continue;
+      c.flags = 0;
+      if (c.fields & kLast)
+        c.flags |= kPriceMoved;
+      if (c.fields & kTotalVol)
+        c.flags |= q.volume > prev.volume ? kTraded : kCorrected;
+      c.volumeDelta = q.volume - prev.volume;
+      c.tradeDelta = q.trade - prev.trade;
+      c.valueDelta = q.value - prev.value;
+    }
+    m_board[id] = q;
+    out.changes.push_back(c);
+    out.quotes.push_back(q);
+  }
+
+  // Only look for halted symbols when fewer known rows came back than
+  // were on the page, so a full page costs no scan of the board
+  if (stillHere < before) {
+    for (uint32_t id = 0; id < (uint32_t)m_board.size(); ++id) {
+      if (!m_onPage[id] || m_stamp[id] == m_generation)
+        continue;
+      m_onPage[id] = 0;
+      --m_present;
+      const char *sym = m_board[id].symbol;
+      out.halted.emplace_back(sym, strnlen(sym, sizeof(m_board[id].symbol)));
+    }
+  }
+  if (m_order.size() > quotes.size())
+    m_order.resize(quotes.size());
+}
@@ -0,0 +1,555 @@
+// SnapshotJournal.cpp — Append-Only Binary Journal of Live Snapshots
+//
+// Prices are stored as integer ticks (paisa), so a typical 5-second poll
+// where a few dozen symbols traded costs a few hundred bytes. A keyframe
+// with every symbol's absolute state is written every keyframeEvery polls
+// so readers can seek without decoding the whole session.
+
+#include "SnapshotJournal.h"
+#include "ByteCodec.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include <array>
+#include <cstring>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// File-scope helpers
+// ---------------------------------------------------------------------------
+
+namespace {
+
+const uint8_t kRecSymbol = 1;
+const uint8_t kRecDelta = 2;
+const uint8_t kRecKeyframe = 3;
+
+const uint32_t kVersion = 1;
+const size_t kHeaderSize = 12;
+const size_t kMaxQueued = 256;
+
+// ltp, high, low, close, ycp, change, trade, value (mn), volume
+const int kFieldCount = 9;
+const double kScale[kFieldCount] = {100, 100, 100, 100, 100,
+                                    100, 1,   1000, 1};
+
+typedef std::array<int64_t, kFieldCount> TickState;
+
+double &Field(DseQuote &q, int i) {
+  switch (i) {
+  case 0: return q.ltp;
+  case 1: return q.high;
+  case 2: return q.low;
+  case 3: return q.close;
+  case 4: return q.ycp;
+  case 5: return q.change;
+  case 6: return q.trade;
+  case 7: return q.value;
+  default: return q.volume;
+  }
+}
+
+// Rebuild a DseQuote from ticks, matching what ParseLatestPriceHtml yields.
+DseQuote ToQuote(const std::string &name, const TickState &t) {
+  DseQuote q;
+  memset(&q, 0, sizeof(q));
+  strncpy(q.symbol, name.c_str(), sizeof(q.symbol) - 1);
+  for (int i = 0; i < kFieldCount; ++i)
+    Field(q, i) = (double)t[i] / kScale[i];
+  if (q.ycp > 0)
+    q.changePercent = ((q.ltp - q.ycp) / q.ycp) * 100.0;
+  q.open = q.ycp;
+  q.valid = true;
+  return q;
+}
+
+bool TruncateFile(FILE *fp, long size) {
+#ifdef _WIN32
+  return _chsize_s(_fileno(fp), size) == 0;
+#else
+  return ftruncate(fileno(fp), size) == 0;
+#endif
+}
+
+void MakeDir(const char *dir) {
+#ifdef _WIN32
+  _mkdir(dir);
+#else
+  mkdir(dir, 0755);
+#endif
+}
+
+bool ReadWholeFile(const char *path, std::string &out) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp)
+    return false;
+  char buf[65536];
+  size_t n;
+  out.clear();
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+    out.append(buf, n);
+  fclose(fp);
+  return true;
+}
+
+std::string IndexPathFor(const char *journalPath) {
+  std::string p(journalPath);
+  size_t dot = p.rfind('.');
+  if (dot != std::string::npos)
+    p.resize(dot);
+  return p + ".dsx";
+}
+
+// Decodes records from data[pos..size). Stops at the first record that is
+// truncated or malformed and returns its offset (the valid end of file).
+struct Decoder {
+  std::vector<std::string> names;
+  std::vector<TickState> state;
+
+  void Ensure(uint32_t id) {
+    if (id >= names.size()) {
+      names.resize(id + 1);
+      TickState zero;
+      zero.fill(0);
+      state.resize(id + 1, zero);
+    }
+  }
+
+  size_t Run(const uint8_t *data, size_t size, size_t pos,
+             const SnapshotJournal::SnapshotFn &fn,
+             std::vector<SnapshotJournal::IndexEntry> *index) {
+    const uint8_t *end = data + size;
+    std::vector<DseQuote> changed;
+
+    while (pos < size) {
+      const uint8_t *p = data + pos;
+      uint8_t type = *p++;
+      uint64_t len;
+      if (!ByteCodec::GetVarint(p, end, len) || (uint64_t)(end - p) < len)
+        return pos;
+      const uint8_t *rec = p;
+      const uint8_t *recEnd = p + len;
+      size_t next = (size_t)(recEnd - data);
+
+      if (type == kRecSymbol) {
+        uint64_t id;
+        if (!ByteCodec::GetVarint(rec, recEnd, id) || rec >= recEnd ||
+            id > 1000000)
+          return pos;
+        uint8_t n = *rec++;
+        if (recEnd - rec < n)
+          return pos;
+        Ensure((uint32_t)id);
+        names[id].assign((const char *)rec, n);
+      } else if (type == kRecDelta || type == kRecKeyframe) {
+        uint64_t sec, count;
+        if (!ByteCodec::GetVarint(rec, recEnd, sec) ||
+            !ByteCodec::GetVarint(rec, recEnd, count))
+          return pos;
+        changed.clear();
+        for (uint64_t k = 0; k < count; ++k) {
+          uint64_t id;
+          if (!ByteCodec::GetVarint(rec, recEnd, id) || id > 1000000)
+            return pos;
+          Ensure((uint32_t)id);
+
+          uint64_t bitmap = (1u << kFieldCount) - 1;
+          if (type == kRecKeyframe) {
+            if (rec >= recEnd)
+              return pos;
+            uint8_t n = *rec++;
+            if (recEnd - rec < n)
+              return pos;
+            names[id].assign((const char *)rec, n);
+            rec += n;
+          } else if (!ByteCodec::GetVarint(rec, recEnd, bitmap)) {
+            return pos;
+          }
+
+          TickState &t = state[id];
+          for (int i = 0; i < kFieldCount; ++i) {
+            if (!(bitmap & (1u << i)))
+              continue;
+            uint64_t z;
+            if (!ByteCodec::GetVarint(rec, recEnd, z))
+              return pos;
+            int64_t v = ByteCodec::UnZigZag(z);
+            t[i] = (type == kRecKeyframe) ? v : t[i] + v;
+          }
+          if (!names[id].empty())
+            changed.push_back(ToQuote(names[id], t));
+        }
+        if (index) {
+          SnapshotJournal::IndexEntry e;
+          e.secOfDay = (uint32_t)sec;
+          e.offset = (uint32_t)pos;
+          e.flags = (type == kRecKeyframe) ? 1 : 0;
+          index->push_back(e);
+        }
+        if (fn)
+          fn((int)sec, changed);
+      }
+      // Unknown record types are skipped for forward compatibility
+      pos = next;
+    }
+    return pos;
+  }
+};
+
+bool CheckHeader(const std::string &bytes, uint32_t *outDate) {
+  if (bytes.size() < kHeaderSize || memcmp(bytes.data(), "DSJ1", 4) != 0)
+    return false;
+  const uint8_t *p = (const uint8_t *)bytes.data() + 4;
+  const uint8_t *end = (const uint8_t *)bytes.data() + kHeaderSize;
+  uint32_t version, date;
+  if (!ByteCodec::GetU32(p, end, version) || !ByteCodec::GetU32(p, end, date))
+    return false;
+  if (outDate)
+    *outDate = date;
+  return version == kVersion;
+}
+
+void PutRecord(std::string &out, uint8_t type, const std::string &payload) {
+  out.push_back((char)type);
+  ByteCodec::PutVarint(out, payload.size());
+  out += payload;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Constructor / Destructor
+// ---------------------------------------------------------------------------
+
+SnapshotJournal::SnapshotJournal()
+    : m_keyframeEvery(60), m_open(false), m_file(NULL), m_indexFile(NULL),
+      m_fileDate(0), m_fileSize(0), m_sinceKeyframe(0), m_stop(false),
+      m_dropped(0) {}
+
+SnapshotJournal::~SnapshotJournal() { Close(); }
+
+// ---------------------------------------------------------------------------
+// Open / Close
+// ---------------------------------------------------------------------------
+
+std::string SnapshotJournal::SessionPath(const char *dir, int date) {
+  char name[32];
+  snprintf(name, sizeof(name), "%08d.dsj", date);
+  std::string path(dir ? dir : "");
+#ifdef _WIN32
+  const char sep = '\\';
+#else
+  const char sep = '/';
+#endif
+  if (!path.empty() && path.back() != '\\' && path.back() != '/')
+    path += sep;
+  return path + name;
+}
+
+bool SnapshotJournal::Open(const char *dir, int date,
+                           const SnapshotFn &onReplay, int keyframeEvery) {
+  Close();
+
+  m_dir = (dir && dir[0]) ? dir : ".";
+  m_keyframeEvery = (keyframeEvery > 0) ? keyframeEvery : 60;
+  MakeDir(m_dir.c_str());
+
+  if (!OpenFile(date, onReplay))
+    return false;
+
+  m_stop = false;
+  m_open = true;
+  m_thread = std::thread(&SnapshotJournal::WriterLoop, this);
+  return true;
+}
+
+void SnapshotJournal::Close() {
+  if (!m_open)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    m_stop = true;
+  }
+  m_queueCv.notify_all();
+  if (m_thread.joinable())
+    m_thread.join();
+  m_open = false;
+  CloseFile();
+}
+
+bool SnapshotJournal::OpenFile(int date, const SnapshotFn &onReplay) {
+  std::string path = SessionPath(m_dir.c_str(), date);
+  std::string indexPath = IndexPathFor(path.c_str());
+
+  m_ids.clear();
+  m_names.clear();
+  m_state.clear();
+
+  std::string bytes;
+  uint32_t headerDate = 0;
+  if (ReadWholeFile(path.c_str(), bytes) && CheckHeader(bytes, &headerDate) &&
+      headerDate == (uint32_t)date) {
+    // Resume: decode what is there, rebuild the index, cut a torn tail
+    Decoder dec;
+    std::vector<IndexEntry> index;
+    size_t validEnd =
+        dec.Run((const uint8_t *)bytes.data(), bytes.size(), kHeaderSize,
+                onReplay, &index);
+
+    m_file = fopen(path.c_str(), "r+b");
+    if (!m_file)
+      return false;
+    if (validEnd < bytes.size())
+      TruncateFile(m_file, (long)validEnd);
+    fseek(m_file, 0, SEEK_END);
+    m_fileSize = (uint32_t)validEnd;
+
+    m_indexFile = fopen(indexPath.c_str(), "wb");
+    if (m_indexFile && !index.empty())
+      fwrite(index.data(), sizeof(IndexEntry), index.size(), m_indexFile);
+
+    for (size_t id = 0; id < dec.names.size(); ++id) {
+      SymbolState st;
+      for (int i = 0; i < kFieldCount; ++i)
+        st.fields[i] = dec.state[id][i];
+      m_state.push_back(st);
+      m_names.push_back(dec.names[id]);
+      if (!dec.names[id].empty())
+        m_ids[dec.names[id]] = (uint32_t)id;
+    }
+  } else {
+    m_file = fopen(path.c_str(), "wb");
+    if (!m_file)
+      return false;
+    std::string header("DSJ1");
+    ByteCodec::PutU32(header, kVersion);
+    ByteCodec::PutU32(header, (uint32_t)date);
+    fwrite(header.data(), 1, header.size(), m_file);
+    fflush(m_file);
+    m_fileSize = (uint32_t)header.size();
+    m_indexFile = fopen(indexPath.c_str(), "wb");
+  }
+
+  m_fileDate = date;
+  m_sinceKeyframe = m_keyframeEvery; // first write is always a keyframe
+  return true;
+}
+
+void SnapshotJournal::CloseFile() {
+  if (m_file) {
+    fclose(m_file);
+    m_file = NULL;
+  }
+  if (m_indexFile) {
+    fclose(m_indexFile);
+    m_indexFile = NULL;
+  }
+  m_fileDate = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+
+void SnapshotJournal::Append(int date, int secOfDay,
+                             const std::vector<DseQuote> &quotes) {
+  if (!m_open)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    if (m_queue.size() >= kMaxQueued) {
+      m_queue.pop_front();
+      ++m_dropped;
+    }
+    m_queue.emplace_back();
+    Pending &p = m_queue.back();
+    p.date = date;
+    p.secOfDay = secOfDay;
+    p.quotes = quotes;
+    Metrics::Set(Metrics::kJournalQueue, (int64_t)m_queue.size());
+  }
+  m_queueCv.notify_one();
+}
+
+void SnapshotJournal::WriterLoop() {
+  Trace::SetThreadName("journal");
+  for (;;) {
+    Pending snap;
+    {
+      std::unique_lock<std::mutex> lock(m_queueMutex);
+      m_queueCv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+      if (m_queue.empty())
+        return; // stop requested and queue drained
+      snap = std::move(m_queue.front());
+      m_queue.pop_front();
+      Metrics::Set(Metrics::kJournalQueue, (int64_t)m_queue.size());
+    }
+
+    // Session rollover
+    if (snap.date != m_fileDate) {
+      CloseFile();
+      if (!OpenFile(snap.date, nullptr))
+        continue;
+    }
+    if (m_file)
+      WriteSnapshot(snap);
+  }
+}
+
+void SnapshotJournal::WriteSnapshot(const Pending &snap) {
+  std::string out;
+  std::string payload;
+  std::string body;
+  uint32_t changedCount = 0;
+  const bool keyframe = m_sinceKeyframe >= m_keyframeEvery;
+
+  for (const auto &q : snap.quotes) {
+    if (!q.symbol[0])
+      continue;
+
+    uint32_t id;
+    auto it = m_ids.find(q.symbol);
+    if (it == m_ids.end()) {
+      id = (uint32_t)m_names.size();
+      m_ids[q.symbol] = id;
+      m_names.push_back(q.symbol);
+      SymbolState zero;
+      memset(&zero, 0, sizeof(zero));
+      m_state.push_back(zero);
+
+      if (!keyframe) {
+        payload.clear();
+        ByteCodec::PutVarint(payload, id);
+        size_t n = strlen(q.symbol);
+        payload.push_back((char)(uint8_t)n);
+        payload.append(q.symbol, n);
+        PutRecord(out, kRecSymbol, payload);
+      }
+    } else {
+      id = it->second;
+    }
+
+    DseQuote copy = q;
+    int64_t ticks[kFieldCount];
+    uint32_t bitmap = 0;
+    for (int i = 0; i < kFieldCount; ++i) {
+      ticks[i] = ByteCodec::ToTicks(Field(copy, i), kScale[i]);
+      if (ticks[i] != m_state[id].fields[i])
+        bitmap |= 1u << i;
+    }
+    if (!bitmap)
+      continue;
+
+    if (!keyframe) {
+      ByteCodec::PutVarint(body, id);
+      ByteCodec::PutVarint(body, bitmap);
+      for (int i = 0; i < kFieldCount; ++i)
+        if (bitmap & (1u << i))
+          ByteCodec::PutVarint(
+              body, ByteCodec::ZigZag(ticks[i] - m_state[id].fields[i]));
+      ++changedCount;
+    }
+    for (int i = 0; i < kFieldCount; ++i)
+      m_state[id].fields[i] = ticks[i];
+  }
+
+  payload.clear();
+  ByteCodec::PutVarint(payload, (uint64_t)snap.secOfDay);
+  if (keyframe) {
+    // Absolute state of every symbol, names inline, so a reader can start
+    // decoding here without any earlier record
+    uint32_t n = 0;
+    for (size_t id = 0; id < m_names.size(); ++id) {
+      if (m_names[id].empty())
+        continue;
+      ++n;
+      ByteCodec::PutVarint(body, id);
+      body.push_back((char)(uint8_t)m_names[id].size());
+      body += m_names[id];
+      for (int i = 0; i < kFieldCount; ++i)
+        ByteCodec::PutVarint(body, ByteCodec::ZigZag(m_state[id].fields[i]));
+    }
+    ByteCodec::PutVarint(payload, n);
+  } else {
+    if (changedCount == 0 && out.empty())
+      return; // nothing moved since the previous poll
+    ByteCodec::PutVarint(payload, changedCount);
+  }
+  payload += body;
+
+  size_t recordStart = m_fileSize + out.size();
+  PutRecord(out, keyframe ? kRecKeyframe : kRecDelta, payload);
+
+  if (fwrite(out.data(), 1, out.size(), m_file) != out.size() ||
+      fflush(m_file) != 0) {
+    // Disk full or a locked file: m_state already holds this snapshot, so
+    // a later delta would decode against values the file never got. Cut
+    // the partial record off and make the next record a keyframe, which
+    // restates every symbol (names included) in absolute ticks.
+    clearerr(m_file);
+    fseek(m_file, (long)m_fileSize, SEEK_SET);
+    TruncateFile(m_file, (long)m_fileSize);
+    m_sinceKeyframe = m_keyframeEvery;
+    return;
+  }
+  m_fileSize += (uint32_t)out.size();
+
+  if (m_indexFile) {
+    IndexEntry e;
+    e.secOfDay = (uint32_t)snap.secOfDay;
+    e.offset = (uint32_t)recordStart;
+    e.flags = keyframe ? 1 : 0;
+    fwrite(&e, sizeof(e), 1, m_indexFile);
+    fflush(m_indexFile);
+  }
+
+  m_sinceKeyframe = keyframe ? 0 : m_sinceKeyframe + 1;
+}
+
+// ---------------------------------------------------------------------------
+// Reading
+// ---------------------------------------------------------------------------
+
+bool SnapshotJournal::ReadIndex(const char *path,
+                                std::vector<IndexEntry> &outIndex) {
+  std::string bytes;
+  outIndex.clear();
+  if (!ReadWholeFile(IndexPathFor(path).c_str(), bytes))
+    return false;
+  size_t n = bytes.size() / sizeof(IndexEntry);
+  outIndex.resize(n);
+  if (n)
+    memcpy(outIndex.data(), bytes.data(), n * sizeof(IndexEntry));
+  return true;
+}
+
+bool SnapshotJournal::Replay(const char *path, const SnapshotFn &onSnapshot,
+                             int fromSecOfDay) {
+  std::string bytes;
+  if (!ReadWholeFile(path, bytes) || !CheckHeader(bytes, NULL))
+    return false;
+
+  size_t start = kHeaderSize;
+  if (fromSecOfDay > 0) {
+    std::vector<IndexEntry> index;
+    if (ReadIndex(path, index)) {
+      for (const auto &e : index) {
+        if (e.secOfDay > (uint32_t)fromSecOfDay)
+          break;
+        if ((e.flags & 1) && e.offset < bytes.size())
+          start = e.offset;
+      }
+    }
+  }
+
+  Decoder dec;
+  dec.Run((const uint8_t *)bytes.data(), bytes.size(), start, onSnapshot,
+          NULL);
+  return true;
+}
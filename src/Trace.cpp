@@ -0,0 +1,233 @@
+// Trace.cpp — Chrome trace_event Timeline of Plugin Threads
+
+#include "Trace.h"
+#include "CsvUtils.h"
+#include "PlatformCompat.h"
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Trace {
+
+std::atomic<bool> g_enabled(false);
+
+// ---------------------------------------------------------------------------
+// Per-thread rings
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct Event {
+  const char *name;
+  const char *cat;
+  uint64_t ts;
+  uint64_t dur;
+  char ph; // 'X' complete, 'i' instant
+};
+
+// Written by its thread, read by the dumper; the lock is uncontended
+// except during a dump
+struct ThreadBuffer {
+  std::mutex mutex;
+  std::vector<Event> ring;
+  size_t next = 0; // slot the next event overwrites once the ring is full
+  uint32_t tid = 0;
+  std::string name;
+  bool alive = true;
+};
+
+// Rings of exited threads stay for the dump; past this many, the oldest
+// dead ones are dropped (per-symbol backfill threads come and go)
+const size_t kMaxBuffers = 256;
+
+std::mutex g_registryMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> g_buffers;
+uint32_t g_nextTid = 1;
+std::atomic<size_t> g_capacity(65536);
+
+struct ThreadSlot {
+  std::shared_ptr<ThreadBuffer> buffer;
+  ~ThreadSlot() {
+    if (buffer) {
+      std::lock_guard<std::mutex> lock(buffer->mutex);
+      buffer->alive = false;
+    }
+  }
+};
+
+ThreadBuffer &CurrentBuffer() {
+  static thread_local ThreadSlot slot;
+  if (!slot.buffer) {
+    std::shared_ptr<ThreadBuffer> buf = std::make_shared<ThreadBuffer>();
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    buf->tid = g_nextTid++;
+    if (g_buffers.size() >= kMaxBuffers) {
+      for (auto it = g_buffers.begin(); it != g_buffers.end(); ++it) {
+        std::lock_guard<std::mutex> bufLock((*it)->mutex);
+        if (!(*it)->alive) {
+          g_buffers.erase(it);
+          break;
+        }
+      }
+    }
+    g_buffers.push_back(buf);
+    slot.buffer = buf;
+  }
+  return *slot.buffer;
+}
+
+void Push(const Event &e) {
+  ThreadBuffer &buf = CurrentBuffer();
+  size_t cap = g_capacity.load(std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(buf.mutex);
+  if (buf.ring.size() < cap) {
+    buf.ring.push_back(e);
+    buf.next = buf.ring.size() % cap;
+  } else {
+    buf.ring[buf.next] = e;
+    buf.next = (buf.next + 1) % cap;
+  }
+}
+
+void AppendEscaped(std::string &out, const char *s) {
+  for (; *s; ++s) {
+    unsigned char c = (unsigned char)*s;
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += (char)c;
+    } else if (c < 0x20) {
+      char esc[8];
+      sprintf_s(esc, "\\u%04x", c);
+      out += esc;
+    } else {
+      out += (char)c;
+    }
+  }
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Control
+// ---------------------------------------------------------------------------
+
+void Start(size_t eventsPerThread) {
+  if (eventsPerThread < 1024)
+    eventsPerThread = 1024;
+  g_enabled.store(false, std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    g_capacity.store(eventsPerThread, std::memory_order_relaxed);
+    for (auto it = g_buffers.begin(); it != g_buffers.end();) {
+      std::lock_guard<std::mutex> bufLock((*it)->mutex);
+      if (!(*it)->alive) {
+        it = g_buffers.erase(it);
+        continue;
+      }
+      (*it)->ring.clear();
+      (*it)->next = 0;
+      ++it;
+    }
+  }
+  g_enabled.store(true, std::memory_order_relaxed);
+}
+
+void Stop() { g_enabled.store(false, std::memory_order_relaxed); }
+
+void SetThreadName(const char *name) {
+  ThreadBuffer &buf = CurrentBuffer();
+  std::lock_guard<std::mutex> lock(buf.mutex);
+  if (buf.name != name)
+    buf.name = name;
+}
+
+// ---------------------------------------------------------------------------
+// Recording
+// ---------------------------------------------------------------------------
+
+void Complete(const char *name, const char *cat, uint64_t beginUs,
+              uint64_t durUs) {
+  if (!Enabled())
+    return;
+  Event e = {name, cat, beginUs, durUs, 'X'};
+  Push(e);
+}
+
+void Instant(const char *name, const char *cat) {
+  if (!Enabled())
+    return;
+  Event e = {name, cat, Metrics::NowUs(), 0, 'i'};
+  Push(e);
+}
+
+// ---------------------------------------------------------------------------
+// Output
+// ---------------------------------------------------------------------------
+
+std::string DumpJson() {
+  // Copy each ring under its own lock, oldest event first
+  struct Copy {
+    uint32_t tid;
+    std::string name;
+    std::vector<Event> events;
+  };
+  std::vector<Copy> copies;
+  {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    copies.reserve(g_buffers.size());
+    for (const auto &b : g_buffers) {
+      std::lock_guard<std::mutex> bufLock(b->mutex);
+      Copy c;
+      c.tid = b->tid;
+      c.name = b->name;
+      c.events.reserve(b->ring.size());
+      c.events.insert(c.events.end(), b->ring.begin() + b->next,
+                      b->ring.end());
+      c.events.insert(c.events.end(), b->ring.begin(),
+                      b->ring.begin() + b->next);
+      copies.push_back(std::move(c));
+    }
+  }
+
+  std::string out;
+  out.reserve(256 + copies.size() * 128);
+  out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  out += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+         "\"args\":{\"name\":\"DSE Data Plugin\"}}";
+
+  char line[160];
+  for (const auto &c : copies) {
+    if (!c.name.empty()) {
+      sprintf_s(line, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                      "\"tid\":%u,\"args\":{\"name\":\"",
+                c.tid);
+      out += line;
+      AppendEscaped(out, c.name.c_str());
+      out += "\"}}";
+    }
+    for (const auto &e : c.events) {
+      out += ",\n{\"name\":\"";
+      AppendEscaped(out, e.name);
+      out += "\",\"cat\":\"";
+      AppendEscaped(out, e.cat);
+      if (e.ph == 'X')
+        sprintf_s(line, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu,"
+                        "\"dur\":%llu}",
+                  c.tid, (unsigned long long)e.ts, (unsigned long long)e.dur);
+      else
+        sprintf_s(line, "\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,"
+                        "\"ts\":%llu}",
+                  c.tid, (unsigned long long)e.ts);
+      out += line;
+    }
+  }
+  out += "\n]}\n";
+  return out;
+}
+
+bool WriteJson(const std::string &path) {
+  return CsvUtils::WriteFileAtomic(path.c_str(), DumpJson());
+}
+
+} // namespace Trace
@@ -0,0 +1,282 @@
+// TradingCalendar.cpp — DSE Trading Days and Session Hours
+//
+// Lookups work on day numbers: the weekly pattern is a bit test on
+// (day + 4) % 7, and exceptions are a binary search in a sorted table, so
+// counting trading days over years of history costs O(log holidays).
+
+#include "TradingCalendar.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const int kSearchLimitDays = 5 * 366;
+
+int CountBits(unsigned v) {
+  int n = 0;
+  for (; v; v &= v - 1)
+    ++n;
+  return n;
+}
+
+// "HH:MM" -> seconds since midnight, -1 on error
+int ParseHhMm(const char *s) {
+  int h, m;
+  if (sscanf(s, "%d:%d", &h, &m) != 2 || h < 0 || h > 23 || m < 0 || m > 59)
+    return -1;
+  return h * 3600 + m * 60;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Setup
+// ---------------------------------------------------------------------------
+
+TradingCalendar::TradingCalendar()
+    : m_weekMask(0x1F), m_openSec(10 * 3600), m_closeSec(14 * 3600 + 1800) {}
+
+unsigned TradingCalendar::ParseWeekdays(const char *list) {
+  static const char *kNames[7] = {"sun", "mon", "tue", "wed",
+                                  "thu", "fri", "sat"};
+  unsigned mask = 0;
+  if (!list)
+    return 0;
+
+  const char *p = list;
+  while (*p) {
+    while (*p && !isalpha((unsigned char)*p))
+      ++p;
+    char word[4] = {0};
+    int n = 0;
+    while (*p && isalpha((unsigned char)*p)) {
+      if (n < 3)
+        word[n++] = (char)tolower((unsigned char)*p);
+      ++p;
+    }
+    for (int i = 0; i < 7; ++i)
+      if (n == 3 && strcmp(word, kNames[i]) == 0)
+        mask |= 1u << i;
+  }
+  return mask;
+}
+
+void TradingCalendar::SetDefaultSession(int openSec, int closeSec) {
+  m_openSec = openSec;
+  m_closeSec = closeSec;
+}
+
+bool TradingCalendar::Load(const char *path, int *outBadLines) {
+  m_specials.clear();
+  m_holidays.clear();
+  if (outBadLines)
+    *outBadLines = 0;
+
+  FILE *fp = path ? fopen(path, "r") : nullptr;
+  if (!fp)
+    return false;
+
+  char line[256];
+  while (fgets(line, sizeof(line), fp)) {
+    char *comment = strpbrk(line, ";#");
+    if (comment)
+      *comment = '\0';
+
+    char dateStr[32] = {0}, hours[32] = {0};
+    int fields = sscanf(line, "%31s %31s", dateStr, hours);
+    if (fields < 1)
+      continue; // blank or comment-only
+
+    int y, m, d;
+    if (sscanf(dateStr, "%d-%d-%d", &y, &m, &d) != 3 || m < 1 || m > 12 ||
+        d < 1 || d > 31) {
+      if (outBadLines)
+        ++*outBadLines;
+      continue;
+    }
+
+    Special s;
+    s.day = ToDayNumber(y * 10000 + m * 100 + d);
+    s.openSec = -1;
+    s.closeSec = -1;
+    if (fields == 2) {
+      char *dash = strchr(hours, '-');
+      if (dash) {
+        *dash = '\0';
+        s.openSec = ParseHhMm(hours);
+        s.closeSec = ParseHhMm(dash + 1);
+      }
+      if (s.openSec < 0 || s.closeSec <= s.openSec) {
+        if (outBadLines)
+          ++*outBadLines;
+        continue;
+      }
+    }
+    m_specials.push_back(s);
+  }
+  fclose(fp);
+
+  // Later lines win for a repeated date
+  std::stable_sort(
+      m_specials.begin(), m_specials.end(),
+      [](const Special &a, const Special &b) { return a.day < b.day; });
+  std::vector<Special> unique;
+  for (const auto &s : m_specials) {
+    if (!unique.empty() && unique.back().day == s.day)
+      unique.back() = s;
+    else
+      unique.push_back(s);
+  }
+  m_specials.swap(unique);
+
+  for (const auto &s : m_specials)
+    if (s.openSec < 0)
+      m_holidays.push_back(s.day);
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Lookups
+// ---------------------------------------------------------------------------
+
+const TradingCalendar::Special *TradingCalendar::FindSpecial(int day) const {
+  auto it = std::lower_bound(
+      m_specials.begin(), m_specials.end(), day,
+      [](const Special &s, int d) { return s.day < d; });
+  return (it != m_specials.end() && it->day == day) ? &*it : nullptr;
+}
+
+bool TradingCalendar::IsTradingDayNumber(int day) const {
+  const Special *s = FindSpecial(day);
+  if (s)
+    return s->openSec >= 0;
+  int dow = ((day % 7) + 11) % 7; // 1970-01-01 was a Thursday
+  return (m_weekMask >> dow) & 1;
+}
+
+bool TradingCalendar::IsTradingDay(int ymd) const {
+  return IsTradingDayNumber(ToDayNumber(ymd));
+}
+
+bool TradingCalendar::GetSession(int ymd, int &openSec, int &closeSec) const {
+  int day = ToDayNumber(ymd);
+  const Special *s = FindSpecial(day);
+  if (s) {
+    if (s->openSec < 0)
+      return false;
+    openSec = s->openSec;
+    closeSec = s->closeSec;
+    return true;
+  }
+  if (!IsTradingDayNumber(day))
+    return false;
+  openSec = m_openSec;
+  closeSec = m_closeSec;
+  return true;
+}
+
+int TradingCalendar::NextTradingDay(int ymd) const {
+  if (!m_weekMask && m_specials.empty())
+    return 0;
+  int day = ToDayNumber(ymd);
+  for (int i = 1; i <= kSearchLimitDays; ++i)
+    if (IsTradingDayNumber(day + i))
+      return FromDayNumber(day + i);
+  return 0;
+}
+
+int TradingCalendar::PrevTradingDay(int ymd) const {
+  if (!m_weekMask && m_specials.empty())
+    return 0;
+  int day = ToDayNumber(ymd);
+  for (int i = 1; i <= kSearchLimitDays; ++i)
+    if (IsTradingDayNumber(day - i))
+      return FromDayNumber(day - i);
+  return 0;
+}
+
+bool TradingCalendar::NextSession(int ymd, int secOfDay, int &outYmd,
+                                  int &outOpenSec) const {
+  int openSec, closeSec;
+  if (GetSession(ymd, openSec, closeSec) && secOfDay < closeSec) {
+    outYmd = ymd;
+    outOpenSec = openSec;
+    return true;
+  }
+  int next = NextTradingDay(ymd);
+  if (!next || !GetSession(next, openSec, closeSec))
+    return false;
+  outYmd = next;
+  outOpenSec = openSec;
+  return true;
+}
+
+// Days in [fromDay, toDay] matching the weekly pattern: whole weeks
+// contribute popcount(mask) each, the remainder is walked.
+int TradingCalendar::CountPatternDays(int fromDay, int toDay) const {
+  int span = toDay - fromDay + 1;
+  int count = (span / 7) * CountBits(m_weekMask);
+  for (int day = fromDay + (span / 7) * 7; day <= toDay; ++day) {
+    int dow = ((day % 7) + 11) % 7;
+    count += (m_weekMask >> dow) & 1;
+  }
+  return count;
+}
+
+int TradingCalendar::TradingDaysBetween(int fromYmd, int toYmd) const {
+  int from = ToDayNumber(fromYmd), to = ToDayNumber(toYmd);
+  if (from > to)
+    return 0;
+
+  int count = CountPatternDays(from, to);
+
+  // Correct for exceptions inside the range
+  auto lo = std::lower_bound(
+      m_specials.begin(), m_specials.end(), from,
+      [](const Special &s, int d) { return s.day < d; });
+  for (auto it = lo; it != m_specials.end() && it->day <= to; ++it) {
+    int dow = ((it->day % 7) + 11) % 7;
+    bool pattern = (m_weekMask >> dow) & 1;
+    bool trading = it->openSec >= 0;
+    if (pattern && !trading)
+      --count;
+    else if (!pattern && trading)
+      ++count;
+  }
+  return count;
+}
+
+// ---------------------------------------------------------------------------
+// Date arithmetic (proleptic Gregorian, days since 1970-01-01)
+// ---------------------------------------------------------------------------
+
+int TradingCalendar::ToDayNumber(int ymd) {
+  int y = ymd / 10000, m = (ymd / 100) % 100, d = ymd % 100;
+  y -= m <= 2;
+  int era = (y >= 0 ? y : y - 399) / 400;
+  int yoe = y - era * 400;
+  int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+int TradingCalendar::FromDayNumber(int z) {
+  z += 719468;
+  int era = (z >= 0 ? z : z - 146096) / 146097;
+  int doe = z - era * 146097;
+  int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int y = yoe + era * 400;
+  int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  int mp = (5 * doy + 2) / 153;
+  int d = doy - (153 * mp + 2) / 5 + 1;
+  int m = mp + (mp < 10 ? 3 : -9);
+  y += m <= 2;
+  return y * 10000 + m * 100 + d;
+}
+
+int TradingCalendar::DayOfWeek(int ymd) {
+  int day = ToDayNumber(ymd);
+  return ((day % 7) + 11) % 7;
+}
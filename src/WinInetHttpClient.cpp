@@ -0,0 +1,181 @@
+// WinInetHttpClient.cpp — HttpClient over WinInet (plugin build only)
+
+#include "WinInetHttpClient.h"
+#include "Metrics.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+WinInetHttpClient::WinInetHttpClient() : m_hInternet(NULL) {}
+
+WinInetHttpClient::~WinInetHttpClient() { Close(); }
+
+void WinInetHttpClient::Emit(const char *fmt, ...) const {
+  if (!m_log)
+    return;
+  char msg[1024];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(msg, sizeof(msg), fmt, args);
+  va_end(args);
+  m_log(msg);
+}
+
+// ---------------------------------------------------------------------------
+// Session
+// ---------------------------------------------------------------------------
+
+bool WinInetHttpClient::Open(const char *userAgent, int timeoutSec,
+                             const LogFn &log) {
+  m_log = log;
+  HINTERNET hInternet = InternetOpenA(userAgent, INTERNET_OPEN_TYPE_PRECONFIG,
+                                      NULL, NULL, 0);
+  if (!hInternet) {
+    Emit("ERROR: InternetOpen failed, error=%lu", GetLastError());
+    return false;
+  }
+  Close();
+  m_hInternet = hInternet;
+  Configure(userAgent, timeoutSec);
+  return true;
+}
+
+void WinInetHttpClient::Configure(const char *userAgent, int timeoutSec) {
+  if (!m_hInternet)
+    return;
+  DWORD timeout = timeoutSec * 1000;
+  InternetSetOptionA(m_hInternet, INTERNET_OPTION_CONNECT_TIMEOUT, &timeout,
+                     sizeof(timeout));
+  InternetSetOptionA(m_hInternet, INTERNET_OPTION_RECEIVE_TIMEOUT, &timeout,
+                     sizeof(timeout));
+  InternetSetOptionA(m_hInternet, INTERNET_OPTION_SEND_TIMEOUT, &timeout,
+                     sizeof(timeout));
+  InternetSetOptionA(m_hInternet, INTERNET_OPTION_USER_AGENT, (LPVOID)userAgent,
+                     (DWORD)strlen(userAgent));
+}
+
+void WinInetHttpClient::Close() {
+  if (m_hInternet) {
+    InternetCloseHandle(m_hInternet);
+    m_hInternet = NULL;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Requests
+// ---------------------------------------------------------------------------
+
+uint64_t WinInetHttpClient::ReadAll(HINTERNET h, std::string &outBody) {
+  outBody.clear();
+  uint64_t firstByte = 0;
+  char buffer[8192];
+  DWORD bytesRead = 0;
+  while (InternetReadFile(h, buffer, sizeof(buffer), &bytesRead) &&
+         bytesRead > 0) {
+    if (!firstByte)
+      firstByte = Metrics::NowUs();
+    outBody.append(buffer, bytesRead);
+    bytesRead = 0;
+  }
+  return firstByte;
+}
+
+// WinInet resolves, connects, handshakes, sends and reads the response
+// headers inside the one open/send call, so "connect" ends at the headers.
+void WinInetHttpClient::RecordTimings(uint64_t start, uint64_t responded,
+                                      uint64_t firstByte) {
+  if (!Metrics::Enabled())
+    return;
+  Metrics::Record(Metrics::kHttpConnect, responded - start);
+  if (firstByte) {
+    uint64_t end = Metrics::NowUs();
+    Metrics::Record(Metrics::kHttpTtfb, firstByte - start);
+    Metrics::Record(Metrics::kHttpBody, end - firstByte);
+  }
+}
+
+bool WinInetHttpClient::Get(const char *url, std::string &outBody) {
+  if (!m_hInternet)
+    return false;
+
+  uint64_t start = Metrics::NowUs();
+
+  // Try HTTPS first, fall back to plain HTTP on failure
+  HINTERNET hUrl =
+      InternetOpenUrlA(m_hInternet, url, NULL, 0,
+                       INTERNET_FLAG_RELOAD | INTERNET_FLAG_NO_CACHE_WRITE |
+                           INTERNET_FLAG_PRAGMA_NOCACHE | INTERNET_FLAG_SECURE,
+                       0);
+
+  if (!hUrl) {
+    Emit("WARNING: HttpGet HTTPS failed (err=%lu), retrying without SECURE",
+         GetLastError());
+    hUrl = InternetOpenUrlA(m_hInternet, url, NULL, 0,
+                            INTERNET_FLAG_RELOAD | INTERNET_FLAG_NO_CACHE_WRITE,
+                            0);
+    if (!hUrl)
+      return false;
+  }
+
+  uint64_t responded = Metrics::NowUs();
+  RecordTimings(start, responded, ReadAll(hUrl, outBody));
+  InternetCloseHandle(hUrl);
+  return true;
+}
+
+bool WinInetHttpClient::Post(const char *url, const char *formPayload,
+                             std::string &outBody) {
+  if (!m_hInternet)
+    return false;
+
+  URL_COMPONENTSA urlComp = {0};
+  char host[256] = {0};
+  char path[1024] = {0};
+  urlComp.dwStructSize = sizeof(urlComp);
+  urlComp.lpszHostName = host;
+  urlComp.dwHostNameLength = sizeof(host);
+  urlComp.lpszUrlPath = path;
+  urlComp.dwUrlPathLength = sizeof(path);
+
+  if (!InternetCrackUrlA(url, 0, 0, &urlComp)) {
+    Emit("ERROR: InternetCrackUrl failed, error=%lu", GetLastError());
+    return false;
+  }
+
+  uint64_t start = Metrics::NowUs();
+  HINTERNET hConnect =
+      InternetConnectA(m_hInternet, host, INTERNET_DEFAULT_HTTPS_PORT, NULL,
+                       NULL, INTERNET_SERVICE_HTTP, 0, 0);
+  if (!hConnect) {
+    Emit("ERROR: InternetConnect failed, error=%lu", GetLastError());
+    return false;
+  }
+
+  const char *acceptTypes[] = {"*/*", NULL};
+  HINTERNET hRequest =
+      HttpOpenRequestA(hConnect, "POST", path, NULL, NULL, acceptTypes,
+                       INTERNET_FLAG_RELOAD | INTERNET_FLAG_NO_CACHE_WRITE |
+                           INTERNET_FLAG_SECURE,
+                       0);
+  if (!hRequest) {
+    Emit("ERROR: HttpOpenRequest failed, error=%lu", GetLastError());
+    InternetCloseHandle(hConnect);
+    return false;
+  }
+
+  const char *headers = "Content-Type: application/x-www-form-urlencoded";
+  DWORD headersLen = (DWORD)strlen(headers);
+  if (!HttpSendRequestA(hRequest, headers, headersLen, (LPVOID)formPayload,
+                        (DWORD)strlen(formPayload))) {
+    Emit("ERROR: HttpSendRequest failed, error=%lu", GetLastError());
+    InternetCloseHandle(hRequest);
+    InternetCloseHandle(hConnect);
+    return false;
+  }
+
+  uint64_t responded = Metrics::NowUs();
+  RecordTimings(start, responded, ReadAll(hRequest, outBody));
+  InternetCloseHandle(hRequest);
+  InternetCloseHandle(hConnect);
+  return true;
+}
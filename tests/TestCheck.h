@@ -0,0 +1,43 @@
+///////////////////////////////////////////////////////////////////////////
+// TestCheck.h — Minimal Assertions for the ctest Programs
+//
+// Each test in tests/ is a plain program over dse_core: CHECK records a
+// failure (with file and line) and carries on, and main returns
+// TestCheck::Report(), which is non-zero if anything failed.
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <cstdio>
+
+namespace TestCheck {
+
+  inline int &Failures() {
+    static int failures = 0;
+    return failures;
+  }
+
+  inline void Fail(const char *expr, const char *file, int line) {
+    ++Failures();
+    fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, expr);
+  }
+
+  // Print a summary; the value to return from main
+  inline int Report(const char *name) {
+    if (Failures())
+      fprintf(stderr, "%s: %d check(s) failed\n", name, Failures());
+    else
+      printf("%s: ok\n", name);
+    return Failures() ? 1 : 0;
+  }
+
+} // namespace TestCheck
+
+#define CHECK(expr)                                                          \
+  do {                                                                       \
+    if (!(expr))                                                             \
+      TestCheck::Fail(#expr, __FILE__, __LINE__);                            \
+  } while (0)
+
+#endif // TEST_CHECK_H
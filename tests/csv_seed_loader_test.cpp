@@ -0,0 +1,106 @@
+// csv_seed_loader_test.cpp — CsvSeedLoader Line Formats
+//
+// Both layouts with every date form the header promises (YYYY-MM-DD with
+// any separator, bare YYYYMMDD), plus the rows the parser must skip, and a
+// whole file through Parse with mixed line endings.
+
+#include "CsvSeedLoader.h"
+#include "TestCheck.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+bool Line(const std::string &line, DseBar &bar, std::string *sym = nullptr) {
+  const char *s = nullptr;
+  size_t len = 0;
+  bool ok = CsvSeedLoader::ParseLine(line.data(), line.data() + line.size(),
+                                     bar, &s, &len);
+  if (ok && sym)
+    sym->assign(s, len);
+  return ok;
+}
+
+bool IsJan2(const DseBar &b) {
+  return b.year == 2024 && b.month == 1 && b.day == 2 && b.valid;
+}
+
+void TestDateFirst() {
+  const char *rows[] = {
+      "2024-01-02,10.5,11,10,10.75,12345",
+      "2024/01/02,10.5,11,10,10.75,12345",
+      "2024.01.02,10.5,11,10,10.75,12345",
+      "20240102,10.5,11,10,10.75,12345",
+      "2024-01-02 00:00:00,10.5,11,10,10.75,12345\r",
+  };
+  for (const char *row : rows) {
+    DseBar bar;
+    std::string sym = "unset";
+    CHECK(Line(row, bar, &sym));
+    CHECK(IsJan2(bar));
+    CHECK(sym.empty()); // Format B has no trading code
+    CHECK(bar.open == 10.5 && bar.high == 11 && bar.low == 10 &&
+          bar.close == 10.75 && bar.volume == 12345);
+  }
+}
+
+void TestTickerFirst() {
+  const char *rows[] = {
+      "GP,2024-01-02,10.5,11,10,10.75,12345",
+      "GP,2024/01/02,10.5,11,10,10.75,12345",
+      "GP,20240102,10.5,11,10,10.75,12345",
+  };
+  for (const char *row : rows) {
+    DseBar bar;
+    std::string sym;
+    CHECK(Line(row, bar, &sym));
+    CHECK(IsJan2(bar));
+    CHECK(sym == "GP");
+    CHECK(bar.close == 10.75 && bar.volume == 12345);
+  }
+
+  // Codes that start with digits are still codes
+  DseBar bar;
+  std::string sym;
+  CHECK(Line("1JANATAMF,20240102,5.1,5.2,5,5.1,100", bar, &sym));
+  CHECK(sym == "1JANATAMF" && IsJan2(bar));
+}
+
+void TestSkipped() {
+  DseBar bar;
+  CHECK(!Line("Date,Open,High,Low,Close,Volume", bar));
+  CHECK(!Line("Trading_Code,Date,Open,High,Low,Close,Volume", bar));
+  CHECK(!Line("", bar));
+  CHECK(!Line("\r", bar));
+  CHECK(!Line("2024-13-02,10,11,9,10,1", bar)); // no such month
+  CHECK(!Line("2024-01-02,0,11,9,10,1", bar));  // zero price
+  CHECK(!Line("2024-01-02,10,9,11,10,1", bar)); // high below low
+  CHECK(!Line("GP,2024-1-2,10,11,9,10,1", bar)); // unpadded date
+}
+
+void TestParse() {
+  std::string file = "Date,Open,High,Low,Close,Volume\r\n"
+                     "2024-01-02,1,2,1,2,10\r\n"
+                     "2024/01/03,2,3,2,3,20\n"
+                     "20240104,3,4,3,4,30\n"
+                     "\n"
+                     "2024-01-05,4,5,4,5,40";
+  std::vector<DseBar> bars;
+  CHECK(CsvSeedLoader::Parse(file.data(), file.size(), bars) == 4);
+  CHECK(bars.size() == 4);
+  for (size_t i = 0; i < bars.size(); ++i) {
+    CHECK(bars[i].day == (int)i + 2);
+    CHECK(bars[i].volume == 10.0 * (i + 1));
+  }
+}
+
+} // namespace
+
+int main() {
+  TestDateFirst();
+  TestTickerFirst();
+  TestSkipped();
+  TestParse();
+  return TestCheck::Report("csv_seed_loader_test");
+}
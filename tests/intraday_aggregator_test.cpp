@@ -0,0 +1,193 @@
+// intraday_aggregator_test.cpp — IntradayAggregator Over Hand-Built Polls
+//
+// Feeds cumulative day totals the way the poll loop does and checks the
+// bars that come out: volume deltas landing in the right interval, a
+// symbol joined mid-session, the ring dropping the oldest session once it
+// wraps, a page correction that lowers the cumulative volume, and a
+// special session whose open comes from the calendar.
+
+#include "IntradayAggregator.h"
+#include "TestCheck.h"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+const int kOpen = 10 * 3600;
+const int kClose = 14 * 3600 + 30 * 60;
+
+DseQuote Row(const char *symbol, double ltp, double volume) {
+  DseQuote q;
+  memset(&q, 0, sizeof(q));
+  strncpy(q.symbol, symbol, sizeof(q.symbol) - 1);
+  q.ltp = q.high = q.low = q.open = q.close = q.ycp = ltp;
+  q.volume = volume;
+  q.trade = volume / 10;
+  q.value = ltp * volume;
+  q.valid = true;
+  return q;
+}
+
+int Sec(int h, int m, int s) { return h * 3600 + m * 60 + s; }
+
+void Poll(IntradayAggregator &agg, int date, int secOfDay,
+          const DseQuote &q) {
+  agg.OnSnapshot(std::vector<DseQuote>(1, q), date, secOfDay);
+}
+
+void TestVolumeDeltas() {
+  IntradayAggregator agg;
+  agg.Configure(60, 5, kOpen, kClose);
+  const int day = 20240102;
+
+  Poll(agg, day, Sec(10, 0, 10), Row("GP", 300.0, 100));
+  DseQuote q = Row("GP", 301.0, 150);
+  q.high = 301.0;
+  Poll(agg, day, Sec(10, 0, 40), q);
+  Poll(agg, day, Sec(10, 1, 5), q);  // no trade: no bar for 10:01
+  q = Row("GP", 299.0, 400);
+  q.high = 301.0;
+  Poll(agg, day, Sec(10, 2, 20), q);
+
+  std::vector<DseIntradayBar> bars;
+  CHECK(agg.GetBars("GP", 60, bars));
+  CHECK(bars.size() == 2);
+  if (bars.size() == 2) {
+    CHECK(bars[0].date == day && bars[0].time == 100000);
+    CHECK(bars[0].open == 300.0 && bars[0].high == 301.0 &&
+          bars[0].low == 300.0 && bars[0].close == 301.0);
+    CHECK(bars[0].volume == 150); // from zero at the open
+    CHECK(bars[0].trade == 15);
+    CHECK(bars[1].time == 100200);
+    CHECK(bars[1].open == 299.0 && bars[1].close == 299.0);
+    CHECK(bars[1].volume == 250);
+    CHECK(bars[1].trade == 25);
+    CHECK(bars[1].value == 299.0 * 400 - 301.0 * 150);
+  }
+
+  // Compressed to five minutes: one bar holding both
+  CHECK(agg.GetBars("GP", 300, bars));
+  CHECK(bars.size() == 1);
+  if (bars.size() == 1) {
+    CHECK(bars[0].time == 100000);
+    CHECK(bars[0].open == 300.0 && bars[0].close == 299.0);
+    CHECK(bars[0].high == 301.0 && bars[0].low == 299.0);
+    CHECK(bars[0].volume == 400);
+  }
+
+  // First seen mid-session: the morning's volume is a baseline, not a bar
+  Poll(agg, day, Sec(11, 30, 0), Row("ACI", 250.0, 5000));
+  CHECK(!agg.GetBars("ACI", 60, bars));
+  Poll(agg, day, Sec(11, 30, 45), Row("ACI", 251.0, 5075));
+  CHECK(agg.GetBars("ACI", 60, bars));
+  CHECK(bars.size() == 1 && bars[0].time == 113000 && bars[0].volume == 75);
+
+  CHECK(!agg.GetBars("NONE", 60, bars));
+  agg.Clear();
+  CHECK(!agg.GetBars("GP", 60, bars));
+}
+
+void TestRingWrap() {
+  // A five-minute session at one-minute bars holds 5 + 2 bars per session
+  const int sessions = 2;
+  const int perSession = 7;
+  IntradayAggregator agg;
+  agg.Configure(60, sessions, kOpen, kOpen + 5 * 60);
+
+  // Three sessions of six bars each, every one of them traded
+  const int days[] = {20240102, 20240103, 20240104};
+  for (int day : days)
+    for (int m = 0; m < 6; ++m)
+      Poll(agg, day, Sec(10, m, 30), Row("GP", 300.0 + m, 100.0 * (m + 1)));
+
+  std::vector<DseIntradayBar> bars;
+  CHECK(agg.GetBars("GP", 60, bars));
+  CHECK(bars.size() == (size_t)(sessions * perSession));
+  if (bars.size() == (size_t)(sessions * perSession)) {
+    // 18 bars written, the oldest 4 overwritten: day one keeps 10:04-10:05
+    CHECK(bars.front().date == days[0] && bars.front().time == 100400);
+    CHECK(bars.back().date == days[2] && bars.back().time == 100500);
+    for (size_t i = 1; i < bars.size(); ++i)
+      CHECK(bars[i - 1].date < bars[i].date ||
+            (bars[i - 1].date == bars[i].date &&
+             bars[i - 1].time < bars[i].time));
+    // Each session starts its deltas from zero again
+    for (const auto &b : bars)
+      CHECK(b.volume == 100);
+  }
+}
+
+void TestCorrectedVolume() {
+  IntradayAggregator agg;
+  agg.Configure(60, 5, kOpen, kClose);
+  const int day = 20240102;
+
+  Poll(agg, day, Sec(10, 0, 30), Row("GP", 300.0, 500));
+  // The page restates the day total lower: rebase, no bar, no negative
+  // volume folded into the open bar
+  Poll(agg, day, Sec(10, 0, 50), Row("GP", 300.5, 300));
+  std::vector<DseIntradayBar> bars;
+  CHECK(agg.GetBars("GP", 60, bars));
+  CHECK(bars.size() == 1 && bars[0].volume == 500 && bars[0].close == 300.0);
+
+  // Trading on from the corrected total counts only what is new
+  Poll(agg, day, Sec(10, 1, 10), Row("GP", 301.0, 350));
+  CHECK(agg.GetBars("GP", 60, bars));
+  CHECK(bars.size() == 2);
+  if (bars.size() == 2) {
+    CHECK(bars[1].time == 100100);
+    CHECK(bars[1].volume == 50);
+    CHECK(bars[1].close == 301.0);
+  }
+}
+
+void TestSpecialSession() {
+  // A make-up day that opens an hour late
+  const char *path = "intraday_aggregator_test_calendar.txt";
+  FILE *fp = fopen(path, "w");
+  CHECK(fp != nullptr);
+  if (!fp)
+    return;
+  fputs("2024-01-06 11:00-13:00     ; make-up session\n", fp);
+  fclose(fp);
+  std::shared_ptr<TradingCalendar> calendar(new TradingCalendar());
+  calendar->SetDefaultSession(kOpen, kClose);
+  CHECK(calendar->Load(path));
+  remove(path);
+
+  const int makeUp = 20240106; // a Saturday
+  std::vector<DseIntradayBar> bars;
+
+  // Fixed hours: the first poll after 11:00 looks like a mid-session join
+  IntradayAggregator fixed;
+  fixed.Configure(60, 5, kOpen, kClose);
+  Poll(fixed, makeUp, Sec(11, 0, 20), Row("GP", 300.0, 200));
+  CHECK(!fixed.GetBars("GP", 60, bars));
+
+  // With the calendar it is the open, and its volume is the first bar's
+  IntradayAggregator agg;
+  agg.Configure(60, 5, kOpen, kClose);
+  agg.SetCalendar(calendar);
+  Poll(agg, makeUp, Sec(11, 0, 20), Row("GP", 300.0, 200));
+  CHECK(agg.GetBars("GP", 60, bars));
+  CHECK(bars.size() == 1 && bars[0].time == 110000 && bars[0].volume == 200);
+
+  // Regular days keep the default open
+  Poll(agg, 20240107, Sec(10, 0, 20), Row("ACI", 250.0, 80));
+  CHECK(agg.GetBars("ACI", 60, bars));
+  CHECK(bars.size() == 1 && bars[0].volume == 80);
+  Poll(agg, 20240107, Sec(11, 0, 20), Row("BATBC", 500.0, 900));
+  CHECK(!agg.GetBars("BATBC", 60, bars));
+}
+
+} // namespace
+
+int main() {
+  TestVolumeDeltas();
+  TestRingWrap();
+  TestCorrectedVolume();
+  TestSpecialSession();
+  return TestCheck::Report("intraday_aggregator_test");
+}
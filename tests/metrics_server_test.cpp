@@ -0,0 +1,115 @@
+// metrics_server_test.cpp — MetricsServer Against Loopback
+//
+// Starts the endpoint on a free port and checks each kind of answer: the
+// Prometheus text for GET /metrics, 404 for an unknown path, 405 for a
+// method other than GET/HEAD, and headers without a body for HEAD.
+
+// winsock2.h must precede anything that pulls in windows.h
+#include "SocketCompat.h"
+
+#include "Metrics.h"
+#include "MetricsServer.h"
+#include "TestCheck.h"
+#include <cstring>
+#include <string>
+
+namespace {
+
+struct Response {
+  int status;
+  std::string headers;
+  std::string body;
+};
+
+// One request on a fresh connection; status 0 if the exchange failed
+Response Request(int port, const std::string &request) {
+  Response r = {0, std::string(), std::string()};
+  Net::Socket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (s == Net::kInvalid)
+    return r;
+  Net::SetTimeouts(s, 5000);
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons((unsigned short)port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(s, (const sockaddr *)&addr, sizeof(addr)) != 0 ||
+      send(s, request.data(), (int)request.size(), Net::kSendFlags) !=
+          (int)request.size()) {
+    Net::Close(s);
+    return r;
+  }
+
+  // The server closes the connection after every response
+  std::string raw;
+  char buf[4096];
+  int n;
+  while ((n = recv(s, buf, sizeof(buf), 0)) > 0)
+    raw.append(buf, (size_t)n);
+  Net::Close(s);
+
+  size_t end = raw.find("\r\n\r\n");
+  if (end == std::string::npos || raw.compare(0, 9, "HTTP/1.1 ") != 0)
+    return r;
+  r.status = atoi(raw.c_str() + 9);
+  r.headers = raw.substr(0, end);
+  r.body = raw.substr(end + 4);
+  return r;
+}
+
+size_t ContentLength(const Response &r) {
+  size_t at = r.headers.find("Content-Length: ");
+  return at == std::string::npos
+             ? (size_t)-1
+             : (size_t)strtoul(r.headers.c_str() + at + 16, nullptr, 10);
+}
+
+} // namespace
+
+int main() {
+  Metrics::Add(Metrics::kPolls, 3);
+
+  MetricsServer server;
+  bool started = server.Start(0, [](std::string &out) {
+    out += "dse_test_extra 42\n";
+  });
+  CHECK(started);
+  CHECK(server.Port() > 0);
+  if (!started)
+    return TestCheck::Report("metrics_server_test");
+  int port = server.Port();
+
+  Response get = Request(port, "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n");
+  CHECK(get.status == 200);
+  CHECK(get.headers.find("Content-Type: text/plain; version=0.0.4") !=
+        std::string::npos);
+  CHECK(ContentLength(get) == get.body.size());
+  CHECK(get.body.find("# TYPE") != std::string::npos);
+  CHECK(get.body.find("polls") != std::string::npos);
+  CHECK(get.body.find("dse_test_extra 42\n") != std::string::npos);
+
+  Response query =
+      Request(port, "GET /metrics?x=1 HTTP/1.1\r\nHost: x\r\n\r\n");
+  CHECK(query.status == 200);
+
+  Response missing = Request(port, "GET /nope HTTP/1.1\r\nHost: x\r\n\r\n");
+  CHECK(missing.status == 404);
+
+  Response post = Request(
+      port, "POST /metrics HTTP/1.1\r\nHost: x\r\nContent-Length: 0\r\n\r\n");
+  CHECK(post.status == 405);
+
+  Response head = Request(port, "HEAD /metrics HTTP/1.1\r\nHost: x\r\n\r\n");
+  CHECK(head.status == 200);
+  CHECK(head.body.empty());
+  CHECK(ContentLength(head) > 0); // the size a GET would have sent
+
+  Response junk = Request(port, "garbage\r\n\r\n");
+  CHECK(junk.status == 400);
+
+  server.Stop();
+  CHECK(!server.IsRunning());
+  CHECK(Request(port, "GET /metrics HTTP/1.1\r\n\r\n").status == 0);
+
+  return TestCheck::Report("metrics_server_test");
+}
@@ -0,0 +1,295 @@
+// quote_bus_test.cpp — Two QuoteBus Instances on One POSIX Segment
+//
+// Each instance maps the segment on its own, as two AmiBroker processes
+// would. Checks that a reader never sees a torn quote while the writer
+// publishes, that the writer role passes on when its holder exits or goes
+// silent past the lease, and that an arena restart invalidates the series
+// written before it. The writers that die or stall are forked children, so
+// the lease sees a pid other than this process's.
+
+#include "QuoteBus.h"
+#include "SharedMemory.h"
+#include "TestCheck.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const size_t kArenaBytes = 1 << 20;
+const int kLeaseMs = 5000; // long enough that only a dead pid frees it
+
+// Every price and count field of a quote carries the same value, so a
+// reader that copied half of one publish and half of the next sees two
+std::vector<DseQuote> Board(size_t symbols, double value) {
+  std::vector<DseQuote> quotes(symbols);
+  for (size_t i = 0; i < symbols; ++i) {
+    DseQuote &q = quotes[i];
+    memset(&q, 0, sizeof(q));
+    snprintf(q.symbol, sizeof(q.symbol), "SYM%03u", (unsigned)i);
+    q.ltp = q.high = q.low = q.open = q.close = q.ycp = value;
+    q.change = q.changePercent = q.volume = q.trade = q.value = value;
+    q.valid = true;
+  }
+  return quotes;
+}
+
+bool Consistent(const DseQuote &q) {
+  const double v = q.ltp;
+  return q.high == v && q.low == v && q.open == v && q.close == v &&
+         q.ycp == v && q.change == v && q.changePercent == v &&
+         q.volume == v && q.trade == v && q.value == v && q.valid;
+}
+
+std::vector<DseBar> Bars(int count, double close) {
+  std::vector<DseBar> bars(count);
+  for (int i = 0; i < count; ++i) {
+    DseBar &b = bars[i];
+    memset(&b, 0, sizeof(b));
+    b.year = 2024;
+    b.month = 1;
+    b.day = i + 1;
+    b.open = b.high = b.low = b.close = close;
+    b.valid = true;
+  }
+  return bars;
+}
+
+// A writer in another process, driven over two pipes: it claims the role
+// and publishes, reports back, then waits for a command ('p' publish
+// again and report, 'q' exit without releasing the role)
+struct ChildWriter {
+  pid_t pid;
+  int toChild, fromChild;
+
+  bool Start(const char *name) {
+    int down[2], up[2];
+    if (pipe(down) != 0 || pipe(up) != 0)
+      return false;
+    pid = fork();
+    if (pid < 0)
+      return false;
+    if (pid == 0) {
+      close(down[1]);
+      close(up[0]);
+      QuoteBus bus;
+      char ok = bus.Open(name, kArenaBytes, kLeaseMs) &&
+                        bus.TryAcquireWriter() &&
+                        bus.PublishQuotes(Board(8, 7.0))
+                    ? 'y'
+                    : 'n';
+      if (write(up[1], &ok, 1) != 1)
+        _exit(2);
+      char cmd;
+      while (read(down[0], &cmd, 1) == 1 && cmd == 'p') {
+        ok = bus.PublishQuotes(Board(8, 8.0)) ? 'y' : 'n';
+        if (write(up[1], &ok, 1) != 1)
+          _exit(2);
+      }
+      _exit(0); // no destructors: the lease stays as a crash leaves it
+    }
+    close(down[0]);
+    close(up[1]);
+    toChild = down[1];
+    fromChild = up[0];
+    return true;
+  }
+
+  // Next report from the child: true for 'y'
+  bool Reply() {
+    char c = 0;
+    return read(fromChild, &c, 1) == 1 && c == 'y';
+  }
+
+  bool Publish() {
+    char cmd = 'p';
+    return write(toChild, &cmd, 1) == 1 && Reply();
+  }
+
+  void Exit() {
+    char cmd = 'q';
+    if (write(toChild, &cmd, 1) != 1)
+      kill(pid, SIGKILL);
+    int status;
+    waitpid(pid, &status, 0); // reaped, so its pid no longer answers
+    close(toChild);
+    close(fromChild);
+  }
+};
+
+void TestSeqlockReads(const char *name) {
+  QuoteBus writer, reader;
+  CHECK(writer.Open(name, kArenaBytes, kLeaseMs));
+  CHECK(reader.Open(name, kArenaBytes, kLeaseMs));
+
+  std::vector<DseQuote> out;
+  uint64_t seq = 0;
+  CHECK(!reader.ReadQuotes(out, seq)); // nothing published yet
+
+  CHECK(writer.TryAcquireWriter());
+  CHECK(writer.PublishQuotes(Board(50, 1.0)));
+  CHECK(reader.ReadQuotes(out, seq));
+  CHECK(seq == 1);
+  CHECK(out.size() == 50);
+  if (out.size() == 50)
+    CHECK(strcmp(out[0].symbol, "SYM000") == 0 &&
+          strcmp(out[49].symbol, "SYM049") == 0 && out[0].ltp == 1.0);
+
+  // A symbol missing from the latest snapshot is left out
+  CHECK(writer.PublishQuotes(Board(20, 2.0)));
+  CHECK(reader.ReadQuotes(out, seq));
+  CHECK(seq == 2 && out.size() == 20);
+
+  // Hammer the board from one mapping while the other reads it
+  const int kPublishes = 20000;
+  std::atomic<bool> done(false);
+  std::thread publisher([&] {
+    for (int i = 0; i < kPublishes; ++i)
+      writer.PublishQuotes(Board(50, 100.0 + i));
+    done = true;
+  });
+  size_t reads = 0, torn = 0;
+  uint64_t lastSeq = 0;
+  bool monotonic = true;
+  while (!done) {
+    if (!reader.ReadQuotes(out, seq))
+      continue;
+    ++reads;
+    monotonic = monotonic && seq >= lastSeq;
+    lastSeq = seq;
+    for (const auto &q : out)
+      torn += !Consistent(q);
+  }
+  publisher.join();
+  CHECK(reads > 0);
+  CHECK(torn == 0);
+  CHECK(monotonic);
+
+  CHECK(reader.ReadQuotes(out, seq));
+  CHECK(seq == 2 + (uint64_t)kPublishes);
+  CHECK(out.size() == 50);
+  for (const auto &q : out)
+    CHECK(q.ltp == 100.0 + kPublishes - 1);
+
+  writer.ReleaseWriter();
+}
+
+void TestDeadWriter(const char *name) {
+  QuoteBus bus;
+  CHECK(bus.Open(name, kArenaBytes, kLeaseMs));
+
+  ChildWriter child;
+  if (!child.Start(name)) {
+    CHECK(!"fork failed");
+    return;
+  }
+  CHECK(child.Reply());
+
+  // Live holder with a fresh lease keeps the role
+  CHECK(!bus.TryAcquireWriter());
+  CHECK(!bus.IsWriter());
+  std::vector<DseQuote> out;
+  uint64_t seq = 0;
+  CHECK(bus.ReadQuotes(out, seq));
+  CHECK(out.size() == 8 && out[0].ltp == 7.0);
+
+  // It exits without releasing; the lease is still fresh but its pid is
+  // gone, so the role is free at once
+  child.Exit();
+  CHECK(bus.TryAcquireWriter());
+  CHECK(bus.IsWriter());
+  CHECK(bus.PublishQuotes(Board(8, 9.0)));
+  bus.ReleaseWriter();
+}
+
+void TestStaleWriter(const char *name) {
+  ChildWriter child;
+  if (!child.Start(name)) {
+    CHECK(!"fork failed");
+    return;
+  }
+  CHECK(child.Reply());
+
+  // This instance holds writers to a short lease
+  const int kShortLeaseMs = 200;
+  QuoteBus bus;
+  CHECK(bus.Open(name, kArenaBytes, kShortLeaseMs));
+  CHECK(!bus.TryAcquireWriter());
+
+  // The child stays alive but stops publishing
+  std::this_thread::sleep_for(
+      std::chrono::milliseconds(kShortLeaseMs + 150));
+  std::vector<DseQuote> out;
+  uint64_t seq = 0;
+  CHECK(!bus.ReadQuotes(out, seq)); // the board is stale too
+  CHECK(bus.TryAcquireWriter());
+  CHECK(bus.PublishQuotes(Board(8, 10.0)));
+
+  // The old holder finds the role gone when it wakes up
+  CHECK(!child.Publish());
+  CHECK(bus.ReadQuotes(out, seq));
+  CHECK(out.size() == 8 && out[0].ltp == 10.0);
+
+  child.Exit();
+  bus.ReleaseWriter();
+}
+
+void TestArenaRestart(const char *name) {
+  // Room for two 20-bar series; the third starts the arena over
+  const size_t seriesBytes = (20 * sizeof(DseBar) + 63) & ~(size_t)63;
+  QuoteBus a, b;
+  CHECK(a.Open(name, 2 * seriesBytes + seriesBytes / 2, kLeaseMs));
+  CHECK(b.Open(name, kArenaBytes, kLeaseMs)); // creator's size wins
+
+  std::vector<DseBar> out;
+  CHECK(a.PublishBars("AAA", 20240101, 20240120, Bars(20, 1.0)));
+  CHECK(a.PublishBars("BBB", 20240101, 20240120, Bars(20, 2.0)));
+  CHECK(b.ReadBars("AAA", 20240105, 20240110, out));
+  CHECK(out.size() == 20 && out[0].close == 1.0);
+  CHECK(b.ReadBars("BBB", 20240101, 20240120, out));
+  CHECK(!b.ReadBars("BBB", 20231231, 20240120, out)); // window not covered
+  CHECK(!b.ReadBars("ZZZ", 20240101, 20240120, out));
+
+  // Published from the other mapping: both older series are invalidated
+  CHECK(b.PublishBars("CCC", 20240101, 20240120, Bars(20, 3.0)));
+  CHECK(!a.ReadBars("AAA", 20240101, 20240120, out));
+  CHECK(out.empty());
+  CHECK(!a.ReadBars("BBB", 20240101, 20240120, out));
+  CHECK(a.ReadBars("CCC", 20240101, 20240120, out));
+  CHECK(out.size() == 20 && out[19].close == 3.0);
+
+  // Republishing brings a series back in the new generation
+  CHECK(a.PublishBars("AAA", 20240101, 20240120, Bars(20, 4.0)));
+  CHECK(b.ReadBars("AAA", 20240101, 20240120, out));
+  CHECK(out.size() == 20 && out[0].close == 4.0);
+  CHECK(b.ReadBars("CCC", 20240101, 20240120, out));
+
+  // A series larger than the arena is refused
+  CHECK(!a.PublishBars("DDD", 20240101, 20241231, Bars(200, 5.0)));
+}
+
+} // namespace
+
+int main() {
+  std::string pid = std::to_string((unsigned)getpid());
+  std::string boardName = "dse_test_bus_" + pid;
+  std::string barsName = "dse_test_bars_" + pid;
+  SharedMemory::Remove(boardName.c_str());
+  SharedMemory::Remove(barsName.c_str());
+
+  TestSeqlockReads(boardName.c_str());
+  TestDeadWriter(boardName.c_str());
+  TestStaleWriter(boardName.c_str());
+  TestArenaRestart(barsName.c_str());
+
+  SharedMemory::Remove(boardName.c_str());
+  SharedMemory::Remove(barsName.c_str());
+  return TestCheck::Report("quote_bus_test");
+}
@@ -0,0 +1,163 @@
+// realtime_feed_test.cpp — RealtimeFeed Over a Replayed Session
+//
+// Plays a recorded session (a snapshot journal in which the board trades)
+// through the feed at full speed and lets it run past the last frame, where
+// a live feed would capture the close. The bar cache must come out exactly
+// as it went in: a replay never writes provisional bars into it. While it
+// plays, the engine clock runs on the recording's time.
+
+#include "CsvUtils.h"
+#include "DseDataEngine.h"
+#include "FeedSource.h"
+#include "OsServices.h"
+#include "RealtimeFeed.h"
+#include "SnapshotJournal.h"
+#include "TestCheck.h"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char *kDir = "realtime_feed_test_data";
+const int kSessionDate = 20240102;
+
+DseQuote Row(const char *symbol, double ltp, double volume) {
+  DseQuote q;
+  memset(&q, 0, sizeof(q));
+  strncpy(q.symbol, symbol, sizeof(q.symbol) - 1);
+  q.ltp = q.high = q.low = q.open = q.close = q.ycp = ltp;
+  q.volume = volume;
+  q.trade = volume / 10;
+  q.value = ltp * volume;
+  q.valid = true;
+  return q;
+}
+
+std::vector<DseBar> History() {
+  std::vector<DseBar> bars;
+  for (int day = 1; day <= 20; ++day) {
+    DseBar b;
+    memset(&b, 0, sizeof(b));
+    b.year = 2023;
+    b.month = 12;
+    b.day = day;
+    b.open = b.high = b.low = b.close = 100.0 + day;
+    b.volume = 1000;
+    b.valid = true;
+    bars.push_back(b);
+  }
+  return bars;
+}
+
+bool SameBars(const std::vector<DseBar> &a, const std::vector<DseBar> &b) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); ++i)
+    if (a[i].year != b[i].year || a[i].month != b[i].month ||
+        a[i].day != b[i].day || a[i].close != b[i].close ||
+        a[i].volume != b[i].volume || a[i].provisional != b[i].provisional)
+      return false;
+  return true;
+}
+
+// A session in which AAA and BBB trade on every frame
+bool WriteJournal(const std::string &dir, double &lastLtp) {
+  SnapshotJournal journal;
+  if (!journal.Open(dir.c_str(), kSessionDate,
+                    [](int, const std::vector<DseQuote> &) {}))
+    return false;
+  std::vector<DseQuote> board = {Row("AAA", 120.0, 500),
+                                 Row("BBB", 50.0, 800)};
+  for (int i = 0; i < 20; ++i) {
+    for (auto &q : board) {
+      q.ltp += 0.5;
+      q.volume += 100;
+    }
+    journal.Append(kSessionDate, 10 * 3600 + i * 60, board);
+  }
+  journal.Close();
+  lastLtp = board[0].ltp;
+  return true;
+}
+
+} // namespace
+
+int main() {
+  std::string seedDir = Os::JoinPath(kDir, "seed");
+  std::string journalDir = Os::JoinPath(kDir, "journal");
+  std::string iniPath = Os::JoinPath(kDir, "dse_config.ini");
+  Os::MakeDir(kDir);
+  Os::MakeDir(seedDir.c_str());
+  Os::MakeDir(journalDir.c_str());
+  CHECK(CsvUtils::ExportBarsToCsv("AAA", seedDir.c_str(), History()));
+  CHECK(CsvUtils::ExportBarsToCsv("BBB", seedDir.c_str(), History()));
+
+  FILE *ini = fopen(iniPath.c_str(), "w");
+  CHECK(ini != nullptr);
+  if (!ini)
+    return TestCheck::Report("realtime_feed_test");
+  fprintf(ini,
+          "[General]\nWatchConfig=0\n"
+          "[Debug]\nLogFilePath=%s\n"
+          "[DataSource]\nCsvSeedPath=%s\n",
+          Os::JoinPath(kDir, "dse_plugin.log").c_str(), seedDir.c_str());
+  fclose(ini);
+
+  // Start from an empty journal; Open would resume one left by a past run
+  std::string journalPath =
+      SnapshotJournal::SessionPath(journalDir.c_str(), kSessionDate);
+  remove(journalPath.c_str());
+  remove((journalPath.substr(0, journalPath.size() - 4) + ".dsx").c_str());
+  double lastLtp = 0;
+  CHECK(WriteJournal(journalDir, lastLtp));
+
+  // No HTTP client: history comes from the seeds alone
+  DseDataEngine engine;
+  CHECK(engine.Initialize(iniPath.c_str()));
+  std::vector<DseBar> before, after;
+  CHECK(engine.FetchHistoricalData("AAA", "2023-12-01", "2023-12-31", before));
+  CHECK(engine.FetchHistoricalData("BBB", "2023-12-01", "2023-12-31", after));
+  CHECK(engine.GetCachedBars("AAA", before));
+  CHECK(before.size() == 20);
+  CHECK(!engine.HasProvisionalBars());
+
+  std::unique_ptr<ReplayFeedSource> replay(
+      new ReplayFeedSource(&engine, journalPath.c_str(), 0));
+  CHECK(replay->Load());
+
+  RealtimeFeed feed;
+  feed.SetFeedSource(std::move(replay));
+  CHECK(feed.Start(NULL, &engine));
+
+  // Wait for the last frame, then give the loop time to pass the end of
+  // the session, where a live feed captures the close
+  DseQuote last;
+  bool done = false;
+  for (int i = 0; i < 500 && !done; ++i) {
+    done = feed.GetLatestQuote("AAA", last) && last.ltp == lastLtp;
+    if (!done)
+      Os::SleepMs(10);
+  }
+  CHECK(done);
+
+  // The engine clock follows the recording while it plays, so GetQuotesEx
+  // sees the replayed session as today and the market as open
+  MarketClock::Time now = engine.GetClock().Now();
+  CHECK(now.date == kSessionDate);
+  CHECK(now.secOfDay == 10 * 3600 + 19 * 60);
+  CHECK(engine.IsMarketOpen());
+
+  Os::SleepMs(500);
+  feed.Stop();
+  CHECK(engine.GetClock().Today() != kSessionDate); // system clock again
+
+  CHECK(engine.GetCachedBars("AAA", after));
+  CHECK(SameBars(before, after));
+  CHECK(!engine.HasProvisionalBars());
+
+  engine.Shutdown();
+  return TestCheck::Report("realtime_feed_test");
+}
@@ -0,0 +1,212 @@
+// snapshot_diff_test.cpp — SnapshotDiff Over Hand-Built Pages
+//
+// Walks one SnapshotDiff through the page sequences a poll loop meets:
+// the first page, an unchanged page, changed rows, a symbol dropping off
+// and coming back, rows in a new order, repeated rows and NaN fields.
+
+#include "QuoteCodec.h"
+#include "SnapshotDiff.h"
+#include "TestCheck.h"
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace QuoteCodec;
+
+namespace {
+
+DseQuote Row(const char *symbol, double ltp, double volume) {
+  DseQuote q;
+  memset(&q, 0, sizeof(q));
+  strncpy(q.symbol, symbol, sizeof(q.symbol) - 1);
+  q.ltp = q.high = q.low = q.open = q.close = q.ycp = ltp;
+  q.volume = volume;
+  q.trade = volume / 10;
+  q.value = ltp * volume;
+  q.valid = true;
+  return q;
+}
+
+std::vector<DseQuote> Page() {
+  return {Row("ACI", 250.0, 1000), Row("BATBC", 500.0, 2000),
+          Row("GP", 300.0, 3000), Row("SQURPHARMA", 210.0, 4000)};
+}
+
+const SnapshotDiff::Change *Find(const SnapshotDiff &diff,
+                                 const SnapshotDiff::ChangeSet &set,
+                                 const char *symbol) {
+  for (const auto &c : set.changes)
+    if (strcmp(diff.Name(c.id), symbol) == 0)
+      return &c;
+  return nullptr;
+}
+
+void TestAppearedAndUnchanged() {
+  SnapshotDiff diff;
+  SnapshotDiff::ChangeSet set;
+  diff.Apply(Page(), set);
+  CHECK(set.symbols == 4);
+  CHECK(diff.Symbols() == 4);
+  CHECK(set.changes.size() == 4 && set.quotes.size() == 4);
+  CHECK(set.halted.empty());
+  CHECK(set.PageMoved());
+  for (const auto &c : set.changes) {
+    CHECK(c.flags == SnapshotDiff::kAppeared);
+    CHECK((c.fields & (kLast | kTotalVol | kValue | kValid)) ==
+          (kLast | kTotalVol | kValue | kValid));
+    CHECK(c.volumeDelta == 0);
+  }
+  if (set.quotes.size() == 4)
+    CHECK(strcmp(set.quotes[2].symbol, "GP") == 0);
+
+  diff.Apply(Page(), set);
+  CHECK(set.Empty());
+  CHECK(!set.PageMoved());
+  CHECK(set.symbols == 4);
+
+  // Forgetting the board makes every row new again
+  diff.Reset();
+  diff.Apply(Page(), set);
+  CHECK(set.changes.size() == 4);
+  CHECK(set.changes.empty() ||
+        set.changes[0].flags == SnapshotDiff::kAppeared);
+}
+
+void TestChanged() {
+  SnapshotDiff diff;
+  SnapshotDiff::ChangeSet set;
+  diff.Apply(Page(), set);
+
+  std::vector<DseQuote> page = Page();
+  page[1].ltp = 505.0;   // BATBC trades at a new price
+  page[1].volume = 2100;
+  page[1].trade = 215;
+  page[1].value += 50500;
+  page[3].value = 1.0;   // SQURPHARMA: turnover column alone
+  diff.Apply(page, set);
+  CHECK(set.changes.size() == 2);
+  CHECK(set.halted.empty());
+  CHECK(set.PageMoved());
+
+  const SnapshotDiff::Change *traded = Find(diff, set, "BATBC");
+  CHECK(traded != nullptr);
+  if (traded) {
+    CHECK(traded->flags == (SnapshotDiff::kTraded | SnapshotDiff::kPriceMoved));
+    CHECK(traded->fields == (kLast | kTradeVol | kTotalVol | kValue));
+    CHECK(traded->volumeDelta == 100);
+    CHECK(traded->tradeDelta == 15);
+    CHECK(traded->valueDelta == 50500);
+  }
+  const SnapshotDiff::Change *value = Find(diff, set, "SQURPHARMA");
+  CHECK(value != nullptr && value->fields == kValue && value->flags == 0);
+  if (set.quotes.size() == 2)
+    CHECK(set.quotes[0].ltp == 505.0); // new rows, in page order
+
+  // A correction to another column alone is not a page move
+  page[3].value = 2.0;
+  diff.Apply(page, set);
+  CHECK(set.changes.size() == 1);
+  CHECK(!set.PageMoved());
+
+  // Volume going backwards is a correction, not a trade
+  page[2].volume = 2500;
+  diff.Apply(page, set);
+  const SnapshotDiff::Change *corrected = Find(diff, set, "GP");
+  CHECK(corrected != nullptr);
+  if (corrected) {
+    CHECK(corrected->flags == SnapshotDiff::kCorrected);
+    CHECK(corrected->volumeDelta == -500);
+  }
+
+  // NaN on both sides is no change
+  page[0].close = NAN;
+  diff.Apply(page, set);
+  CHECK(set.changes.size() == 1);
+  diff.Apply(page, set);
+  CHECK(set.Empty());
+}
+
+void TestHaltedAndBack() {
+  SnapshotDiff diff;
+  SnapshotDiff::ChangeSet set;
+  diff.Apply(Page(), set);
+  uint32_t gpId = set.changes.size() == 4 ? set.changes[2].id : 0;
+
+  std::vector<DseQuote> page = Page();
+  page.erase(page.begin() + 2); // GP drops off
+  diff.Apply(page, set);
+  CHECK(set.changes.empty());
+  CHECK(set.halted.size() == 1 && set.halted[0] == "GP");
+  CHECK(set.symbols == 3);
+  CHECK(diff.Symbols() == 3);
+  CHECK(set.PageMoved());
+
+  // Still gone: reported once, not on every poll
+  diff.Apply(page, set);
+  CHECK(set.Empty());
+
+  // Back at the end of the page, with its old ID
+  page.push_back(Row("GP", 301.0, 3000));
+  diff.Apply(page, set);
+  CHECK(set.halted.empty());
+  CHECK(set.changes.size() == 1);
+  if (set.changes.size() == 1) {
+    CHECK(set.changes[0].id == gpId);
+    CHECK(set.changes[0].flags == SnapshotDiff::kAppeared);
+  }
+  CHECK(diff.Symbols() == 4);
+
+  // One symbol swapped for another: one halt, one arrival
+  page[0] = Row("BEXIMCO", 120.0, 500);
+  diff.Apply(page, set);
+  CHECK(set.halted.size() == 1 && set.halted[0] == "ACI");
+  CHECK(set.changes.size() == 1 &&
+        set.changes[0].flags == SnapshotDiff::kAppeared);
+  CHECK(diff.Symbols() == 4);
+
+  // An empty page halts everything
+  diff.Apply(std::vector<DseQuote>(), set);
+  CHECK(set.halted.size() == 4);
+  CHECK(diff.Symbols() == 0);
+}
+
+void TestReordered() {
+  SnapshotDiff diff;
+  SnapshotDiff::ChangeSet set;
+  diff.Apply(Page(), set);
+
+  // Same rows, new order: nothing changed, nothing halted
+  std::vector<DseQuote> page = Page();
+  std::swap(page[0], page[3]);
+  std::swap(page[1], page[2]);
+  diff.Apply(page, set);
+  CHECK(set.Empty());
+  CHECK(set.symbols == 4);
+
+  // A change after the shuffle lands on the right symbol
+  page[0].ltp = 211.0; // SQURPHARMA, first row now
+  diff.Apply(page, set);
+  CHECK(set.changes.size() == 1);
+  if (set.changes.size() == 1) {
+    CHECK(strcmp(diff.Name(set.changes[0].id), "SQURPHARMA") == 0);
+    CHECK(set.changes[0].flags == SnapshotDiff::kPriceMoved);
+  }
+
+  // A repeated row keeps the first copy
+  page.push_back(Row("SQURPHARMA", 999.0, 1));
+  diff.Apply(page, set);
+  CHECK(set.Empty());
+  CHECK(set.symbols == 4);
+}
+
+} // namespace
+
+int main() {
+  TestAppearedAndUnchanged();
+  TestChanged();
+  TestHaltedAndBack();
+  TestReordered();
+  return TestCheck::Report("snapshot_diff_test");
+}